@@ -3,30 +3,50 @@
 
 #include "gpaddon.h"
 
+#include <type_traits>
 #include <vector>
 #include <pico/mutex.h>
 
 enum ADDON_PROCESS {
     CORE0_INPUT,
     CORE0_USBREPORT,
-    CORE1_LOOP
+    CORE1_LOOP,
+    ADDON_PROCESS_COUNT
 };
 
 struct AddonBlock {
     GPAddon * ptr;
-    ADDON_PROCESS process;
+    uint8_t perfStage; // PerfStats stage id
+    uint8_t jitterStage; // PerfStats stage id for how late a scheduled run started
+    uint64_t due; // When a scheduled addon next runs, in us since boot
 };
 
 class AddonManager {
 public:
     AddonManager() {}
     ~AddonManager() {}
-    void LoadAddon(GPAddon*, ADDON_PROCESS);
+
+    // Addons that keep the empty GPAddon::preprocess() are left out of the preprocess pass
+    template<typename T>
+    void LoadAddon(T* addon, ADDON_PROCESS processAt) {
+        constexpr bool hasPreprocess = !std::is_same<decltype(&T::preprocess), void (GPAddon::*)()>::value;
+        AddAddon(addon, processAt, hasPreprocess);
+    }
     void PreprocessAddons(ADDON_PROCESS);
     void ProcessAddons(ADDON_PROCESS);
+    uint64_t ProcessDueAddons(ADDON_PROCESS);
     GPAddon * GetAddon(std::string); // hack for NeoPicoLED
 private:
-    std::vector<AddonBlock*> addons;    // addons currently loaded
+    void AddAddon(GPAddon*, ADDON_PROCESS, bool hasPreprocess);
+    void siftDown(ADDON_PROCESS, size_t);
+
+    // Loaded addons bucketed by the pass that runs them, so each pass is a plain loop
+    std::vector<AddonBlock> preprocessAddons[ADDON_PROCESS_COUNT];
+    std::vector<AddonBlock> processAddons[ADDON_PROCESS_COUNT];
+
+    // Min-heap of indexes into processAddons, ordered by due time, for passes run by deadline
+    std::vector<uint8_t> schedule[ADDON_PROCESS_COUNT];
+    uint32_t cyclesPerMicro = 0;
 };
 
 #endif
@@ -57,6 +57,22 @@
 #define AUTO_CALIBRATE_ENABLED 0
 #endif
 
+// Sample the stick channels with a free-running round-robin into a DMA buffer instead of blocking reads.
+// Falls back to blocking reads when no DMA channel is free or the turbo dial also uses the ADC.
+#ifndef ANALOG_ADC_DMA
+#define ANALOG_ADC_DMA 1
+#endif
+
+// Samples per channel kept in the DMA buffer and averaged on every read, must be a power of two
+#ifndef ANALOG_ADC_OVERSAMPLE
+#define ANALOG_ADC_OVERSAMPLE 8
+#endif
+
+// Exponential moving average over reads, each read moves 1/2^n of the way to the new sample. 0 disables it.
+#ifndef ANALOG_ADC_SMOOTHING
+#define ANALOG_ADC_SMOOTHING 0
+#endif
+
 // Analog Module Name
 #define AnalogName "Analog"
 
@@ -65,7 +81,6 @@ public:
 	virtual bool available();
 	virtual void setup();       // Analog Setup
 	virtual void process();     // Analog Process
-	virtual void preprocess() {}
     virtual std::string name() { return AnalogName; }
 private:
 	uint16_t adc_1_x_center = 0;
@@ -73,9 +88,21 @@ private:
 	uint16_t adc_2_x_center = 0;
 	uint16_t adc_2_y_center = 0;
 
-	static float readPin(int pin, uint16_t center, bool autoCalibrate, float deadzone);
+	// Round-robin sampling, the buffer holds ANALOG_ADC_OVERSAMPLE rounds of one sample per channel in adcMask
+	int dataChannel = -1;
+	int controlChannel = -1;
+	uint8_t adcMask = 0;
+	uint8_t adcChannelCount = 0;
+	uint16_t * adcSamples = nullptr; // Also the word the control channel rewrites into the data channel
+	uint32_t adcFiltered[4] = {}; // EMA state per ADC input, scaled by 2^ANALOG_ADC_SMOOTHING
+	uint8_t adcFilterSeeded = 0;
+
+	bool startSampling(uint8_t mask);
+	uint16_t readADC(uint8_t input);
+	uint16_t filter(uint8_t input, uint16_t value);
+	int32_t readPin(int pin, uint16_t center, bool autoCalibrate, uint32_t deadzone);
 	static uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
-	void adjustCircularity(float& x, float& y);
+	static void adjustCircularity(int32_t& x, int32_t& y);
 };
 
 #endif  // _Analog_H_
\ No newline at end of file
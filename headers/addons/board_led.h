@@ -25,7 +25,6 @@ public:
 	virtual bool available();
 	virtual void setup();       // BoardLed Setup
 	virtual void process();     // BoardLed Process
-	virtual void preprocess() {}
 	virtual std::string name() { return OnBoardLedName; }
 private:
 	OnBoardLedMode onBoardLedMode;
@@ -127,9 +127,9 @@ class BuzzerSpeakerAddon : public GPAddon
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
 	virtual std::string name() { return BuzzerSpeakerName; }
+	virtual uint32_t interval() { return currentSong != NULL ? 1000 : 10000; } // tones are timed in ms
 private:
 	void processBuzzer();
 	void play(Song *song);
@@ -36,7 +36,6 @@ public:
 	virtual bool available();
 	virtual void setup();       // FocusMode Setup
 	virtual void process();     // FocusMode Process
-	virtual void preprocess() {}
 	virtual std::string name() { return FocusModeName; }
 private:
 	uint32_t buttonLockMask;
@@ -31,6 +31,11 @@
 #define I2C_ANALOG1219_ADDRESS 0x40
 #endif
 
+// DRDY pin of the ADS1219, when set conversions are collected from interrupts instead of polled
+#ifndef I2C_ANALOG1219_DRDY_PIN
+#define I2C_ANALOG1219_DRDY_PIN    -1
+#endif
+
 // Analog Module Name
 #define I2CAnalog1219Name "I2CAnalog"
 
@@ -40,17 +45,20 @@ typedef struct {
 
 class I2CAnalog1219Input : public GPAddon {
 public:
+	virtual ~I2CAnalog1219Input() { delete ads; }
 	virtual bool available();
 	virtual void setup();       // Analog Setup
-	virtual void preprocess() {}
 	virtual void process();     // Analog Process
     virtual std::string name() { return I2CAnalog1219Name; }
 private:
-    ADS1219 * ads;
+    ADS1219 * ads = nullptr;
 	ADS_PINS pins;
 	int channelHop;
 	uint32_t uIntervalMS;       // ADS1219 Interval
 	uint32_t nextTimer;         // Turbo Timer
+	bool interruptMode = false;
+	uint32_t cyclesPerMicro;
+	uint8_t perfSampleAge;      // Age of the stalest axis
 };
 
 #endif  // _I2CAnalog_H_
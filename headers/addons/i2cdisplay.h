@@ -58,6 +58,11 @@
 #define DISPLAY_SAVER_TIMEOUT 0
 #endif
 
+// Hand display updates to DMA and let the other core1 addons run while they go out
+#ifndef DISPLAY_I2C_DMA
+#define DISPLAY_I2C_DMA 1
+#endif
+
 #ifndef SPLASH_DURATION
 #define SPLASH_DURATION 7500 // Duration in milliseconds
 #endif
@@ -139,7 +144,6 @@ class I2CDisplayAddon : public GPAddon
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
 	virtual std::string name() { return I2CDisplayName; }
 private:
@@ -150,6 +154,7 @@ private:
 	void drawWasdBox(int startX, int startY, int buttonRadius, int buttonPadding);
 	void drawArcadeStick(int startX, int startY, int buttonRadius, int buttonPadding);
 	void drawStatusBar(Gamepad*);
+	void updateStatusBar(Gamepad*);
 	void drawText(int startX, int startY, std::string text);
 	void initMenu(char**);
 	//Adding my stuff here, remember to sort before PR
@@ -194,6 +199,9 @@ private:
 	uint8_t displayIsPowerOn = 1;
 	uint32_t prevMillis;
 	uint8_t ucBackBuffer[1024];
+	uint8_t ucFrontBuffer[1024]; // What the display shows, only the difference is sent
+	bool flushFailed; // Last asynchronous update was NACKed, ucFrontBuffer can't be trusted
+	static void flushDone(void* pUser, int bError);
 	OBDISP obd;
 	std::string statusBar;
 	Gamepad* gamepad;
@@ -208,6 +216,12 @@ private:
 
 	DisplayMode getDisplayMode();
 	DisplayMode prevDisplayMode;
+
+	// Inputs of the last button layout frame, an unchanged frame is not redrawn
+	bool hasRenderedButtons;
+	uint16_t renderedButtons;
+	uint8_t renderedDirections;
+	std::string renderedStatusBar;
 	uint16_t prevButtonState;
 	bool isFocusModeEnabled;
 	bool focusModePrevState;
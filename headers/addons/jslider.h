@@ -24,7 +24,6 @@ class JSliderInput : public GPAddon {
 public:
     virtual bool available();
 	virtual void setup();       // JSlider Button Setup
-    virtual void preprocess() {}
 	virtual void process();     // JSlider process
     virtual std::string name() { return JSliderName; }
 private:
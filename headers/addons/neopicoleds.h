@@ -167,9 +167,9 @@ class NeoPicoLEDAddon : public GPAddon {
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
 	virtual std::string name() { return NeoPicoLEDName; }
+	virtual uint32_t interval() { return intervalMS * 1000; }
 	void configureLEDs();
 	uint32_t frame[100];
 private:
@@ -181,7 +181,6 @@ private:
 	std::vector<std::vector<Pixel>> createLEDLayout(ButtonLayout layout, uint8_t ledsPerPixel, uint8_t ledButtonCount);
 	uint8_t setupButtonPositions();
 	const uint32_t intervalMS = 10;
-	absolute_time_t nextRunTime;
 	uint8_t ledCount;
 	PixelMatrix matrix;
 	NeoPico *neopico;
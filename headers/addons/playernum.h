@@ -23,7 +23,6 @@ public:
 	virtual bool available();
 	virtual void setup();       // Analog Setup
 	virtual void process();     // Analog Process
-	virtual void preprocess() {}
     virtual std::string name() { return PlayerNumName; }
 private:
 	void handleLED(int);
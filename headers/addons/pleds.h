@@ -36,7 +36,6 @@ class PlayerLEDAddon : public GPAddon
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
 	virtual std::string name() { return PLEDName; }
 	PlayerLEDAddon() {
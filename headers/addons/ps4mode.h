@@ -17,7 +17,6 @@ class PS4ModeAddon : public GPAddon {
 public:
 	virtual bool available();
 	virtual void setup();       // TURBO Button Setup
-	virtual void preprocess() {}
 	virtual void process();     // TURBO Setting of buttons (Enable/Disable)
 	virtual std::string name() { return PS4ModeName; }
 private:
@@ -28,17 +28,28 @@
 #define SNES_PAD_DATA_PIN -1
 #endif
 
+// Clock the controller from a pio1 state machine when one is free instead of bit-banging it.
+// Off until it has been checked against real controllers.
+#ifndef SNES_PAD_PIO
+#define SNES_PAD_PIO 0
+#endif
+
 class SNESpadInput : public GPAddon {
 public:
 	virtual bool available();
 	virtual void setup();       // SNESpad Setup
 	virtual void process();     // SNESpad Process
-	virtual void preprocess() {}
 	virtual std::string name() { return SNESpadName; }
 private:
     SNESpad * snes;
     uint32_t uIntervalMS;
     uint32_t nextTimer;
+    bool usePIO = false;
+
+    uint32_t lastSampleTime = 0;
+    uint32_t cyclesPerMicro;
+    uint8_t perfSampleAge;      // Age of the state the gamepad was built from
+    uint8_t perfSampleInterval; // Time between consecutive reads
 
     bool buttonA = false;
     bool buttonB = false;
@@ -90,7 +90,6 @@ class TurboInput : public GPAddon {
 public:
     virtual bool available();
 	virtual void setup();       // TURBO Button Setup
-    virtual void preprocess() {}
 	virtual void process();     // TURBO Setting of buttons (Enable/Disable)
     virtual std::string name() { return TurboName; }
 private:
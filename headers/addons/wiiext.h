@@ -37,18 +37,28 @@
 #define WII_EXTENSION_I2C_SPEED 400000
 #endif
 
+// Poll the extension from a timer alarm instead of blocking the gamepad loop on the bus.
+// Off until it has been checked against real extensions.
+#ifndef WII_EXTENSION_ASYNC
+#define WII_EXTENSION_ASYNC 0
+#endif
+
 class WiiExtensionInput : public GPAddon {
 public:
 	virtual bool available();
 	virtual void setup();       // WiiExtension Setup
 	virtual void process();     // WiiExtension Process
-	virtual void preprocess() {}
 	virtual std::string name() { return WiiExtensionName; }
 private:
     WiiExtension * wii;
     uint32_t uIntervalMS;
     uint32_t nextTimer;
 
+    uint32_t lastSampleTime = 0;
+    uint32_t cyclesPerMicro;
+    uint8_t perfSampleAge;      // Age of the report the gamepad state was built from
+    uint8_t perfSampleInterval; // Time between consecutive reports
+
     bool buttonC = false;
     bool buttonZ = false;
 
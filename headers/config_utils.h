@@ -11,6 +11,11 @@ namespace ConfigUtils {
     void initUnsetPropertiesWithDefaults(Config& config);
 
     std::string toJSON(const Config& config);
+    // Copies the bytes [offset, offset + size) of toJSON(config) into buffer and returns how many were copied.
+    // The text is regenerated up to offset + size on every call, so a response can be streamed without keeping it in
+    // memory at the cost of serializing the start of it again for every chunk.
+    size_t toJSON(const Config& config, char* buffer, size_t offset, size_t size);
+    size_t jsonLength(const Config& config);
     bool fromJSON(Config& config, const char* data, size_t dataLen);
     bool fromLegacyStorage(Config& config);
 }
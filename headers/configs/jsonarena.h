@@ -0,0 +1,48 @@
+#ifndef _JSONARENA_H_
+#define _JSONARENA_H_
+
+#include <cstddef>
+#include <cstdlib>
+
+// Allocator for ArduinoJson's BasicJsonDocument. Every web config handler works on a single JSON document at a time,
+// so they all share one arena of ArenaSize bytes. It is allocated on the first request and then kept, which stops
+// repeated requests from fragmenting or exhausting the heap. A second document alive at the same time (e.g. while
+// ArduinoJson copies one) falls back to the heap.
+template <size_t ArenaSize>
+struct JsonArenaAllocator
+{
+	void* allocate(size_t size)
+	{
+		if (!arenaInUse && size <= ArenaSize)
+		{
+			if (arena == nullptr)
+				arena = malloc(ArenaSize);
+			if (arena != nullptr)
+			{
+				arenaInUse = true;
+				return arena;
+			}
+		}
+		return malloc(size);
+	}
+
+	void deallocate(void* ptr)
+	{
+		if (ptr != nullptr && ptr == arena)
+			arenaInUse = false;
+		else
+			free(ptr);
+	}
+
+	void* reallocate(void* ptr, size_t newSize)
+	{
+		if (ptr != nullptr && ptr == arena)
+			return newSize <= ArenaSize ? ptr : nullptr;
+		return realloc(ptr, newSize);
+	}
+
+	static inline void* arena = nullptr;
+	static inline bool arenaInUse = false;
+};
+
+#endif
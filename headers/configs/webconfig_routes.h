@@ -0,0 +1,38 @@
+#ifndef _WEBCONFIG_ROUTES_H_
+#define _WEBCONFIG_ROUTES_H_
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+// Route tables of the web config, arrays of paths or of (path, handler) pairs. They are kept sorted by path so a
+// lookup is a binary search, isSortedByPath() lets a static_assert check that at compile time.
+
+static constexpr int comparePaths(const char* a, const char* b)
+{
+	return (*a != *b || *a == '\0') ? static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b) : comparePaths(a + 1, b + 1);
+}
+
+static constexpr const char* routePath(const char* path) { return path; }
+template <typename T>
+static constexpr const char* routePath(const std::pair<const char*, T>& route) { return route.first; }
+
+template <typename T, size_t N>
+static constexpr bool isSortedByPath(const T (&routes)[N])
+{
+	for (size_t i = 1; i < N; i++)
+		if (comparePaths(routePath(routes[i - 1]), routePath(routes[i])) >= 0)
+			return false;
+	return true;
+}
+
+template <typename T, size_t N>
+static const T* findRoute(const T (&routes)[N], const char* name)
+{
+	const T* route = std::lower_bound(std::begin(routes), std::end(routes), name,
+		[](const T& route, const char* name) { return strcmp(routePath(route), name) < 0; });
+	return (route != std::end(routes) && strcmp(routePath(*route), name) == 0) ? route : nullptr;
+}
+
+#endif
@@ -24,6 +24,16 @@ extern uint64_t getMicro();
 #define GAMEPAD_POLL_MS 1
 #define GAMEPAD_POLL_MICRO 100
 
+// Align the read/process/send pass to USB start-of-frame instead of the free running poll
+#ifndef GAMEPAD_SOF_SYNC
+#define GAMEPAD_SOF_SYNC 0
+#endif
+
+// How far ahead of the expected start-of-frame the SOF synced pass starts
+#ifndef GAMEPAD_SOF_LEAD_MICRO
+#define GAMEPAD_SOF_LEAD_MICRO 100
+#endif
+
 #define GAMEPAD_FEATURE_REPORT_SIZE 32
 
 struct GamepadButtonMapping
@@ -57,9 +67,12 @@ struct GamepadButtonMapping
 
 #define GAMEPAD_DIGITAL_INPUT_COUNT 18 // Total number of buttons, including D-pad
 
+// GPIO snapshot is remapped one nibble at a time, covering all of bank 0
+#define GAMEPAD_PIN_LUT_NIBBLES ((NUM_BANK0_GPIOS + 3) / 4)
+
 class Gamepad {
 public:
-	Gamepad(int debounceMS = 5);
+	Gamepad(int debounceMS = 5, DebounceMode debounceMode = DEBOUNCE_MODE_EAGER);
 
 	void setup();
 	void teardown_and_reinit(const uint32_t profileNum);
@@ -85,8 +98,22 @@ public:
 	 */
 	bool hasRightAnalogStick {false};
 
-	void *getReport();
-	uint16_t getReportSize();
+	/**
+	 * @brief Encode the current state for the active input mode into a report buffer.
+	 *
+	 * Encoders only write the fields that follow the state, so the buffer must first be
+	 * primed with getReportTemplate(). The encoder, template and report size are picked
+	 * once by selectReportEncoder() rather than switching on the input mode every frame.
+	 */
+	inline void encodeReport(void *report) { (this->*reportEncoder)(report); }
+	inline const void *getReportTemplate() const { return reportTemplate; }
+	inline uint16_t getReportSize() { return reportSize; }
+
+	/**
+	 * @brief Check whether the state has changed since the last report went out.
+	 */
+	bool isReportDirty() const;
+	inline void markReportSent() { reportedState = state; }
 	HIDReport *getHIDReport();
 	SwitchReport *getSwitchReport();
 	XInputReport *getXInputReport();
@@ -150,7 +177,7 @@ public:
 
 	const GamepadOptions& getOptions() const { return options; }
 
-	void setInputMode(InputMode inputMode) { options.inputMode = inputMode; }
+	void setInputMode(InputMode inputMode);
 	void setSOCDMode(SOCDMode socdMode) { options.socdMode = socdMode; }
 	void setDpadMode(DpadMode dpadMode) { options.dpadMode = dpadMode; }
 
@@ -178,6 +205,14 @@ public:
 	GamepadButtonMapping *mapButtonA2;
 	GamepadButtonMapping **gamepadMappings;
 
+	/**
+	 * @brief GPIO nibble to packed button lookup, rebuilt on setup and profile switch.
+	 *
+	 * Each entry holds buttons in bits 0-15, dpad in bits 16-19 and the Function
+	 * button in bit 31, so read() is a fixed number of loads and ORs.
+	 */
+	uint32_t pinLUT[GAMEPAD_PIN_LUT_NIBBLES][16] {};
+
 	inline static const SOCDMode resolveSOCDMode(const GamepadOptions& options) {
 		 return (options.socdMode == SOCD_MODE_BYPASS &&
 				 (options.inputMode == INPUT_MODE_HID ||
@@ -192,11 +227,24 @@ private:
 	uint8_t getModifier(uint8_t code);
 	uint8_t getMultimedia(uint8_t code);
 	void processHotkeyIfNewAction(GamepadHotkey action);
+	void buildPinLUT(const PinMappings& pinMappings);
+	void selectReportEncoder();
+	template<typename Report> void encodeReportAs(void *report);
+	template<typename Report> void useReportEncoder(const Report *reportTemplate);
+	void fillHIDReport(HIDReport& report);
+	void fillSwitchReport(SwitchReport& report);
+	void fillXInputReport(XInputReport& report);
+	void fillPS4Report(PS4Report& report);
 
 	GamepadOptions& options;
 	const HotkeyOptions& hotkeyOptions;
 
 	GamepadHotkey lastAction = HOTKEY_NONE;
+
+	void (Gamepad::*reportEncoder)(void *report) = nullptr;
+	const void *reportTemplate = nullptr;
+	uint16_t reportSize = 0;
+	GamepadState reportedState;
 };
 
 #endif
@@ -7,21 +7,44 @@
 
 #include <string.h>
 #include <stdint.h>
+#include "GamepadEnums.h"
 #include "GamepadState.h"
 
 // Implement this wrapper function for your platform
 // TODO: Make this a pure virtual member instead.
-uint32_t getMillis();
+uint64_t getMicro();
 
+// Dpad bits are packed above the 16 button bits, matching GAMEPAD_MASK_DU..DR
+#define DEBOUNCE_DPAD_SHIFT 16
+#define DEBOUNCE_BIT_COUNT 20
+
+/**
+ * @brief Debounces buttons and dpad as one packed 32-bit word with microsecond timing.
+ *
+ * Changed, locked and pending bits are tracked as masks, so a frame with no input
+ * activity is a handful of word operations. Per-bit timestamps are only touched for
+ * bits that are currently locked or waiting to settle.
+ *
+ * - DEBOUNCE_MODE_EAGER: report a change immediately, then ignore that bit for the window.
+ * - DEBOUNCE_MODE_DEFER: report a change once it has been stable for the window.
+ * - DEBOUNCE_MODE_ASYMMETRIC: eager on press, deferred on release.
+ */
 class GamepadDebouncer
 {
 	public:
-		GamepadDebouncer(const uint8_t debounceMS = 5) : debounceMS(debounceMS) { }
+		GamepadDebouncer(const uint8_t debounceMS = 5, const DebounceMode mode = DEBOUNCE_MODE_EAGER) :
+			debounceMS(debounceMS), debounceUs(debounceMS * 1000), mode(mode) { }
 
 		void debounce(GamepadState *state);
+		uint32_t debounceBits(uint32_t raw, uint32_t now);
 
 		const uint8_t debounceMS;
-		GamepadState debounceState;
-		uint32_t dpadTime[4];
-		uint32_t buttonTime[GAMEPAD_BUTTON_COUNT];
+		const uint32_t debounceUs;
+		const DebounceMode mode;
+
+	private:
+		uint32_t debounced = 0;   // Reported state
+		uint32_t lockedMask = 0;  // Eager bits ignoring input until their window ends
+		uint32_t pendingMask = 0; // Deferred bits waiting for input to settle
+		uint32_t bitTime[DEBOUNCE_BIT_COUNT] = {};
 };
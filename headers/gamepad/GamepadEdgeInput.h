@@ -0,0 +1,67 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2021 Jason Skuby (mytechtoybox.com)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Wake the core0 loop on GPIO edges of mapped buttons instead of waiting out GAMEPAD_POLL_MICRO
+#ifndef GAMEPAD_EDGE_TRIGGERED
+#define GAMEPAD_EDGE_TRIGGERED 0
+#endif
+
+#define GAMEPAD_EDGE_QUEUE_SIZE 32 // Must be a power of two
+#define GAMEPAD_EDGE_LATENCY_BUCKETS 16
+
+struct GamepadEdgeEvent
+{
+	uint32_t timestamp; // time_us_32() when the edge was seen
+	uint32_t values;    // Inverted gpio_get_all() at the edge
+};
+
+/**
+ * @brief Timestamps button edges from the GPIO IRQ into a single-producer/single-consumer ring.
+ *
+ * Both the IRQ and the consumer run on core0, so the ring only needs ordered head/tail updates.
+ * Press-to-send_report latency is kept as a histogram where bucket n counts latencies in
+ * [2^(n-1), 2^n) microseconds, with the last bucket collecting everything above.
+ */
+class GamepadEdgeInput
+{
+public:
+	GamepadEdgeInput(GamepadEdgeInput const&) = delete;
+	void operator=(GamepadEdgeInput const&) = delete;
+	static GamepadEdgeInput& getInstance()
+	{
+		static GamepadEdgeInput instance;
+		return instance;
+	}
+
+	void setup(uint32_t pinMask);
+	void teardown();
+
+	bool pending() const { return head != tail; }
+	bool drain();
+	void reportSent();
+
+	const uint32_t * getLatencyHistogram() const { return latencyHistogram; }
+	uint32_t getDroppedEvents() const { return droppedEvents; }
+	const GamepadEdgeEvent& getLastEvent() const { return lastEvent; }
+
+private:
+	GamepadEdgeInput() {}
+	static void irqHandler();
+
+	uint32_t pinMask = 0;
+	volatile uint32_t head = 0;
+	volatile uint32_t tail = 0;
+	volatile uint32_t droppedEvents = 0;
+	GamepadEdgeEvent queue[GAMEPAD_EDGE_QUEUE_SIZE];
+	GamepadEdgeEvent lastEvent = {};
+
+	bool reportPending = false;
+	uint32_t reportPendingSince = 0;
+	uint32_t latencyHistogram[GAMEPAD_EDGE_LATENCY_BUCKETS] = {};
+};
@@ -14,3 +14,11 @@ typedef enum
 	DIRECTION_LEFT,
 	DIRECTION_RIGHT
 } DpadDirection;
+
+// Algorithm used by GamepadDebouncer
+typedef enum
+{
+	DEBOUNCE_MODE_EAGER,
+	DEBOUNCE_MODE_DEFER,
+	DEBOUNCE_MODE_ASYMMETRIC
+} DebounceMode;
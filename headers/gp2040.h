@@ -36,6 +36,29 @@ private:
     };
     RebootHotkeys rebootHotkeys;
 
+    // PerfStats stage ids for the core0 loop
+    struct PerfStages {
+        uint8_t loop;
+        uint8_t read;
+        uint8_t debounce;
+        uint8_t hotkey;
+        uint8_t process;
+        uint8_t sendReport;
+        uint8_t tudTask;
+        uint8_t inputAge;
+        uint8_t flashCommit;
+    };
+    PerfStages perfStages;
+
+#if GAMEPAD_SOF_SYNC
+    // Input age is measured from read() to the start of the frame the report goes out in
+    uint64_t nextSofRuntime(uint64_t now);
+    void recordInputAge();
+    uint64_t sofSampleTime;
+    bool sofAwaitingPoll;
+    uint32_t cyclesPerMicro;
+#endif
+
     enum class BootAction {
         NONE,
         ENTER_WEBCONFIG_MODE,
@@ -18,8 +18,8 @@ public:
     void setup();           // setup core1
     void run();             // loop core1
 private:
-    uint64_t nextRuntime;
     AddonManager addons;
+    uint8_t perfLoopStage;
 };
 
 #endif
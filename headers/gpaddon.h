@@ -8,11 +8,14 @@
 class GPAddon
 {
 public:
+	virtual ~GPAddon() {} // AddonManager deletes addons that aren't available
 	virtual bool available() = 0;
 	virtual void setup() = 0;
 	virtual void process() = 0;
-	virtual void preprocess() = 0;
+	virtual void preprocess() {}
 	virtual std::string name() = 0;
+	// Microseconds between process() calls on core1, asked again after every call. 0 runs it on every core1 pass
+	virtual uint32_t interval() { return GAMEPAD_POLL_MICRO; }
 };
 
 #endif
\ No newline at end of file
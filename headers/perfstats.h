@@ -0,0 +1,63 @@
+#ifndef PERFSTATS_H_
+#define PERFSTATS_H_
+
+#include <cstdint>
+
+#include "hardware/structs/systick.h"
+
+// Opt-in cycle-count profiling of the core0 and core1 loops
+#ifndef PERF_STATS_ENABLED
+#define PERF_STATS_ENABLED 0
+#endif
+
+#define PERF_STATS_MAX_STAGES 32 // Per core
+#define PERF_STATS_BUCKETS 40
+#define PERF_STATS_NAME_LENGTH 24
+#define PERF_STATS_NONE 0xff
+
+// Cycle statistics for one stage of a core loop
+struct PerfStage {
+    char name[PERF_STATS_NAME_LENGTH];
+    uint32_t samples;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    // Two buckets per power of two, halved when one saturates
+    uint16_t histogram[PERF_STATS_BUCKETS];
+
+    uint32_t getAverage() const { return samples ? totalCycles / samples : 0; }
+    uint32_t getPercentile(uint8_t percent) const;
+};
+
+struct PerfStatsCore {
+    uint32_t magic;
+    uint8_t stageCount;
+    PerfStage stages[PERF_STATS_MAX_STAGES];
+};
+
+// Stats live in uninitialized RAM so that a gamepad session can be inspected after
+// rebooting into web config. Sessions are only recorded outside of web config mode.
+namespace PerfStats {
+#if PERF_STATS_ENABLED
+    // Starts a new session for the calling core, clearing its previous stats
+    void start();
+    // Registers a stage for the calling core, returns PERF_STATS_NONE when not recording
+    uint8_t addStage(const char* name, const char* suffix = nullptr);
+    // Records the cycles elapsed since start against a stage and returns the current count
+    uint32_t lap(uint8_t stage, uint32_t start);
+    // Records a cycle count measured elsewhere against a stage
+    void record(uint8_t stage, uint32_t cycles);
+    // SysTick counts down from 0xFFFFFF at the processor clock
+    inline uint32_t now() { return systick_hw->cvr; }
+#else
+    inline void start() {}
+    inline uint8_t addStage(const char*, const char* = nullptr) { return PERF_STATS_NONE; }
+    inline uint32_t lap(uint8_t, uint32_t) { return 0; }
+    inline void record(uint8_t, uint32_t) {}
+    inline uint32_t now() { return 0; }
+#endif
+    // Returns the last recorded session for a core, or nullptr if there is none
+    const PerfStatsCore* getCoreStats(uint8_t core);
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Single-writer sequence lock for handing a small POD value between cores.
+ *
+ * The writer never waits; it bumps the sequence to odd, copies, then bumps it back to even.
+ * Readers copy the value and retry if the sequence was odd or changed underneath them,
+ * so they always see a coherent snapshot.
+ */
+template<typename T>
+class SeqLock
+{
+public:
+	void write(const T& value)
+	{
+		const uint32_t seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		data = value;
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	// Copies the latest value and returns its version, which increases with every write
+	uint32_t read(T& value) const
+	{
+		uint32_t before;
+		uint32_t after;
+		do {
+			before = sequence.load(std::memory_order_acquire);
+			value = data;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = sequence.load(std::memory_order_relaxed);
+		} while ((before & 1) || before != after);
+		return before >> 1;
+	}
+
+	uint32_t version() const { return sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+	std::atomic<uint32_t> sequence {0};
+	T data {};
+};
+
+#endif
@@ -13,6 +13,7 @@
 #include "enums.h"
 #include "helper.h"
 #include "gamepad.h"
+#include "seqlock.h"
 
 #include "config.pb.h"
 
@@ -22,6 +23,13 @@
 
 #define SI Storage::getInstance()
 
+// Gamepad state and USB feature data handed from core0 to core1 each loop
+struct PublishedGamepadData
+{
+	GamepadState state;
+	uint8_t featureData[GAMEPAD_FEATURE_REPORT_SIZE];
+};
+
 // Storage manager for board, LED options, and thread-safe settings
 class Storage {
 public:
@@ -64,6 +72,10 @@ public:
 	void SetProcessedGamepad(Gamepad *); // MPGS Processed Gamepad Get/Set
 	Gamepad * GetProcessedGamepad();
 
+	void PublishProcessedGamepad(const GamepadState&); // Core0: publish state and feature data
+	uint32_t SyncProcessedGamepad();	// Core1: take a coherent snapshot, returns its version
+	uint8_t * GetProcessedFeatureData();	// Core1 copy of the feature data
+
 	void SetFeatureData(uint8_t *); 	// USB Feature Data Get/Set
 	void ClearFeatureData();
 	uint8_t * GetFeatureData();
@@ -78,7 +90,9 @@ private:
 	bool CONFIG_MODE = false; 			// Config mode (boot)
 	Gamepad * gamepad = nullptr;    		// Gamepad data
 	Gamepad * processedGamepad = nullptr; // Gamepad with ONLY processed data
-	uint8_t featureData[32]; // USB X-Input Feature Data
+	uint8_t featureData[GAMEPAD_FEATURE_REPORT_SIZE]; // USB X-Input Feature Data
+	SeqLock<PublishedGamepadData> publishedGamepad;
+	PublishedGamepadData processedGamepadData = {}; // Core1 snapshot of publishedGamepad
 	DisplayOptions previewDisplayOptions;
 	Config config;
 	std::atomic<bool> animationOptionsSavePending;
@@ -2,6 +2,12 @@
 
 #include <cstring>
 
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+ADS1219 *ADS1219::interruptDevice = nullptr;
+
 ADS1219::ADS1219(int bWire, int sda, int scl, i2c_inst_t *picoI2C, int32_t speed, uint8_t addr) {
   bbi2c.iSDA = sda;
   bbi2c.iSCL = scl;
@@ -13,6 +19,10 @@ ADS1219::ADS1219(int bWire, int sda, int scl, i2c_inst_t *picoI2C, int32_t speed
   singleShot = true;
 }
 
+ADS1219::~ADS1219() {
+  endInterrupt();
+}
+
 void ADS1219::begin() {
   I2CInit(&bbi2c, iSpeed); // on Linux, SDA = bus number, SCL = device address
   reset();
@@ -78,7 +88,11 @@ uint32_t ADS1219::readConversionResult(){
   uc[0] = 0x10; // Read from 24-bit conversion
   I2CWrite(&bbi2c, address, uc, 1);
   I2CRead(&bbi2c, address, uc, 3);
-  uint32_t data32 = (uc[0] << 16) | (uc[1] << 8) | (uc[2]);
+  return decodeResult(uc);
+}
+
+uint32_t ADS1219::decodeResult(const uint8_t *data){
+  uint32_t data32 = (data[0] << 16) | (data[1] << 8) | (data[2]);
   if (data32 >= 0x800000)
 			data32 = data32-0x1000000;
   return data32; // 24-bit ADC result signage hack
@@ -191,23 +205,159 @@ void ADS1219::setVoltageReference(adsRef_t vref){
   writeRegister(config);
 }
 
-void ADS1219::setChannel(int channel){
-  config &= MUX_MASK;
+uint8_t ADS1219::channelMux(int channel){
 	switch (channel){
     case (0):
-      config |= MUX_SINGLE_0;
-      break;
+      return MUX_SINGLE_0;
     case (1):
-      config |= MUX_SINGLE_1;
-      break;
+      return MUX_SINGLE_1;
     case (2):
-      config |= MUX_SINGLE_2;
-      break;
+      return MUX_SINGLE_2;
     case (3):
-      config |= MUX_SINGLE_3;
-      break;
+      return MUX_SINGLE_3;
 	  default:
-	    break;
+	    return 0;
   }
+}
+
+void ADS1219::setChannel(int channel){
+  config &= MUX_MASK;
+  config |= channelMux(channel);
   writeRegister(config);
 }
+
+bool ADS1219::beginInterrupt(int drdyPin, uint8_t channelMask){
+  channelMask &= 0x0F;
+  if (interruptDevice != nullptr || channelMask == 0)
+    return false;
+
+  interruptMask = channelMask;
+  activeChannel = __builtin_ctz(channelMask);
+  setChannel(activeChannel);
+  start();
+
+  // The blocking calls above left TAR on this device, the interrupts only feed the FIFOs from here on
+  i2c_hw_t *hw = i2c_get_hw(bbi2c.picoI2C);
+  interruptDevice = this;
+  interruptPin = drdyPin;
+  readPending = false;
+  resync = false;
+  lastReady = time_us_32();
+
+  // Raised once the three result bytes are in
+  hw->rx_tl = 2;
+  hw->intr_mask = I2C_IC_INTR_MASK_M_RX_FULL_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+  const uint i2cIRQn = I2C0_IRQ + i2c_hw_index(bbi2c.picoI2C);
+  irq_add_shared_handler(i2cIRQn, &ADS1219::i2cIRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(i2cIRQn, true);
+
+  // DRDY is active low
+  gpio_init(drdyPin);
+  gpio_set_dir(drdyPin, GPIO_IN);
+  gpio_pull_up(drdyPin);
+  gpio_add_raw_irq_handler(drdyPin, &ADS1219::drdyIRQ);
+  gpio_set_irq_enabled(drdyPin, GPIO_IRQ_EDGE_FALL, true);
+  irq_set_enabled(IO_IRQ_BANK0, true);
+
+  return true;
+}
+
+void ADS1219::serviceInterrupt(){
+  if (interruptPin < 0 || readPending || gpio_get(interruptPin))
+    return;
+
+  // DRDY is low with nothing in flight, so its edge came before the handler was armed or while a transfer aborted
+  uint32_t save = save_and_disable_interrupts();
+  if (!readPending && !gpio_get(interruptPin) && (time_us_32() - lastReady) > ADS1219_INTERRUPT_STALL_US)
+    dataReady();
+  restore_interrupts(save);
+}
+
+void ADS1219::endInterrupt(){
+  if (interruptDevice != this)
+    return;
+
+  gpio_set_irq_enabled(interruptPin, GPIO_IRQ_EDGE_FALL, false);
+  gpio_remove_raw_irq_handler(interruptPin, &ADS1219::drdyIRQ);
+  i2c_hw_t *hw = i2c_get_hw(bbi2c.picoI2C);
+  hw->intr_mask = 0;
+  irq_remove_handler(I2C0_IRQ + i2c_hw_index(bbi2c.picoI2C), &ADS1219::i2cIRQ);
+  interruptDevice = nullptr;
+  interruptPin = -1;
+}
+
+void ADS1219::drdyIRQ(){
+  ADS1219 *ads = interruptDevice;
+  if (ads == nullptr || !(gpio_get_irq_event_mask(ads->interruptPin) & GPIO_IRQ_EDGE_FALL))
+    return;
+  gpio_acknowledge_irq(ads->interruptPin, GPIO_IRQ_EDGE_FALL);
+  ads->dataReady();
+}
+
+// Queues RDATA, the three byte read and the WREG selecting the next channel. Each is its own frame, as
+// with the blocking calls. The WREG restarts the conversion, so the next DRDY belongs to the new channel.
+void ADS1219::dataReady(){
+  i2c_hw_t *hw = i2c_get_hw(bbi2c.picoI2C);
+  lastReady = time_us_32();
+
+  if (readPending) {
+    // the previous result is still on the bus, this one is dropped
+    interruptErrors = interruptErrors + 1;
+    return;
+  }
+
+  if (!resync) {
+    readChannel = activeChannel;
+    readTime = lastReady;
+    readPending = true;
+    hw->data_cmd = 0x10 | I2C_IC_DATA_CMD_STOP_BITS;
+    hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS;
+    hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS;
+    hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS | I2C_IC_DATA_CMD_STOP_BITS;
+  }
+
+  // after an abort the mux is written again without moving on
+  uint8_t next = activeChannel;
+  while (!resync) {
+    next = (next + 1) & 3;
+    if (interruptMask & (1 << next))
+      break;
+  }
+
+  if (next != activeChannel || resync) {
+    config = (config & MUX_MASK) | channelMux(next);
+    hw->data_cmd = CONFIG_REGISTER_ADDRESS;
+    hw->data_cmd = config | I2C_IC_DATA_CMD_STOP_BITS;
+    activeChannel = next;
+  }
+  resync = false;
+}
+
+void ADS1219::i2cIRQ(){
+  ADS1219 *ads = interruptDevice;
+  if (ads == nullptr)
+    return;
+
+  i2c_hw_t *hw = i2c_get_hw(ads->bbi2c.picoI2C);
+  const uint32_t status = hw->intr_stat;
+
+  if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+    // a NAK flushes the TX FIFO, whatever was queued after it never went out
+    (void)hw->clr_tx_abrt;
+    while (hw->rxflr)
+      (void)hw->data_cmd;
+    ads->readPending = false;
+    ads->resync = true;
+    ads->interruptErrors = ads->interruptErrors + 1;
+    return;
+  }
+
+  if ((status & I2C_IC_INTR_STAT_R_RX_FULL_BITS) && hw->rxflr >= 3) {
+    uint8_t data[3];
+    for (int i = 0; i < 3; i++)
+      data[i] = (uint8_t)hw->data_cmd;
+    ads->channelResults[ads->readChannel] = decodeResult(data);
+    ads->channelTimes[ads->readChannel] = ads->readTime;
+    ads->readPending = false;
+  }
+}
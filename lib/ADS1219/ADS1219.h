@@ -74,12 +74,23 @@ typedef enum{
   CHANNEL_3 = MUX_SINGLE_3
 }adsChannel_t;
 
+// A conversion that has not signalled DRDY for this long is assumed to have lost its edge
+#ifndef ADS1219_INTERRUPT_STALL_US
+#define ADS1219_INTERRUPT_STALL_US 5000
+#endif
+
 class ADS1219  {
   protected:
 	uint8_t address;
   public:
+	// Latest result and the time_us_32() its DRDY fell, per single ended channel. Filled by beginInterrupt().
+	volatile uint32_t channelResults[4] = {};
+	volatile uint32_t channelTimes[4] = {};
+	volatile uint32_t interruptErrors = 0;
+
     // Constructor 
 	ADS1219(int bWire, int sda, int scl, i2c_inst_t *picoI2C, int32_t iSpeed, uint8_t addr = 0x40);
+	~ADS1219();
 
     // Methods
     void begin();
@@ -99,8 +110,32 @@ class ADS1219  {
 	uint8_t readRegister(adsRegister_t reg);
   	void start();
 	uint32_t readConversionResult();
+	// Converts continuously, hopping through the channels in channelMask. Each falling edge of DRDY queues
+	// the result read and the next channel on the I2C FIFO from the GPIO interrupt and the I2C interrupt
+	// stores the result, so nothing waits on the bus. Call after the gain, rate and reference are set.
+	bool beginInterrupt(int drdyPin, uint8_t channelMask = 0x0F);
+	// Recovers a DRDY edge that was missed, cheap enough to call every loop
+	void serviceInterrupt();
+	// Hands the interrupts back, the chip keeps converting on the last channel
+	void endInterrupt();
   private:
 	void writeRegister(uint8_t data);
+	static uint32_t decodeResult(const uint8_t *data);
+	static uint8_t channelMux(int channel);
+
+	static ADS1219 *interruptDevice;
+	static void drdyIRQ();
+	static void i2cIRQ();
+	void dataReady();
+
+	int interruptPin = -1;
+	uint8_t interruptMask = 0;
+	uint8_t activeChannel = 0;      // Channel the running conversion is on
+	uint8_t readChannel = 0;        // Channel of the result being read
+	uint32_t readTime = 0;
+	volatile uint32_t lastReady = 0;
+	volatile bool readPending = false;
+	volatile bool resync = false;   // A transfer aborted, the mux has to be written again before the next read
 	
 	BBI2C bbi2c;
 	int32_t iSpeed;
@@ -2,29 +2,47 @@
 
 LEDFormat Animation::format;
 
+static constexpr RGB wheelColor(uint8_t pos) {
+  pos = 255 - pos;
+  if (pos < 85) {
+    return RGB(255 - pos * 3, 0, pos * 3);
+  } else if (pos < 170) {
+    pos -= 85;
+    return RGB(0, pos * 3, 255 - pos * 3);
+  } else {
+    pos -= 170;
+    return RGB(pos * 3, 255 - pos * 3, 0);
+  }
+}
+
+static constexpr std::array<RGB, 256> generateWheel() {
+  std::array<RGB, 256> table;
+  for (int i = 0; i < 256; i++)
+    table[i] = wheelColor(i);
+
+  return table;
+}
+
+// Built at compile time so it lives in flash and the effects only do a lookup
+const std::array<RGB, 256> RGB::wheelTable = generateWheel();
+
 Animation::Animation(PixelMatrix &matrix) : matrix(&matrix) {
 }
 
-void Animation::UpdatePixels(std::vector<Pixel> pixels) {
-  this->pixels = pixels;
+void Animation::UpdatePixels(uint32_t pressed) {
+  this->pixels = pressed;
 }
 
 void Animation::ClearPixels() {
-  this->pixels.clear();
+  this->pixels = 0;
 }
 
 /* Some of these animations are filtered to specific pixels, such as button press animations.
 This somewhat backwards named method determines if a specific pixel is _not_ included in the filter */
-bool Animation::notInFilter(Pixel pixel) {
+bool Animation::notInFilter(uint8_t pixel) {
   if (!this->filtered) {
     return false;
   }
 
-  for (size_t i = 0; i < this->pixels.size(); i++) {
-    if (pixel == this->pixels.at(i)) {
-      return false;
-    }
-  }
-
-  return true;
+  return !(this->pixels & (1u << pixel));
 }
@@ -2,6 +2,7 @@
 #define _ANIMATION_H_
 
 #include "Pixel.hpp"
+#include <array>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,7 +11,7 @@
 #include "NeoPico.hpp"
 
 struct RGB {
-  RGB() : r(0), g(0), b(0) {}
+  constexpr RGB() : r(0), g(0), b(0), w(0) {}
 
   constexpr RGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b), w(0) {}
 
@@ -18,24 +19,22 @@ struct RGB {
     : r(r), g(g), b(b), w(w) { }
 
   RGB(uint32_t c)
-    : r((c >> 16) & 255), g((c >> 8) & 255), b((c >> 0) & 255) { }
+    : r((c >> 16) & 255), g((c >> 8) & 255), b((c >> 0) & 255), w(0) { }
 
   uint8_t r;
   uint8_t g;
   uint8_t b;
   uint8_t w;
 
+  static const std::array<RGB, 256> wheelTable;
+
   inline static RGB wheel(uint8_t pos) {
-    pos = 255 - pos;
-    if (pos < 85) {
-      return RGB(255 - pos * 3, 0, pos * 3);
-    } else if (pos < 170) {
-      pos -= 85;
-      return RGB(0, pos * 3, 255 - pos * 3);
-    } else {
-      pos -= 170;
-      return RGB(pos * 3, 255 - pos * 3, 0);
-    }
+    return wheelTable[pos];
+  }
+
+  // Scales each channel by a 16-bit level, 0xFFFF keeps the color as is
+  inline RGB scaled(uint16_t level) const {
+    return RGB((r * level) / 0xFFFF, (g * level) / 0xFFFF, (b * level) / 0xFFFF, (w * level) / 0xFFFF);
   }
 
   inline uint32_t value(LEDFormat format, float brightnessX = 1.0F) const {
@@ -76,6 +75,32 @@ struct RGB {
     assert(false);
     return 0;
   }
+
+  // Same packing as above, with each channel taken from a brightness table
+  inline uint32_t value(LEDFormat format, const uint8_t (&lut)[256]) const {
+    switch (format) {
+      case LED_FORMAT_GRB:
+        return ((uint32_t)lut[g] << 16) | ((uint32_t)lut[r] << 8) | (uint32_t)lut[b];
+
+      case LED_FORMAT_RGB:
+        return ((uint32_t)lut[r] << 16) | ((uint32_t)lut[g] << 8) | (uint32_t)lut[b];
+
+      case LED_FORMAT_GRBW:
+        if ((r == g) && (r == b))
+          return (uint32_t)lut[r];
+
+        return ((uint32_t)lut[g] << 24) | ((uint32_t)lut[r] << 16) | ((uint32_t)lut[b] << 8) | (uint32_t)lut[w];
+
+      case LED_FORMAT_RGBW:
+        if ((r == g) && (r == b))
+          return (uint32_t)lut[r];
+
+        return ((uint32_t)lut[r] << 24) | ((uint32_t)lut[g] << 16) | ((uint32_t)lut[b] << 8) | (uint32_t)lut[w];
+    }
+
+    assert(false);
+    return 0;
+  }
 };
 
 constexpr RGB ColorBlack(0, 0, 0);
@@ -101,23 +126,29 @@ inline const std::vector<RGB> colors {
 class Animation {
 public:
   Animation(PixelMatrix &matrix);
-  void UpdatePixels(std::vector<Pixel> pixels);
+  void UpdatePixels(uint32_t pressed);
   void ClearPixels();
   virtual ~Animation(){};
 
   static LEDFormat format;
 
-  bool notInFilter(Pixel pixel);
+  bool notInFilter(uint8_t pixel);
   virtual void Animate(RGB (&frame)[100]) = 0;
   virtual void ParameterUp() = 0;
   virtual void ParameterDown() = 0;
 
 protected:
+  inline void SetPixelColor(RGB (&frame)[100], uint8_t pixel, const RGB &color) {
+    const uint8_t *pos = &matrix->positions[matrix->offsets[pixel]];
+    for (uint8_t p = 0; p != matrix->lengths[pixel]; p++)
+      frame[pos[p]] = color;
+  }
+
 /* We track both the full matrix as well as individual pixels here to support
 button press changes. Rather than adjusting the matrix to represent a subset of pixels,
-we provide a subset of pixels to use as a filter. */
+we provide a bitmask of matrix pixels to use as a filter. */
   PixelMatrix *matrix;
-  std::vector<Pixel> pixels;
+  uint32_t pixels = 0;
   bool filtered = false;
 };
 
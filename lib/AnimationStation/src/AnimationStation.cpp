@@ -10,6 +10,7 @@
 uint8_t AnimationStation::brightnessMax = 100;
 uint8_t AnimationStation::brightnessSteps = 5;
 float AnimationStation::brightnessX = 0;
+uint8_t AnimationStation::brightnessLUT[256] = {};
 absolute_time_t AnimationStation::nextChange = nil_time;
 AnimationOptions AnimationStation::options = {};
 uint8_t AnimationStation::effectCount = TOTAL_EFFECTS;
@@ -53,11 +54,11 @@ void AnimationStation::HandleEvent(AnimationHotkey action) {
     this->baseAnimation->ParameterDown();
   }
 
-  if (action == HOTKEY_LEDS_PRESS_PARAMETER_UP) {
+  if (action == HOTKEY_LEDS_PRESS_PARAMETER_UP && this->buttonAnimation != nullptr) {
     this->buttonAnimation->ParameterUp();
   }
 
-  if (action == HOTKEY_LEDS_PRESS_PARAMETER_DOWN) {
+  if (action == HOTKEY_LEDS_PRESS_PARAMETER_DOWN && this->buttonAnimation != nullptr) {
     this->buttonAnimation->ParameterDown();
   }
 
@@ -71,37 +72,67 @@ void AnimationStation::ChangeAnimation(int changeSize) {
 uint16_t AnimationStation::AdjustIndex(int changeSize) {
   int newIndex = (int)this->options.baseAnimationIndex + changeSize;
 
-  if (newIndex >= AnimationStation::effectCount) {
-    return 0;
-  }
+  // Step past effects with nothing loaded, such as a missing custom theme or effect program
+  for (int i = 0; i < AnimationStation::effectCount; i++) {
+    if (newIndex >= AnimationStation::effectCount) {
+      newIndex = 0;
+    }
+
+    if (newIndex < 0) {
+      newIndex = AnimationStation::effectCount - 1;
+    }
+
+    if (this->IsEffectAvailable(newIndex)) {
+      break;
+    }
 
-  if (newIndex < 0) {
-    return (AnimationStation::effectCount - 1);
+    newIndex += (changeSize < 0) ? -1 : 1;
   }
 
   return (uint16_t)newIndex;
 }
 
-void AnimationStation::HandlePressed(std::vector<Pixel> pressed) {
+bool AnimationStation::IsEffectAvailable(int index) {
+  switch (index) {
+  case AnimationEffects::EFFECT_CUSTOM_THEME:
+    return CustomTheme::HasTheme();
+  case AnimationEffects::EFFECT_SCRIPTED:
+    return this->program.IsLoaded();
+  default:
+    return true;
+  }
+}
+
+void AnimationStation::HandlePressed(uint32_t pressed) {
   this->lastPressed = pressed;
-  this->buttonAnimation->UpdatePixels(pressed);
+  if (this->baseAnimation != nullptr) {
+    this->baseAnimation->UpdatePixels(pressed);
+  }
+  if (this->buttonAnimation != nullptr) {
+    this->buttonAnimation->UpdatePixels(pressed);
+  }
 }
 
 void AnimationStation::ClearPressed() {
+  if (this->baseAnimation != nullptr) {
+    this->baseAnimation->ClearPixels();
+  }
   if (this->buttonAnimation != nullptr) {
     this->buttonAnimation->ClearPixels();
   }
-  this->lastPressed.clear();
+  this->lastPressed = 0;
 }
 
 void AnimationStation::Animate() {
-  if (baseAnimation == nullptr || buttonAnimation == nullptr) {
+  if (baseAnimation == nullptr) {
     this->Clear();
     return;
   }
 
   baseAnimation->Animate(this->frame);
-  buttonAnimation->Animate(this->frame);
+  if (buttonAnimation != nullptr) {
+    buttonAnimation->Animate(this->frame);
+  }
 }
 
 void AnimationStation::Clear() { memset(frame, 0, sizeof(frame)); }
@@ -122,50 +153,96 @@ void AnimationStation::SetMode(uint8_t mode) {
       static_cast<AnimationEffects>(this->options.baseAnimationIndex);
 
   if (this->baseAnimation != nullptr) {
-    delete this->baseAnimation;
+    this->baseAnimation->~Animation();
+    this->baseAnimation = nullptr;
   }
   if (this->buttonAnimation != nullptr) {
-    delete this->buttonAnimation;
+    this->buttonAnimation->~Animation();
+    this->buttonAnimation = nullptr;
   }
 
   this->Clear();
 
   switch (newEffect) {
   case AnimationEffects::EFFECT_RAINBOW:
-    this->baseAnimation = new Rainbow(matrix);
-    this->buttonAnimation = new StaticColor(matrix, lastPressed);
+    this->baseAnimation = new (&baseStorage) Rainbow(matrix);
+    this->buttonAnimation = new (&buttonStorage) StaticColor(matrix, lastPressed);
     break;
   case AnimationEffects::EFFECT_CHASE:
-    this->baseAnimation = new Chase(matrix);
-    this->buttonAnimation = new StaticColor(matrix, lastPressed);
+    this->baseAnimation = new (&baseStorage) Chase(matrix);
+    this->buttonAnimation = new (&buttonStorage) StaticColor(matrix, lastPressed);
     break;
   case AnimationEffects::EFFECT_STATIC_THEME:
-    this->baseAnimation = new StaticTheme(matrix);
-    this->buttonAnimation = new StaticColor(matrix, lastPressed);
+    this->baseAnimation = new (&baseStorage) StaticTheme(matrix);
+    this->buttonAnimation = new (&buttonStorage) StaticColor(matrix, lastPressed);
     break;
   case AnimationEffects::EFFECT_CUSTOM_THEME:
-    this->baseAnimation = new CustomTheme(matrix);
-    this->buttonAnimation = new CustomThemePressed(matrix, lastPressed);
+    this->baseAnimation = new (&baseStorage) CustomTheme(matrix);
+    this->buttonAnimation = new (&buttonStorage) CustomThemePressed(matrix, lastPressed);
     break;
+  case AnimationEffects::EFFECT_SCRIPTED:
+    if (this->program.IsLoaded()) {
+      this->baseAnimation = new (&baseStorage) Scripted(matrix, program, lastPressed);
+      break;
+    }
+    // No program loaded, fall back to the default
+    [[fallthrough]];
   default:
-    this->baseAnimation = new StaticColor(matrix);
-    this->buttonAnimation = new StaticColor(matrix, lastPressed);
+    this->baseAnimation = new (&baseStorage) StaticColor(matrix);
+    this->buttonAnimation = new (&buttonStorage) StaticColor(matrix, lastPressed);
     break;
   }
 }
 
-void AnimationStation::SetMatrix(PixelMatrix matrix) {
+void AnimationStation::SetMatrix(const PixelMatrix &matrix) {
   this->matrix = matrix;
 }
 
+/* Compiles the effect program against the current matrix, so call this after SetMatrix.
+An empty or invalid program leaves the scripted effect out of the rotation. */
+bool AnimationStation::SetEffectProgram(const uint8_t *data, size_t size) {
+  if (!this->program.Compile(data, size, this->matrix)) {
+    return false;
+  }
+
+  if (AnimationStation::effectCount <= EFFECT_SCRIPTED) {
+    AnimationStation::effectCount = EFFECT_SCRIPTED + 1;
+  }
+  return true;
+}
+
 void AnimationStation::SetOptions(AnimationOptions options) {
   AnimationStation::options = options;
   AnimationStation::SetBrightness(options.brightness);
 }
 
 void AnimationStation::ApplyBrightness(uint32_t *frameValue) {
-  for (int i = 0; i < 100; i++)
-    frameValue[i] = this->frame[i].value(Animation::format, brightnessX);
+  const uint8_t (&lut)[256] = AnimationStation::brightnessLUT;
+
+  // Pick the format once, then pack the whole frame through the brightness table
+  switch (Animation::format) {
+    case LED_FORMAT_GRB:
+      for (int i = 0; i < 100; i++)
+        frameValue[i] = ((uint32_t)lut[frame[i].g] << 16) | ((uint32_t)lut[frame[i].r] << 8) | (uint32_t)lut[frame[i].b];
+      break;
+
+    case LED_FORMAT_RGB:
+      for (int i = 0; i < 100; i++)
+        frameValue[i] = ((uint32_t)lut[frame[i].r] << 16) | ((uint32_t)lut[frame[i].g] << 8) | (uint32_t)lut[frame[i].b];
+      break;
+
+    default:
+      for (int i = 0; i < 100; i++)
+        frameValue[i] = this->frame[i].value(Animation::format, lut);
+      break;
+  }
+}
+
+/* Brightness only changes on a hotkey or config update, so the scaled value of every
+channel level is worked out here once instead of multiplying each LED every frame. */
+void AnimationStation::UpdateBrightnessLUT() {
+  for (int i = 0; i < 256; i++)
+    AnimationStation::brightnessLUT[i] = (uint8_t)(i * AnimationStation::brightnessX);
 }
 
 void AnimationStation::SetBrightness(uint8_t brightness) {
@@ -178,6 +255,8 @@ void AnimationStation::SetBrightness(uint8_t brightness) {
     AnimationStation::brightnessX = 1;
   else if (AnimationStation::brightnessX < 0)
     AnimationStation::brightnessX = 0;
+
+  AnimationStation::UpdateBrightnessLUT();
 }
 
 void AnimationStation::DecreaseBrightness() {
@@ -194,4 +273,5 @@ void AnimationStation::IncreaseBrightness() {
 
 void AnimationStation::DimBrightnessTo0() {
   AnimationStation::brightnessX = 0;
+  AnimationStation::UpdateBrightnessLUT();
 }
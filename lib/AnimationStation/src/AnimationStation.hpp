@@ -2,6 +2,8 @@
 #define _ANIMATION_STATION_H_
 
 #include <algorithm>
+#include <new>
+#include <type_traits>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,10 +12,12 @@
 
 #include "NeoPico.hpp"
 #include "Animation.hpp"
+#include "EffectProgram.hpp"
 #include "Effects/Chase.hpp"
 #include "Effects/CustomTheme.hpp"
 #include "Effects/CustomThemePressed.hpp"
 #include "Effects/Rainbow.hpp"
+#include "Effects/Scripted.hpp"
 #include "Effects/StaticColor.hpp"
 #include "Effects/StaticTheme.hpp"
 
@@ -24,6 +28,7 @@ typedef enum
   EFFECT_CHASE,
   EFFECT_STATIC_THEME,
   EFFECT_CUSTOM_THEME,
+  EFFECT_SCRIPTED,
 } AnimationEffects;
 
 const int TOTAL_EFFECTS = 4; // Exclude custom theme until verified present
@@ -101,14 +106,17 @@ public:
   void ChangeAnimation(int changeSize);
   void ApplyBrightness(uint32_t *frameValue);
   uint16_t AdjustIndex(int changeSize);
-  void HandlePressed(std::vector<Pixel> pressed);
+  bool IsEffectAvailable(int index);
+  void HandlePressed(uint32_t pressed);
   void ClearPressed();
 
   uint8_t GetMode();
   void SetMode(uint8_t mode);
-  void SetMatrix(PixelMatrix matrix);
+  void SetMatrix(const PixelMatrix &matrix);
+  bool SetEffectProgram(const uint8_t *data, size_t size);
   static void ConfigureBrightness(uint8_t max, uint8_t steps);
   static float GetBrightnessX();
+  static const uint8_t (&GetBrightnessLUT())[256] { return brightnessLUT; }
   static uint8_t GetBrightness();
   static void SetBrightness(uint8_t brightness);
   static void DecreaseBrightness();
@@ -116,9 +124,9 @@ public:
   static void DimBrightnessTo0();
   static void SetOptions(AnimationOptions options);
 
-  Animation* baseAnimation;
-  Animation* buttonAnimation;
-  std::vector<Pixel> lastPressed;
+  Animation* baseAnimation = nullptr;
+  Animation* buttonAnimation = nullptr;
+  uint32_t lastPressed = 0;
   static AnimationOptions options;
   static absolute_time_t nextChange;
   static uint8_t effectCount;
@@ -129,7 +137,14 @@ protected:
   static uint8_t brightnessMax;
   static uint8_t brightnessSteps;
   static float brightnessX;
+  static uint8_t brightnessLUT[256];
+  static void UpdateBrightnessLUT();
   PixelMatrix matrix;
+  EffectProgram program;
+
+  // Effects are built in place here, so changing mode never touches the heap
+  std::aligned_union_t<0, StaticColor, Rainbow, Chase, StaticTheme, CustomTheme, Scripted> baseStorage;
+  std::aligned_union_t<0, StaticColor, CustomThemePressed> buttonStorage;
 };
 
 #endif
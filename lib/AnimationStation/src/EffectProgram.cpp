@@ -0,0 +1,181 @@
+#include <algorithm>
+#include "EffectProgram.hpp"
+
+static inline uint16_t readU16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t readU32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool EffectProgram::Compile(const uint8_t *data, size_t size, const PixelMatrix &matrix) {
+  this->layerCount = 0;
+  this->held = 0;
+
+  if (data == nullptr || size < EFFECT_PROGRAM_HEADER_SIZE || data[0] != EFFECT_PROGRAM_VERSION)
+    return false;
+
+  uint8_t count = data[1];
+  if (count == 0 || count > EFFECT_PROGRAM_MAX_LAYERS ||
+      size != (size_t)(EFFECT_PROGRAM_HEADER_SIZE + count * EFFECT_PROGRAM_LAYER_SIZE))
+    return false;
+
+  uint32_t allPixels = (matrix.size == PIXEL_MATRIX_MAX_PIXELS) ? 0xFFFFFFFF : ((1u << matrix.size) - 1);
+  int maxIndex = 0;
+  for (uint8_t i = 0; i < matrix.size; i++)
+    if (matrix.indexes[i] > maxIndex)
+      maxIndex = matrix.indexes[i];
+  this->span = maxIndex + 1;
+
+  for (uint8_t l = 0; l < count; l++) {
+    const uint8_t *p = &data[EFFECT_PROGRAM_HEADER_SIZE + l * EFFECT_PROGRAM_LAYER_SIZE];
+    EffectLayer &layer = this->layers[l];
+
+    if (p[0] >= EFFECT_SOURCE_COUNT || p[1] >= EFFECT_BLEND_COUNT ||
+        p[2] >= EFFECT_CURVE_COUNT || p[3] >= EFFECT_TARGET_COUNT)
+      return false;
+
+    layer.source = p[0];
+    layer.blend = p[1];
+    layer.curve = p[2];
+    layer.target = p[3];
+    layer.color = RGB(p[4], p[5], p[6]);
+    layer.spread = p[7];
+    layer.period = readU16(&p[8]);
+    layer.fade = readU16(&p[10]);
+
+    uint32_t buttons = readU32(&p[12]);
+    layer.pixels = (buttons == 0) ? allPixels : matrix.getPressed(buttons);
+  }
+
+  this->layerCount = count;
+  return true;
+}
+
+uint8_t EffectProgram::Shape(uint8_t curve, uint8_t phase) {
+  switch (curve) {
+    case EFFECT_CURVE_RAMP:
+      return phase;
+
+    case EFFECT_CURVE_TRIANGLE:
+      return (phase < 128) ? (phase * 2) : (511 - phase * 2);
+
+    case EFFECT_CURVE_SMOOTH:
+    {
+      uint32_t t = Shape(EFFECT_CURVE_TRIANGLE, phase);
+      return (t * t * (765 - 2 * t)) / 65025;
+    }
+
+    case EFFECT_CURVE_STEP:
+      return (phase < 128) ? 255 : 0;
+
+    default:
+      return 255;
+  }
+}
+
+uint8_t EffectProgram::Fade(uint8_t curve, uint8_t remaining) {
+  switch (curve) {
+    case EFFECT_CURVE_RAMP:
+    case EFFECT_CURVE_TRIANGLE:
+      return remaining;
+
+    case EFFECT_CURVE_SMOOTH:
+    {
+      uint32_t t = remaining;
+      return (t * t * (765 - 2 * t)) / 65025;
+    }
+
+    case EFFECT_CURVE_STEP:
+      return (remaining >= 128) ? 255 : 0;
+
+    default:
+      return (remaining > 0) ? 255 : 0;
+  }
+}
+
+RGB EffectProgram::Blend(uint8_t blend, const RGB &dst, const RGB &src) {
+  switch (blend) {
+    case EFFECT_BLEND_ADD:
+      return RGB(std::min(dst.r + src.r, 255), std::min(dst.g + src.g, 255), std::min(dst.b + src.b, 255));
+
+    case EFFECT_BLEND_MAX:
+      return RGB(std::max(dst.r, src.r), std::max(dst.g, src.g), std::max(dst.b, src.b));
+
+    case EFFECT_BLEND_MULTIPLY:
+      return RGB((dst.r * (src.r + 1)) >> 8, (dst.g * (src.g + 1)) >> 8, (dst.b * (src.b + 1)) >> 8);
+
+    default:
+      return src;
+  }
+}
+
+void EffectProgram::Render(RGB (&frame)[100], const PixelMatrix &matrix, uint32_t pressed, uint32_t now) {
+  RGB colors[PIXEL_MATRIX_MAX_PIXELS];
+
+  for (uint8_t i = 0; i < matrix.size; i++) {
+    if (pressed & (1u << i))
+      this->pressedAt[i] = now;
+  }
+  this->held |= pressed;
+
+  for (uint8_t l = 0; l < this->layerCount; l++) {
+    const EffectLayer &layer = this->layers[l];
+
+    uint32_t pixels = layer.pixels;
+    if (layer.target == EFFECT_TARGET_PRESSED)
+      pixels &= pressed;
+    else if (layer.target == EFFECT_TARGET_RELEASED)
+      pixels &= ~pressed;
+
+    uint8_t phase = (layer.period == 0) ? 0 : ((now % layer.period) * 256) / layer.period;
+    uint8_t shaped = Shape(layer.curve, phase);
+    uint8_t head = (shaped * this->span) >> 8;
+    uint8_t length = (layer.spread == 0) ? 1 : layer.spread;
+
+    for (uint8_t i = 0; i < matrix.size; i++) {
+      if (!(pixels & (1u << i)))
+        continue;
+
+      RGB color;
+      switch (layer.source) {
+        case EFFECT_SOURCE_WHEEL:
+          color = RGB::wheel(shaped + matrix.indexes[i] * layer.spread);
+          break;
+
+        case EFFECT_SOURCE_CHASE:
+        {
+          uint8_t behind = (head - matrix.indexes[i] + this->span) % this->span;
+          color = (behind < length) ? Scale(layer.color, 255 - (behind * 255) / length) : ColorBlack;
+          break;
+        }
+
+        case EFFECT_SOURCE_REACT:
+        {
+          uint32_t elapsed = now - this->pressedAt[i];
+          uint8_t remaining = 0;
+          if (pressed & (1u << i))
+            remaining = 255;
+          else if ((this->held & (1u << i)) && elapsed < layer.fade)
+            remaining = 255 - (elapsed * 255) / layer.fade;
+
+          color = Scale(layer.color, Fade(layer.curve, remaining));
+          break;
+        }
+
+        default:
+          color = Scale(layer.color, shaped);
+          break;
+      }
+
+      colors[i] = Blend(layer.blend, colors[i], color);
+    }
+  }
+
+  for (uint8_t i = 0; i < matrix.size; i++) {
+    const uint8_t *pos = &matrix.positions[matrix.offsets[i]];
+    for (uint8_t p = 0; p != matrix.lengths[i]; p++)
+      frame[pos[p]] = colors[i];
+  }
+}
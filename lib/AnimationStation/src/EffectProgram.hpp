@@ -0,0 +1,110 @@
+#ifndef _EFFECT_PROGRAM_H_
+#define _EFFECT_PROGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Animation.hpp"
+#include "Pixel.hpp"
+
+/* Data driven LED effects.
+
+An effect is a short byte string kept in the LED options, so custom lighting can be loaded
+without a firmware build. Multi-byte values are little endian.
+
+  byte 0    format version, EFFECT_PROGRAM_VERSION
+  byte 1    layer count, 1 to EFFECT_PROGRAM_MAX_LAYERS
+  then EFFECT_PROGRAM_LAYER_SIZE bytes per layer, drawn bottom to top:
+    0       source      EffectSource
+    1       blend       EffectBlend, how the layer mixes with the layers below it
+    2       curve       EffectCurve, how the layer changes over its period
+    3       target      EffectTarget
+    4-6     color       r, g, b
+    7       spread      wheel step between neighbouring pixels, or the chase length
+    8-9     period      ms for one run of the curve, 0 holds it at the start
+    10-11   fade        ms a reaction takes to fade out once the button is released
+    12-15   buttons     only draw on pixels lit by these buttons, 0 for every pixel
+
+The curve is a brightness for color layers, the hue for wheel layers and the head position for
+chase layers. On reaction layers it shapes the fade: ramp and triangle fade evenly, smooth eases
+out, step and constant hold and then cut.
+
+Compile() checks the description once and resolves each layer against the pixel matrix into a
+small table. Render() walks that table every frame without allocating. */
+
+#define EFFECT_PROGRAM_VERSION 1
+#define EFFECT_PROGRAM_MAX_LAYERS 8
+#define EFFECT_PROGRAM_HEADER_SIZE 2
+#define EFFECT_PROGRAM_LAYER_SIZE 16
+#define EFFECT_PROGRAM_MAX_SIZE (EFFECT_PROGRAM_HEADER_SIZE + EFFECT_PROGRAM_MAX_LAYERS * EFFECT_PROGRAM_LAYER_SIZE)
+
+typedef enum
+{
+  EFFECT_SOURCE_COLOR,  // The layer color
+  EFFECT_SOURCE_WHEEL,  // Color wheel, spread across the pixels
+  EFFECT_SOURCE_CHASE,  // The layer color running along the pixels with a fading tail
+  EFFECT_SOURCE_REACT,  // The layer color on pressed buttons, fading after release
+  EFFECT_SOURCE_COUNT
+} EffectSource;
+
+typedef enum
+{
+  EFFECT_BLEND_REPLACE,
+  EFFECT_BLEND_ADD,
+  EFFECT_BLEND_MAX,
+  EFFECT_BLEND_MULTIPLY,
+  EFFECT_BLEND_COUNT
+} EffectBlend;
+
+typedef enum
+{
+  EFFECT_CURVE_CONSTANT,
+  EFFECT_CURVE_RAMP,
+  EFFECT_CURVE_TRIANGLE,
+  EFFECT_CURVE_SMOOTH,
+  EFFECT_CURVE_STEP,
+  EFFECT_CURVE_COUNT
+} EffectCurve;
+
+typedef enum
+{
+  EFFECT_TARGET_ALL,
+  EFFECT_TARGET_PRESSED,
+  EFFECT_TARGET_RELEASED,
+  EFFECT_TARGET_COUNT
+} EffectTarget;
+
+struct EffectLayer {
+  uint8_t source;
+  uint8_t blend;
+  uint8_t curve;
+  uint8_t target;
+  RGB color;
+  uint8_t spread;
+  uint16_t period;
+  uint16_t fade;
+  uint32_t pixels;  // Matrix pixels the layer may draw on
+};
+
+class EffectProgram {
+public:
+  bool Compile(const uint8_t *data, size_t size, const PixelMatrix &matrix);
+  void Clear() { layerCount = 0; }
+  bool IsLoaded() const { return layerCount > 0; }
+  void Render(RGB (&frame)[100], const PixelMatrix &matrix, uint32_t pressed, uint32_t now);
+
+protected:
+  static uint8_t Shape(uint8_t curve, uint8_t phase);
+  static uint8_t Fade(uint8_t curve, uint8_t remaining);
+  static RGB Blend(uint8_t blend, const RGB &dst, const RGB &src);
+  static inline RGB Scale(const RGB &c, uint8_t level) {
+    return RGB((c.r * (level + 1)) >> 8, (c.g * (level + 1)) >> 8, (c.b * (level + 1)) >> 8);
+  }
+
+  EffectLayer layers[EFFECT_PROGRAM_MAX_LAYERS];
+  uint8_t layerCount = 0;
+  uint8_t span = 1;                               // Pixel indexes a chase runs across
+  uint32_t held = 0;                              // Pixels that have been pressed at least once
+  uint32_t pressedAt[PIXEL_MATRIX_MAX_PIXELS];    // Last time each pixel was seen pressed, in ms
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "Chase.hpp"
+#include "../AnimationStation.hpp"
 
 Chase::Chase(PixelMatrix &matrix) : Animation(matrix) {
 }
@@ -8,20 +9,12 @@ void Chase::Animate(RGB (&frame)[100]) {
     return;
   }
 
-  for (auto &col : matrix->pixels) {
-    for (auto &pixel : col) {
-      if (pixel.index == NO_PIXEL.index)
-        continue;
-
-      if (this->IsChasePixel(pixel.index)) {
-        RGB color = RGB::wheel(this->WheelFrame(pixel.index));
-        for (auto &pos : pixel.positions)
-          frame[pos] = color;
-      }
-      else {
-        for (auto &pos : pixel.positions)
-          frame[pos] = ColorBlack;
-      }
+  for (uint8_t i = 0; i != matrix->size; i++) {
+    if (this->IsChasePixel(matrix->indexes[i])) {
+      this->SetPixelColor(frame, i, RGB::wheel(this->WheelFrame(matrix->indexes[i])));
+    }
+    else {
+      this->SetPixelColor(frame, i, ColorBlack);
     }
   }
 
@@ -1,4 +1,5 @@
 #include "CustomTheme.hpp"
+#include "../AnimationStation.hpp"
 
 std::map<uint32_t, RGB> CustomTheme::theme;
 
@@ -7,19 +8,12 @@ CustomTheme::CustomTheme(PixelMatrix &matrix) : Animation(matrix) {
 }
 
 void CustomTheme::Animate(RGB (&frame)[100]) {
-  for (size_t r = 0; r != matrix->pixels.size(); r++) {
-    for (size_t c = 0; c != matrix->pixels[r].size(); c++) {
-      if (matrix->pixels[r][c].index == NO_PIXEL.index)
-        continue;
-
-      auto itr = theme.find(matrix->pixels[r][c].mask);
-      if (itr != theme.end())
-        for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++)
-          frame[matrix->pixels[r][c].positions[p]] = itr->second;
-      else
-        for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++)
-          frame[matrix->pixels[r][c].positions[p]] = defaultColor;
-    }
+  for (uint8_t i = 0; i != matrix->size; i++) {
+    auto itr = theme.find(matrix->masks[i]);
+    if (itr != theme.end())
+      this->SetPixelColor(frame, i, itr->second);
+    else
+      this->SetPixelColor(frame, i, defaultColor);
   }
 }
 
@@ -29,7 +23,8 @@ bool CustomTheme::HasTheme() {
 
 void CustomTheme::SetCustomTheme(std::map<uint32_t, RGB> customTheme) {
   CustomTheme::theme = customTheme;
-  AnimationStation::effectCount = TOTAL_EFFECTS + 1;
+  if (AnimationStation::effectCount <= EFFECT_CUSTOM_THEME)
+    AnimationStation::effectCount = EFFECT_CUSTOM_THEME + 1;
 }
 
 void CustomTheme::ParameterUp() {
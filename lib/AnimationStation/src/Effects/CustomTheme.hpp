@@ -3,7 +3,6 @@
 
 #include <map>
 #include "../Animation.hpp"
-#include "../AnimationStation.hpp"
 
 class CustomTheme : public Animation {
 public:
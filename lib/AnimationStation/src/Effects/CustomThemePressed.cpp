@@ -1,4 +1,5 @@
 #include "CustomThemePressed.hpp"
+#include "../AnimationStation.hpp"
 
 std::map<uint32_t, RGB> CustomThemePressed::theme;
 
@@ -6,24 +7,21 @@ CustomThemePressed::CustomThemePressed(PixelMatrix &matrix) : Animation(matrix)
   this->filtered = true;
 }
 
-CustomThemePressed::CustomThemePressed(PixelMatrix &matrix, std::vector<Pixel> &pixels) : Animation(matrix), pixels(&pixels) {
+CustomThemePressed::CustomThemePressed(PixelMatrix &matrix, uint32_t pressed) : Animation(matrix) {
   this->filtered = true;
+  this->pixels = pressed;
 }
 
 void CustomThemePressed::Animate(RGB (&frame)[100]) {
-  for (size_t r = 0; r != matrix->pixels.size(); r++) {
-    for (size_t c = 0; c != matrix->pixels[r].size(); c++) {
-      if (matrix->pixels[r][c].index == NO_PIXEL.index || this->notInFilter(matrix->pixels[r][c]))
-        continue;
+  for (uint8_t i = 0; i != matrix->size; i++) {
+    if (this->notInFilter(i))
+      continue;
 
-      auto itr = theme.find(matrix->pixels[r][c].mask);
-      if (itr != theme.end())
-        for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++)
-          frame[matrix->pixels[r][c].positions[p]] = itr->second;
-      else
-        for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++)
-          frame[matrix->pixels[r][c].positions[p]] = defaultColor;
-    }
+    auto itr = theme.find(matrix->masks[i]);
+    if (itr != theme.end())
+      this->SetPixelColor(frame, i, itr->second);
+    else
+      this->SetPixelColor(frame, i, defaultColor);
   }
 }
 
@@ -1,4 +1,5 @@
 #include "Rainbow.hpp"
+#include "../AnimationStation.hpp"
 
 Rainbow::Rainbow(PixelMatrix &matrix) : Animation(matrix) {
 }
@@ -8,16 +9,9 @@ void Rainbow::Animate(RGB (&frame)[100]) {
     return;
   }
 
-  for (auto &col : matrix->pixels) {
-    for (auto &pixel : col) {
-      if (pixel.index == NO_PIXEL.index)
-        continue;
-
-      RGB color = RGB::wheel(this->currentFrame);
-      for (auto &pos : pixel.positions)
-        frame[pos] = color;
-    }
-  }
+  RGB color = RGB::wheel(this->currentFrame);
+  for (uint8_t i = 0; i != matrix->size; i++)
+    this->SetPixelColor(frame, i, color);
 
   if (reverse) {
     currentFrame--;
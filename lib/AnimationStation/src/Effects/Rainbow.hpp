@@ -6,7 +6,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <vector>
-#include "../AnimationStation.hpp"
 
 class Rainbow : public Animation {
 public:
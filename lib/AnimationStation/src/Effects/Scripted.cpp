@@ -0,0 +1,9 @@
+#include "Scripted.hpp"
+
+Scripted::Scripted(PixelMatrix &matrix, EffectProgram &program, uint32_t pressed) : Animation(matrix), program(&program) {
+  this->pixels = pressed;
+}
+
+void Scripted::Animate(RGB (&frame)[100]) {
+  this->program->Render(frame, *matrix, this->pixels, to_ms_since_boot(get_absolute_time()));
+}
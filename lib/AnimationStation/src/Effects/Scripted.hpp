@@ -0,0 +1,22 @@
+#ifndef _SCRIPTED_H_
+#define _SCRIPTED_H_
+
+#include "../Animation.hpp"
+#include "../EffectProgram.hpp"
+#include "pico/stdlib.h"
+
+/* Plays the effect program loaded from the LED options. The program handles button
+reactions itself, so this runs as the base animation with no button animation on top. */
+class Scripted : public Animation {
+public:
+  Scripted(PixelMatrix &matrix, EffectProgram &program, uint32_t pressed);
+  ~Scripted() {};
+
+  void Animate(RGB (&frame)[100]);
+  void ParameterUp() { }
+  void ParameterDown() { }
+protected:
+  EffectProgram *program;
+};
+
+#endif
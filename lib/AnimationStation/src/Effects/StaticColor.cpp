@@ -1,22 +1,21 @@
  #include "StaticColor.hpp"
+#include "../AnimationStation.hpp"
 
 StaticColor::StaticColor(PixelMatrix &matrix) : Animation(matrix) {
 }
 
-StaticColor::StaticColor(PixelMatrix &matrix, std::vector<Pixel> &pixels) : Animation(matrix), pixels(&pixels) {
+StaticColor::StaticColor(PixelMatrix &matrix, uint32_t pressed) : Animation(matrix) {
   this->filtered = true;
+  this->pixels = pressed;
 }
 
 void StaticColor::Animate(RGB (&frame)[100]) {
-  for (size_t r = 0; r != matrix->pixels.size(); r++) {
-    for (size_t c = 0; c != matrix->pixels[r].size(); c++) {
-      if (matrix->pixels[r][c].index == NO_PIXEL.index || this->notInFilter(matrix->pixels[r][c]))
-        continue;
+  const RGB &color = colors[this->GetColor()];
+  for (uint8_t i = 0; i != matrix->size; i++) {
+    if (this->notInFilter(i))
+      continue;
 
-      for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++) {
-        frame[matrix->pixels[r][c].positions[p]] = colors[this->GetColor()];
-      }
-    }
+    this->SetPixelColor(frame, i, color);
   }
 }
 
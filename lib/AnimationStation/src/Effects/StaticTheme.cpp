@@ -1,4 +1,5 @@
 #include "StaticTheme.hpp"
+#include "../AnimationStation.hpp"
 
 std::vector<std::map<uint32_t, RGB>> StaticTheme::themes = {};
 
@@ -10,23 +11,14 @@ StaticTheme::StaticTheme(PixelMatrix &matrix) : Animation(matrix) {
 
 void StaticTheme::Animate(RGB (&frame)[100]) {
   if (StaticTheme::themes.size() > 0) {
-    for (size_t r = 0; r != matrix->pixels.size(); r++) {
-      for (size_t c = 0; c != matrix->pixels[r].size(); c++) {
-        if (matrix->pixels[r][c].index == NO_PIXEL.index)
-          continue;
-
-        std::map<uint32_t, RGB> theme =
-            StaticTheme::themes.at(AnimationStation::options.themeIndex);
-        auto itr = theme.find(matrix->pixels[r][c].mask);
-        if (itr != theme.end()) {
-          for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++) {
-            frame[matrix->pixels[r][c].positions[p]] = itr->second;
-          }
-        } else {
-          for (size_t p = 0; p != matrix->pixels[r][c].positions.size(); p++) {
-            frame[matrix->pixels[r][c].positions[p]] = defaultColor;
-          }
-        }
+    const std::map<uint32_t, RGB> &theme =
+        StaticTheme::themes.at(AnimationStation::options.themeIndex);
+    for (uint8_t i = 0; i != matrix->size; i++) {
+      auto itr = theme.find(matrix->masks[i]);
+      if (itr != theme.end()) {
+        this->SetPixelColor(frame, i, itr->second);
+      } else {
+        this->SetPixelColor(frame, i, defaultColor);
       }
     }
   }
@@ -8,7 +8,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "../Animation.hpp"
-#include "../AnimationStation.hpp"
 
 class StaticTheme : public Animation {
 public:
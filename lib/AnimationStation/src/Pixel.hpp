@@ -6,6 +6,12 @@
 #include <stdlib.h>
 #include <vector>
 
+// Most lit pixels a matrix can hold, pressed state is tracked as one bit per pixel
+#define PIXEL_MATRIX_MAX_PIXELS 32
+
+// Most LED positions a matrix can hold, matches the AnimationStation frame
+#define PIXEL_MATRIX_MAX_LEDS 100
+
 struct Pixel {
   Pixel(int index, uint32_t mask = 0) : index(index), mask(mask) { }
   Pixel(int index, std::vector<uint8_t> positions) : index(index), positions(positions) { }
@@ -18,36 +24,66 @@ struct Pixel {
 
 inline const Pixel NO_PIXEL(-1);
 
+/* The layout is built from rows of Pixels, but is stored flattened so the animation loop
+never copies a Pixel or touches the heap. Lit pixels are kept in row order, pixel i lights the
+LEDs at positions[offsets[i]] to positions[offsets[i] + lengths[i] - 1]. */
 struct PixelMatrix {
   PixelMatrix() { }
 
-  std::vector<std::vector<Pixel>> pixels;
+  uint8_t size = 0;                                 // Number of lit pixels
+  int indexes[PIXEL_MATRIX_MAX_PIXELS];             // The pixel index
+  uint32_t masks[PIXEL_MATRIX_MAX_PIXELS];          // Used to detect per-pixel lighting
+  uint8_t offsets[PIXEL_MATRIX_MAX_PIXELS];         // Start of the pixel's run in positions
+  uint8_t lengths[PIXEL_MATRIX_MAX_PIXELS];         // Number of LEDs in the pixel's run
+  uint8_t positions[PIXEL_MATRIX_MAX_LEDS];         // The actual LED indexes on the chain
   uint8_t ledsPerPixel;
-  void setup(std::vector<std::vector<Pixel>> pixels, int ledsPerPixel = -1) {
-    this->pixels = pixels;
+
+  void setup(const std::vector<std::vector<Pixel>> &pixels, int ledsPerPixel = -1) {
+    this->size = 0;
+    this->ledCount = 0;
+    this->pixelCount = 0;
     this->ledsPerPixel = ledsPerPixel;
-  }
 
-  inline int getLedCount() {
-    int count = 0;
-    for (auto &col : pixels)
-      for (auto &pixel : col)
-        if (pixel.index == NO_PIXEL.index)
+    for (auto &col : pixels) {
+      for (auto &pixel : col) {
+        this->pixelCount++;
+        if (pixel.index == NO_PIXEL.index || this->size == PIXEL_MATRIX_MAX_PIXELS)
           continue;
-        else
-          count += pixel.positions.size();
 
-    return count;
+        uint8_t length = 0;
+        for (auto &pos : pixel.positions) {
+          if (this->ledCount + length == PIXEL_MATRIX_MAX_LEDS)
+            break;
+          this->positions[this->ledCount + length++] = pos;
+        }
+
+        this->indexes[this->size] = pixel.index;
+        this->masks[this->size] = pixel.mask;
+        this->offsets[this->size] = this->ledCount;
+        this->lengths[this->size] = length;
+        this->ledCount += length;
+        this->size++;
+      }
+    }
   }
 
-  inline uint16_t getPixelCount() const {
-    uint16_t count = 0;
-    for (auto &col : pixels)
-      count += col.size();
+  inline int getLedCount() const { return ledCount; }
+
+  inline uint16_t getPixelCount() const { return pixelCount; }
+
+  // Bit i is set when pixel i is lit by a button in buttonState
+  inline uint32_t getPressed(uint32_t buttonState) const {
+    uint32_t pressed = 0;
+    for (uint8_t i = 0; i < size; i++)
+      if (buttonState & masks[i])
+        pressed |= (1u << i);
 
-    return count;
+    return pressed;
   }
 
+private:
+  uint8_t ledCount = 0;
+  uint16_t pixelCount = 0;
 };
 
 inline bool operator==(const Pixel &lhs, const Pixel &rhs) {
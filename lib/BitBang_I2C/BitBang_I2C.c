@@ -21,9 +21,95 @@
 #include "hardware/gpio.h"
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 
 #include "BitBang_I2C.h"
 
+//
+// DMA write queue
+// Each byte becomes a 16-bit IC_DATA_CMD word so the STOP between writes is
+// carried in the stream and the controller starts the next write by itself
+// Only one bus at a time owns the queue, in practice the display's
+//
+static struct {
+	i2c_inst_t *picoI2C; // bus the queued words belong to
+	int iDMA;            // claimed channel, -1 if none was free, -2 before the first try
+	uint8_t iAddr;       // target address of every queued write
+	uint8_t bRunning;    // DMA (or the bus) is still busy with the queue
+	uint8_t bError;      // a write was NACKed since the last I2CWriteStart()
+	int iCount;          // words queued
+	void (*pfnDone)(void *pUser, int bError);
+	void *pUser;
+	uint16_t u16Words[I2C_ASYNC_QUEUE_SIZE];
+} i2cAsync = { .iDMA = -2 };
+
+static void I2CAsyncKick(void)
+{
+	i2c_hw_t *hw = i2c_get_hw(i2cAsync.picoI2C);
+	dma_channel_config c;
+
+	if (i2cAsync.picoI2C->restart_on_next) // last blocking write kept the bus
+		i2cAsync.u16Words[0] |= I2C_IC_DATA_CMD_RESTART_BITS;
+	hw->enable = 0;
+	hw->tar = i2cAsync.iAddr;
+	hw->enable = 1;
+
+	c = dma_channel_get_default_config(i2cAsync.iDMA);
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_write_increment(&c, false);
+	channel_config_set_dreq(&c, i2c_get_dreq(i2cAsync.picoI2C, true));
+	dma_channel_configure(i2cAsync.iDMA, &c, &hw->data_cmd, i2cAsync.u16Words, i2cAsync.iCount, true);
+	i2cAsync.bRunning = 1;
+} /* I2CAsyncKick() */
+
+//
+// Returns 1 while the queue is still going out, otherwise retires it
+// and calls the completion callback
+//
+static int I2CAsyncPoll(void)
+{
+	i2c_hw_t *hw;
+	void (*pfnDone)(void *pUser, int bError);
+	int bError;
+
+	if (!i2cAsync.bRunning)
+		return 0;
+	if (dma_channel_is_busy(i2cAsync.iDMA))
+		return 1;
+	hw = i2c_get_hw(i2cAsync.picoI2C);
+	if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+	{
+		// the controller flushed the FIFO and dropped the rest of the queue
+		(void)hw->clr_tx_abrt;
+		i2cAsync.bError = 1;
+	}
+	else if (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS))
+	{
+		return 1; // last bytes and STOP still on the wire
+	}
+	i2cAsync.bRunning = 0;
+	i2cAsync.iCount = 0;
+	i2cAsync.picoI2C->restart_on_next = false;
+	pfnDone = i2cAsync.pfnDone;
+	if (pfnDone)
+	{
+		bError = i2cAsync.bError;
+		i2cAsync.pfnDone = NULL;
+		i2cAsync.bError = 0;
+		(*pfnDone)(i2cAsync.pUser, bError);
+	}
+	return 0;
+} /* I2CAsyncPoll() */
+
+static void I2CAsyncDrain(void)
+{
+	if (!i2cAsync.bRunning && i2cAsync.iCount)
+		I2CAsyncKick();
+	while (I2CAsyncPoll())
+		tight_loop_contents();
+} /* I2CAsyncDrain() */
+
 
 //
 // Transmit a byte and read the ack bit
@@ -55,6 +141,7 @@ uint8_t I2CTest(BBI2C *pI2C, uint8_t addr)
 {
 	int ret;
     uint8_t rxdata;
+    I2CAsyncWait(pI2C);
     ret = i2c_read_blocking(pI2C->picoI2C, addr, &rxdata, 1, false);
     return (ret >= 0);
 } /* I2CTest() */
@@ -88,12 +175,76 @@ int I2CWrite(BBI2C *pI2C, uint8_t iAddr, uint8_t *pData, int iLen)
 {
 	int rc = 0;
 
+    I2CAsyncWait(pI2C);
     rc = i2c_write_blocking(pI2C->picoI2C, iAddr, pData, iLen, true); // true to keep master control of bus
     return rc >= 0 ? iLen : 0;
 
 
 } /* I2CWrite() */
 
+int I2CWriteQueue(BBI2C *pI2C, uint8_t iAddr, uint8_t *pData, int iLen)
+{
+	uint16_t *pWords;
+	int i;
+
+	if (iLen <= 0)
+		return 0;
+	if (i2cAsync.iDMA == -2)
+		i2cAsync.iDMA = dma_claim_unused_channel(false);
+	if (i2cAsync.iDMA < 0 || iLen > I2C_ASYNC_QUEUE_SIZE)
+	{
+		i = I2CWrite(pI2C, iAddr, pData, iLen);
+		if (i == 0)
+			i2cAsync.bError = 1;
+		return i;
+	}
+	// the queue can only be appended to while idle and for a single target
+	if (i2cAsync.bRunning || (i2cAsync.iCount && (i2cAsync.picoI2C != pI2C->picoI2C ||
+		i2cAsync.iAddr != iAddr || i2cAsync.iCount + iLen > I2C_ASYNC_QUEUE_SIZE)))
+		I2CAsyncDrain();
+	i2cAsync.picoI2C = pI2C->picoI2C;
+	i2cAsync.iAddr = iAddr;
+	pWords = &i2cAsync.u16Words[i2cAsync.iCount];
+	for (i = 0; i < iLen; i++)
+		pWords[i] = pData[i];
+	pWords[iLen - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+	i2cAsync.iCount += iLen;
+	return iLen;
+} /* I2CWriteQueue() */
+
+void I2CWriteStart(BBI2C *pI2C, void (*pfnDone)(void *pUser, int bError), void *pUser)
+{
+	int bError;
+
+	if (i2cAsync.iCount == 0 || i2cAsync.picoI2C != pI2C->picoI2C)
+	{
+		// nothing queued, everything already went out blocking
+		bError = i2cAsync.bError;
+		i2cAsync.bError = 0;
+		if (pfnDone)
+			(*pfnDone)(pUser, bError);
+		return;
+	}
+	while (I2CAsyncPoll()) // only if an earlier start is somehow still running
+		tight_loop_contents();
+	i2cAsync.pfnDone = pfnDone;
+	i2cAsync.pUser = pUser;
+	I2CAsyncKick();
+} /* I2CWriteStart() */
+
+int I2CAsyncBusy(BBI2C *pI2C)
+{
+	if (i2cAsync.picoI2C != pI2C->picoI2C)
+		return 0;
+	return I2CAsyncPoll();
+} /* I2CAsyncBusy() */
+
+void I2CAsyncWait(BBI2C *pI2C)
+{
+	if (i2cAsync.picoI2C == pI2C->picoI2C)
+		I2CAsyncDrain();
+} /* I2CAsyncWait() */
+
 //
 // Read N bytes starting at a specific I2C internal register
 //
@@ -101,6 +252,7 @@ int I2CReadRegister(BBI2C *pI2C, uint8_t iAddr, uint8_t u8Register, uint8_t *pDa
 {
 	int rc;
   
+    I2CAsyncWait(pI2C);
     rc = i2c_write_blocking(pI2C->picoI2C, iAddr, &u8Register, 1, true); // true to keep master control of bus 
     if (rc >= 0) {
         rc = i2c_read_blocking(pI2C->picoI2C, iAddr, pData, iLen, false);
@@ -114,6 +266,7 @@ int I2CReadRegister(BBI2C *pI2C, uint8_t iAddr, uint8_t u8Register, uint8_t *pDa
 int I2CRead(BBI2C *pI2C, uint8_t iAddr, uint8_t *pData, int iLen)
 {
 	int rc;
+    I2CAsyncWait(pI2C);
     rc = i2c_read_blocking(pI2C->picoI2C, iAddr, pData, iLen, false);
     return (rc >= 0);
 	
@@ -60,6 +60,12 @@ enum {
   DEVICE_DS1307
 };
 
+// Size of the DMA write queue in bytes (2 bytes of RAM each)
+// Large enough for a full 128x64 OLED frame plus positioning commands
+#ifndef I2C_ASYNC_QUEUE_SIZE
+#define I2C_ASYNC_QUEUE_SIZE 1280
+#endif
+
 #ifndef LOW
 #define LOW 0
 #define HIGH 1
@@ -92,6 +98,29 @@ int I2CReadRegister(BBI2C *pI2C, uint8_t iAddr, uint8_t u8Register, uint8_t *pDa
 //
 int I2CWrite(BBI2C *pI2C, uint8_t iAddr, uint8_t *pData, int iLen);
 //
+// Queue I2C data to be sent by DMA once I2CWriteStart() is called
+// Consecutive writes to the same address go out back to back from a single
+// DMA run, each one still framed by its own START/STOP
+// Falls back to a blocking write when no DMA channel could be claimed
+// returns the number of bytes queued (or written)
+//
+int I2CWriteQueue(BBI2C *pI2C, uint8_t iAddr, uint8_t *pData, int iLen);
+//
+// Start sending the queued writes and return immediately
+// pfnDone (may be NULL) is called from I2CAsyncBusy()/I2CAsyncWait() once the
+// last byte is on the wire, bError is set if any write was NACKed
+//
+void I2CWriteStart(BBI2C *pI2C, void (*pfnDone)(void *pUser, int bError), void *pUser);
+//
+// Returns 1 while queued writes for this bus are still going out
+//
+int I2CAsyncBusy(BBI2C *pI2C);
+//
+// Send anything still queued for this bus and wait for it to finish
+// The blocking functions call this first so transfers never interleave
+//
+void I2CAsyncWait(BBI2C *pI2C);
+//
 // Scans for I2C devices on the bus
 // returns a bitmap of devices which are present (128 bits = 16 bytes, LSB first)
 //
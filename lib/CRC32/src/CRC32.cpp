@@ -6,13 +6,88 @@
 
 #include "CRC32.h"
 
-static const uint32_t crc32_table[] = {
-	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
-	0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
-	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
-	0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+#include <string.h>
+
+#if CRC32_DMA_SNIFFER
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+#include "pico/platform.h"
+#endif
+
+namespace {
+
+// Slice-by-8 tables, table[0] is the classic byte-at-a-time table of the reflected 0xEDB88320 polynomial and
+// table[n] advances a byte that is followed by n more bytes
+struct CRC32Tables {
+	uint32_t table[8][256];
 };
 
+constexpr CRC32Tables makeTables() {
+	CRC32Tables tables{};
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+		tables.table[0][i] = crc;
+	}
+	for (uint32_t i = 0; i < 256; i++)
+		for (int slice = 1; slice < 8; slice++)
+			tables.table[slice][i] = (tables.table[slice - 1][i] >> 8) ^ tables.table[0][tables.table[slice - 1][i] & 0xff];
+	return tables;
+}
+
+constexpr CRC32Tables crc32Tables = makeTables();
+
+inline uint32_t updateByte(uint32_t crc, uint8_t data) {
+	return crc32Tables.table[0][(crc ^ data) & 0xff] ^ (crc >> 8);
+}
+
+inline uint32_t load32(const uint8_t *data) {
+	uint32_t word;
+	memcpy(&word, data, sizeof(word)); // Aligned by the caller, compiles to a single load
+	return word;
+}
+
+#if CRC32_DMA_SNIFFER
+int sniffChannel = -2; // -1 if no channel was free, -2 before the first try
+
+uint32_t bitReverse(uint32_t value) {
+	value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+	value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+	value = ((value >> 4) & 0x0f0f0f0f) | ((value & 0x0f0f0f0f) << 4);
+	return __builtin_bswap32(value);
+}
+
+// The sniffer runs the non-reflected algorithm on bit reversed input, so its register holds the reflected state
+// bit reversed. Only core0 uses it, the sniffer is a single shared block.
+bool sniffUpdate(uint32_t &state, const uint8_t *data, uint32_t size) {
+	if (size < CRC32_DMA_MIN_LENGTH || get_core_num() != 0)
+		return false;
+	if (sniffChannel == -2)
+		sniffChannel = dma_claim_unused_channel(false);
+	if (sniffChannel < 0)
+		return false;
+
+	static uint8_t sink;
+	dma_channel_config config = dma_channel_get_default_config(sniffChannel);
+	channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+	channel_config_set_read_increment(&config, true);
+	channel_config_set_write_increment(&config, false);
+	channel_config_set_sniff_enable(&config, true);
+
+	dma_hw->sniff_data = bitReverse(state);
+	dma_sniffer_enable(sniffChannel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+	hw_set_bits(&dma_hw->sniff_ctrl, DMA_SNIFF_CTRL_OUT_REV_BITS);
+	dma_channel_configure(sniffChannel, &config, &sink, data, size, true);
+	dma_channel_wait_for_finish_blocking(sniffChannel);
+	state = dma_hw->sniff_data;
+	dma_sniffer_disable();
+	return true;
+}
+#endif
+
+}
+
 CRC32::CRC32() {
 	reset();
 }
@@ -22,13 +97,34 @@ void CRC32::reset() {
 }
 
 void CRC32::update(const uint8_t &data) {
-	// via http://forum.arduino.cc/index.php?topic=91179.0
-	uint8_t tbl_idx = 0;
+	_state = updateByte(_state, data);
+}
+
+void CRC32::update(const uint8_t *data, uint32_t size) {
+#if CRC32_DMA_SNIFFER
+	if (sniffUpdate(_state, data, size))
+		return;
+#endif
+
+	uint32_t crc = _state;
+	while (size && (reinterpret_cast<uintptr_t>(data) & 3)) {
+		crc = updateByte(crc, *data++);
+		size--;
+	}
+
+	const uint32_t (&table)[8][256] = crc32Tables.table;
+	while (size >= 8) {
+		const uint32_t one = load32(data) ^ crc;
+		const uint32_t two = load32(data + 4);
+		crc = table[7][one & 0xff] ^ table[6][(one >> 8) & 0xff] ^ table[5][(one >> 16) & 0xff] ^ table[4][one >> 24] ^
+			table[3][two & 0xff] ^ table[2][(two >> 8) & 0xff] ^ table[1][(two >> 16) & 0xff] ^ table[0][two >> 24];
+		data += 8;
+		size -= 8;
+	}
 
-	tbl_idx = _state ^ (data >> (0 * 4));
-	_state = *(uint32_t *)(crc32_table + (tbl_idx & 0x0f)) ^ (_state >> 4);
-	tbl_idx = _state ^ (data >> (1 * 4));
-	_state = *(uint32_t *)(crc32_table + (tbl_idx & 0x0f)) ^ (_state >> 4);
+	while (size--)
+		crc = updateByte(crc, *data++);
+	_state = crc;
 }
 
 uint32_t CRC32::finalize() const
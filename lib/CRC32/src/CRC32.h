@@ -8,6 +8,16 @@
 
 #include <stdint.h>
 
+// Feed buffers through the RP2040 DMA sniffer instead of the slice-by-8 tables, set by the CRC32_DMA_SNIFFER CMake option
+#ifndef CRC32_DMA_SNIFFER
+#define CRC32_DMA_SNIFFER 0
+#endif
+
+// Shorter buffers are cheaper on the tables than setting up a DMA transfer
+#ifndef CRC32_DMA_MIN_LENGTH
+#define CRC32_DMA_MIN_LENGTH 64
+#endif
+
 /// \brief A class for calculating the CRC32 checksum from arbitrary data.
 /// \sa http://forum.arduino.cc/index.php?topic=91179.0
 class CRC32 {
@@ -30,19 +40,18 @@ public:
 		update(&data, 1);
 	}
 
+	/// \brief Update the current checksum caclulation with a block of bytes.
+	/// \param data The bytes to add to the checksum.
+	/// \param size Number of bytes to add.
+	void update(const uint8_t *data, uint32_t size);
+
 	/// \brief Update the current checksum caclulation with the given data.
 	/// \tparam Type The data type to read.
 	/// \param data The array to add to the checksum.
 	/// \param size Size of the array to add.
 	template <typename Type>
 	void update(const Type *data, uint16_t size) {
-		uint16_t nBytes = size * sizeof(Type);
-		const uint8_t *pData = (const uint8_t *)data;
-
-		for (uint16_t i = 0; i < nBytes; i++)
-		{
-			update(pData[i]);
-		}
+		update(reinterpret_cast<const uint8_t *>(data), static_cast<uint32_t>(size) * sizeof(Type));
 	}
 
 	/// \returns the caclulated checksum.
@@ -3,28 +3,307 @@
  * SPDX-FileCopyrightText: Copyright (c) 2021 Jason Skuby (mytechtoybox.com)
  */
 
+#include <stddef.h>
+
 #include "FlashPROM.h"
+#include "CRC32.h"
 
-uint8_t FlashPROM::writeCache[EEPROM_SIZE_BYTES];
-volatile static alarm_id_t flashWriteAlarm = 0;
+alignas(4) uint8_t FlashPROM::writeCache[EEPROM_SIZE_BYTES];
 volatile static spin_lock_t *flashLock = nullptr;
 
-int64_t writeToFlash(alarm_id_t id, void *flashCache)
+#define JOURNAL_MAGIC            0x4a4d5047 // "GPMJ"
+#define JOURNAL_PAGES            (EEPROM_JOURNAL_SIZE / FLASH_PAGE_SIZE)
+#define JOURNAL_BANK_PAGES       (EEPROM_BANK_SIZE / FLASH_PAGE_SIZE)
+#define JOURNAL_COMMIT_BLOCK     0xFFFE     // Block number of a commit record
+#define JOURNAL_NO_PAGE          0xFFFF
+#define JOURNAL_NO_BANK          0xFF
+
+static_assert(EEPROM_JOURNAL_SECTORS % 2 == 0, "The journal is made of two banks of whole sectors");
+static_assert(JOURNAL_BANK_PAGES >= EEPROM_BLOCK_COUNT + 1 + 8, "A bank needs room for every block, a commit record and some deltas");
+static_assert(EEPROM_JOURNAL_START + EEPROM_BANK_SIZE <= EEPROM_ADDRESS_START, "Bank 0 must not overlap the image of older firmware");
+static_assert(EEPROM_JOURNAL_START >= XIP_BASE, "The journal has to lie in flash");
+
+struct JournalRecord
 {
-	while (is_spin_locked(flashLock));
+	uint32_t magic;
+	uint32_t generation; // Number of the commit the record belongs to
+	uint16_t block;
+	uint16_t reserved;
+	uint32_t crc;        // Over the header fields above and data
+	uint8_t data[EEPROM_BLOCK_SIZE];
+};
 
-	multicore_lockout_start_blocking();
-	uint32_t interrupts = spin_lock_blocking(flashLock);
+static_assert(sizeof(JournalRecord) == FLASH_PAGE_SIZE, "A journal record has to fill exactly one flash page");
+static_assert(EEPROM_BLOCK_COUNT * sizeof(uint16_t) <= EEPROM_BLOCK_SIZE, "A commit record has to hold the page of every block");
+
+// State of the last complete commit
+static uint16_t blockPages[EEPROM_BLOCK_COUNT]; // Page of every block, JOURNAL_NO_PAGE for a block of zeros
+static uint32_t journalGeneration = 0;          // Highest generation found on flash or written since
+static uint8_t journalBank = JOURNAL_NO_BANK;   // Bank holding the last complete commit
+static uint16_t journalHead = 0;                // Next page to program in that bank
+
+// State of the commit in progress
+static bool commitRunning = false;
+static bool commitWholeImage = false;           // Switching banks, every block gets a new record
+static uint8_t commitBank = 0;
+static uint16_t commitSector = 0;               // Next sector of commitBank to erase
+static uint16_t commitBlock = 0;                // Next block to compare against the last commit
+static uint16_t commitHead = 0;                 // Next page to program in commitBank
+static uint16_t commitPages[EEPROM_BLOCK_COUNT];
+static absolute_time_t commitDeadline = nil_time; // A commit is pending once this is set
+static uint32_t imageVersion = 0;               // Bumped by every commit() request
+static uint32_t commitVersion = 0;              // imageVersion the running commit started from
+static JournalRecord pageBuffer;
+
+static inline const JournalRecord *journalRecord(uint16_t page)
+{
+	return reinterpret_cast<const JournalRecord *>(EEPROM_JOURNAL_START + page * FLASH_PAGE_SIZE);
+}
+
+static inline uint8_t journalBankOf(uint16_t page)
+{
+	return page / JOURNAL_BANK_PAGES;
+}
 
-	flash_range_erase((intptr_t)EEPROM_ADDRESS_START - (intptr_t)XIP_BASE, EEPROM_SIZE_BYTES);
-	flash_range_program((intptr_t)EEPROM_ADDRESS_START - (intptr_t)XIP_BASE, reinterpret_cast<uint8_t *>(flashCache), EEPROM_SIZE_BYTES);
+static inline uint16_t blockSize(uint16_t block)
+{
+	return block == EEPROM_BLOCK_COUNT - 1 ? EEPROM_SIZE_BYTES - block * EEPROM_BLOCK_SIZE : EEPROM_BLOCK_SIZE;
+}
 
-	flashWriteAlarm = 0;
+static uint32_t recordCrc(const JournalRecord *record)
+{
+	CRC32 crc;
+	crc.update(reinterpret_cast<const uint8_t *>(record), offsetof(JournalRecord, crc));
+	crc.update(record->data, EEPROM_BLOCK_SIZE);
+	return crc.finalize();
+}
 
+static bool recordValid(const JournalRecord *record)
+{
+	return record->magic == JOURNAL_MAGIC &&
+		(record->block < EEPROM_BLOCK_COUNT || record->block == JOURNAL_COMMIT_BLOCK) &&
+		record->crc == recordCrc(record);
+}
+
+static inline bool generationAfter(uint32_t a, uint32_t b)
+{
+	return (int32_t)(a - b) > 0;
+}
+
+static bool pageErased(uint16_t page)
+{
+	const uint32_t *words = reinterpret_cast<const uint32_t *>(journalRecord(page));
+	for (uint32_t i = 0; i < FLASH_PAGE_SIZE / sizeof(uint32_t); i++)
+		if (words[i] != 0xFFFFFFFF)
+			return false;
+	return true;
+}
+
+static bool sectorErased(uint16_t sector)
+{
+	for (uint16_t page = sector * (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE); page < (sector + 1) * (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE); page++)
+		if (!pageErased(page))
+			return false;
+	return true;
+}
+
+// Every flash operation locks core1 out on its own, keeping each stall to a single page or sector
+static void programPage(uint16_t page, const void *data)
+{
+	multicore_lockout_start_blocking();
+	uint32_t interrupts = spin_lock_blocking(flashLock);
+	flash_range_program((intptr_t)EEPROM_JOURNAL_START - (intptr_t)XIP_BASE + page * FLASH_PAGE_SIZE, reinterpret_cast<const uint8_t *>(data), FLASH_PAGE_SIZE);
 	multicore_lockout_end_blocking();
 	spin_unlock(flashLock, interrupts);
+}
 
-	return 0;
+static void eraseSector(uint16_t sector)
+{
+	multicore_lockout_start_blocking();
+	uint32_t interrupts = spin_lock_blocking(flashLock);
+	flash_range_erase((intptr_t)EEPROM_JOURNAL_START - (intptr_t)XIP_BASE + sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+	multicore_lockout_end_blocking();
+	spin_unlock(flashLock, interrupts);
+}
+
+// Programs pageBuffer at the next erased page of the commit's bank. A page that does not read back is skipped, it
+// was torn by a power loss during an earlier erase. Returns JOURNAL_NO_PAGE once the bank is full.
+static uint16_t appendRecord()
+{
+	pageBuffer.magic = JOURNAL_MAGIC;
+	pageBuffer.generation = journalGeneration + 1;
+	pageBuffer.reserved = 0xFFFF;
+	pageBuffer.crc = recordCrc(&pageBuffer);
+
+	const uint16_t bankEnd = (commitBank + 1) * JOURNAL_BANK_PAGES;
+	while (commitHead < bankEnd)
+	{
+		uint16_t page = commitHead++;
+		if (!pageErased(page))
+			continue;
+		programPage(page, &pageBuffer);
+		if (memcmp(journalRecord(page), &pageBuffer, FLASH_PAGE_SIZE) == 0)
+			return page;
+	}
+	return JOURNAL_NO_PAGE;
+}
+
+static bool blockZero(uint16_t block, const uint8_t *image)
+{
+	const uint8_t *data = image + block * EEPROM_BLOCK_SIZE;
+	for (uint16_t i = 0; i < blockSize(block); i++)
+		if (data[i] != 0)
+			return false;
+	return true;
+}
+
+// Compared against the last complete commit, blocks without a record read back as zero
+static bool blockChanged(uint16_t block, const uint8_t *image)
+{
+	if (blockPages[block] == JOURNAL_NO_PAGE)
+		return !blockZero(block, image);
+	return memcmp(image + block * EEPROM_BLOCK_SIZE, journalRecord(blockPages[block])->data, blockSize(block)) != 0;
+}
+
+static uint16_t erasedPages(uint8_t bank, uint16_t page)
+{
+	uint16_t count = 0;
+	for (const uint16_t bankEnd = (bank + 1) * JOURNAL_BANK_PAGES; page < bankEnd; page++)
+		if (pageErased(page))
+			count++;
+	return count;
+}
+
+// Write the whole image to a freshly erased bank, used when there is no commit yet or the active bank is full
+static void startBankSwitch(uint8_t bank)
+{
+	commitWholeImage = true;
+	commitBank = bank;
+	commitSector = 0;
+	commitBlock = 0;
+	commitHead = bank * JOURNAL_BANK_PAGES;
+}
+
+// The commit's bank ran out of pages. A delta moves on to the other bank, but a bank switch is given up instead of
+// erasing the bank with the last commit, pages only fail like this on worn out flash.
+static void bankFull()
+{
+	if (commitWholeImage)
+		commitRunning = false;
+	else
+		startBankSwitch(commitBank ^ 1);
+}
+
+// Decides where the commit goes, returns false if the image matches the last commit
+static bool startCommit(const uint8_t *image)
+{
+	uint16_t changed = 0;
+	uint16_t records = 0;
+	for (uint16_t block = 0; block < EEPROM_BLOCK_COUNT; block++)
+	{
+		commitPages[block] = blockPages[block];
+		if (blockChanged(block, image))
+		{
+			changed++;
+			if (!blockZero(block, image))
+				records++;
+		}
+	}
+
+	if (journalBank == JOURNAL_NO_BANK)
+	{
+		startBankSwitch(0);
+		return true;
+	}
+	if (changed == 0)
+		return false;
+
+	if (records + 1 > erasedPages(journalBank, journalHead))
+	{
+		startBankSwitch(journalBank ^ 1);
+		return true;
+	}
+
+	commitWholeImage = false;
+	commitBank = journalBank;
+	commitSector = EEPROM_BANK_SECTORS;
+	commitBlock = 0;
+	commitHead = journalHead;
+	return true;
+}
+
+// Performs the next flash operation of the commit, returns false once there is nothing left to do
+static bool stepJournal(const uint8_t *image)
+{
+	while (commitSector < EEPROM_BANK_SECTORS)
+	{
+		uint16_t sector = commitBank * EEPROM_BANK_SECTORS + commitSector++;
+		if (!sectorErased(sector))
+		{
+			eraseSector(sector);
+			return true;
+		}
+	}
+
+	for (; commitBlock < EEPROM_BLOCK_COUNT; commitBlock++)
+	{
+		if (blockZero(commitBlock, image))
+		{
+			commitPages[commitBlock] = JOURNAL_NO_PAGE;
+			continue;
+		}
+		if (!commitWholeImage && !blockChanged(commitBlock, image))
+			continue;
+
+		pageBuffer.block = commitBlock;
+		memset(pageBuffer.data, 0, EEPROM_BLOCK_SIZE);
+		memcpy(pageBuffer.data, image + commitBlock * EEPROM_BLOCK_SIZE, blockSize(commitBlock));
+		uint16_t page = appendRecord();
+		if (page == JOURNAL_NO_PAGE)
+		{
+			// The records written so far are never referenced
+			bankFull();
+			return true;
+		}
+		commitPages[commitBlock++] = page;
+		return true;
+	}
+
+	// The commit record makes the new records count, until it is written the last commit stays in effect
+	pageBuffer.block = JOURNAL_COMMIT_BLOCK;
+	memset(pageBuffer.data, 0, EEPROM_BLOCK_SIZE);
+	memcpy(pageBuffer.data, commitPages, sizeof(commitPages));
+	if (appendRecord() == JOURNAL_NO_PAGE)
+	{
+		bankFull();
+		return true;
+	}
+
+	memcpy(blockPages, commitPages, sizeof(blockPages));
+	journalGeneration++;
+	journalBank = commitBank;
+	journalHead = commitHead;
+	commitRunning = false;
+	return true;
+}
+
+// A commit only counts when every block it names is still there and intact
+static bool commitValid(uint16_t commitPage)
+{
+	const JournalRecord *commit = journalRecord(commitPage);
+	const uint16_t *pages = reinterpret_cast<const uint16_t *>(commit->data);
+	for (uint16_t block = 0; block < EEPROM_BLOCK_COUNT; block++)
+	{
+		uint16_t page = pages[block];
+		if (page == JOURNAL_NO_PAGE)
+			continue;
+		if (page >= commitPage || journalBankOf(page) != journalBankOf(commitPage))
+			return false;
+		const JournalRecord *record = journalRecord(page);
+		if (!recordValid(record) || record->block != block || generationAfter(record->generation, commit->generation))
+			return false;
+	}
+	return true;
 }
 
 void FlashPROM::start()
@@ -32,7 +311,53 @@ void FlashPROM::start()
 	if (flashLock == nullptr)
 		flashLock = spin_lock_instance(spin_lock_claim_unused(true));
 
-	memcpy(writeCache, reinterpret_cast<uint8_t *>(EEPROM_ADDRESS_START), EEPROM_SIZE_BYTES);
+	// Find the newest complete commit. Generations only grow, so stale and unfinished commits never win.
+	uint16_t commitPage = JOURNAL_NO_PAGE;
+	bool seenRecord = false;
+	for (uint16_t page = 0; page < JOURNAL_PAGES; page++)
+	{
+		const JournalRecord *record = journalRecord(page);
+		if (!recordValid(record))
+			continue;
+		if (!seenRecord || generationAfter(record->generation, journalGeneration))
+			journalGeneration = record->generation;
+		seenRecord = true;
+
+		if (record->block != JOURNAL_COMMIT_BLOCK || !commitValid(page))
+			continue;
+		if (commitPage == JOURNAL_NO_PAGE || generationAfter(record->generation, journalRecord(commitPage)->generation))
+			commitPage = page;
+	}
+	if (!seenRecord)
+		journalGeneration = 0;
+
+	commitRunning = false;
+	commitDeadline = nil_time;
+	if (commitPage == JOURNAL_NO_PAGE)
+	{
+		// Nothing committed yet, take over the image written by older firmware
+		journalBank = JOURNAL_NO_BANK;
+		for (uint16_t block = 0; block < EEPROM_BLOCK_COUNT; block++)
+			blockPages[block] = JOURNAL_NO_PAGE;
+		memcpy(writeCache, reinterpret_cast<uint8_t *>(EEPROM_ADDRESS_START), EEPROM_SIZE_BYTES);
+		return;
+	}
+
+	journalBank = journalBankOf(commitPage);
+	memcpy(blockPages, journalRecord(commitPage)->data, sizeof(blockPages));
+	for (uint16_t block = 0; block < EEPROM_BLOCK_COUNT; block++)
+	{
+		uint8_t *data = writeCache + block * EEPROM_BLOCK_SIZE;
+		if (blockPages[block] != JOURNAL_NO_PAGE)
+			memcpy(data, journalRecord(blockPages[block])->data, blockSize(block));
+		else
+			memset(data, 0, blockSize(block));
+	}
+
+	// Append after anything already programmed in the bank, including records of an interrupted commit
+	journalHead = (journalBank + 1) * JOURNAL_BANK_PAGES;
+	while (journalHead > commitPage + 1 && pageErased(journalHead - 1))
+		journalHead--;
 }
 
 /* We don't have an actual EEPROM, so we need to be extra careful about minimizing writes. Instead
@@ -40,10 +365,40 @@ void FlashPROM::start()
 	to commit in that timeframe, we'll hold off until the user is done sending changes. */
 void FlashPROM::commit()
 {
-	while (is_spin_locked(flashLock));
-	if (flashWriteAlarm != 0)
-		cancel_alarm(flashWriteAlarm);
-	flashWriteAlarm = add_alarm_in_ms(EEPROM_WRITE_WAIT, writeToFlash, writeCache, true);
+	imageVersion++;
+	commitDeadline = make_timeout_time_ms(EEPROM_WRITE_WAIT);
+}
+
+/* A commit is spread over many calls so that the gamepad loop never waits on more than a single page program
+	or sector erase. A change made while a commit is running abandons it before its commit record is written,
+	otherwise the commit would mix blocks of both images. The next commit starts over from the new image. */
+bool FlashPROM::process()
+{
+	if (commitRunning && commitVersion != imageVersion)
+		commitRunning = false;
+
+	if (!commitRunning)
+	{
+		if (is_nil_time(commitDeadline) || !time_reached(commitDeadline))
+			return false;
+		commitDeadline = nil_time;
+		if (!startCommit(writeCache))
+			return false;
+		commitRunning = true;
+		commitVersion = imageVersion;
+	}
+
+	return stepJournal(writeCache);
+}
+
+void FlashPROM::flush()
+{
+	while (commitRunning || !is_nil_time(commitDeadline))
+	{
+		if (!is_nil_time(commitDeadline))
+			commitDeadline = get_absolute_time();
+		process();
+	}
 }
 
 void FlashPROM::reset()
@@ -12,20 +12,42 @@
 #include <pico/multicore.h>
 #include <hardware/flash.h>
 #include <hardware/timer.h>
+#include <pico/time.h>
 
 #define EEPROM_SIZE_BYTES    0x2000           // Reserve 8k of flash memory (ensure this value is divisible by 256)
 #define EEPROM_ADDRESS_START _u(0x101FE000) // The arduino-pico EEPROM lib starts here, so we'll do the same
-// Warning: If the write wait is too long it can stall other processes
-#define EEPROM_WRITE_WAIT    50             // Amount of time in ms to wait before blocking core1 and committing to flash
+
+// The 8k image is persisted as a journal of 256 byte records, each carrying one block of the image. The journal is
+// split into two banks. A commit appends the blocks that changed and then a commit record naming the page of every
+// block, an interrupted commit has no commit record and is ignored on the next boot. When a bank runs out of pages the
+// whole image goes to the other bank first, the full bank is only erased by the switch after that.
+// The journal ends where the image of older firmware ends. That image lies in bank 1 and is picked up on first boot,
+// the first commit goes to bank 0 so it is kept until then.
+// The size is set by FLASHPROM_JOURNAL_SECTORS in CMake, which also makes the link fail if the program reaches it.
+#ifndef EEPROM_JOURNAL_SECTORS
+#define EEPROM_JOURNAL_SECTORS 6
+#endif
+#define EEPROM_BANK_SECTORS  (EEPROM_JOURNAL_SECTORS / 2)
+#define EEPROM_BANK_SIZE     (EEPROM_BANK_SECTORS * FLASH_SECTOR_SIZE)
+#define EEPROM_JOURNAL_SIZE  (EEPROM_JOURNAL_SECTORS * FLASH_SECTOR_SIZE)
+#define EEPROM_JOURNAL_START (EEPROM_ADDRESS_START + EEPROM_SIZE_BYTES - EEPROM_JOURNAL_SIZE)
+#define EEPROM_BLOCK_SIZE    (FLASH_PAGE_SIZE - 16) // Image bytes per record, the rest is the record header
+#define EEPROM_BLOCK_COUNT   ((EEPROM_SIZE_BYTES + EEPROM_BLOCK_SIZE - 1) / EEPROM_BLOCK_SIZE)
+#define EEPROM_WRITE_WAIT    50             // Amount of time in ms to wait for further changes before committing to flash
 
 class FlashPROM
 {
 	public:
 		void start();
+		// Call after every change to writeCache, the change is written once no other one followed for EEPROM_WRITE_WAIT
 		void commit();
+		// Runs at most one flash operation of a pending commit, returns true if it did
+		bool process();
+		// Finishes a pending commit right away, e.g. before rebooting
+		void flush();
 		void reset();
 
-		static uint8_t writeCache[EEPROM_SIZE_BYTES];
+		alignas(4) static uint8_t writeCache[EEPROM_SIZE_BYTES]; // The image as it is persisted, read config from here and not from flash
 };
 
 inline FlashPROM EEPROM;
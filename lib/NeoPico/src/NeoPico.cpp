@@ -12,8 +12,31 @@
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/timer.h"
 #include "NeoPico.hpp"
 
+#define NEO_PICO_MAX_PIXELS 100
+#define NEO_PICO_LATCH_TIMERS 4 // Latch alarms pending at once, one per instance is plenty
+
+// Alarms fire on the core that created their pool. The default pool belongs to core0, where the latch alarm would
+// cut into the gamepad loop, so the first Show() creates a pool on a spare hardware alarm for the core it runs on.
+static alarm_pool_t *latchPool = nullptr;
+
+static alarm_pool_t *GetLatchPool() {
+  if (latchPool == nullptr) {
+    // alarm_pool_create() claims the alarm itself
+    int hardwareAlarm = hardware_alarm_claim_unused(false);
+    if (hardwareAlarm >= 0) {
+      hardware_alarm_unclaim(hardwareAlarm);
+      latchPool = alarm_pool_create(hardwareAlarm, NEO_PICO_LATCH_TIMERS);
+    } else {
+      latchPool = alarm_pool_get_default();
+    }
+  }
+  return latchPool;
+}
+
 LEDFormat NeoPico::GetFormat() {
   return format;
 }
@@ -22,23 +45,72 @@ void NeoPico::PutPixel(uint32_t pixelData) {
   switch (format) {
     case LED_FORMAT_GRB:
     case LED_FORMAT_RGB:
-      pio_sm_put_blocking(pio0, 0, pixelData << 8u);
+      pio_sm_put_blocking(pio, sm, pixelData << 8u);
       break;
     case LED_FORMAT_GRBW:
     case LED_FORMAT_RGBW:
-      pio_sm_put_blocking(pio0, 0, pixelData);
+      pio_sm_put_blocking(pio, sm, pixelData);
       break;
   }
 }
 
 NeoPico::NeoPico(int ledPin, int numPixels, LEDFormat format) : format(format), numPixels(numPixels) {
-  PIO pio = pio0;
-  int sm = 0;
-  uint offset = pio_add_program(pio, &ws2812_program);
+  critical_section_init(&lock);
+  this->Clear();
+  if (this->numPixels > NEO_PICO_MAX_PIXELS)
+    this->numPixels = NEO_PICO_MAX_PIXELS;
+
+  // The placeholder instance created before the LED options are known drives nothing
+  if (ledPin < 0 || this->numPixels <= 0)
+    return;
+
+  // pio0 as before, pio1 if the keyboard host's PIO-USB left no room there
+  PIO candidates[] = { pio0, pio1 };
+  for (PIO candidate : candidates) {
+    if (!pio_can_add_program(candidate, &ws2812_program))
+      continue;
+    int claimed = pio_claim_unused_sm(candidate, false);
+    if (claimed < 0)
+      continue;
+    pio = candidate;
+    sm = claimed;
+    break;
+  }
+  if (sm < 0)
+    return;
+
+  offset = pio_add_program(pio, &ws2812_program);
   bool rgbw = (format == LED_FORMAT_GRBW) || (format == LED_FORMAT_RGBW);
   ws2812_program_init(pio, sm, offset, ledPin, 800000, rgbw);
-  this->Clear();
-  sleep_ms(10);
+
+  // Without a free channel Show() falls back to pushing the FIFO itself
+  dmaChannel = dma_claim_unused_channel(false);
+  if (dmaChannel >= 0) {
+    dma_channel_config config = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(dmaChannel, &config, &pio->txf[sm], buffers[0], this->numPixels, false);
+  }
+}
+
+NeoPico::~NeoPico() {
+  if (sm >= 0) {
+    // Drop a queued frame and let the one going out latch, so the next owner of the pin starts clean
+    critical_section_enter_blocking(&lock);
+    pending = false;
+    critical_section_exit(&lock);
+    while (sending)
+      tight_loop_contents();
+
+    if (dmaChannel >= 0)
+      dma_channel_unclaim(dmaChannel);
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_unclaim(pio, sm);
+    pio_remove_program(pio, &ws2812_program, offset);
+  }
+  critical_section_deinit(&lock);
 }
 
 void NeoPico::Clear() {
@@ -49,17 +121,95 @@ void NeoPico::SetFrame(uint32_t newFrame[100]) {
   memcpy(frame, newFrame, sizeof(frame));
 }
 
+bool NeoPico::IsBusy() {
+  return sending || pending;
+}
+
+uint32_t NeoPico::GetFramesShown() {
+  return framesShown;
+}
+
+// Called with the lock held, returns how long until the frame has gone out and latched
+uint32_t NeoPico::StartFrame() {
+  active ^= 1;
+  sending = true;
+  dma_channel_transfer_from_buffer_now(dmaChannel, buffers[active], numPixels);
+
+  bool rgbw = (format == LED_FORMAT_GRBW) || (format == LED_FORMAT_RGBW);
+  return numPixels * (rgbw ? 40 : 30) + NEO_PICO_RESET_US; // 1.25us a bit
+}
+
+int64_t NeoPico::FrameDoneCallback(alarm_id_t id, void *userData) {
+  return static_cast<NeoPico*>(userData)->FrameDone();
+}
+
+int64_t NeoPico::FrameDone() {
+  // Still shifting out, the state machine runs slower than assumed
+  if (dma_channel_is_busy(dmaChannel) || !pio_sm_is_tx_fifo_empty(pio, sm)) {
+    draining = true;
+    return NEO_PICO_RESET_US;
+  }
+  // The last word left the FIFO some time since the previous check and may still be shifting out
+  if (draining) {
+    draining = false;
+    bool rgbw = (format == LED_FORMAT_GRBW) || (format == LED_FORMAT_RGBW);
+    return (rgbw ? 40 : 30) + NEO_PICO_RESET_US;
+  }
+
+  int64_t next = 0;
+  critical_section_enter_blocking(&lock);
+  framesShown = framesShown + 1;
+  if (pending) {
+    pending = false;
+    next = StartFrame();
+  } else {
+    sending = false;
+  }
+  critical_section_exit(&lock);
+  return next;
+}
+
 void NeoPico::Show() {
+  if (sm < 0)
+    return;
+
+  if (dmaChannel < 0) {
+    for (int i = 0; i < this->numPixels; ++i) {
+       this->PutPixel(this->frame[i]);
+    }
+    busy_wait_us(numPixels * 40 + NEO_PICO_RESET_US);
+    framesShown = framesShown + 1;
+    return;
+  }
+
+  // A queued frame is replaced by this one, take its buffer back before refilling it
+  critical_section_enter_blocking(&lock);
+  pending = false;
+  uint32_t *words = buffers[active ^ 1];
+  critical_section_exit(&lock);
+
+  bool rgbw = (format == LED_FORMAT_GRBW) || (format == LED_FORMAT_RGBW);
   for (int i = 0; i < this->numPixels; ++i) {
-     this->PutPixel(this->frame[i]);
+    words[i] = rgbw ? this->frame[i] : this->frame[i] << 8u;
+  }
+
+  critical_section_enter_blocking(&lock);
+  if (sending) {
+    pending = true;
+    critical_section_exit(&lock);
+    return;
+  }
+  uint32_t delay = StartFrame();
+  critical_section_exit(&lock);
+
+  if (alarm_pool_add_alarm_in_us(GetLatchPool(), delay, FrameDoneCallback, this, true) < 0) {
+    // No alarm slot, wait it out here
+    for (int64_t wait = delay; wait != 0; wait = FrameDone())
+      busy_wait_us(wait);
   }
-  sleep_ms(10);
 }
 
 void NeoPico::Off() {
   Clear();
-  for (int i = 0; i < this->numPixels; ++i) {
-     this->PutPixel(this->frame[i]);
-  }
-  sleep_ms(10);
+  Show();
 }
@@ -2,8 +2,15 @@
 #define _NEO_PICO_H_
 
 #include "ws2812.pio.h"
+#include "pico/critical_section.h"
+#include "pico/time.h"
 #include <vector>
 
+// Low time after a frame before the LEDs latch it, WS2812B parts need 280us
+#ifndef NEO_PICO_RESET_US
+#define NEO_PICO_RESET_US 300
+#endif
+
 typedef enum
 {
   LED_FORMAT_GRB = 0,
@@ -16,18 +23,38 @@ class NeoPico
 {
 public:
   NeoPico(int ledPin, int numPixels, LEDFormat format = LED_FORMAT_GRB);
+  ~NeoPico();
+  // Hands the frame to DMA and returns, a frame shown while another is still going out is sent after it
   void Show();
   void Clear();
   void Off();
   LEDFormat GetFormat();
+  // True until every shown frame has been sent and latched
+  bool IsBusy();
+  // Number of frames sent and latched so far
+  uint32_t GetFramesShown();
   // void SetPixel(int pixel, uint32_t color);
   void SetFrame(uint32_t newFrame[100]);
 private:
   void PutPixel(uint32_t pixel_grb);
+  uint32_t StartFrame();
+  int64_t FrameDone();
+  static int64_t FrameDoneCallback(alarm_id_t id, void *userData);
   LEDFormat format;
   PIO pio = pio0;
+  int sm = -1;
+  uint offset = 0;
+  int dmaChannel = -1;
   int numPixels = 0;
   uint32_t frame[100];
+  // Words as the state machine shifts them out, the DMA reads buffers[active] while Show() fills the other
+  uint32_t buffers[2][100];
+  uint8_t active = 0;
+  volatile bool sending = false;    // A frame is going out or latching
+  volatile bool pending = false;    // buffers[active ^ 1] goes out once it has latched
+  bool draining = false;            // The latch alarm found the frame still going out
+  volatile uint32_t framesShown = 0;
+  critical_section_t lock;          // The latch alarm interrupts Show()
 };
 
 #endif
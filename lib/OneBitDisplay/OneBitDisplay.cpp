@@ -454,6 +454,7 @@ int obdI2CInit(OBDISP *pOBD, int iType, int iAddr, int bFlip, int bInvert, int b
 	pOBD->bbi2c.picoI2C = picoI2C;
 	pOBD->bbi2c.bWire = bWire;
 	pOBD->com_mode = COM_I2C; // communication mode
+	pOBD->bAsync = 0;
 
 	I2CInit(&pOBD->bbi2c, iSpeed); // on Linux, SDA = bus number, SCL = device address
 
@@ -822,6 +823,75 @@ void obdDumpBuffer(OBDISP *pOBD, uint8_t *pBuffer)
 	} // for y
 	obdCachedFlush(pOBD, 1);
 } /* obdDumpBuffer() */
+//
+// Send only the bytes of the back buffer that differ from pShadow, a copy of what
+// the display currently shows, then bring pShadow up to date.
+// Runs closer than OBD_DIFF_MERGE_GAP bytes are merged since every reposition
+// costs a command write of its own.
+//
+void obdDumpBufferDiff(OBDISP *pOBD, uint8_t *pShadow)
+{
+	int x, y, iStart, iEnd, iLines;
+	uint8_t *pSrc, *pDst;
+
+	if (pOBD->type == LCD_VIRTUAL || pOBD->ucScreen == NULL || pShadow == NULL)
+		return;
+	if (pOBD->type >= SHARP_144x168) // whole lines only, nothing to gain
+	{
+		obdDumpBuffer(pOBD, NULL);
+		memcpy(pShadow, pOBD->ucScreen, pOBD->width * (pOBD->height >> 3));
+		return;
+	}
+	iLines = pOBD->height >> 3;
+	for (y = 0; y < iLines; y++)
+	{
+		pSrc = &pOBD->ucScreen[y * pOBD->width];
+		pDst = &pShadow[y * pOBD->width];
+		x = 0;
+		while (x < pOBD->width)
+		{
+			if (pSrc[x] == pDst[x])
+			{
+				x++;
+				continue;
+			}
+			iStart = x;
+			iEnd = x + 1;
+			for (x = iEnd; x < pOBD->width && x - iEnd < OBD_DIFF_MERGE_GAP; x++)
+			{
+				if (pSrc[x] != pDst[x])
+					iEnd = x + 1;
+			}
+			obdSetPosition(pOBD, iStart, y, 1);
+			obdCachedWrite(pOBD, &pSrc[iStart], iEnd - iStart, 1);
+			memcpy(&pDst[iStart], &pSrc[iStart], iEnd - iStart);
+			x = iEnd;
+		} // while x
+	} // for y
+	obdCachedFlush(pOBD, 1);
+} /* obdDumpBufferDiff() */
+
+void obdDumpBufferDiffAsync(OBDISP *pOBD, uint8_t *pShadow, void (*pfnDone)(void *pUser, int bError), void *pUser)
+{
+	if (pOBD->com_mode != COM_I2C)
+	{
+		obdDumpBufferDiff(pOBD, pShadow);
+		if (pfnDone)
+			(*pfnDone)(pUser, 0);
+		return;
+	}
+	pOBD->bAsync = 1;
+	obdDumpBufferDiff(pOBD, pShadow);
+	pOBD->bAsync = 0;
+	I2CWriteStart(&pOBD->bbi2c, pfnDone, pUser);
+} /* obdDumpBufferDiffAsync() */
+
+int obdBusy(OBDISP *pOBD)
+{
+	if (pOBD->com_mode != COM_I2C)
+		return 0;
+	return I2CAsyncBusy(&pOBD->bbi2c);
+} /* obdBusy() */
 
 // A valid CW or CCW move returns 1 or -1, invalid returns 0.
 static int obdMenuReadRotary(SIMPLEMENU *sm)
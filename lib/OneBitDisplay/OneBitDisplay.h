@@ -38,6 +38,7 @@ uint8_t mode; // data/command mode for 9-bit SPI
 uint8_t iDCPin, iMOSIPin, iCLKPin, iCSPin;
 uint8_t iLEDPin; // backlight
 uint8_t bBitBang;
+uint8_t bAsync; // I2C writes are queued for DMA instead of sent right away
 } OBDISP;
 
 typedef char * (*SIMPLECALLBACK)(int iMenuItem);
@@ -288,6 +289,26 @@ int obdSetPixel(OBDISP *pOBD, int x, int y, unsigned char ucColor, int bRender);
 //
 void obdDumpBuffer(OBDISP *pOBD, uint8_t *pBuffer);
 //
+// Send only what changed since the last call, pShadow holds a copy of the display
+// contents and must start out matching it (e.g. zeroed after obdFill(pOBD, 0, 1))
+//
+void obdDumpBufferDiff(OBDISP *pOBD, uint8_t *pShadow);
+//
+// Same as obdDumpBufferDiff() but returns as soon as the writes are handed to DMA
+// pfnDone is called with bError set if the display NACKed part of the update,
+// in which case pShadow no longer matches the display
+// SPI displays and boards without a free DMA channel send synchronously
+//
+void obdDumpBufferDiffAsync(OBDISP *pOBD, uint8_t *pShadow, void (*pfnDone)(void *pUser, int bError), void *pUser);
+//
+// Returns 1 while an asynchronous update is still going out
+//
+int obdBusy(OBDISP *pOBD);
+// Unchanged bytes worth resending rather than repositioning (a 4 byte command write)
+#ifndef OBD_DIFF_MERGE_GAP
+#define OBD_DIFF_MERGE_GAP 4
+#endif
+//
 // Render a window of pixels from a provided buffer or the library's internal buffer
 // to the display. The row values refer to byte rows, not pixel rows due to the memory
 // layout of OLEDs. Pass a src pointer of NULL to use the internal backing buffer
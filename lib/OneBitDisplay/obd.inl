@@ -601,6 +601,10 @@ static void _I2CWrite(OBDISP *pOBD, unsigned char *pData, int iLen)
 		if (pOBD->type < SHARP_144x168)
 			gpio_put(pOBD->iCSPin, HIGH);
 	}
+	else if (pOBD->bAsync) // DMA has no length limit, queue it whole
+	{
+		I2CWriteQueue(&pOBD->bbi2c, pOBD->oled_addr, pData, iLen);
+	}
 	else // must be I2C
 	{
 		if (pOBD->bbi2c.bWire && iLen > 32) // Hardware I2C has write length limits
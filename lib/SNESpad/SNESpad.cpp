@@ -31,6 +31,7 @@
 #else
     #include <cstring>
     #include <cstdio>
+    #include "generated/snespad.pio.h"
 #endif
 
 SNESpad::SNESpad(int clock, int latch, int data) {
@@ -46,6 +47,37 @@ void SNESpad::begin() {
 #endif
 }
 
+#ifndef ARDUINO
+bool SNESpad::beginPIO() {
+    // pio0 drives the LEDs, pio1 is otherwise only used by the keyboard host's PIO-USB
+    PIO candidate = pio1;
+    if (!pio_can_add_program(candidate, &snespad_program)) return false;
+
+    int sm = pio_claim_unused_sm(candidate, false);
+    if (sm < 0) return false;
+
+    pio = candidate;
+    pioSM = sm;
+    pioBusy = false;
+    snespad_program_init(pio, pioSM, pio_add_program(pio, &snespad_program), latchPin, clockPin, dataPin);
+
+#if SNES_PAD_DEBUG==true
+    printf("SNESpad::beginPIO sm %d\n", pioSM);
+#endif
+    return true;
+}
+
+// start a read on the state machine, the result is collected by a later poll
+void SNESpad::requestPIO() {
+    /* A connected device will pull the data line low prior to latch.
+       A disconnected pin is kept high by internal pull_up.*/
+    pioDisconnected = gpio_get(dataPin);
+    pioLatchTime = time_us_32();
+    pio_sm_put(pio, pioSM, speedStep() ? 1 : 0);
+    pioBusy = true;
+}
+#endif
+
 void SNESpad::start() {
     uint32_t packet;
 
@@ -55,6 +87,14 @@ void SNESpad::start() {
 
     type = SNES_PAD_NONE;
 
+#ifndef ARDUINO
+    // the device type is detected by the next poll
+    if (pioSM >= 0) {
+        if (!pioBusy) requestPIO();
+        return;
+    }
+#endif
+
     packet = read();
 
 #if SNES_PAD_DEBUG==true
@@ -65,23 +105,7 @@ void SNESpad::start() {
 #if SNES_PAD_DEBUG==true
         printf("Device Type: %d\n", type);
 #endif
-        mouseX          = 0;
-        mouseY          = 0;
-
-        buttonA         = 0;
-        buttonB         = 0;
-        buttonX         = 0;
-        buttonY         = 0;
-        buttonStart     = 0;
-        buttonSelect    = 0;
-        buttonL         = 0;
-        buttonR         = 0;
-
-        directionUp     = 0;
-        directionDown   = 0;
-        directionLeft   = 0;
-        directionRight  = 0;
-
+        clear();
     } else {
 #if SNES_PAD_DEBUG==true
         printf("Unknown Device: %02x\n", packet);
@@ -89,79 +113,33 @@ void SNESpad::start() {
     }
 }
 
-void SNESpad::poll() {
-    int32_t state = 0;
+bool SNESpad::poll() {
+    uint32_t state = 0;
 
 #if SNES_PAD_DEBUG==true
     //printf("SNESpad::poll\n");
 #endif
 
+#ifndef ARDUINO
+    if (pioSM >= 0) {
+        const int8_t lastType = type;
+        if (!readState(state)) return false;
+
+        if (lastType != SNES_PAD_NONE && state) {
+            update(state);
+        } else if (type != SNES_PAD_NONE) {
+            // newly connected
+            clear();
+        }
+        return true;
+    }
+#endif
+
     if (type != SNES_PAD_NONE) {
         state = read(); // polls current controller state
 
         if (state) {
-            switch (type) {
-                case SNES_PAD_BASIC:
-                    directionLeft =  (state & SNES_LEFT);
-                    directionUp =    (state & SNES_UP);
-                    directionRight = (state & SNES_RIGHT);
-                    directionDown =  (state & SNES_DOWN);
-
-                    buttonSelect =   (state & SNES_SELECT);
-                    buttonStart =    (state & SNES_START);
-                    buttonB =        (state & SNES_B);
-                    buttonY =        (state & SNES_Y);
-                    buttonA =        (state & SNES_A);
-                    buttonX =        (state & SNES_X);
-                    buttonL =        (state & SNES_L);
-                    buttonR =        (state & SNES_R);
-
-                    break;
-                case SNES_PAD_NES:
-                    directionLeft =  (state & SNES_LEFT);
-                    directionUp =    (state & SNES_UP);
-                    directionRight = (state & SNES_RIGHT);
-                    directionDown =  (state & SNES_DOWN);
-
-                    buttonSelect =   (state & SNES_SELECT);
-                    buttonStart =    (state & SNES_START);
-                    buttonB =        (state & SNES_Y);
-                    buttonA =        (state & SNES_B);
-
-                    break;
-                case SNES_PAD_MOUSE:
-                    int x = 127;  //set center position [0-255]
-                    int y = 127;
-
-                    // Mouse X axis
-                    x = (state & SNES_MOUSE_X) >> 25;
-                    x = reverse(x) * SNES_MOUSE_PRECISION;
-                    if (state & SNES_MOUSE_X_SIGN) x = 127 - x;
-                    else x = 127 + x;
-
-                    // Mouse Y axis
-                    y = (state & SNES_MOUSE_Y) >> 17;
-                    y = reverse(y) * SNES_MOUSE_PRECISION;
-                    if (state & SNES_MOUSE_Y_SIGN) y = 127 - y;
-                    else y = 127 + y;
-
-                    mouseX  = x;
-                    mouseY  = y;
-                    buttonB = (state & SNES_X);
-                    buttonA = (state & SNES_A);
-
-                    break;
-            }
-
-#if SNES_PAD_DEBUG==true
-            if (_lastRead != state) {
-                printf(
-                    "A=%1d B=%1d X=%1d Y=%1d L=%1d R=%1d Select=%1d Start=%1d Mouse X=%4d Y=%4d\n",
-                    buttonA, buttonB, buttonX, buttonY, buttonL, buttonR, buttonSelect, buttonStart, mouseX, mouseY
-                );
-            }
-            _lastRead = state;
-#endif
+            update(state);
         } else {
             // device disconnected or invalid read
             type = SNES_PAD_NONE;
@@ -170,6 +148,111 @@ void SNESpad::poll() {
     } else {
         start();
     }
+    return true;
+}
+
+// collect a finished read from the state machine and start the next one
+bool SNESpad::readState(uint32_t& state) {
+#ifndef ARDUINO
+    if (pio_sm_is_rx_fifo_empty(pio, pioSM)) {
+        if (!pioBusy) requestPIO();
+        return false;
+    }
+
+    const uint32_t raw = pio_sm_get(pio, pioSM);
+    const bool disconnected = pioDisconnected;
+    sampleTime = pioLatchTime;
+    pioBusy = false;
+
+    state = decode(raw, disconnected);
+    requestPIO();
+#endif
+    return true;
+}
+
+void SNESpad::update(uint32_t state) {
+    switch (type) {
+        case SNES_PAD_BASIC:
+            directionLeft =  (state & SNES_LEFT);
+            directionUp =    (state & SNES_UP);
+            directionRight = (state & SNES_RIGHT);
+            directionDown =  (state & SNES_DOWN);
+
+            buttonSelect =   (state & SNES_SELECT);
+            buttonStart =    (state & SNES_START);
+            buttonB =        (state & SNES_B);
+            buttonY =        (state & SNES_Y);
+            buttonA =        (state & SNES_A);
+            buttonX =        (state & SNES_X);
+            buttonL =        (state & SNES_L);
+            buttonR =        (state & SNES_R);
+
+            break;
+        case SNES_PAD_NES:
+            directionLeft =  (state & SNES_LEFT);
+            directionUp =    (state & SNES_UP);
+            directionRight = (state & SNES_RIGHT);
+            directionDown =  (state & SNES_DOWN);
+
+            buttonSelect =   (state & SNES_SELECT);
+            buttonStart =    (state & SNES_START);
+            buttonB =        (state & SNES_Y);
+            buttonA =        (state & SNES_B);
+
+            break;
+        case SNES_PAD_MOUSE:
+            int x = 127;  //set center position [0-255]
+            int y = 127;
+
+            // Mouse X axis
+            x = (state & SNES_MOUSE_X) >> 25;
+            x = reverse(x) * SNES_MOUSE_PRECISION;
+            if (state & SNES_MOUSE_X_SIGN) x = 127 - x;
+            else x = 127 + x;
+
+            // Mouse Y axis
+            y = (state & SNES_MOUSE_Y) >> 17;
+            y = reverse(y) * SNES_MOUSE_PRECISION;
+            if (state & SNES_MOUSE_Y_SIGN) y = 127 - y;
+            else y = 127 + y;
+
+            mouseX  = x;
+            mouseY  = y;
+            buttonB = (state & SNES_X);
+            buttonA = (state & SNES_A);
+
+            break;
+    }
+
+#if SNES_PAD_DEBUG==true
+    if (_lastRead != state) {
+        printf(
+            "A=%1d B=%1d X=%1d Y=%1d L=%1d R=%1d Select=%1d Start=%1d Mouse X=%4d Y=%4d\n",
+            buttonA, buttonB, buttonX, buttonY, buttonL, buttonR, buttonSelect, buttonStart, mouseX, mouseY
+        );
+    }
+    _lastRead = state;
+#endif
+}
+
+// reset to default input values in the event of a removal/hotswap
+void SNESpad::clear() {
+    mouseX          = 0;
+    mouseY          = 0;
+
+    buttonA         = 0;
+    buttonB         = 0;
+    buttonX         = 0;
+    buttonY         = 0;
+    buttonStart     = 0;
+    buttonSelect    = 0;
+    buttonL         = 0;
+    buttonR         = 0;
+
+    directionUp     = 0;
+    directionDown   = 0;
+    directionLeft   = 0;
+    directionRight  = 0;
 }
 
 // init gpio pins
@@ -196,14 +279,18 @@ void SNESpad::init() {
     return;
 }
 
+// default mouse to fastest speed
+bool SNESpad::speedStep()
+{
+    return type == SNES_PAD_MOUSE
+        && mouseSpeed != SNES_MOUSE_FAST
+        && mouseSpeedFails < SNES_MOUSE_THRESHOLD;
+}
+
 // signal mouse to go to next speed if not at desired speed
 void SNESpad::speed()
 {
-    // default mouse to fastest speed
-    if (type == SNES_PAD_MOUSE
-        && mouseSpeed != SNES_MOUSE_FAST
-        && mouseSpeedFails < SNES_MOUSE_THRESHOLD
-    ) {
+    if (speedStep()) {
 #ifdef ARDUINO
         digitalWrite(clockPin,LOW);
         delayMicroseconds(6);
@@ -296,6 +383,15 @@ uint32_t SNESpad::read()
 #endif
         }
     }
+#ifndef ARDUINO
+    sampleTime = time_us_32();
+#endif
+
+    return decode(ret, disconnected);
+}
+
+uint32_t SNESpad::decode(uint32_t ret, bool disconnected)
+{
     ret = ~ret; // buttons are active low, so invert bits
 
     // verify controller or mouse is connected
@@ -34,6 +34,7 @@
 #else
     // If we aren't compiling on Arduino, include the Pico SDK standard library
     #include "pico/stdlib.h"
+    #include "hardware/pio.h"
 #endif
 
 #define SNES_PAD_NONE   -1
@@ -97,13 +98,22 @@ class SNESpad {
     bool directionLeft   = false;
     bool directionRight  = false;
 
+    // time_us_32() when the current state was latched by the controller
+    uint32_t sampleTime  = 0;
+
     // Constructor 
     SNESpad(int clock, int latch, int data);
 
     // Methods
     void begin();
+#ifndef ARDUINO
+    // Hands latching and clocking to a PIO state machine, poll() then never waits. Returns false if no
+    // state machine or program space is free, polling then stays bit-banged.
+    bool beginPIO();
+#endif
     void start();
-    void poll();
+    // Returns true when a new state was read, with PIO it only collects a finished read and starts the next
+    bool poll();
   private:
   
     uint8_t latchPin; // output: latch
@@ -113,10 +123,25 @@ class SNESpad {
     uint8_t mouseSpeedFails = 0;
     uint32_t _lastRead;
 
+#ifndef ARDUINO
+    PIO pio = nullptr;
+    int pioSM = -1;
+    bool pioBusy = false;
+    bool pioDisconnected = false; // Data line level before the running read latched
+    uint32_t pioLatchTime = 0;
+
+    void requestPIO();
+#endif
+
     void init();
+    bool speedStep();
     void speed();
     void latch();
+    bool readState(uint32_t& state);
     uint32_t read();
+    uint32_t decode(uint32_t ret, bool disconnected);
+    void update(uint32_t state);
+    void clear();
     uint32_t clock();
     uint8_t reverse(uint8_t c);
 };
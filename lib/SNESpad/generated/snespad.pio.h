@@ -0,0 +1,71 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ------- //
+// snespad //
+// ------- //
+
+#define snespad_wrap_target 0
+#define snespad_wrap 13
+
+static const uint16_t snespad_program_instructions[] = {
+            //     .wrap_target
+    0x80a0, //  0: pull   block                      
+    0xa027, //  1: mov    x, osr                     
+    0xe501, //  2: set    pins, 1                [5] 
+    0x0026, //  3: jmp    !x, 6                      
+    0xb242, //  4: nop                    side 0 [2] 
+    0xbd42, //  5: nop                    side 1 [5] 
+    0xe200, //  6: set    pins, 0                [2] 
+    0xe041, //  7: set    y, 1                       
+    0xe02f, //  8: set    x, 15                      
+    0xb142, //  9: nop                    side 0 [1] 
+    0x4001, // 10: in     pins, 1                    
+    0xb942, // 11: nop                    side 1 [1] 
+    0x0049, // 12: jmp    x--, 9                     
+    0x008e, // 13: jmp    y--, 14                    
+            //     .wrap
+    0xa542, // 14: nop                           [5] 
+    0x0008, // 15: jmp    8                          
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program snespad_program = {
+    .instructions = snespad_program_instructions,
+    .length = 16,
+    .origin = -1,
+};
+
+static inline pio_sm_config snespad_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + snespad_wrap_target, offset + snespad_wrap);
+    sm_config_set_sideset(&c, 2, true, false);
+    return c;
+}
+
+#include "hardware/clocks.h"
+static inline void snespad_program_init(PIO pio, uint sm, uint offset, uint latchPin, uint clockPin, uint dataPin) {
+    const uint32_t outputMask = (1u << latchPin) | (1u << clockPin);
+    // Latch idles low and clock high, the data pin keeps its pull-up and is only read
+    pio_sm_set_pins_with_mask(pio, sm, 1u << clockPin, outputMask);
+    pio_sm_set_pindirs_with_mask(pio, sm, outputMask, outputMask | (1u << dataPin));
+    pio_gpio_init(pio, latchPin);
+    pio_gpio_init(pio, clockPin);
+    pio_sm_config c = snespad_program_get_default_config(offset);
+    sm_config_set_set_pins(&c, latchPin, 1);
+    sm_config_set_sideset_pins(&c, clockPin);
+    sm_config_set_in_pins(&c, dataPin);
+    sm_config_set_in_shift(&c, true, true, 32);
+    sm_config_set_clkdiv(&c, clock_get_hz(clk_sys) / 500000.0f);
+    pio_sm_init(pio, sm, offset, &c);
+    pio_sm_set_enabled(pio, sm, true);
+}
+
+#endif
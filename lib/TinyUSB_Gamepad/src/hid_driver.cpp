@@ -16,10 +16,21 @@
 // Magic byte sequence to enable PS button on PS3
 static const uint8_t magic_init_bytes[8] = {0x21, 0x26, 0x01, 0x07, 0x00, 0x00, 0x00, 0x00};
 
+static uint8_t endpoint_in = 0;
+
 bool send_hid_report(uint8_t report_id, void *report, uint8_t report_size)
 {
-	if (tud_hid_ready())
-		return tud_hid_report(report_id, report, report_size);
+	if (report_id != 0)
+	{
+		if (tud_hid_ready())
+			return tud_hid_report(report_id, report, report_size);
+
+		return false;
+	}
+
+	// Without a report ID the buffer goes out as is, tud_hid_report() would copy it first
+	if (tud_ready() && endpoint_in != 0 && usbd_edpt_claim(TUD_OPT_RHPORT, endpoint_in))
+		return usbd_edpt_xfer(TUD_OPT_RHPORT, endpoint_in, (uint8_t *)report, report_size);
 
 	return false;
 }
@@ -54,13 +65,35 @@ bool hid_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t c
 	}
 }
 
+uint16_t hid_open(uint8_t rhport, tusb_desc_interface_t const *itf_descriptor, uint16_t max_length)
+{
+	uint16_t driver_length = hidd_open(rhport, itf_descriptor, max_length);
+
+	// Remember the IN endpoint for send_hid_report()
+	uint8_t const *current_descriptor = (uint8_t const *)itf_descriptor;
+	uint8_t const *end_descriptor = current_descriptor + driver_length;
+	while (current_descriptor < end_descriptor)
+	{
+		tusb_desc_endpoint_t const *endpoint_descriptor = (tusb_desc_endpoint_t const *)current_descriptor;
+		if (TUSB_DESC_ENDPOINT == tu_desc_type(endpoint_descriptor) &&
+			tu_edpt_dir(endpoint_descriptor->bEndpointAddress) == TUSB_DIR_IN)
+		{
+			endpoint_in = endpoint_descriptor->bEndpointAddress;
+		}
+
+		current_descriptor = tu_desc_next(current_descriptor);
+	}
+
+	return driver_length;
+}
+
 const usbd_class_driver_t hid_driver = {
 #if CFG_TUSB_DEBUG >= 2
 	.name = "HID",
 #endif
 	.init = hidd_init,
 	.reset = hidd_reset,
-	.open = hidd_open,
+	.open = hid_open,
 	.control_xfer_cb = hid_control_xfer_cb,
 	.xfer_cb = hidd_xfer_cb,
-	.sof = NULL};
\ No newline at end of file
+	.sof = usb_sof_cb};
\ No newline at end of file
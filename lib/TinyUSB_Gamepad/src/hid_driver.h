@@ -13,3 +13,4 @@ extern const usbd_class_driver_t hid_driver;
 
 bool send_hid_report(uint8_t report_id, void *report, uint8_t report_size);
 bool send_keyboard_report(void *report);
+uint16_t hid_open(uint8_t rhport, tusb_desc_interface_t const *itf_descriptor, uint16_t max_length);
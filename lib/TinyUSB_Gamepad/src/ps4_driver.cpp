@@ -4,6 +4,8 @@
  */
 
 #include "ps4_driver.h"
+#include "hid_driver.h"
+#include "usb_driver.h"
 
 #include "CRC32.h"
 
@@ -211,7 +213,7 @@ const usbd_class_driver_t ps4_driver =
 #endif
 		.init = hidd_init,
 		.reset = hidd_reset,
-		.open = hidd_open,
+		.open = hid_open,
 		.control_xfer_cb = hidd_control_xfer_cb,
 		.xfer_cb = hidd_xfer_cb,
-		.sof = NULL};
+		.sof = usb_sof_cb};
@@ -12,6 +12,9 @@
 
 #include "gamepad/GamepadDescriptors.h"
 
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
 #include "usb_driver.h"
 #include "net_driver.h"
 #include "hid_driver.h"
@@ -22,6 +25,19 @@ UsbMode usb_mode = USB_MODE_HID;
 InputMode input_mode = INPUT_MODE_XINPUT;
 bool usb_mounted = false;
 
+// Full speed frames are 1ms, the measured period tracks host clock drift
+#define USB_SOF_FRAME_US 1000
+#define USB_SOF_FRAME_SHIFT 4 // Period is kept in 1/16us
+#define USB_SOF_STALE_FRAMES 3
+
+// Reports are encoded straight into these, one is free while the other may be in flight
+CFG_TUSB_MEM_SECTION CFG_TUSB_MEM_ALIGN static uint8_t report_buffers[2][CFG_TUD_ENDPOINT0_SIZE] = { };
+static uint8_t report_buffer_index = 0;
+
+static bool sof_tracking = false;
+static volatile uint64_t sof_last_us = 0;
+static volatile uint32_t sof_frame_us_q4 = USB_SOF_FRAME_US << USB_SOF_FRAME_SHIFT;
+
 InputMode get_input_mode(void)
 {
 	return input_mode;
@@ -50,33 +66,82 @@ void receive_report(uint8_t *buffer)
 	}
 }
 
-void send_report(void *report, uint16_t report_size)
+void init_report_buffers(const void *report_template, uint16_t report_size)
 {
-	static uint8_t previous_report[CFG_TUD_ENDPOINT0_SIZE] = { };
+	memcpy(report_buffers[0], report_template, report_size);
+	memcpy(report_buffers[1], report_template, report_size);
+	report_buffer_index = 0;
+}
 
+void *get_report_buffer(void)
+{
+	return report_buffers[report_buffer_index];
+}
+
+bool send_report(uint16_t report_size)
+{
 	if (tud_suspended())
 		tud_remote_wakeup();
 
-	if (memcmp(previous_report, report, report_size) != 0)
+	void *report = report_buffers[report_buffer_index];
+	bool sent = false;
+	switch (input_mode)
 	{
-		bool sent = false;
-		switch (input_mode)
-		{
-			case INPUT_MODE_XINPUT:
-				sent = send_xinput_report(report, report_size);
-				break;
-			case INPUT_MODE_KEYBOARD:
-				sent = send_keyboard_report(report);
-				break;
+		case INPUT_MODE_XINPUT:
+			sent = send_xinput_report(report, report_size);
+			break;
+		case INPUT_MODE_KEYBOARD:
+			sent = send_keyboard_report(report);
+			break;
 
-			default:
-				sent = send_hid_report(0, report, report_size);
-				break;
-		}
+		default:
+			sent = send_hid_report(0, report, report_size);
+			break;
+	}
+
+	// The endpoint may still be reading the sent buffer, encode the next report into the other one
+	if (sent)
+		report_buffer_index ^= 1;
+
+	return sent;
+}
+
+void set_usb_sof_tracking(bool enabled)
+{
+	sof_tracking = enabled;
+	usbd_sof_enable(TUD_OPT_RHPORT, enabled);
+}
 
-		if (sent)
-			memcpy(previous_report, report, report_size);
+bool get_usb_sof(uint64_t *sof_us, uint32_t *frame_us)
+{
+	// The SOF interrupt runs on this core, mask it while reading the pair
+	uint32_t irq_state = save_and_disable_interrupts();
+	uint64_t last_us = sof_last_us;
+	uint32_t period_q4 = sof_frame_us_q4;
+	restore_interrupts(irq_state);
+
+	*sof_us = last_us;
+	*frame_us = period_q4 >> USB_SOF_FRAME_SHIFT;
+
+	// No SOF while unmounted or suspended
+	return last_us != 0 && time_us_64() - last_us < USB_SOF_STALE_FRAMES * USB_SOF_FRAME_US;
+}
+
+// Class driver SOF hook, TinyUSB calls this from the USB interrupt
+void usb_sof_cb(uint8_t rhport, uint32_t frame_count)
+{
+	(void)rhport;
+	(void)frame_count;
+
+	uint64_t now = time_us_64();
+	uint64_t delta = now - sof_last_us;
+	if (delta > USB_SOF_FRAME_US / 2 && delta < USB_SOF_FRAME_US * 3 / 2)
+	{
+		// Exponential average over 16 frames, in 1/16us
+		int32_t error = static_cast<int32_t>(delta << USB_SOF_FRAME_SHIFT) - static_cast<int32_t>(sof_frame_us_q4);
+		sof_frame_us_q4 += error / 16;
 	}
+	sof_last_us = now;
 }
 
 /* USB Driver Callback (Required for XInput) */
@@ -174,6 +239,10 @@ void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t rep
 void tud_mount_cb(void)
 {
 	usb_mounted = true;
+
+	// Bus resets drop the SOF interrupt
+	if (sof_tracking)
+		usbd_sof_enable(TUD_OPT_RHPORT, true);
 }
 
 // Invoked when device is unmounted
@@ -18,5 +18,12 @@ InputMode get_input_mode(void);
 bool get_usb_mounted(void);
 void initialize_driver(InputMode mode);
 void receive_report(uint8_t *buffer);
-void send_report(void *report, uint16_t report_size);
+void init_report_buffers(const void *report_template, uint16_t report_size);
+void *get_report_buffer(void);
+bool send_report(uint16_t report_size);
+
+// Start-of-frame tracking, timestamps are taken in the SOF interrupt
+void set_usb_sof_tracking(bool enabled);
+bool get_usb_sof(uint64_t *sof_us, uint32_t *frame_us);
+void usb_sof_cb(uint8_t rhport, uint32_t frame_count);
 
@@ -3,6 +3,8 @@
 #include <cstring>
 #include <cstdio>
 
+#include "hardware/sync.h"
+
 WiiExtension::WiiExtension(int sda, int scl, i2c_inst_t *i2cCtl, int32_t speed, uint8_t addr) {
     iSDA = sda;
     iSCL = scl;
@@ -21,6 +23,11 @@ void WiiExtension::begin() {
     reset();
 }
 
+void WiiExtension::beginAsync() {
+    asyncEnabled = true;
+    begin();
+}
+
 void WiiExtension::start(){
     uint8_t idRead[32];
     uint8_t regWrite[16];
@@ -319,352 +326,375 @@ void WiiExtension::reset(){
     }
 }
 
-void WiiExtension::poll() {
-    uint8_t reg = _u(0x08);
+bool WiiExtension::poll() {
     uint8_t regWrite[16];
     uint8_t regRead[16];
-    int8_t result;
+    int result;
 
 #if WII_EXTENSION_DEBUG==true
     //printf("WiiExtension::poll\n");
     //printf("WiiExtension::poll isReady? %1d\n", isReady);
 #endif
 
-    if (!isReady) return;
+    if (!isReady) return false;
 
     if (extensionType != WII_EXTENSION_NONE) {
-        switch (dataType) {
-            case WII_DATA_TYPE_1:
-                result = doI2CRead(regRead, 6);
-                break;
-            case WII_DATA_TYPE_2:
-                result = doI2CRead(regRead, 9);
-                break;
-            case WII_DATA_TYPE_3:
-                result = doI2CRead(regRead, 8);
-                break;
-            default:
-                // unknown. TBD
-                result = -1;
-#if WII_EXTENSION_DEBUG==true
-                printf("WiiExtension::poll Unknown data type: %1d\n", dataType);
-#endif
-                break;
+        if (!asyncEnabled) {
+            result = reportLength();
+            if (result > 0) {
+                result = doI2CRead(regRead, result);
+                sampleTime = time_us_32();
+            }
+        } else if (asyncFailed) {
+            result = -1;
+        } else if (asyncAlarm == 0) {
+            startAsync();
+            return false;
+        } else {
+            result = takeAsyncReport(regRead);
+            if (result == 0) return false;
         }
 
         if (result > 0) {
-            switch (extensionType) {
-                case WII_EXTENSION_NUNCHUCK:
-                    joy1X = (regRead[0] & 0xFF);
-                    joy1Y = (regRead[1] & 0xFF);
+            decode(regRead, result);
 
-                    accelX = (((regRead[2] << 2) | ((regRead[5] >> 2) & 0x03)));
-                    accelY = (((regRead[3] << 2) | ((regRead[5] >> 4) & 0x03)));
-                    accelZ = (((regRead[4] << 2) | ((regRead[5] >> 6) & 0x03)));
-                    buttonZ  = (!(regRead[5] & 0x01));
-                    buttonC  = (!(regRead[5] & 0x02));
+            if (!asyncEnabled) {
+                // continue poll
+                regWrite[0] = 0x00;
+                doI2CWrite(regWrite, 1);
+            }
+            return true;
+        } else {
+            // device disconnected or invalid read
+            extensionType = WII_EXTENSION_NONE;
+            stopAsync();
+            reset();
+            start();
+        }
+    } else {
+        reset();
+        start();
+    }
+    return false;
+}
 
+int WiiExtension::reportLength() {
+    switch (dataType) {
+        case WII_DATA_TYPE_1:
+            return 6;
+        case WII_DATA_TYPE_2:
+            return 9;
+        case WII_DATA_TYPE_3:
+            return 8;
+        default:
+            // unknown. TBD
 #if WII_EXTENSION_DEBUG==true
-                printf("Joy X=%4d Y=%4d   Acc X=%4d Y=%4d Z=%4d   Btn Z=%1d C=%1d\n", joy1X, joy1Y, accelX, accelY, accelZ, buttonZ, buttonC);
+            printf("WiiExtension::poll Unknown data type: %1d\n", dataType);
 #endif
+            return -1;
+    }
+}
 
-                    break;
-                case WII_EXTENSION_CLASSIC:
-                case WII_EXTENSION_CLASSIC_PRO:
-                    // write data format to return
-                    // see wiki for data types
-                    if (dataType == WII_DATA_TYPE_1) {
-                        joy1X =          (regRead[0] & 0x3F);
-                        joy1Y =          (regRead[1] & 0x3F);
-                        joy2X =          ((regRead[0] & 0xC0) >> 3) | ((regRead[1] & 0xC0) >> 5) | ((regRead[2] & 0x80) >> 7);
-                        joy2Y =          (regRead[2] & 0x1F);
-
-                        triggerLeft =    (((regRead[2] & 0x60) >> 2) | ((regRead[3] & 0xE0) >> 5));
-                        triggerRight =   ((regRead[3] & 0x1F) >> 0);
-
-                        directionRight = !((regRead[4] & 0x80) >> 7);
-                        directionDown =  !((regRead[4] & 0x40) >> 6);
-                        buttonLT =       !((regRead[4] & 0x20) >> 5);
-                        buttonMinus =    !((regRead[4] & 0x10) >> 4);
-                        buttonHome =     !((regRead[4] & 0x08) >> 3);
-                        buttonPlus =     !((regRead[4] & 0x04) >> 2);
-                        buttonRT =       !((regRead[4] & 0x02) >> 1);
-
-                        buttonZL =       !((regRead[5] & 0x80) >> 7);
-                        buttonB =        !((regRead[5] & 0x40) >> 6);
-                        buttonY =        !((regRead[5] & 0x20) >> 5);
-                        buttonA =        !((regRead[5] & 0x10) >> 4);
-                        buttonX =        !((regRead[5] & 0x08) >> 3);
-                        buttonZR =       !((regRead[5] & 0x04) >> 2);
-                        directionLeft =  !((regRead[5] & 0x02) >> 1);
-                        directionUp =    !((regRead[5] & 0x01) >> 0);
-                    } else if (dataType == WII_DATA_TYPE_2) {
-                        joy1X =          ((regRead[0] << 2) | ((regRead[4] & 0x03) >> 0));
-                        joy1Y =          ((regRead[2] << 2) | ((regRead[4] & 0x30) >> 4));
-                        joy2X =          ((regRead[1] << 2) | ((regRead[4] & 0x0C) >> 2));
-                        joy2Y =          ((regRead[3] << 2) | ((regRead[4] & 0xC0) >> 6));
-
-                        triggerLeft =    (regRead[5] & 0xFF);
-                        triggerRight =   (regRead[6] & 0xFF);
-
-                        directionRight = !((regRead[7] & 0x80) >> 7);
-                        directionDown =  !((regRead[7] & 0x40) >> 6);
-                        buttonLT =       !((regRead[7] & 0x20) >> 5);
-                        buttonMinus =    !((regRead[7] & 0x10) >> 4);
-                        buttonHome =     !((regRead[7] & 0x08) >> 3);
-                        buttonPlus =     !((regRead[7] & 0x04) >> 2);
-                        buttonRT =       !((regRead[7] & 0x02) >> 1);
-
-                        buttonZL =       !((regRead[8] & 0x80) >> 7);
-                        buttonB =        !((regRead[8] & 0x40) >> 6);
-                        buttonY =        !((regRead[8] & 0x20) >> 5);
-                        buttonA =        !((regRead[8] & 0x10) >> 4);
-                        buttonX =        !((regRead[8] & 0x08) >> 3);
-                        buttonZR =       !((regRead[8] & 0x04) >> 2);
-                        directionLeft =  !((regRead[8] & 0x02) >> 1);
-                        directionUp =    !((regRead[8] & 0x01) >> 0);
-                    } else if (dataType == WII_DATA_TYPE_3) {
-                        joy1X =          (regRead[0] & 0xFF);
-                        joy1Y =          (regRead[2] & 0xFF);
-                        joy2X =          (regRead[1] & 0xFF);
-                        joy2Y =          (regRead[3] & 0xFF);
-
-                        triggerLeft =    (regRead[4] & 0xFF);
-                        triggerRight =   (regRead[5] & 0xFF);
-
-                        directionRight = !((regRead[6] & 0x80) >> 7);
-                        directionDown =  !((regRead[6] & 0x40) >> 6);
-                        buttonLT =       !((regRead[6] & 0x20) >> 5);
-                        buttonMinus =    !((regRead[6] & 0x10) >> 4);
-                        buttonHome =     !((regRead[6] & 0x08) >> 3);
-                        buttonPlus =     !((regRead[6] & 0x04) >> 2);
-                        buttonRT =       !((regRead[6] & 0x02) >> 1);
-
-                        buttonZL =       !((regRead[7] & 0x80) >> 7);
-                        buttonB =        !((regRead[7] & 0x40) >> 6);
-                        buttonY =        !((regRead[7] & 0x20) >> 5);
-                        buttonA =        !((regRead[7] & 0x10) >> 4);
-                        buttonX =        !((regRead[7] & 0x08) >> 3);
-                        buttonZR =       !((regRead[7] & 0x04) >> 2);
-                        directionLeft =  !((regRead[7] & 0x02) >> 1);
-                        directionUp =    !((regRead[7] & 0x01) >> 0);
-                    } else {
-                        // unknown
-                    }
+void WiiExtension::decode(const uint8_t *regRead, int result) {
+    switch (extensionType) {
+        case WII_EXTENSION_NUNCHUCK:
+            joy1X = (regRead[0] & 0xFF);
+            joy1Y = (regRead[1] & 0xFF);
+
+            accelX = (((regRead[2] << 2) | ((regRead[5] >> 2) & 0x03)));
+            accelY = (((regRead[3] << 2) | ((regRead[5] >> 4) & 0x03)));
+            accelZ = (((regRead[4] << 2) | ((regRead[5] >> 6) & 0x03)));
+            buttonZ  = (!(regRead[5] & 0x01));
+            buttonC  = (!(regRead[5] & 0x02));
 
 #if WII_EXTENSION_DEBUG==true
-                //if ((_lastRead[0] != regRead[0]) || (_lastRead[1] != regRead[1]) || (_lastRead[2] != regRead[2]) || (_lastRead[3] != regRead[3])) {
-                    printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d\n", joy1X, joy1Y, joy2X, joy2Y);
-                //}
-                //printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d  U=%1d D=%1d L=%1d R=%1d TL=%4d TR=%4d\n", joy1X, joy1Y, joy2X, joy2Y, directionUp, directionDown, directionLeft, directionRight, triggerLeft, triggerRight);
-                //printf("A=%1d B=%1d X=%1d Y=%1d ZL=%1d ZR=%1d LT=%1d RT=%1d -=%1d H=%1d +=%1d\n", buttonA, buttonB, buttonX, buttonY, buttonZL, buttonZR, buttonLT, buttonRT, buttonMinus, buttonHome, buttonPlus);
+        printf("Joy X=%4d Y=%4d   Acc X=%4d Y=%4d Z=%4d   Btn Z=%1d C=%1d\n", joy1X, joy1Y, accelX, accelY, accelZ, buttonZ, buttonC);
 #endif
 
-                    break;
-                case WII_EXTENSION_GUITAR:
-                    // on first read, check the status of the guitar flag
-                    if (_guitarType == WII_GUITAR_UNSET) {
-                        if (((regRead[0] & 0x80) >> 7) == 0) {
-                            _guitarType = WII_GUITAR_GHWT;
-                        } else {
-                            _guitarType = WII_GUITAR_GH3;
-                        }
-                        // force the data type to 1 when a World Tour guitar is detected
-                        if ((_guitarType == WII_GUITAR_GHWT) && (dataType != WII_DATA_TYPE_1)) {
-                            dataType = WII_DATA_TYPE_1;
-                            _analogPrecision1From = WII_ANALOG_PRECISION_1;
-                            _analogPrecision1To = WII_ANALOG_PRECISION_3;
-                            _analogPrecision2From = WII_ANALOG_PRECISION_0;
-                            _analogPrecision2To = WII_ANALOG_PRECISION_3;
-                        }
-                    }
-                    if (_guitarType != WII_GUITAR_UNSET) {
-                        // as defined works for GH3 guitar
-                        if (dataType == WII_DATA_TYPE_1) {
-                            joy1X =          (regRead[0] & 0x3F);
-                            joy1Y =          (regRead[1] & 0x3F);
-
-                            touchBar =       ((_guitarType == WII_GUITAR_GHWT) ? (regRead[2] & 0x1F) : 0);
-
-                            whammyBar =      (regRead[3] & 0x1F);
-                            joy2X =          (regRead[3] & 0x1F);
-
-                            directionDown =  !((regRead[4] & 0x40) >> 6);
-                            buttonMinus =    !((regRead[4] & 0x10) >> 4);
-                            buttonPlus =     !((regRead[4] & 0x04) >> 2);
-
-                            fretOrange =     !((regRead[5] & 0x80) >> 7);
-                            fretRed =        !((regRead[5] & 0x40) >> 6);
-                            fretBlue =       !((regRead[5] & 0x20) >> 5);
-                            fretGreen =      !((regRead[5] & 0x10) >> 4);
-                            fretYellow =     !((regRead[5] & 0x08) >> 3);
-                            pedalButton =    !((regRead[5] & 0x04) >> 2);
-                            directionUp =    !((regRead[5] & 0x01) >> 0);
-
-                            isTouched        = (touchBar != WII_GUITAR_TOUCHPAD_NONE);
-
-                            // process the touch bar for button states
-                            // touch only seems to exist in GHWT, and GHWT always reports data type 1 format regardless of setting
-                            if (isTouched) {
-                                // touched
-                                fretGreen     = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_GREEN,WII_GUITAR_TOUCHPAD_RED));
-                                fretRed       = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_RED,WII_GUITAR_TOUCHPAD_YELLOW));
-                                fretYellow    = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_YELLOW,WII_GUITAR_TOUCHPAD_BLUE));
-                                fretBlue      = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_BLUE,WII_GUITAR_TOUCHPAD_ORANGE));
-                                fretOrange    = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_ORANGE,WII_GUITAR_TOUCHPAD_MAX));
-                                directionDown = isTouched;
-                            }
-                        } else if (dataType == WII_DATA_TYPE_2) {
-                            joy1X =          ((regRead[0] << 2) | ((regRead[4] & 0x03) >> 0));
-                            joy1Y =          ((regRead[2] << 2) | ((regRead[4] & 0x30) >> 4));
-
-                            touchBar =       0;
-
-                            whammyBar =      (regRead[6] & 0xFF);
-                            joy2X =          (regRead[6] & 0xFF);
-
-                            directionDown =  !((regRead[7] & 0x40) >> 6);
-                            buttonMinus =    !((regRead[7] & 0x10) >> 4);
-                            buttonPlus =     !((regRead[7] & 0x04) >> 2);
-
-                            fretOrange =     !((regRead[8] & 0x80) >> 7);
-                            fretRed =        !((regRead[8] & 0x40) >> 6);
-                            fretBlue =       !((regRead[8] & 0x20) >> 5);
-                            fretGreen =      !((regRead[8] & 0x10) >> 4);
-                            fretYellow =     !((regRead[8] & 0x08) >> 3);
-                            pedalButton =    !((regRead[8] & 0x04) >> 2);
-                            directionUp =    !((regRead[8] & 0x01) >> 0);
-                        } else if (dataType == WII_DATA_TYPE_3) {
-                            joy1X =          (regRead[0] & 0xFF);
-                            joy1Y =          (regRead[2] & 0xFF);
-
-                            touchBar =       0;
-
-                            whammyBar =      (regRead[5] & 0xFF);
-                            joy2X =          (regRead[5] & 0xFF);
-
-                            directionDown =  !((regRead[6] & 0x40) >> 6);
-                            buttonMinus =    !((regRead[6] & 0x10) >> 4);
-                            buttonPlus =     !((regRead[6] & 0x04) >> 2);
-
-                            fretOrange =     !((regRead[7] & 0x80) >> 7);
-                            fretRed =        !((regRead[7] & 0x40) >> 6);
-                            fretBlue =       !((regRead[7] & 0x20) >> 5);
-                            fretGreen =      !((regRead[7] & 0x10) >> 4);
-                            fretYellow =     !((regRead[7] & 0x08) >> 3);
-                            pedalButton =    !((regRead[7] & 0x04) >> 2);
-                            directionUp =    !((regRead[7] & 0x01) >> 0);
-                        }
+            break;
+        case WII_EXTENSION_CLASSIC:
+        case WII_EXTENSION_CLASSIC_PRO:
+            // write data format to return
+            // see wiki for data types
+            if (dataType == WII_DATA_TYPE_1) {
+                joy1X =          (regRead[0] & 0x3F);
+                joy1Y =          (regRead[1] & 0x3F);
+                joy2X =          ((regRead[0] & 0xC0) >> 3) | ((regRead[1] & 0xC0) >> 5) | ((regRead[2] & 0x80) >> 7);
+                joy2Y =          (regRead[2] & 0x1F);
+
+                triggerLeft =    (((regRead[2] & 0x60) >> 2) | ((regRead[3] & 0xE0) >> 5));
+                triggerRight =   ((regRead[3] & 0x1F) >> 0);
+
+                directionRight = !((regRead[4] & 0x80) >> 7);
+                directionDown =  !((regRead[4] & 0x40) >> 6);
+                buttonLT =       !((regRead[4] & 0x20) >> 5);
+                buttonMinus =    !((regRead[4] & 0x10) >> 4);
+                buttonHome =     !((regRead[4] & 0x08) >> 3);
+                buttonPlus =     !((regRead[4] & 0x04) >> 2);
+                buttonRT =       !((regRead[4] & 0x02) >> 1);
+
+                buttonZL =       !((regRead[5] & 0x80) >> 7);
+                buttonB =        !((regRead[5] & 0x40) >> 6);
+                buttonY =        !((regRead[5] & 0x20) >> 5);
+                buttonA =        !((regRead[5] & 0x10) >> 4);
+                buttonX =        !((regRead[5] & 0x08) >> 3);
+                buttonZR =       !((regRead[5] & 0x04) >> 2);
+                directionLeft =  !((regRead[5] & 0x02) >> 1);
+                directionUp =    !((regRead[5] & 0x01) >> 0);
+            } else if (dataType == WII_DATA_TYPE_2) {
+                joy1X =          ((regRead[0] << 2) | ((regRead[4] & 0x03) >> 0));
+                joy1Y =          ((regRead[2] << 2) | ((regRead[4] & 0x30) >> 4));
+                joy2X =          ((regRead[1] << 2) | ((regRead[4] & 0x0C) >> 2));
+                joy2Y =          ((regRead[3] << 2) | ((regRead[4] & 0xC0) >> 6));
+
+                triggerLeft =    (regRead[5] & 0xFF);
+                triggerRight =   (regRead[6] & 0xFF);
+
+                directionRight = !((regRead[7] & 0x80) >> 7);
+                directionDown =  !((regRead[7] & 0x40) >> 6);
+                buttonLT =       !((regRead[7] & 0x20) >> 5);
+                buttonMinus =    !((regRead[7] & 0x10) >> 4);
+                buttonHome =     !((regRead[7] & 0x08) >> 3);
+                buttonPlus =     !((regRead[7] & 0x04) >> 2);
+                buttonRT =       !((regRead[7] & 0x02) >> 1);
+
+                buttonZL =       !((regRead[8] & 0x80) >> 7);
+                buttonB =        !((regRead[8] & 0x40) >> 6);
+                buttonY =        !((regRead[8] & 0x20) >> 5);
+                buttonA =        !((regRead[8] & 0x10) >> 4);
+                buttonX =        !((regRead[8] & 0x08) >> 3);
+                buttonZR =       !((regRead[8] & 0x04) >> 2);
+                directionLeft =  !((regRead[8] & 0x02) >> 1);
+                directionUp =    !((regRead[8] & 0x01) >> 0);
+            } else if (dataType == WII_DATA_TYPE_3) {
+                joy1X =          (regRead[0] & 0xFF);
+                joy1Y =          (regRead[2] & 0xFF);
+                joy2X =          (regRead[1] & 0xFF);
+                joy2Y =          (regRead[3] & 0xFF);
+
+                triggerLeft =    (regRead[4] & 0xFF);
+                triggerRight =   (regRead[5] & 0xFF);
+
+                directionRight = !((regRead[6] & 0x80) >> 7);
+                directionDown =  !((regRead[6] & 0x40) >> 6);
+                buttonLT =       !((regRead[6] & 0x20) >> 5);
+                buttonMinus =    !((regRead[6] & 0x10) >> 4);
+                buttonHome =     !((regRead[6] & 0x08) >> 3);
+                buttonPlus =     !((regRead[6] & 0x04) >> 2);
+                buttonRT =       !((regRead[6] & 0x02) >> 1);
+
+                buttonZL =       !((regRead[7] & 0x80) >> 7);
+                buttonB =        !((regRead[7] & 0x40) >> 6);
+                buttonY =        !((regRead[7] & 0x20) >> 5);
+                buttonA =        !((regRead[7] & 0x10) >> 4);
+                buttonX =        !((regRead[7] & 0x08) >> 3);
+                buttonZR =       !((regRead[7] & 0x04) >> 2);
+                directionLeft =  !((regRead[7] & 0x02) >> 1);
+                directionUp =    !((regRead[7] & 0x01) >> 0);
+            } else {
+                // unknown
+            }
+
+#if WII_EXTENSION_DEBUG==true
+        //if ((_lastRead[0] != regRead[0]) || (_lastRead[1] != regRead[1]) || (_lastRead[2] != regRead[2]) || (_lastRead[3] != regRead[3])) {
+            printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d\n", joy1X, joy1Y, joy2X, joy2Y);
+        //}
+        //printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d  U=%1d D=%1d L=%1d R=%1d TL=%4d TR=%4d\n", joy1X, joy1Y, joy2X, joy2Y, directionUp, directionDown, directionLeft, directionRight, triggerLeft, triggerRight);
+        //printf("A=%1d B=%1d X=%1d Y=%1d ZL=%1d ZR=%1d LT=%1d RT=%1d -=%1d H=%1d +=%1d\n", buttonA, buttonB, buttonX, buttonY, buttonZL, buttonZR, buttonLT, buttonRT, buttonMinus, buttonHome, buttonPlus);
+#endif
+
+            break;
+        case WII_EXTENSION_GUITAR:
+            // on first read, check the status of the guitar flag
+            if (_guitarType == WII_GUITAR_UNSET) {
+                if (((regRead[0] & 0x80) >> 7) == 0) {
+                    _guitarType = WII_GUITAR_GHWT;
+                } else {
+                    _guitarType = WII_GUITAR_GH3;
+                }
+                // force the data type to 1 when a World Tour guitar is detected
+                if ((_guitarType == WII_GUITAR_GHWT) && (dataType != WII_DATA_TYPE_1)) {
+                    dataType = WII_DATA_TYPE_1;
+                    _analogPrecision1From = WII_ANALOG_PRECISION_1;
+                    _analogPrecision1To = WII_ANALOG_PRECISION_3;
+                    _analogPrecision2From = WII_ANALOG_PRECISION_0;
+                    _analogPrecision2To = WII_ANALOG_PRECISION_3;
+                }
+            }
+            if (_guitarType != WII_GUITAR_UNSET) {
+                // as defined works for GH3 guitar
+                if (dataType == WII_DATA_TYPE_1) {
+                    joy1X =          (regRead[0] & 0x3F);
+                    joy1Y =          (regRead[1] & 0x3F);
+
+                    touchBar =       ((_guitarType == WII_GUITAR_GHWT) ? (regRead[2] & 0x1F) : 0);
+
+                    whammyBar =      (regRead[3] & 0x1F);
+                    joy2X =          (regRead[3] & 0x1F);
+
+                    directionDown =  !((regRead[4] & 0x40) >> 6);
+                    buttonMinus =    !((regRead[4] & 0x10) >> 4);
+                    buttonPlus =     !((regRead[4] & 0x04) >> 2);
+
+                    fretOrange =     !((regRead[5] & 0x80) >> 7);
+                    fretRed =        !((regRead[5] & 0x40) >> 6);
+                    fretBlue =       !((regRead[5] & 0x20) >> 5);
+                    fretGreen =      !((regRead[5] & 0x10) >> 4);
+                    fretYellow =     !((regRead[5] & 0x08) >> 3);
+                    pedalButton =    !((regRead[5] & 0x04) >> 2);
+                    directionUp =    !((regRead[5] & 0x01) >> 0);
+
+                    isTouched        = (touchBar != WII_GUITAR_TOUCHPAD_NONE);
+
+                    // process the touch bar for button states
+                    // touch only seems to exist in GHWT, and GHWT always reports data type 1 format regardless of setting
+                    if (isTouched) {
+                        // touched
+                        fretGreen     = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_GREEN,WII_GUITAR_TOUCHPAD_RED));
+                        fretRed       = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_RED,WII_GUITAR_TOUCHPAD_YELLOW));
+                        fretYellow    = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_YELLOW,WII_GUITAR_TOUCHPAD_BLUE));
+                        fretBlue      = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_BLUE,WII_GUITAR_TOUCHPAD_ORANGE));
+                        fretOrange    = (TOUCH_BETWEEN_RANGE(touchBar,WII_GUITAR_TOUCHPAD_ORANGE,WII_GUITAR_TOUCHPAD_MAX));
+                        directionDown = isTouched;
                     }
+                } else if (dataType == WII_DATA_TYPE_2) {
+                    joy1X =          ((regRead[0] << 2) | ((regRead[4] & 0x03) >> 0));
+                    joy1Y =          ((regRead[2] << 2) | ((regRead[4] & 0x30) >> 4));
+
+                    touchBar =       0;
+
+                    whammyBar =      (regRead[6] & 0xFF);
+                    joy2X =          (regRead[6] & 0xFF);
+
+                    directionDown =  !((regRead[7] & 0x40) >> 6);
+                    buttonMinus =    !((regRead[7] & 0x10) >> 4);
+                    buttonPlus =     !((regRead[7] & 0x04) >> 2);
+
+                    fretOrange =     !((regRead[8] & 0x80) >> 7);
+                    fretRed =        !((regRead[8] & 0x40) >> 6);
+                    fretBlue =       !((regRead[8] & 0x20) >> 5);
+                    fretGreen =      !((regRead[8] & 0x10) >> 4);
+                    fretYellow =     !((regRead[8] & 0x08) >> 3);
+                    pedalButton =    !((regRead[8] & 0x04) >> 2);
+                    directionUp =    !((regRead[8] & 0x01) >> 0);
+                } else if (dataType == WII_DATA_TYPE_3) {
+                    joy1X =          (regRead[0] & 0xFF);
+                    joy1Y =          (regRead[2] & 0xFF);
+
+                    touchBar =       0;
+
+                    whammyBar =      (regRead[5] & 0xFF);
+                    joy2X =          (regRead[5] & 0xFF);
+
+                    directionDown =  !((regRead[6] & 0x40) >> 6);
+                    buttonMinus =    !((regRead[6] & 0x10) >> 4);
+                    buttonPlus =     !((regRead[6] & 0x04) >> 2);
+
+                    fretOrange =     !((regRead[7] & 0x80) >> 7);
+                    fretRed =        !((regRead[7] & 0x40) >> 6);
+                    fretBlue =       !((regRead[7] & 0x20) >> 5);
+                    fretGreen =      !((regRead[7] & 0x10) >> 4);
+                    fretYellow =     !((regRead[7] & 0x08) >> 3);
+                    pedalButton =    !((regRead[7] & 0x04) >> 2);
+                    directionUp =    !((regRead[7] & 0x01) >> 0);
+                }
+            }
 #if WII_EXTENSION_DEBUG==true
 //                printf("Joy1 X=%4d Y=%4d  Whammy=%4d  U=%1d D=%1d -=%1d +=%1d\n", joy1X, joy1Y, whammyBar, directionUp, directionDown, buttonMinus, buttonPlus);
 //                printf("Joy1 X=%4d Y=%4d  Whammy=%4d  U=%1d D=%1d -=%1d +=%1d\n", joy1X, joy1Y, whammyBar, directionUp, directionDown, buttonMinus, buttonPlus);
 //                printf("O=%1d B=%1d Y=%1d R=%1d G=%1d\n", fretOrange, fretBlue, fretYellow, fretRed, fretGreen);
 #endif
-                    break;
-                case WII_EXTENSION_TAIKO:
-                    if (dataType == WII_DATA_TYPE_1) {
-                        drumLeft        = !((regRead[5] & 0x40) >> 6);
-                        rimLeft         = !((regRead[5] & 0x20) >> 5);
-                        drumRight       = !((regRead[5] & 0x10) >> 4);
-                        rimRight        = !((regRead[5] & 0x08) >> 3);
-                    } else if (dataType == WII_DATA_TYPE_2) {
-                        drumLeft        = !((regRead[8] & 0x40) >> 6);
-                        rimLeft         = !((regRead[8] & 0x20) >> 5);
-                        drumRight       = !((regRead[8] & 0x10) >> 4);
-                        rimRight        = !((regRead[8] & 0x08) >> 3);
-                    } else if (dataType == WII_DATA_TYPE_3) {
-                        drumLeft        = !((regRead[7] & 0x40) >> 6);
-                        rimLeft         = !((regRead[7] & 0x20) >> 5);
-                        drumRight       = !((regRead[7] & 0x10) >> 4);
-                        rimRight        = !((regRead[7] & 0x08) >> 3);
-                    }
+            break;
+        case WII_EXTENSION_TAIKO:
+            if (dataType == WII_DATA_TYPE_1) {
+                drumLeft        = !((regRead[5] & 0x40) >> 6);
+                rimLeft         = !((regRead[5] & 0x20) >> 5);
+                drumRight       = !((regRead[5] & 0x10) >> 4);
+                rimRight        = !((regRead[5] & 0x08) >> 3);
+            } else if (dataType == WII_DATA_TYPE_2) {
+                drumLeft        = !((regRead[8] & 0x40) >> 6);
+                rimLeft         = !((regRead[8] & 0x20) >> 5);
+                drumRight       = !((regRead[8] & 0x10) >> 4);
+                rimRight        = !((regRead[8] & 0x08) >> 3);
+            } else if (dataType == WII_DATA_TYPE_3) {
+                drumLeft        = !((regRead[7] & 0x40) >> 6);
+                rimLeft         = !((regRead[7] & 0x20) >> 5);
+                drumRight       = !((regRead[7] & 0x10) >> 4);
+                rimRight        = !((regRead[7] & 0x08) >> 3);
+            }
 
 #if WII_EXTENSION_DEBUG==true
-                //if (_lastRead[0] != regRead[0]) printf("Byte0    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[0]));
-                //if (_lastRead[1] != regRead[1]) printf("Byte1    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[1]));
-                //if (_lastRead[2] != regRead[2]) printf("Byte2    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[2]));
-                //if (_lastRead[3] != regRead[3]) printf("Byte3    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[3]));
-                //if (_lastRead[4] != regRead[4]) printf("Byte4    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[4]));
-                //if (_lastRead[5] != regRead[5]) printf("Byte5    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[5]));
-                //
-                //if (_lastRead[7] != regRead[7]) {
-                //    printf("DL=%1d RL=%1d DR=%1d RR=%1d\n", drumLeft, rimLeft, drumRight, rimRight);
-                //}
+        //if (_lastRead[0] != regRead[0]) printf("Byte0    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[0]));
+        //if (_lastRead[1] != regRead[1]) printf("Byte1    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[1]));
+        //if (_lastRead[2] != regRead[2]) printf("Byte2    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[2]));
+        //if (_lastRead[3] != regRead[3]) printf("Byte3    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[3]));
+        //if (_lastRead[4] != regRead[4]) printf("Byte4    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[4]));
+        //if (_lastRead[5] != regRead[5]) printf("Byte5    " BYTE_TO_BINARY_PATTERN "\n", BYTE_TO_BINARY(regRead[5]));
+        //
+        //if (_lastRead[7] != regRead[7]) {
+        //    printf("DL=%1d RL=%1d DR=%1d RR=%1d\n", drumLeft, rimLeft, drumRight, rimRight);
+        //}
 #endif
 
-                    break;
-            }
+            break;
+    }
 
-            // calibrate and remap
-            joy1X   = map(
-                calibrate(joy1X, _minX1, _maxX1, _cenX1),
-                0+_minX1,
-                (_analogPrecision1From-_maxX1),
-                0,
-                (_analogPrecision1To-1)
-            );
-            joy1Y   = map(
-                calibrate(joy1Y, _minY1, _maxY1, _cenY1),
-                0+_minY1,
-                (_analogPrecision1From-_maxY1),
-                0,
-                (_analogPrecision1To-1)
-            );
-
-            joy2X   = map(
-                calibrate(joy2X, _minX2, _maxX2, _cenX2),
-                0+_minX2,
-                (_analogPrecision2From-_maxX2),
-                0,
-                (_analogPrecision2To-1)
-            );
-            joy2Y   = map(
-                calibrate(joy2Y, _minY2, _maxY2, _cenY2),
-                0+_minY2,
-                (_analogPrecision2From-_maxY2),
-                0,
-                (_analogPrecision2To-1)
-            );
-
-            triggerLeft  = map(
-                triggerLeft,
-                0,
-                (_triggerPrecision1From-1),
-                0,
-                (_triggerPrecision1To-1)
-            );
-            triggerRight = map(
-                triggerRight,
-                0,
-                (_triggerPrecision2From-1),
-                0,
-                (_triggerPrecision2To-1)
-            );
+    // calibrate and remap
+    joy1X   = map(
+        calibrate(joy1X, _minX1, _maxX1, _cenX1),
+        0+_minX1,
+        (_analogPrecision1From-_maxX1),
+        0,
+        (_analogPrecision1To-1)
+    );
+    joy1Y   = map(
+        calibrate(joy1Y, _minY1, _maxY1, _cenY1),
+        0+_minY1,
+        (_analogPrecision1From-_maxY1),
+        0,
+        (_analogPrecision1To-1)
+    );
+
+    joy2X   = map(
+        calibrate(joy2X, _minX2, _maxX2, _cenX2),
+        0+_minX2,
+        (_analogPrecision2From-_maxX2),
+        0,
+        (_analogPrecision2To-1)
+    );
+    joy2Y   = map(
+        calibrate(joy2Y, _minY2, _maxY2, _cenY2),
+        0+_minY2,
+        (_analogPrecision2From-_maxY2),
+        0,
+        (_analogPrecision2To-1)
+    );
+
+    triggerLeft  = map(
+        triggerLeft,
+        0,
+        (_triggerPrecision1From-1),
+        0,
+        (_triggerPrecision1To-1)
+    );
+    triggerRight = map(
+        triggerRight,
+        0,
+        (_triggerPrecision2From-1),
+        0,
+        (_triggerPrecision2To-1)
+    );
 
 #if WII_EXTENSION_DEBUG==true
-            //if ((_lastRead[0] != regRead[0]) || (_lastRead[1] != regRead[1]) || (_lastRead[2] != regRead[2]) || (_lastRead[3] != regRead[3])) {
-            //    printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d\n", joy1X, joy1Y, joy2X, joy2Y);
-            //}
-            //printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d  U=%1d D=%1d L=%1d R=%1d TL=%4d TR=%4d\n", joy1X, joy1Y, joy2X, joy2Y, directionUp, directionDown, directionLeft, directionRight, triggerLeft, triggerRight);
-            //printf("A=%1d B=%1d X=%1d Y=%1d ZL=%1d ZR=%1d LT=%1d RT=%1d -=%1d H=%1d +=%1d\n", buttonA, buttonB, buttonX, buttonY, buttonZL, buttonZR, buttonLT, buttonRT, buttonMinus, buttonHome, buttonPlus);
-            for (int i = 0; i < result; ++i) {
-                _lastRead[i] = regRead[i];
-            }
-#endif
-            // continue poll
-            regWrite[0] = 0x00;
-            result = doI2CWrite(regWrite, 1);
-        } else {
-            // device disconnected or invalid read
-            extensionType = WII_EXTENSION_NONE;
-            reset();
-            start();
-        }
-    } else {
-        reset();
-        start();
+    //if ((_lastRead[0] != regRead[0]) || (_lastRead[1] != regRead[1]) || (_lastRead[2] != regRead[2]) || (_lastRead[3] != regRead[3])) {
+    //    printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d\n", joy1X, joy1Y, joy2X, joy2Y);
+    //}
+    //printf("Joy1 X=%4d Y=%4d  Joy2 X=%4d Y=%4d  U=%1d D=%1d L=%1d R=%1d TL=%4d TR=%4d\n", joy1X, joy1Y, joy2X, joy2Y, directionUp, directionDown, directionLeft, directionRight, triggerLeft, triggerRight);
+    //printf("A=%1d B=%1d X=%1d Y=%1d ZL=%1d ZR=%1d LT=%1d RT=%1d -=%1d H=%1d +=%1d\n", buttonA, buttonB, buttonX, buttonY, buttonZL, buttonZR, buttonLT, buttonRT, buttonMinus, buttonHome, buttonPlus);
+    for (int i = 0; i < result; ++i) {
+        _lastRead[i] = regRead[i];
     }
+#endif
 }
 
 uint16_t WiiExtension::map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max) {
@@ -693,6 +723,134 @@ uint16_t WiiExtension::calibrate(uint16_t pos, uint16_t min, uint16_t max, uint1
     return result;
 }
 
+void WiiExtension::startAsync() {
+    i2c_hw_t *hw = i2c_get_hw(picoI2C);
+
+    asyncLength = reportLength();
+    if (asyncLength == 0 || asyncLength > sizeof(asyncReports[0])) {
+        asyncFailed = true;
+        return;
+    }
+
+    hw->enable = 0;
+    hw->tar = address;
+    hw->enable = 1;
+
+    asyncFailed = false;
+    asyncRetries = 0;
+    asyncStep = ASYNC_READ;
+    asyncTaken = asyncSequence;
+
+    alarm_id_t id = add_alarm_in_us(WII_EXTENSION_DELAY, asyncAlarmCallback, this, true);
+    if (id > 0) {
+        asyncAlarm = id;
+    } else {
+        // no free alarm slot, stay on blocking reads
+        asyncEnabled = false;
+    }
+}
+
+void WiiExtension::stopAsync() {
+    i2c_hw_t *hw = i2c_get_hw(picoI2C);
+
+    if (asyncAlarm != 0) {
+        cancel_alarm(asyncAlarm);
+        asyncAlarm = 0;
+    }
+
+    // let a transfer already on the bus finish before the blocking calls take over
+    absolute_time_t timeout = make_timeout_time_ms(WII_EXTENSION_TIMEOUT);
+    while ((hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS) && !time_reached(timeout)) {
+        tight_loop_contents();
+    }
+    while (hw->rxflr) {
+        (void)hw->data_cmd;
+    }
+    (void)hw->clr_tx_abrt;
+
+    asyncFailed = false;
+}
+
+int WiiExtension::takeAsyncReport(uint8_t *report) {
+    int length = 0;
+
+    // the alarm runs on this core, so masking interrupts is enough to keep the slot stable
+    uint32_t save = save_and_disable_interrupts();
+    uint32_t sequence = asyncSequence;
+    if (sequence != asyncTaken) {
+        uint8_t slot = sequence & 1;
+        length = asyncReportLengths[slot];
+        memcpy(report, asyncReports[slot], length);
+        sampleTime = asyncReportTimes[slot];
+        asyncTaken = sequence;
+    }
+    restore_interrupts(save);
+
+    return length;
+}
+
+int64_t WiiExtension::asyncAlarmCallback(alarm_id_t id, void *userData) {
+    return static_cast<WiiExtension*>(userData)->stepAsync();
+}
+
+int64_t WiiExtension::stepAsync() {
+    i2c_hw_t *hw = i2c_get_hw(picoI2C);
+
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        // NAK or arbitration loss, poll() will reset and rescan the extension
+        (void)hw->clr_tx_abrt;
+        return failAsync();
+    }
+
+    switch (asyncStep) {
+        case ASYNC_READ:
+            asyncReadTime = time_us_32();
+            for (uint8_t i = 0; i < asyncLength; ++i) {
+                hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS | ((i == asyncLength - 1) ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+            }
+            asyncRetries = 0;
+            asyncStep = ASYNC_READ_WAIT;
+            // address plus the report, nine clocks a byte
+            return ((asyncLength + 1) * 9 * 1000000) / iSpeed + 10;
+        case ASYNC_READ_WAIT:
+            if (hw->rxflr < asyncLength) return retryAsync();
+            {
+                uint8_t slot = (asyncSequence + 1) & 1;
+                for (uint8_t i = 0; i < asyncLength; ++i) {
+                    asyncReports[slot][i] = (uint8_t)hw->data_cmd;
+                }
+                asyncReportLengths[slot] = asyncLength;
+                asyncReportTimes[slot] = asyncReadTime;
+                asyncSequence = asyncSequence + 1;
+            }
+            asyncStep = ASYNC_WRITE;
+            return WII_EXTENSION_DELAY;
+        case ASYNC_WRITE:
+            // continue poll
+            hw->data_cmd = 0x00 | I2C_IC_DATA_CMD_STOP_BITS;
+            asyncRetries = 0;
+            asyncStep = ASYNC_WRITE_WAIT;
+            return (2 * 9 * 1000000) / iSpeed + 10;
+        case ASYNC_WRITE_WAIT:
+            if (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) return retryAsync();
+            asyncStep = ASYNC_READ;
+            return WII_EXTENSION_DELAY;
+    }
+
+    return failAsync();
+}
+
+int64_t WiiExtension::retryAsync() {
+    if (++asyncRetries > WII_EXTENSION_ASYNC_RETRIES) return failAsync();
+    return WII_EXTENSION_ASYNC_RETRY_US;
+}
+
+int64_t WiiExtension::failAsync() {
+    asyncFailed = true;
+    asyncAlarm = 0;
+    return 0;
+}
+
 int WiiExtension::doI2CWrite(uint8_t *pData, int iLen) {
     int result = i2c_write_blocking(picoI2C, address, pData, iLen, false);
     waitUntil_us(WII_EXTENSION_DELAY);
@@ -67,6 +67,13 @@
 #define WII_ALARM_NUM 0
 #define WII_ALARM_IRQ TIMER_IRQ_0
 
+// Asynchronous polling gives up on a transfer that is this many retries late
+#ifndef WII_EXTENSION_ASYNC_RETRIES
+#define WII_EXTENSION_ASYNC_RETRIES 20
+#endif
+
+#define WII_EXTENSION_ASYNC_RETRY_US 25
+
 static volatile bool WiiExtension_alarmFired;
 
 #define BYTE_TO_BINARY_PATTERN "%c%c%c%c%c%c%c%c"
@@ -137,14 +144,23 @@ class WiiExtension {
 
     bool isReady         = false;
 
+    // time_us_32() when the current state was read from the extension
+    uint32_t sampleTime  = 0;
+
     // Constructor 
 	WiiExtension(int sda, int scl, i2c_inst_t *i2cCtl, int32_t speed, uint8_t addr);
 
     // Methods
     void begin();
+    // Reads reports from a repeating alarm that drives the I2C FIFOs directly, poll() then only decodes
+    // the newest report and never waits on the bus
+    void beginAsync();
 	void reset();
   	void start();
-  	void poll();
+    // Returns true when a new report was decoded
+  	bool poll();
+    // The alarm is reading reports, poll() only picks them up and never touches the bus
+    bool asyncRunning() const { return asyncAlarm != 0; }
   private:
 	
     uint8_t iSDA;
@@ -196,9 +212,37 @@ class WiiExtension {
 
     uint8_t _guitarType   = WII_GUITAR_UNSET;
 
+    enum AsyncStep : uint8_t { ASYNC_READ, ASYNC_READ_WAIT, ASYNC_WRITE, ASYNC_WRITE_WAIT };
+
+    bool asyncEnabled = false;
+    volatile alarm_id_t asyncAlarm = 0;
+    volatile bool asyncFailed = false;
+    AsyncStep asyncStep = ASYNC_READ;
+    uint8_t asyncLength = 0;     // Report length of the read in flight
+    uint8_t asyncRetries = 0;
+    uint32_t asyncReadTime = 0;
+
+    // Double buffered raw reports, the alarm fills the slot after the newest and then bumps the sequence
+    uint8_t asyncReports[2][16];
+    uint8_t asyncReportLengths[2];
+    uint32_t asyncReportTimes[2];
+    volatile uint32_t asyncSequence = 0;
+    uint32_t asyncTaken = 0;     // Sequence of the last report poll() decoded
+
     uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
     uint16_t calibrate(uint16_t pos, uint16_t min, uint16_t max, uint16_t center);
 
+    int reportLength();
+    void decode(const uint8_t *regRead, int result);
+
+    void startAsync();
+    void stopAsync();
+    int takeAsyncReport(uint8_t *report);
+    int64_t stepAsync();
+    int64_t retryAsync();
+    int64_t failAsync();
+    static int64_t asyncAlarmCallback(alarm_id_t id, void *userData);
+
     int doI2CWrite(uint8_t *pData, int iLen);
     int doI2CRead(uint8_t *pData, int iLen);
     uint8_t doI2CTest();
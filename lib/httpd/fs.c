@@ -52,6 +52,9 @@
 #if LWIP_HTTPD_CUSTOM_FILES
 int fs_open_custom(struct fs_file *file, const char *name);
 void fs_close_custom(struct fs_file *file);
+#if LWIP_HTTPD_DYNAMIC_FILE_READ
+int fs_read_custom(struct fs_file *file, char *buffer, int count);
+#endif /* LWIP_HTTPD_DYNAMIC_FILE_READ */
 #if LWIP_HTTPD_FS_ASYNC_READ
 u8_t fs_canread_custom(struct fs_file *file);
 u8_t fs_wait_read_custom(struct fs_file *file, fs_wait_cb callback_fn, void *callback_arg);
@@ -140,6 +143,12 @@ fs_read(struct fs_file *file, char *buffer, int count)
 #endif /* LWIP_HTTPD_CUSTOM_FILES */
 #endif /* LWIP_HTTPD_FS_ASYNC_READ */
 
+#if LWIP_HTTPD_CUSTOM_FILES
+  if (file->is_custom_file && (file->data == NULL)) {
+    return fs_read_custom(file, buffer, count);
+  }
+#endif /* LWIP_HTTPD_CUSTOM_FILES */
+
   read = file->len - file->index;
   if(read > count) {
     read = count;
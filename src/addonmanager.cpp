@@ -1,12 +1,25 @@
 #include "addonmanager.h"
+#include "perfstats.h"
 
-void AddonManager::LoadAddon(GPAddon* addon, ADDON_PROCESS processAt) {
+#include "hardware/clocks.h"
+
+#include <algorithm>
+
+void AddonManager::AddAddon(GPAddon* addon, ADDON_PROCESS processAt, bool hasPreprocess) {
     if (addon->available()) {
-        AddonBlock * block = new AddonBlock;
 		addon->setup();
-        block->ptr = addon;
-        block->process = processAt;
-        addons.push_back(block);
+        if (hasPreprocess) {
+            preprocessAddons[processAt].push_back({ addon, PerfStats::addStage(addon->name().c_str(), ".preprocess") });
+        }
+        uint8_t jitterStage = PERF_STATS_NONE;
+        if (processAt == CORE1_LOOP) { // core1 runs its addons by deadline
+            jitterStage = PerfStats::addStage(addon->name().c_str(), ".jitter");
+            cyclesPerMicro = clock_get_hz(clk_sys) / 1000000;
+        }
+        processAddons[processAt].push_back({ addon, PerfStats::addStage(addon->name().c_str(), ".process"), jitterStage, 0 });
+
+        // Everything starts due now, so adding to the end keeps the heap ordered
+        schedule[processAt].push_back(processAddons[processAt].size() - 1);
 	} else {
         delete addon; // Don't use the memory if we don't have to
     }
@@ -14,26 +27,81 @@ void AddonManager::LoadAddon(GPAddon* addon, ADDON_PROCESS processAt) {
 
 
 void AddonManager::PreprocessAddons(ADDON_PROCESS processType) {
-    // Loop through all addons and process any that match our type
-    for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
-        if ( (*it)->process == processType )
-            (*it)->ptr->preprocess();
+    for (const AddonBlock& block : preprocessAddons[processType]) {
+        uint32_t perfStart = PerfStats::now();
+        block.ptr->preprocess();
+        PerfStats::lap(block.perfStage, perfStart);
     }
 }
 
 void AddonManager::ProcessAddons(ADDON_PROCESS processType) {
-    // Loop through all addons and process any that match our type
-    for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
-        if ( (*it)->process == processType )
-            (*it)->ptr->process();
+    for (const AddonBlock& block : processAddons[processType]) {
+        uint32_t perfStart = PerfStats::now();
+        block.ptr->process();
+        PerfStats::lap(block.perfStage, perfStart);
+    }
+}
+
+// Runs every addon whose deadline has passed, earliest first, and returns when the next one is due
+uint64_t AddonManager::ProcessDueAddons(ADDON_PROCESS processType) {
+    std::vector<AddonBlock>& addons = processAddons[processType];
+    std::vector<uint8_t>& heap = schedule[processType];
+    const uint64_t now = getMicro(); // anything that comes due during this pass waits for the next one
+    if (heap.empty()) {
+        return now + GAMEPAD_POLL_MICRO;
+    }
+
+    while (addons[heap[0]].due <= now) {
+        AddonBlock& block = addons[heap[0]];
+        if (block.due != 0) { // not the first run
+            PerfStats::record(block.jitterStage, (getMicro() - block.due) * cyclesPerMicro);
+        }
+
+        uint32_t perfStart = PerfStats::now();
+        block.ptr->process();
+        PerfStats::lap(block.perfStage, perfStart);
+
+        // Keep a steady rate, but start over from now rather than catching up on missed runs.
+        // Every addon lands after now, so one with an interval of 0 runs once per pass instead of forever.
+        const uint32_t interval = std::max<uint32_t>(block.ptr->interval(), 1);
+        block.due += interval;
+        if (block.due <= now) {
+            block.due = now + interval;
+        }
+        siftDown(processType, 0);
+    }
+
+    return addons[heap[0]].due;
+}
+
+void AddonManager::siftDown(ADDON_PROCESS processType, size_t i) {
+    const std::vector<AddonBlock>& addons = processAddons[processType];
+    std::vector<uint8_t>& heap = schedule[processType];
+    while (true) {
+        size_t earliest = i;
+        const size_t left = 2 * i + 1;
+        const size_t right = left + 1;
+        if (left < heap.size() && addons[heap[left]].due < addons[heap[earliest]].due) {
+            earliest = left;
+        }
+        if (right < heap.size() && addons[heap[right]].due < addons[heap[earliest]].due) {
+            earliest = right;
+        }
+        if (earliest == i) {
+            return;
+        }
+        std::swap(heap[i], heap[earliest]);
+        i = earliest;
     }
 }
 
 // HACK : change this for NeoPicoLED
 GPAddon * AddonManager::GetAddon(std::string name) { // hack for NeoPicoLED
-    for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
-        if ( (*it)->ptr->name() == name )
-            return (*it)->ptr;
+    for (const std::vector<AddonBlock>& addons : processAddons) {
+        for (const AddonBlock& block : addons) {
+            if ( block.ptr->name() == name )
+                return block.ptr;
+        }
     }
     return nullptr;
 }
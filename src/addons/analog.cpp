@@ -6,12 +6,44 @@
 #include "enums.pb.h"
 
 #include "hardware/adc.h"
+#include "hardware/dma.h"
 
-#include <math.h>
+#include <stdlib.h>
 
 #define ADC_MAX ((1 << 12) - 1)
-#define ANALOG_CENTER 0.5f // 0.5f is center
-#define ANALOG_MAX 1.0f    // 1.0f is max
+#define ANALOG_CENTER 0        // Axis values are offsets from center in half steps of the 16-bit output
+#define ANALOG_MAX 65535       // so center is exact and -ANALOG_MAX..ANALOG_MAX spans the full travel
+
+static_assert((ANALOG_ADC_OVERSAMPLE & (ANALOG_ADC_OVERSAMPLE - 1)) == 0, "ANALOG_ADC_OVERSAMPLE must be a power of two");
+
+static inline int32_t toOffset(uint16_t adc) {
+    return (int32_t)(((uint32_t)adc * 2 * ANALOG_MAX) / ADC_MAX) - ANALOG_MAX;
+}
+
+static inline uint16_t toOutput(int32_t offset) {
+    return (uint16_t)((offset + ANALOG_MAX) / 2);
+}
+
+static inline uint8_t adcInput(int pin) {
+    return (pin >= 26 && pin <= 29) ? (1 << (pin - 26)) : 0;
+}
+
+static uint32_t isqrt(uint32_t x) {
+    uint32_t result = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > x) bit >>= 2;
+    while (bit != 0) {
+        if (x >= result + bit) {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
 
 bool AnalogInput::available() {
     return Storage::getInstance().getAddonOptions().analogOptions.enabled;
@@ -53,24 +85,128 @@ void AnalogInput::setup() {
 			adc_2_y_center = adc_read();
 		}
 	}
+
+#if ANALOG_ADC_DMA
+	// The turbo dial does its own blocking reads, a free-running ADC would hand it other channels
+	const TurboOptions& turboOptions = Storage::getInstance().getAddonOptions().turboOptions;
+	if (!(turboOptions.enabled && isValidPin(turboOptions.shmupDialPin))) {
+		uint8_t mask = 0;
+		if ( isValidPin(analogOptions.analogAdc1PinX) ) mask |= adcInput(analogOptions.analogAdc1PinX);
+		if ( isValidPin(analogOptions.analogAdc1PinY) ) mask |= adcInput(analogOptions.analogAdc1PinY);
+		if ( isValidPin(analogOptions.analogAdc2PinX) ) mask |= adcInput(analogOptions.analogAdc2PinX);
+		if ( isValidPin(analogOptions.analogAdc2PinY) ) mask |= adcInput(analogOptions.analogAdc2PinY);
+		if (mask != 0) {
+			startSampling(mask);
+		}
+	}
+#endif
+}
+
+bool AnalogInput::startSampling(uint8_t mask) {
+    dataChannel = dma_claim_unused_channel(false);
+    if (dataChannel < 0) {
+        return false;
+    }
+    controlChannel = dma_claim_unused_channel(false);
+    if (controlChannel < 0) {
+        dma_channel_unclaim(dataChannel);
+        dataChannel = -1;
+        return false;
+    }
+
+    adcMask = mask;
+    adcChannelCount = __builtin_popcount(mask);
+    const uint32_t sampleCount = adcChannelCount * ANALOG_ADC_OVERSAMPLE;
+    adcSamples = new uint16_t[sampleCount];
+
+    // Seed every slot with a blocking read so the first averages are not pulled towards zero
+    for (uint8_t input = 0, slot = 0; input < 4; input++) {
+        if (mask & (1 << input)) {
+            adc_select_input(input);
+            uint16_t value = adc_read();
+            for (uint32_t i = slot; i < sampleCount; i += adcChannelCount) {
+                adcSamples[i] = value;
+            }
+            slot++;
+        }
+    }
+
+    // The data channel drains the ADC FIFO into one pass of the buffer, then chains to the control channel
+    dma_channel_config config = dma_channel_get_default_config(dataChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_dreq(&config, DREQ_ADC);
+    channel_config_set_chain_to(&config, controlChannel);
+    dma_channel_configure(dataChannel, &config, adcSamples, &adc_hw->fifo, sampleCount, false);
+
+    // which points it back at the start of the buffer, retriggering it. The FIFO covers the gap, so the
+    // round-robin never slips and every slot keeps holding the same input.
+    config = dma_channel_get_default_config(controlChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, false);
+    dma_channel_configure(controlChannel, &config, &dma_hw->ch[dataChannel].al2_write_addr_trig, &adcSamples, 1, false);
+
+    // Free-running at 500ksps, shared between the inputs in ascending order from the lowest one
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(0);
+    adc_select_input(__builtin_ctz(mask));
+    adc_set_round_robin(mask);
+    adc_fifo_drain();
+    dma_channel_start(dataChannel);
+    adc_run(true);
+
+    return true;
+}
+
+uint16_t AnalogInput::readADC(uint8_t input) {
+    uint16_t value;
+
+    if (adcMask & (1 << input)) {
+        // The DMA may be writing the buffer meanwhile, every slot read is still a recent sample of this input
+        uint32_t sum = 0;
+        for (uint32_t i = __builtin_popcount(adcMask & ((1 << input) - 1)); i < adcChannelCount * ANALOG_ADC_OVERSAMPLE; i += adcChannelCount) {
+            sum += adcSamples[i];
+        }
+        value = sum / ANALOG_ADC_OVERSAMPLE;
+    } else {
+        adc_select_input(input);
+        value = adc_read();
+    }
+
+    return filter(input, value);
+}
+
+uint16_t AnalogInput::filter(uint8_t input, uint16_t value) {
+#if ANALOG_ADC_SMOOTHING
+    if (!(adcFilterSeeded & (1 << input))) {
+        adcFiltered[input] = (uint32_t)value << ANALOG_ADC_SMOOTHING;
+        adcFilterSeeded |= (1 << input);
+    }
+    adcFiltered[input] += value - (adcFiltered[input] >> ANALOG_ADC_SMOOTHING);
+    return adcFiltered[input] >> ANALOG_ADC_SMOOTHING;
+#else
+    return value;
+#endif
 }
 
 void AnalogInput::process()
 {
     const AnalogOptions& analogOptions = Storage::getInstance().getAddonOptions().analogOptions;
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
-    float adc_1_x = ANALOG_CENTER;
-    float adc_1_y = ANALOG_CENTER;
-    float adc_2_x = ANALOG_CENTER;
-    float adc_2_y = ANALOG_CENTER;
-    float adc_deadzone = analogOptions.analog_deadzone / 200.0f;
+    int32_t adc_1_x = ANALOG_CENTER;
+    int32_t adc_1_y = ANALOG_CENTER;
+    int32_t adc_2_x = ANALOG_CENTER;
+    int32_t adc_2_y = ANALOG_CENTER;
+    uint32_t adc_deadzone = analogOptions.analog_deadzone;
 
     if ( isValidPin(analogOptions.analogAdc1PinX) ) {
         adc_1_x = readPin(analogOptions.analogAdc1PinX, adc_1_x_center, analogOptions.auto_calibrate, adc_deadzone);
         
         if ( analogOptions.analogAdc1Invert == InvertMode::INVERT_X ||
             analogOptions.analogAdc1Invert == InvertMode::INVERT_XY) {
-            adc_1_x = ANALOG_MAX - adc_1_x;
+            adc_1_x = -adc_1_x;
         }
     }
     if ( isValidPin(analogOptions.analogAdc1PinY) ) {
@@ -78,7 +214,7 @@ void AnalogInput::process()
         
         if ( analogOptions.analogAdc1Invert == InvertMode::INVERT_Y ||
             analogOptions.analogAdc1Invert == InvertMode::INVERT_XY) {
-            adc_1_y = ANALOG_MAX - adc_1_y;
+            adc_1_y = -adc_1_y;
         }
     }
     if ( isValidPin(analogOptions.analogAdc2PinX) ) {
@@ -86,7 +222,7 @@ void AnalogInput::process()
         
         if ( analogOptions.analogAdc2Invert == InvertMode::INVERT_X ||
             analogOptions.analogAdc2Invert == InvertMode::INVERT_XY) {
-            adc_2_x = ANALOG_MAX - adc_2_x;
+            adc_2_x = -adc_2_x;
         }
     }
     if ( isValidPin(analogOptions.analogAdc2PinY) ) {
@@ -94,7 +230,7 @@ void AnalogInput::process()
 
         if ( analogOptions.analogAdc2Invert == InvertMode::INVERT_Y ||
             analogOptions.analogAdc2Invert == InvertMode::INVERT_XY) {
-            adc_2_y = ANALOG_MAX - adc_2_y;
+            adc_2_y = -adc_2_y;
         }
     }
     
@@ -106,24 +242,23 @@ void AnalogInput::process()
 
     // Convert to 16-bit value
     if ( analogOptions.analogAdc1Mode == DpadMode::DPAD_MODE_LEFT_ANALOG) {
-        gamepad->state.lx = (uint16_t)(65535.0f*adc_1_x);
-        gamepad->state.ly = (uint16_t)(65535.0f*adc_1_y);
+        gamepad->state.lx = toOutput(adc_1_x);
+        gamepad->state.ly = toOutput(adc_1_y);
     } else if ( analogOptions.analogAdc1Mode == DpadMode::DPAD_MODE_RIGHT_ANALOG) {
-        gamepad->state.rx = (uint16_t)(65535.0f*adc_1_x);
-        gamepad->state.ry = (uint16_t)(65535.0f*adc_1_y);
+        gamepad->state.rx = toOutput(adc_1_x);
+        gamepad->state.ry = toOutput(adc_1_y);
     }
     if ( analogOptions.analogAdc2Mode == DpadMode::DPAD_MODE_LEFT_ANALOG) {
-        gamepad->state.lx = (uint16_t)(65535.0f*adc_2_x);
-        gamepad->state.ly = (uint16_t)(65535.0f*adc_2_y);
+        gamepad->state.lx = toOutput(adc_2_x);
+        gamepad->state.ly = toOutput(adc_2_y);
     } else if ( analogOptions.analogAdc2Mode == DpadMode::DPAD_MODE_RIGHT_ANALOG) {
-        gamepad->state.rx = (uint16_t)(65535.0f*adc_2_x);
-        gamepad->state.ry = (uint16_t)(65535.0f*adc_2_y);
+        gamepad->state.rx = toOutput(adc_2_x);
+        gamepad->state.ry = toOutput(adc_2_y);
     }
 }
 
-float AnalogInput::readPin(int pin, uint16_t center, bool autoCalibrate, float deadzone) {
-	adc_select_input(pin - 26);
-	uint16_t adc_hold = adc_read();
+int32_t AnalogInput::readPin(int pin, uint16_t center, bool autoCalibrate, uint32_t deadzone) {
+	uint16_t adc_hold = readADC(pin - 26);
 
 	// Calibrate axis based on off-center
 	uint16_t adc_calibrated;
@@ -143,9 +278,10 @@ float AnalogInput::readPin(int pin, uint16_t center, bool autoCalibrate, float d
 		adc_calibrated = adc_hold;
 	}
 
-	float adc_value = ((float)adc_calibrated) / ADC_MAX;
+	int32_t adc_value = toOffset(adc_calibrated);
 
-	if (abs(adc_value - ANALOG_CENTER) < deadzone) { // deadzones
+	// deadzone is a percentage of the travel from center to either edge
+	if ((uint32_t)abs(adc_value) * 100 < deadzone * ANALOG_MAX) { // deadzones
 		adc_value = ANALOG_CENTER;
 	}
 
@@ -156,13 +292,16 @@ uint16_t AnalogInput::map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t
     return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
-void AnalogInput::adjustCircularity(float& x, float& y) {
-    float x_magnitude = x - ANALOG_CENTER;
-    float y_magnitude = y - ANALOG_CENTER;
-    float magnitude = sqrt((x_magnitude * x_magnitude) + (y_magnitude * y_magnitude));
+void AnalogInput::adjustCircularity(int32_t& x, int32_t& y) {
+    // Halved so the squared magnitude fits in 32 bits
+    int32_t x_magnitude = x / 2;
+    int32_t y_magnitude = y / 2;
+    uint32_t magnitude_squared = (uint32_t)(x_magnitude * x_magnitude) + (uint32_t)(y_magnitude * y_magnitude);
 
-    if (magnitude > ANALOG_CENTER) {
-        x = ((x_magnitude / magnitude) * ANALOG_CENTER + ANALOG_CENTER);
-        y = ((y_magnitude / magnitude) * ANALOG_CENTER + ANALOG_CENTER);
+    // Outside of the (ANALOG_MAX / 2)^2 circle, the common case inside it needs no square root
+    if (magnitude_squared > 1073709056) {
+        int32_t magnitude = isqrt(magnitude_squared);
+        x = x_magnitude * ANALOG_MAX / magnitude;
+        y = y_magnitude * ANALOG_MAX / magnitude;
     }
-}
\ No newline at end of file
+}
@@ -21,6 +21,7 @@ void BuzzerSpeakerAddon::setup() {
 
 	buzzerVolume = options.volume;
 	introPlayed = false;
+	currentSong = NULL;
 }
 
 void BuzzerSpeakerAddon::process() {
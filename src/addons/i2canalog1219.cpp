@@ -2,6 +2,10 @@
 #include "storagemanager.h"
 #include "helper.h"
 #include "config.pb.h"
+#include "perfstats.h"
+#include "hardware/clocks.h"
+
+#include <algorithm>
 
 #define ADS_MAX (float)((1 << 23) - 1)
 #define VREF_VOLTAGE 2.048f
@@ -34,11 +38,29 @@ void I2CAnalog1219Input::setup() {
     ads->setDataRate(1000);                     // 1mhz (1.1ms delay)
     ads->setVoltageReference(REF_INTERNAL);     // Use internal VREF for now
     ads->start();                               // START/SYNC command
+
+    // Hop through all four channels from the DRDY interrupt, otherwise poll the status register
+    if (isValidPin(options.drdyPin)) {
+        interruptMode = ads->beginInterrupt(options.drdyPin, 0x0F);
+    }
+
+    cyclesPerMicro = clock_get_hz(clk_sys) / 1000000;
+    perfSampleAge = PerfStats::addStage(name().c_str(), ".age");
 }
 
 void I2CAnalog1219Input::process()
 {
-    if (nextTimer < getMillis()) {
+    if (interruptMode) {
+        ads->serviceInterrupt();
+
+        const uint32_t now = time_us_32();
+        uint32_t oldest = 0;
+        for (int i = 0; i < 4; i++) {
+            pins.A[i] = ads->channelResults[i] / float(ADS_MAX);
+            oldest = std::max(oldest, now - ads->channelTimes[i]);
+        }
+        PerfStats::record(perfSampleAge, oldest * cyclesPerMicro);
+    } else if (nextTimer < getMillis()) {
         float result;
         uint32_t readValue;
         if ( ads->readRegister(STATUS) & REGISTER_STATUS_DRDY ) {
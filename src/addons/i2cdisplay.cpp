@@ -46,6 +46,9 @@ void I2CDisplayAddon::setup() {
 	obdSetContrast(&obd, 0xFF);
 	obdSetBackBuffer(&obd, ucBackBuffer);
 	clearScreen(1);
+	memset(ucFrontBuffer, 0, sizeof(ucFrontBuffer));
+	flushFailed = false;
+	hasRenderedButtons = false;
 	gamepad = Storage::getInstance().GetGamepad();
 	pGamepad = Storage::getInstance().GetProcessedGamepad();
 
@@ -100,10 +103,34 @@ void I2CDisplayAddon::setDisplayPower(uint8_t status)
 void I2CDisplayAddon::process() {
 	const FocusModeOptions& focusModeOptions = Storage::getInstance().getAddonOptions().focusModeOptions;
 	if (!configMode && isDisplayPowerOff()) return;
+	if (obdBusy(&obd)) return; // previous frame is still going out
+
+	const DisplayMode displayMode = getDisplayMode();
+
+	// Outside of web config the button layout only depends on these, skip frames where none changed
+	if (displayMode == I2CDisplayAddon::DisplayMode::BUTTONS && !configMode) {
+		updateStatusBar(gamepad);
+		const uint8_t directions = (pressedUp() ? GAMEPAD_MASK_UP : 0)
+			| (pressedDown() ? GAMEPAD_MASK_DOWN : 0)
+			| (pressedLeft() ? GAMEPAD_MASK_LEFT : 0)
+			| (pressedRight() ? GAMEPAD_MASK_RIGHT : 0);
+		if (hasRenderedButtons &&
+			renderedButtons == pGamepad->state.buttons &&
+			renderedDirections == directions &&
+			renderedStatusBar == statusBar) {
+			return;
+		}
+		hasRenderedButtons = true;
+		renderedButtons = pGamepad->state.buttons;
+		renderedDirections = directions;
+		renderedStatusBar = statusBar;
+	} else {
+		hasRenderedButtons = false;
+	}
 
 	clearScreen(0);
 
-	switch (getDisplayMode()) {
+	switch (displayMode) {
 		case I2CDisplayAddon::DisplayMode::CONFIG_INSTRUCTION:
 			drawStatusBar(gamepad);
 			drawText(0, 2, "[Web Config Mode]");
@@ -223,7 +250,25 @@ void I2CDisplayAddon::process() {
 			break;
 	}
 
-	obdDumpBuffer(&obd, NULL);
+	if (flushFailed) {
+		// Make every byte differ so the whole frame is resent
+		for (size_t i = 0; i < sizeof(ucFrontBuffer); i++)
+			ucFrontBuffer[i] = ~ucBackBuffer[i];
+		flushFailed = false;
+	}
+#if DISPLAY_I2C_DMA
+	obdDumpBufferDiffAsync(&obd, ucFrontBuffer, flushDone, this);
+#else
+	obdDumpBufferDiff(&obd, ucFrontBuffer);
+#endif
+}
+
+void I2CDisplayAddon::flushDone(void* pUser, int bError) {
+	if (bError) {
+		I2CDisplayAddon* display = static_cast<I2CDisplayAddon*>(pUser);
+		display->flushFailed = true;
+		display->hasRenderedButtons = false;
+	}
 }
 
 I2CDisplayAddon::DisplayMode I2CDisplayAddon::getDisplayMode() {
@@ -924,6 +969,12 @@ void I2CDisplayAddon::drawText(int x, int y, std::string text) {
 }
 
 void I2CDisplayAddon::drawStatusBar(Gamepad * gamepad)
+{
+	updateStatusBar(gamepad);
+	drawText(0, 0, statusBar);
+}
+
+void I2CDisplayAddon::updateStatusBar(Gamepad * gamepad)
 {
 	const DisplayOptions& options = getDisplayOptions();
 	const TurboOptions& turboOptions = Storage::getInstance().getAddonOptions().turboOptions;
@@ -971,7 +1022,6 @@ void I2CDisplayAddon::drawStatusBar(Gamepad * gamepad)
 		case SOCD_MODE_FIRST_INPUT_PRIORITY:  statusBar += " SOCD-F"; break;
 		case SOCD_MODE_BYPASS:                statusBar += " SOCD-X"; break;
 	}
-	drawText(0, 0, statusBar);
 }
 
 bool I2CDisplayAddon::pressedUp()
@@ -121,7 +121,6 @@ void NeoPicoLEDAddon::setup()
 	neopico = new NeoPico(-1, 0);
 	configureLEDs();
 
-	nextRunTime = make_timeout_time_ms(0); // Reset timeout
 	const FocusModeOptions& focusModeOptions = Storage::getInstance().getAddonOptions().focusModeOptions;
 	isFocusModeEnabled = focusModeOptions.enabled && focusModeOptions.rgbLockEnabled &&
 		isValidPin(focusModeOptions.pin);
@@ -130,11 +129,11 @@ void NeoPicoLEDAddon::setup()
 void NeoPicoLEDAddon::process()
 {
 	const LEDOptions& ledOptions = Storage::getInstance().getLedOptions();
-	if (!isValidPin(ledOptions.dataPin) || !time_reached(this->nextRunTime))
+	if (!isValidPin(ledOptions.dataPin))
 		return;
 
 	Gamepad * gamepad = Storage::getInstance().GetProcessedGamepad();
-	uint8_t * featureData = Storage::getInstance().GetFeatureData();
+	uint8_t * featureData = Storage::getInstance().GetProcessedFeatureData();
 	AnimationHotkey action = animationHotkeys(gamepad);
 	if (ledOptions.pledType == PLED_TYPE_RGB) {
 		inputMode = gamepad->getOptions().inputMode; // HACK
@@ -152,16 +151,8 @@ void NeoPicoLEDAddon::process()
 	}
 
 	uint32_t buttonState = gamepad->state.dpad << 16 | gamepad->state.buttons;
-	vector<Pixel> pressed;
-	for (auto row : matrix.pixels)
-	{
-		for (auto pixel : row)
-		{
-			if (buttonState & pixel.mask)
-				pressed.push_back(pixel);
-		}
-	}
-	if (pressed.size() > 0)
+	uint32_t pressed = matrix.getPressed(buttonState);
+	if (pressed != 0)
 		as.HandlePressed(pressed);
 	else
 		as.ClearPressed();
@@ -192,9 +183,9 @@ void NeoPicoLEDAddon::process()
 					if (pledPins[i] < 0)
 						continue;
 
-					float level = (static_cast<float>(PLED_MAX_LEVEL - neoPLEDs->getLedLevels()[i]) / static_cast<float>(PLED_MAX_LEVEL));
-					float brightness = as.GetBrightnessX() * level;
-					rgbPLEDValues[i] = ((RGB)ledOptions.pledColor).value(neopico->GetFormat(), brightness);
+					uint16_t level = PLED_MAX_LEVEL - neoPLEDs->getLedLevels()[i];
+					RGB color = ((RGB)ledOptions.pledColor).scaled(level);
+					rgbPLEDValues[i] = color.value(neopico->GetFormat(), AnimationStation::GetBrightnessLUT());
 					frame[pledPins[i]] = rgbPLEDValues[i];
 				}
 		}
@@ -203,8 +194,6 @@ void NeoPicoLEDAddon::process()
 	neopico->SetFrame(frame);
 	neopico->Show();
 	AnimationStore.save();
-
-	this->nextRunTime = make_timeout_time_ms(NeoPicoLEDAddon::intervalMS);
 }
 
 std::vector<uint8_t> * NeoPicoLEDAddon::getLEDPositions(string button, std::vector<std::vector<uint8_t>> *positions)
@@ -522,6 +511,7 @@ void NeoPicoLEDAddon::configureLEDs()
 	addStaticThemes(ledOptions, animationOptions);
 	as.SetOptions(animationOptions);
 	as.SetMatrix(matrix);
+	as.SetEffectProgram(ledOptions.ledEffect.bytes, ledOptions.ledEffect.size);
 	as.SetMode(as.options.baseAnimationIndex);
 }
 
@@ -103,7 +103,7 @@ void PlayerLEDAddon::process()
 	const LEDOptions& ledOptions = Storage::getInstance().getLedOptions();
 
 	// Player LEDs can be PWM or driven by NeoPixel
-	uint8_t * featureData = Storage::getInstance().GetFeatureData();
+	uint8_t * featureData = Storage::getInstance().GetProcessedFeatureData();
 	if (ledOptions.pledType == PLED_TYPE_PWM) { // only process the feature queue if we're on PWM
 		if (pwmLEDs != nullptr)
 			pwmLEDs->display();
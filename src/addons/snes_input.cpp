@@ -2,6 +2,8 @@
 #include "storagemanager.h"
 #include "hardware/gpio.h"
 #include "helper.h"
+#include "perfstats.h"
+#include "hardware/clocks.h"
 
 bool SNESpadInput::available() {
     const SNESOptions& snesOptions = Storage::getInstance().getAddonOptions().snesOptions;
@@ -27,12 +29,26 @@ void SNESpadInput::setup() {
         snesOptions.latchPin,
         snesOptions.dataPin);
     snes->begin();
+#if SNES_PAD_PIO
+    usePIO = snes->beginPIO();
+#endif
     snes->start();
+
+    cyclesPerMicro = clock_get_hz(clk_sys) / 1000000;
+    perfSampleAge = PerfStats::addStage(name().c_str(), ".age");
+    perfSampleInterval = PerfStats::addStage(name().c_str(), ".interval");
 }
 
 void SNESpadInput::process() {
-    if (nextTimer < getMillis()) {
-        snes->poll();
+    // A PIO read is collected without waiting, so it is checked every pass
+    if (usePIO || nextTimer < getMillis()) {
+        if (snes->poll()) {
+            PerfStats::record(perfSampleInterval, (snes->sampleTime - lastSampleTime) * cyclesPerMicro);
+            lastSampleTime = snes->sampleTime;
+        }
+        if (snes->type != SNES_PAD_NONE) {
+            PerfStats::record(perfSampleAge, (time_us_32() - snes->sampleTime) * cyclesPerMicro);
+        }
 
         leftX = GAMEPAD_JOYSTICK_MID;
         leftY = GAMEPAD_JOYSTICK_MID;
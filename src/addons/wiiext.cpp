@@ -3,6 +3,8 @@
 #include "hardware/gpio.h"
 #include "helper.h"
 #include "config.pb.h"
+#include "perfstats.h"
+#include "hardware/clocks.h"
 
 bool WiiExtensionInput::available() {
     const DisplayOptions& displayOptions = Storage::getInstance().getDisplayOptions();
@@ -27,13 +29,30 @@ void WiiExtensionInput::setup() {
         options.i2cBlock == 0 ? i2c0 : i2c1,
         options.i2cSpeed,
         WII_EXTENSION_I2C_ADDR);
+#if WII_EXTENSION_ASYNC
+    wii->beginAsync();
+#else
     wii->begin();
+#endif
     wii->start();
+
+    cyclesPerMicro = clock_get_hz(clk_sys) / 1000000;
+    perfSampleAge = PerfStats::addStage(name().c_str(), ".age");
+    perfSampleInterval = PerfStats::addStage(name().c_str(), ".interval");
 }
 
 void WiiExtensionInput::process() {
-    if (nextTimer < getMillis()) {
-        wii->poll();
+    // While the alarm reads reports, poll only picks up a finished one and can run every pass. Detecting and
+    // resetting an extension blocks on the bus, so that keeps to the timer.
+    const bool asyncReading = wii->extensionType != WII_EXTENSION_NONE && wii->asyncRunning();
+    if (asyncReading || nextTimer < getMillis()) {
+        if (wii->poll()) {
+            PerfStats::record(perfSampleInterval, (wii->sampleTime - lastSampleTime) * cyclesPerMicro);
+            lastSampleTime = wii->sampleTime;
+        }
+        if (wii->extensionType != WII_EXTENSION_NONE) {
+            PerfStats::record(perfSampleAge, (time_us_32() - wii->sampleTime) * cyclesPerMicro);
+        }
         
         if (wii->extensionType == WII_EXTENSION_NUNCHUCK) {
             buttonZ = wii->buttonZ;
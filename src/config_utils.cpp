@@ -37,7 +37,10 @@
 
 #include <ArduinoJson.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cinttypes>
+#include <cstdio>
 #include <cstring>
 #include <memory>
 
@@ -300,6 +303,7 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.ledOptions, pledPin3, PLED3_PIN);
     INIT_UNSET_PROPERTY(config.ledOptions, pledPin4, PLED4_PIN);
     INIT_UNSET_PROPERTY(config.ledOptions, pledColor, static_cast<uint32_t>(PLED_COLOR.r) << 16 | static_cast<uint32_t>(PLED_COLOR.g) << 8 | static_cast<uint32_t>(PLED_COLOR.b)); 
+    INIT_UNSET_PROPERTY_BYTES(config.ledOptions, ledEffect, emptyByteArray);
 
     // animationOptions
     INIT_UNSET_PROPERTY(config.animationOptions, baseAnimationIndex, LEDS_BASE_ANIMATION_INDEX);
@@ -418,6 +422,7 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.analogADS1219Options, i2cSCLPin, I2C_ANALOG1219_SCL_PIN);
     INIT_UNSET_PROPERTY(config.addonOptions.analogADS1219Options, i2cAddress, I2C_ANALOG1219_ADDRESS);
     INIT_UNSET_PROPERTY(config.addonOptions.analogADS1219Options, i2cSpeed, I2C_ANALOG1219_SPEED);
+    INIT_UNSET_PROPERTY(config.addonOptions.analogADS1219Options, drdyPin, I2C_ANALOG1219_DRDY_PIN);
 
     // addonOptions.dualDirectionalOptions
     INIT_UNSET_PROPERTY(config.addonOptions.dualDirectionalOptions, enabled, !!DUAL_DIRECTIONAL_ENABLED);
@@ -578,13 +583,17 @@ void hotkeysMigration(Config& config)
 
 // We put a ConfigFooter struct at the end of the flash area reserved for FlashPROM. It contains a magicvalue, the size
 // of the serialized config data and a CRC of that data. This information allows us to both locate and verify the stored
-// data. The serialized data is located directly before the footer:
+// data. The serialized data is located at the start of the block:
 //
 //                       FlashPROM block
 // ┌────────────────────────────┴─────────────────────────────┐
-// ┌──────────────┬────────────────────────────────────┬──────┐
-// │Unused memory │Protobuf data                       │Footer│
-// └──────────────┴────────────────────────────────────┴──────┘
+// ┌────────────────────────────────────┬──────────────┬──────┐
+// │Protobuf data                       │Unused memory │Footer│
+// └────────────────────────────────────┴──────────────┴──────┘
+//
+// FlashPROM only writes the blocks that changed. Keeping the start of the data in place means a change that grows or
+// shrinks the data only rewrites the blocks from that point on, rather than every block of it.
+// Older firmware put the data directly before the footer, such a footer carries FOOTER_MAGIC_LEGACY.
 //
 struct ConfigFooter
 {
@@ -601,7 +610,8 @@ struct ConfigFooter
     }
 };
 
-static const uint32_t FOOTER_MAGIC = 0xd2f1e365;
+static const uint32_t FOOTER_MAGIC = 0xd2f1e366;
+static const uint32_t FOOTER_MAGIC_LEGACY = 0xd2f1e365;
 
 // Verify that the maximum size of the serialized Config object fits into the allocated flash block
 #if defined(Config_size)
@@ -614,11 +624,12 @@ static bool loadConfigInner(Config& config)
 {
     config = Config Config_init_zero;
 
-    const uint8_t* flashEnd = reinterpret_cast<const uint8_t*>(EEPROM_ADDRESS_START) + EEPROM_SIZE_BYTES;
+    // FlashPROM keeps the whole image in RAM, it is no longer laid out as-is in flash
+    const uint8_t* flashEnd = EEPROM.writeCache + EEPROM_SIZE_BYTES;
     const ConfigFooter& footer = *reinterpret_cast<const ConfigFooter*>(flashEnd - sizeof(ConfigFooter));
 
     // Check for presence of magic value
-    if (footer.magic != FOOTER_MAGIC)
+    if (footer.magic != FOOTER_MAGIC && footer.magic != FOOTER_MAGIC_LEGACY)
     {
         return false;
     }
@@ -629,7 +640,7 @@ static bool loadConfigInner(Config& config)
         return false;
     }
 
-    const uint8_t* dataPtr = flashEnd - sizeof(ConfigFooter) - footer.dataSize;
+    const uint8_t* dataPtr = footer.magic == FOOTER_MAGIC ? EEPROM.writeCache : flashEnd - sizeof(ConfigFooter) - footer.dataSize;
 
     // Verify CRC32 hash
     if (CRC32::calculate(dataPtr, footer.dataSize) != footer.dataCrc)
@@ -717,8 +728,10 @@ bool ConfigUtils::save(Config& config)
     // its default value.
     setHasFlags(Config_fields, &config);
 
-    // Encode the data directly into the cache of FlashPROM
-    pb_ostream_t outputStream = pb_ostream_from_buffer(EEPROM.writeCache, EEPROM_SIZE_BYTES - sizeof(ConfigFooter));
+    // Encode into a buffer of our own, the cache of FlashPROM is only touched when the data has changed. A running
+    // commit is abandoned by every change, and a failed or unchanged encode must not leave anything behind in it.
+    static uint8_t encodeBuffer[Config_size];
+    pb_ostream_t outputStream = pb_ostream_from_buffer(encodeBuffer, sizeof(encodeBuffer));
     if (!pb_encode(&outputStream, Config_fields, &config))
     {
         return false;
@@ -727,7 +740,7 @@ bool ConfigUtils::save(Config& config)
     // Create the new footer
     ConfigFooter newFooter;
     newFooter.dataSize = outputStream.bytes_written;
-    newFooter.dataCrc = CRC32::calculate(EEPROM.writeCache, newFooter.dataSize);
+    newFooter.dataCrc = CRC32::calculate(encodeBuffer, newFooter.dataSize);
     newFooter.magic = FOOTER_MAGIC;
 
     // The data has changed when the footer content has changed. Only then do we acutally need to save.
@@ -738,14 +751,12 @@ bool ConfigUtils::save(Config& config)
         return true;
     }
 
-    // Write the footer
+    // Copy the data, clear what is left of the previous data and write the footer
+    memcpy(EEPROM.writeCache, encodeBuffer, newFooter.dataSize);
+    memset(EEPROM.writeCache + newFooter.dataSize, 0, EEPROM_SIZE_BYTES - sizeof(ConfigFooter) - newFooter.dataSize);
     ConfigFooter* cacheFooter = reinterpret_cast<ConfigFooter*>(EEPROM.writeCache + EEPROM_SIZE_BYTES - sizeof(ConfigFooter));
     memcpy(cacheFooter, &newFooter, sizeof(ConfigFooter));
 
-    // Move the encoded data in memory down to the footer
-    memmove(EEPROM.writeCache + EEPROM_SIZE_BYTES - sizeof(ConfigFooter) - newFooter.dataSize, EEPROM.writeCache, newFooter.dataSize);
-    memset(EEPROM.writeCache, 0, EEPROM_SIZE_BYTES - sizeof(ConfigFooter) - newFooter.dataSize);
-
     EEPROM.commit();
 
     return true;
@@ -755,21 +766,88 @@ bool ConfigUtils::save(Config& config)
 // To JSON
 // -----------------------------------------------------
 
-static void writeIndentation(std::string& str, int level)
+// Receives the text produced by the toJSON functions. It either collects all of it in a string, only counts it,
+// or copies out the window [offset, offset + size) so that a response can be produced chunk by chunk without
+// ever holding all of it.
+class JsonWriter
+{
+public:
+    JsonWriter() {}
+    explicit JsonWriter(std::string& str) : str(&str) {}
+    JsonWriter(char* buffer, size_t offset, size_t size) : buffer(buffer), offset(offset), end(offset + size) {}
+
+    void append(const char* text) { append(text, strlen(text)); }
+
+    void append(const char* text, size_t length)
+    {
+        if (str)
+        {
+            str->append(text, length);
+        }
+        else if (buffer && position < end && position + length > offset)
+        {
+            const size_t from = position < offset ? offset - position : 0;
+            const size_t to = std::min(length, end - position);
+            memcpy(buffer + position + from - offset, text + from, to - from);
+        }
+        position += length;
+    }
+
+    void append(size_t count, char c)
+    {
+        while (count--)
+            append(&c, 1);
+    }
+
+    void push_back(char c) { append(&c, 1); }
+
+    // Same output as Base64::Encode without building a temporary string
+    void appendBase64(const uint8_t* data, size_t length)
+    {
+        static constexpr char encodingTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        char quad[4];
+        for (size_t i = 0; i < length; i += 3)
+        {
+            const uint32_t bits = (data[i] << 16) | (i + 1 < length ? data[i + 1] << 8 : 0) | (i + 2 < length ? data[i + 2] : 0);
+            quad[0] = encodingTable[(bits >> 18) & 0x3F];
+            quad[1] = encodingTable[(bits >> 12) & 0x3F];
+            quad[2] = i + 1 < length ? encodingTable[(bits >> 6) & 0x3F] : '=';
+            quad[3] = i + 2 < length ? encodingTable[bits & 0x3F] : '=';
+            append(quad, sizeof(quad));
+        }
+    }
+
+    // Nothing more can land in the window, the rest of the serialization can be skipped
+    bool full() const { return buffer && position >= end; }
+
+    size_t length() const { return position; }
+    size_t copied() const { return position > offset ? std::min(position, end) - offset : 0; }
+
+private:
+    std::string* str = nullptr;
+    char* buffer = nullptr;
+    size_t offset = 0;
+    size_t end = 0;
+    size_t position = 0; // Bytes produced so far
+};
+
+static void writeIndentation(JsonWriter& str, int level)
 {
-    str.append(static_cast<std::string::size_type>(level), '\t');
+    str.append(static_cast<size_t>(level), '\t');
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) appendAsString(std::string& str, int32_t value)
+static void __attribute__((noinline)) appendAsString(JsonWriter& str, int32_t value)
 {
-    str.append(std::to_string(value));
+    char text[12];
+    str.append(text, snprintf(text, sizeof(text), "%" PRId32, value));
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t value)
+static void __attribute__((noinline)) appendAsString(JsonWriter& str, uint32_t value)
 {
-    str.append(std::to_string(value));
+    char text[12];
+    str.append(text, snprintf(text, sizeof(text), "%" PRIu32, value));
 }
 
 #define TO_JSON_ENUM(fieldname, submessageType) appendAsString(str, static_cast<int32_t>(s.fieldname));
@@ -778,7 +856,7 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
 #define TO_JSON_UINT32(fieldname, submessageType) appendAsString(str, s.fieldname);
 #define TO_JSON_BOOL(fieldname, submessageType) str.append((s.fieldname) ? "true" : "false");
 #define TO_JSON_STRING(fieldname, submessageType) str.push_back('"'); str.append(s.fieldname); str.push_back('"');
-#define TO_JSON_BYTES(fieldname, submessageType) str.push_back('"'); str.append(Base64::Encode(reinterpret_cast<const char*>(s.fieldname.bytes), s.fieldname.size)); str.push_back('"');
+#define TO_JSON_BYTES(fieldname, submessageType) str.push_back('"'); str.appendBase64(s.fieldname.bytes, s.fieldname.size); str.push_back('"');
 #define TO_JSON_MESSAGE(fieldname, submessageType) PREPROCESSOR_JOIN(toJSON, submessageType)(str, s.fieldname, indentLevel + 1);
 
 #define TO_JSON_REPEATED_RENUM(fieldname, submessageType) appendAsString(str, static_cast<int32_t>(s.fieldname[i]));
@@ -814,6 +892,7 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
 #define TO_JSON_CALLBACK(htype, ltype, fieldname, submessageType) static_assert(false, "not supported");
 
 #define TO_JSON_FIELD(parenttype, atype, htype, ltype, fieldname, tag, disallow_export) \
+    if (str.full()) return; \
     if (!disallow_export) \
     { \
         if (!firstField) str.append(",\n"); \
@@ -823,10 +902,10 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
         PREPROCESSOR_JOIN(TO_JSON_, atype)(htype, ltype, fieldname, parenttype ## _ ## fieldname ## _MSGTYPE) \
     }
 
-#define GEN_TO_JSON_FUNCTION_DECL(structtype) static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel);
+#define GEN_TO_JSON_FUNCTION_DECL(structtype) static void toJSON ## structtype(JsonWriter& str, const structtype& s, int indentLevel);
 
 #define GEN_TO_JSON_FUNCTION(structtype) \
-    static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel) \
+    static void toJSON ## structtype(JsonWriter& str, const structtype& s, int indentLevel) \
     { \
         bool firstField = true; \
         str.append("{\n"); \
@@ -845,16 +924,36 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
     ENUM_MESSAGES_GP2040(GEN_TO_JSON_FUNCTION)
 #endif
 
+static void writeJSON(JsonWriter& writer, const Config& config)
+{
+    toJSONConfig(writer, config, 1);
+    writer.push_back('\n');
+}
+
 std::string ConfigUtils::toJSON(const Config& config)
 {
     std::string str;
     str.reserve(1024 * 4);
-    toJSONConfig(str, config, 1);
-    str.push_back('\n');
+    JsonWriter writer(str);
+    writeJSON(writer, config);
 
     return str;
 }
 
+size_t ConfigUtils::toJSON(const Config& config, char* buffer, size_t offset, size_t size)
+{
+    JsonWriter writer(buffer, offset, size);
+    writeJSON(writer, config);
+    return writer.copied();
+}
+
+size_t ConfigUtils::jsonLength(const Config& config)
+{
+    JsonWriter writer;
+    writeJSON(writer, config);
+    return writer.length();
+}
+
 // -----------------------------------------------------
 // From JSON
 // -----------------------------------------------------
@@ -6,14 +6,22 @@
 #include "configmanager.h"
 #include "AnimationStorage.hpp"
 #include "system.h"
+#include "perfstats.h"
+#include "gamepad/GamepadEdgeInput.h"
 #include "config_utils.h"
+#include "configs/jsonarena.h"
+#include "configs/webconfig_routes.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <vector>
 #include <memory>
+#include <new>
 
 #include <pico/types.h>
+#include <hardware/clocks.h>
 
 // HTTPD Includes
 #include <ArduinoJson.h>
@@ -35,8 +43,8 @@ using namespace std;
 
 extern struct fsdata_file file__index_html[];
 
-const static char* spaPaths[] = { "/display-config", "/led-config", "/pin-mapping", "/keyboard-mapping", "/settings", "/reset-settings", "/add-ons", "/custom-theme" };
-const static char* excludePaths[] = { "/css", "/images", "/js", "/static" };
+static constexpr const char* spaPaths[] = { "/add-ons", "/custom-theme", "/display-config", "/keyboard-mapping", "/led-config", "/pin-mapping", "/reset-settings", "/settings" };
+static constexpr const char* excludePaths[] = { "/css", "/images", "/js", "/static" };
 const static uint32_t rebootDelayMs = 500;
 static string http_post_uri;
 static char http_post_payload[LWIP_HTTPD_POST_MAX_PAYLOAD_LEN];
@@ -44,36 +52,42 @@ static uint16_t http_post_payload_len = 0;
 static absolute_time_t rebootDelayTimeout = nil_time;
 static System::BootMode rebootMode = System::BootMode::DEFAULT;
 
+// The largest document a handler builds is the splash image, one array element per byte
+static constexpr size_t splashImageDocSize = JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(sizeof(DisplayOptions_splashImage_t::bytes));
+static constexpr size_t jsonArenaSize = std::max<size_t>(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN * 2, splashImageDocSize);
+
+typedef BasicJsonDocument<JsonArenaAllocator<jsonArenaSize>> PooledJsonDocument;
+
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T, typename K>
-static void __attribute__((noinline)) readDoc(T& var, const DynamicJsonDocument& doc, const K& key)
+static void __attribute__((noinline)) readDoc(T& var, const PooledJsonDocument& doc, const K& key)
 {
 	var = doc[key];
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T, typename K0, typename K1>
-static void __attribute__((noinline)) readDoc(T& var, const DynamicJsonDocument& doc, const K0& key0, const K1& key1)
+static void __attribute__((noinline)) readDoc(T& var, const PooledJsonDocument& doc, const K0& key0, const K1& key1)
 {
 	var = doc[key0][key1];
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T, typename K0, typename K1, typename K2>
-static void __attribute__((noinline)) readDoc(T& var, const DynamicJsonDocument& doc, const K0& key0, const K1& key1, const K2& key2)
+static void __attribute__((noinline)) readDoc(T& var, const PooledJsonDocument& doc, const K0& key0, const K1& key1, const K2& key2)
 {
 	var = doc[key0][key1][key2];
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static bool __attribute__((noinline)) hasValue(const DynamicJsonDocument& doc, const char* key0, const char* key1)
+static bool __attribute__((noinline)) hasValue(const PooledJsonDocument& doc, const char* key0, const char* key1)
 {
 	return doc[key0][key1] != nullptr;
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T>
-static void __attribute__((noinline)) docToValue(T& value, const DynamicJsonDocument& doc, const char* key)
+static void __attribute__((noinline)) docToValue(T& value, const PooledJsonDocument& doc, const char* key)
 {
 	if (doc[key] != nullptr)
 	{
@@ -83,7 +97,7 @@ static void __attribute__((noinline)) docToValue(T& value, const DynamicJsonDocu
 
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T>
-static void __attribute__((noinline)) docToValue(T& value, const DynamicJsonDocument& doc, const char* key0, const char* key1)
+static void __attribute__((noinline)) docToValue(T& value, const PooledJsonDocument& doc, const char* key0, const char* key1)
 {
 	if (doc[key0][key1] != nullptr)
 	{
@@ -92,7 +106,7 @@ static void __attribute__((noinline)) docToValue(T& value, const DynamicJsonDocu
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) docToPinLegacy(uint8_t& pin, const DynamicJsonDocument& doc, const char* key)
+static void __attribute__((noinline)) docToPinLegacy(uint8_t& pin, const PooledJsonDocument& doc, const char* key)
 {
 	if (doc[key] != nullptr)
 	{
@@ -101,7 +115,7 @@ static void __attribute__((noinline)) docToPinLegacy(uint8_t& pin, const Dynamic
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) docToPin(int32_t& pin, const DynamicJsonDocument& doc, const char* key)
+static void __attribute__((noinline)) docToPin(int32_t& pin, const PooledJsonDocument& doc, const char* key)
 {
 	if (doc.containsKey(key))
 	{
@@ -115,7 +129,7 @@ static void __attribute__((noinline)) docToPin(int32_t& pin, const DynamicJsonDo
 
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T, typename K>
-static void __attribute__((noinline)) writeDoc(DynamicJsonDocument& doc, const K& key, const T& var)
+static void __attribute__((noinline)) writeDoc(PooledJsonDocument& doc, const K& key, const T& var)
 {
 	doc[key] = var;
 }
@@ -123,21 +137,21 @@ static void __attribute__((noinline)) writeDoc(DynamicJsonDocument& doc, const K
 // Don't inline this function, we do not want to consume stack space in the calling function
 // Web-config frontend compatibility workaround
 template <typename K>
-static void __attribute__((noinline)) writeDoc(DynamicJsonDocument& doc, const K& key, const bool& var)
+static void __attribute__((noinline)) writeDoc(PooledJsonDocument& doc, const K& key, const bool& var)
 {
 	doc[key] = var ? 1 : 0;
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T, typename K0, typename K1>
-static void __attribute__((noinline)) writeDoc(DynamicJsonDocument& doc, const K0& key0, const K1& key1, const T& var)
+static void __attribute__((noinline)) writeDoc(PooledJsonDocument& doc, const K0& key0, const K1& key1, const T& var)
 {
 	doc[key0][key1] = var;
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
 template <typename T, typename K0, typename K1, typename K2>
-static void __attribute__((noinline)) writeDoc(DynamicJsonDocument& doc, const K0& key0, const K1& key1, const K2& key2, const T& var)
+static void __attribute__((noinline)) writeDoc(PooledJsonDocument& doc, const K0& key0, const K1& key1, const K2& key2, const T& var)
 {
 	doc[key0][key1][key2] = var;
 }
@@ -215,14 +229,14 @@ int set_file_data(fs_file *file, string&& data)
 	return set_file_data(file, DataAndStatusCode(std::move(data), HttpStatusCode::_200));
 }
 
-DynamicJsonDocument get_post_data()
+PooledJsonDocument get_post_data()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	deserializeJson(doc, http_post_payload, http_post_payload_len);
 	return doc;
 }
 
-void save_hotkey(HotkeyEntry* hotkey, const DynamicJsonDocument& doc, const string hotkey_key)
+void save_hotkey(HotkeyEntry* hotkey, const PooledJsonDocument& doc, const string hotkey_key)
 {
 	readDoc(hotkey->auxMask, doc, hotkey_key, "auxMask");
 	uint32_t buttonsMask = doc[hotkey_key]["buttonsMask"];
@@ -245,7 +259,7 @@ void save_hotkey(HotkeyEntry* hotkey, const DynamicJsonDocument& doc, const stri
 	readDoc(hotkey->action, doc, hotkey_key, "action");
 }
 
-void load_hotkey(const HotkeyEntry* hotkey, DynamicJsonDocument& doc, const string hotkey_key)
+void load_hotkey(const HotkeyEntry* hotkey, PooledJsonDocument& doc, const string hotkey_key)
 {
 	writeDoc(doc, hotkey_key, "auxMask", hotkey->auxMask);
 	uint32_t buttonsMask = hotkey->buttonsMask;
@@ -331,7 +345,7 @@ void httpd_post_finished(void *connection, char *response_uri, uint16_t response
 	}
 }
 
-void addUsedPinsArray(DynamicJsonDocument& doc)
+void addUsedPinsArray(PooledJsonDocument& doc)
 {
 	auto usedPins = doc.createNestedArray("usedPins");
 
@@ -382,20 +396,21 @@ void addUsedPinsArray(DynamicJsonDocument& doc)
 std::string serialize_json(JsonDocument &doc)
 {
 	string data;
+	data.reserve(measureJson(doc));
 	serializeJson(doc, data);
 	return data;
 }
 
 std::string getUsedPins()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	addUsedPinsArray(doc);
 	return serialize_json(doc);
 }
 
 std::string setDisplayOptions(DisplayOptions& displayOptions)
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 	readDoc(displayOptions.enabled, doc, "enabled");
 	docToPin(displayOptions.i2cSDAPin, doc, "sdaPin");
 	docToPin(displayOptions.i2cSCLPin, doc, "sclPin");
@@ -440,7 +455,7 @@ std::string setPreviewDisplayOptions()
 
 std::string getDisplayOptions() // Manually set Document Attributes for the display
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	const DisplayOptions& displayOptions = Storage::getInstance().getDisplayOptions();
 	writeDoc(doc, "enabled", displayOptions.enabled ? 1 : 0);
 	writeDoc(doc, "sdaPin", cleanPin(displayOptions.i2cSDAPin));
@@ -474,7 +489,7 @@ std::string getDisplayOptions() // Manually set Document Attributes for the disp
 
 std::string getSplashImage()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN * 10); // TODO: Figoure out correct length
+	PooledJsonDocument doc(splashImageDocSize);
 
 	JsonArray splashImageArray = doc.createNestedArray("splashImage");
 	const DisplayOptions& displayOptions = Storage::getInstance().getDisplayOptions();
@@ -487,7 +502,7 @@ std::string getSplashImage()
 
 std::string setSplashImage()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
 	DisplayOptions& displayOptions = Storage::getInstance().getDisplayOptions();
 
@@ -506,7 +521,7 @@ std::string setSplashImage()
 
 std::string setProfileOptions()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
 	ProfileOptions& profileOptions = Storage::getInstance().getProfileOptions();
 	JsonObject options = doc.as<JsonObject>();
@@ -535,7 +550,7 @@ std::string setProfileOptions()
 
 std::string getProfileOptions()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 
 	ProfileOptions& profileOptions = Storage::getInstance().getProfileOptions();
 	JsonArray alts = doc.createNestedArray("alternativePinMappings");
@@ -560,7 +575,7 @@ std::string getProfileOptions()
 
 std::string setGamepadOptions()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
 	GamepadOptions& gamepadOptions = Storage::getInstance().getGamepadOptions();
 	readDoc(gamepadOptions.dpadMode, doc, "dpadMode");
@@ -595,7 +610,7 @@ std::string setGamepadOptions()
 
 std::string getGamepadOptions()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 
 	GamepadOptions& gamepadOptions = Storage::getInstance().getGamepadOptions();
 	writeDoc(doc, "dpadMode", gamepadOptions.dpadMode);
@@ -630,7 +645,7 @@ std::string getGamepadOptions()
 
 std::string setLedOptions()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
 	const auto readIndex = [&](int32_t& var, const char* key0, const char* key1)
 	{
@@ -673,13 +688,25 @@ std::string setLedOptions()
 	readDoc(ledOptions.pledPin4, doc, "pledPin4");
 	readDoc(ledOptions.pledColor, doc, "pledColor");
 
+	if (doc.containsKey("ledEffect"))
+	{
+		const char* encoded = nullptr;
+		std::string decoded;
+		readDoc(encoded, doc, "ledEffect");
+		if (encoded != nullptr && Base64::Decode(encoded, decoded) && decoded.length() <= sizeof(ledOptions.ledEffect.bytes))
+		{
+			memcpy(ledOptions.ledEffect.bytes, decoded.data(), decoded.length());
+			ledOptions.ledEffect.size = decoded.length();
+		}
+	}
+
 	Storage::getInstance().save();
 	return serialize_json(doc);
 }
 
 std::string getLedOptions()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	const LEDOptions& ledOptions = Storage::getInstance().getLedOptions();
 	writeDoc(doc, "dataPin", cleanPin(ledOptions.dataPin));
 	writeDoc(doc, "ledFormat", ledOptions.ledFormat);
@@ -723,13 +750,14 @@ std::string getLedOptions()
 	writeDoc(doc, "pledPin3", ledOptions.pledPin3);
 	writeDoc(doc, "pledPin4", ledOptions.pledPin4);
 	writeDoc(doc, "pledColor", ((RGB)ledOptions.pledColor).value(LED_FORMAT_RGB));
+	writeDoc(doc, "ledEffect", Base64::Encode(reinterpret_cast<const char*>(ledOptions.ledEffect.bytes), ledOptions.ledEffect.size));
 
 	return serialize_json(doc);
 }
 
 std::string setCustomTheme()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
 	AnimationOptions options = AnimationStation::options;
 
@@ -789,7 +817,7 @@ std::string setCustomTheme()
 
 std::string getCustomTheme()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	const AnimationOptions& options = AnimationStation::options;
 
 	writeDoc(doc, "enabled", options.hasCustomTheme);
@@ -835,7 +863,7 @@ std::string getCustomTheme()
 
 std::string setPinMappings()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
 	// PinMappings uses -1 to denote unassigned pins
 	const auto convertPin = [&] (const char* key) -> int32_t
@@ -873,7 +901,7 @@ std::string setPinMappings()
 
 std::string getPinMappings()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 
 	const PinMappings& pinMappings = Storage::getInstance().getPinMappings();
 	writeDoc(doc, "Up", cleanPin(pinMappings.pinDpadUp));
@@ -901,7 +929,7 @@ std::string getPinMappings()
 
 std::string setKeyMappings()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
 	KeyboardMapping& keyboardMapping = Storage::getInstance().getKeyboardMapping();
 
@@ -931,7 +959,7 @@ std::string setKeyMappings()
 
 std::string getKeyMappings()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	const KeyboardMapping& keyboardMapping = Storage::getInstance().getKeyboardMapping();
 
 	writeDoc(doc, "Up", keyboardMapping.keyDpadUp);
@@ -958,7 +986,7 @@ std::string getKeyMappings()
 
 std::string setAddonOptions()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 
     AnalogOptions& analogOptions = Storage::getInstance().getAddonOptions().analogOptions;
 	docToPin(analogOptions.analogAdc1PinX, doc, "analogAdc1PinX");
@@ -1026,6 +1054,7 @@ std::string setAddonOptions()
 	docToValue(analogADS1219Options.i2cBlock, doc, "i2cAnalog1219Block");
 	docToValue(analogADS1219Options.i2cSpeed, doc, "i2cAnalog1219Speed");
 	docToValue(analogADS1219Options.i2cAddress, doc, "i2cAnalog1219Address");
+	docToPin(analogADS1219Options.drdyPin, doc, "i2cAnalog1219DRDYPin");
 	docToValue(analogADS1219Options.enabled, doc, "I2CAnalog1219InputEnabled");
 
     SliderOptions& sliderOptions = Storage::getInstance().getAddonOptions().sliderOptions;
@@ -1125,7 +1154,7 @@ std::string setAddonOptions()
 
 std::string setPS4Options()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 	PS4Options& ps4Options = Storage::getInstance().getAddonOptions().ps4Options;
 	std::string encoded;
 	std::string decoded;
@@ -1199,7 +1228,7 @@ std::string setPS4Options()
 
 std::string getAddonOptions()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 
     const AnalogOptions& analogOptions = Storage::getInstance().getAddonOptions().analogOptions;
 	writeDoc(doc, "analogAdc1PinX", cleanPin(analogOptions.analogAdc1PinX));
@@ -1259,6 +1288,7 @@ std::string getAddonOptions()
 	writeDoc(doc, "i2cAnalog1219Block", analogADS1219Options.i2cBlock);
 	writeDoc(doc, "i2cAnalog1219Speed", analogADS1219Options.i2cSpeed);
 	writeDoc(doc, "i2cAnalog1219Address", analogADS1219Options.i2cAddress);
+	writeDoc(doc, "i2cAnalog1219DRDYPin", cleanPin(analogADS1219Options.drdyPin));
 	writeDoc(doc, "I2CAnalog1219InputEnabled", analogADS1219Options.enabled);
 
     const SliderOptions& sliderOptions = Storage::getInstance().getAddonOptions().sliderOptions;
@@ -1364,14 +1394,14 @@ std::string getAddonOptions()
 
 std::string getFirmwareVersion()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	writeDoc(doc, "version", GP2040VERSION);
 	return serialize_json(doc);
 }
 
 std::string getMemoryReport()
 {
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	writeDoc(doc, "totalFlash", System::getTotalFlash());
 	writeDoc(doc, "usedFlash", System::getUsedFlash());
 	writeDoc(doc, "staticAllocs", System::getStaticAllocs());
@@ -1380,11 +1410,82 @@ std::string getMemoryReport()
 	return serialize_json(doc);
 }
 
+// Both cores at PERF_STATS_MAX_STAGES plus the edge input histogram, well inside the arena
+static constexpr size_t perfStatsDocSize = JSON_OBJECT_SIZE(5)
+	+ 2 * (JSON_ARRAY_SIZE(PERF_STATS_MAX_STAGES) + PERF_STATS_MAX_STAGES * JSON_OBJECT_SIZE(6))
+	+ JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(GAMEPAD_EDGE_LATENCY_BUCKETS);
+
+std::string getPerfStats()
+{
+	PooledJsonDocument doc(perfStatsDocSize);
+	writeDoc(doc, "enabled", PERF_STATS_ENABLED != 0);
+	writeDoc(doc, "cyclesPerMicro", clock_get_hz(clk_sys) / 1000000);
+
+	const char* coreKeys[] = { "core0", "core1" };
+	for (uint8_t core = 0; core < 2; core++)
+	{
+		JsonArray stages = doc.createNestedArray(coreKeys[core]);
+		const PerfStatsCore* coreStats = PerfStats::getCoreStats(core);
+		if (coreStats == nullptr)
+			continue;
+
+		for (uint8_t i = 0; i < coreStats->stageCount; i++)
+		{
+			const PerfStage& stage = coreStats->stages[i];
+			JsonObject stageObj = stages.createNestedObject();
+			stageObj["name"] = static_cast<const char*>(stage.name);
+			stageObj["samples"] = stage.samples;
+			stageObj["min"] = stage.samples ? stage.minCycles : 0;
+			stageObj["avg"] = stage.getAverage();
+			stageObj["max"] = stage.maxCycles;
+			stageObj["p99"] = stage.getPercentile(99);
+		}
+	}
+
+	// Press-to-report latency, bucket n counts [2^(n-1), 2^n) microseconds
+	JsonObject edgeObj = doc.createNestedObject("edgeInput");
+	edgeObj["enabled"] = GAMEPAD_EDGE_TRIGGERED != 0;
+	const GamepadEdgeInput& edgeInput = GamepadEdgeInput::getInstance();
+	JsonArray latencyHistogram = edgeObj.createNestedArray("latencyHistogram");
+	for (uint8_t bucket = 0; bucket < GAMEPAD_EDGE_LATENCY_BUCKETS; bucket++)
+		latencyHistogram.add(edgeInput.getLatencyHistogram()[bucket]);
+	edgeObj["droppedEvents"] = edgeInput.getDroppedEvents();
+
+	return serialize_json(doc);
+}
+
 std::string getConfig()
 {
 	return ConfigUtils::toJSON(Storage::getInstance().getConfig());
 }
 
+// The response is made from a copy of the config taken when it is opened. A save while it is still being sent would
+// otherwise change the text between chunks, and it would no longer match the Content-Length sent up front.
+void* openConfig()
+{
+	Config* snapshot = new (std::nothrow) Config;
+	if (snapshot != nullptr)
+		*snapshot = Storage::getInstance().getConfig();
+	return snapshot;
+}
+
+void closeConfig(void* source)
+{
+	delete static_cast<Config*>(source);
+}
+
+size_t getConfigLength(const void* source)
+{
+	return ConfigUtils::jsonLength(*static_cast<const Config*>(source));
+}
+
+// Every chunk serializes the config again from the start up to the end of the chunk, so a response of n chunks costs
+// about n/2 full serializations. Web config mode has the CPU time to spare, not the RAM to hold the whole text.
+size_t readConfig(const void* source, char* buffer, size_t offset, size_t size)
+{
+	return ConfigUtils::toJSON(*static_cast<const Config*>(source), buffer, offset, size);
+}
+
 DataAndStatusCode setConfig()
 {
 	bool success = false;
@@ -1415,7 +1516,7 @@ DataAndStatusCode setConfig()
 std::string resetSettings()
 {
 	Storage::getInstance().ResetSettings();
-	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	PooledJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	doc["success"] = true;
 	return serialize_json(doc);
 }
@@ -1423,14 +1524,14 @@ std::string resetSettings()
 #if !defined(NDEBUG)
 std::string echo()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 	return serialize_json(doc);
 }
 #endif
 
 std::string reboot()
 {
-	DynamicJsonDocument doc = get_post_data();
+	PooledJsonDocument doc = get_post_data();
 	doc["success"] = true;
 	// We need to wait for a bit before we actually reboot to leave the webclient some time to receive the response
 	rebootDelayTimeout = make_timeout_time_ms(rebootDelayMs);
@@ -1452,80 +1553,135 @@ std::string reboot()
 }
 
 typedef std::string (*HandlerFuncPtr)();
-static const std::pair<const char*, HandlerFuncPtr> handlerFuncs[] =
+static constexpr std::pair<const char*, HandlerFuncPtr> handlerFuncs[] =
 {
-	{ "/api/setDisplayOptions", setDisplayOptions },
-	{ "/api/setPreviewDisplayOptions", setPreviewDisplayOptions },
-	{ "/api/setGamepadOptions", setGamepadOptions },
-	{ "/api/setLedOptions", setLedOptions },
-	{ "/api/setCustomTheme", setCustomTheme },
+#if !defined(NDEBUG)
+	{ "/api/echo", echo },
+#endif
+	{ "/api/getAddonsOptions", getAddonOptions },
 	{ "/api/getCustomTheme", getCustomTheme },
-	{ "/api/setPinMappings", setPinMappings },
-	{ "/api/setProfileOptions", setProfileOptions },
-	{ "/api/setKeyMappings", setKeyMappings },
-	{ "/api/setAddonsOptions", setAddonOptions },
-	{ "/api/setPS4Options", setPS4Options },
-	{ "/api/setSplashImage", setSplashImage },
-	{ "/api/reboot", reboot },
 	{ "/api/getDisplayOptions", getDisplayOptions },
+	{ "/api/getFirmwareVersion", getFirmwareVersion },
 	{ "/api/getGamepadOptions", getGamepadOptions },
+	{ "/api/getKeyMappings", getKeyMappings },
 	{ "/api/getLedOptions", getLedOptions },
+	{ "/api/getMemoryReport", getMemoryReport },
+	{ "/api/getPerfStats", getPerfStats },
 	{ "/api/getPinMappings", getPinMappings },
 	{ "/api/getProfileOptions", getProfileOptions },
-	{ "/api/getKeyMappings", getKeyMappings },
-	{ "/api/getAddonsOptions", getAddonOptions },
-	{ "/api/resetSettings", resetSettings },
 	{ "/api/getSplashImage", getSplashImage },
-	{ "/api/getFirmwareVersion", getFirmwareVersion },
-	{ "/api/getMemoryReport", getMemoryReport },
 	{ "/api/getUsedPins", getUsedPins },
-	{ "/api/getConfig", getConfig },
-#if !defined(NDEBUG)
-	{ "/api/echo", echo },
-#endif
+	{ "/api/reboot", reboot },
+	{ "/api/resetSettings", resetSettings },
+	{ "/api/setAddonsOptions", setAddonOptions },
+	{ "/api/setCustomTheme", setCustomTheme },
+	{ "/api/setDisplayOptions", setDisplayOptions },
+	{ "/api/setGamepadOptions", setGamepadOptions },
+	{ "/api/setKeyMappings", setKeyMappings },
+	{ "/api/setLedOptions", setLedOptions },
+	{ "/api/setPS4Options", setPS4Options },
+	{ "/api/setPinMappings", setPinMappings },
+	{ "/api/setPreviewDisplayOptions", setPreviewDisplayOptions },
+	{ "/api/setProfileOptions", setProfileOptions },
+	{ "/api/setSplashImage", setSplashImage },
 };
 
 typedef DataAndStatusCode (*HandlerFuncStatusCodePtr)();
-static const std::pair<const char*, HandlerFuncStatusCodePtr> handlerFuncsWithStatusCode[] =
+static constexpr std::pair<const char*, HandlerFuncStatusCodePtr> handlerFuncsWithStatusCode[] =
 {
 	{ "/api/setConfig", setConfig },
 };
 
-int fs_open_custom(struct fs_file *file, const char *name)
+// Responses that are produced chunk by chunk while lwIP drains the connection instead of being built up front.
+// open() returns the source every chunk is read from, or nullptr if it cannot be provided.
+struct StreamHandler
+{
+	void* (*open)();
+	void (*close)(void* source);
+	size_t (*length)(const void* source);
+	size_t (*read)(const void* source, char* buffer, size_t offset, size_t size);
+};
+
+static constexpr std::pair<const char*, StreamHandler> streamHandlers[] =
+{
+	{ "/api/getConfig", { openConfig, closeConfig, getConfigLength, readConfig } },
+};
+
+static_assert(isSortedByPath(handlerFuncs), "handlerFuncs must be sorted by path");
+static_assert(isSortedByPath(handlerFuncsWithStatusCode), "handlerFuncsWithStatusCode must be sorted by path");
+static_assert(isSortedByPath(streamHandlers), "streamHandlers must be sorted by path");
+static_assert(isSortedByPath(excludePaths), "excludePaths must be sorted");
+static_assert(isSortedByPath(spaPaths), "spaPaths must be sorted");
+
+// Lives in pextension of the open file, fs_close_custom closes the source and frees it
+struct StreamState
+{
+	const StreamHandler* handler;
+	void* source;
+	int headerLength;
+	char header[128];
+};
+
+static int open_stream(struct fs_file *file, const StreamHandler& handler)
 {
-	for (const auto& handlerFunc : handlerFuncs)
+	StreamState* state = static_cast<StreamState*>(mem_malloc(sizeof(StreamState)));
+	if (state == NULL)
+		return 0;
+
+	state->handler = &handler;
+	state->source = handler.open();
+	if (state->source == nullptr)
 	{
-		if (strcmp(handlerFunc.first, name) == 0)
-		{
-			return set_file_data(file, handlerFunc.second());
-		}
+		mem_free(state);
+		return 0;
 	}
 
-	for (const auto& handlerFunc : handlerFuncsWithStatusCode)
+	const size_t length = handler.length(state->source);
+	state->headerLength = snprintf(state->header, sizeof(state->header),
+		"HTTP/1.0 200 OK\r\n"
+		"Server: GP2040-CE " GP2040VERSION "\r\n"
+		"Content-Type: application/json\r\n"
+		"Content-Length: %u\r\n\r\n",
+		static_cast<unsigned>(length)
+	);
+	if (state->headerLength <= 0 || state->headerLength >= static_cast<int>(sizeof(state->header)))
 	{
-		if (strcmp(handlerFunc.first, name) == 0)
-		{
-			return set_file_data(file, handlerFunc.second());
-		}
+		handler.close(state->source);
+		mem_free(state);
+		return 0;
 	}
 
-	bool isExclude = false;
-	for (const char* excludePath : excludePaths)
-		if (strcmp(excludePath, name) == 0)
-			return 0;
+	file->data = NULL;
+	file->len = state->headerLength + length;
+	file->index = 0;
+	file->pextension = state;
+
+	return 1;
+}
+
+int fs_open_custom(struct fs_file *file, const char *name)
+{
+	if (const auto* handler = findRoute(streamHandlers, name))
+		return open_stream(file, handler->second);
 
-	for (const char* spaPath : spaPaths)
+	if (const auto* handlerFunc = findRoute(handlerFuncs, name))
+		return set_file_data(file, handlerFunc->second());
+
+	if (const auto* handlerFunc = findRoute(handlerFuncsWithStatusCode, name))
+		return set_file_data(file, handlerFunc->second());
+
+	if (findRoute(excludePaths, name))
+		return 0;
+
+	if (findRoute(spaPaths, name))
 	{
-		if (strcmp(spaPath, name) == 0)
-		{
-			file->data = (const char *)file__index_html[0].data;
-			file->len = file__index_html[0].len;
-			file->index = file__index_html[0].len;
-			file->http_header_included = file__index_html[0].http_header_included;
-			file->pextension = NULL;
-			file->is_custom_file = 0;
-			return 1;
-		}
+		file->data = (const char *)file__index_html[0].data;
+		file->len = file__index_html[0].len;
+		file->index = file__index_html[0].len;
+		file->http_header_included = file__index_html[0].http_header_included;
+		file->pextension = NULL;
+		file->is_custom_file = 0;
+		return 1;
 	}
 
 	return 0;
@@ -1535,7 +1691,28 @@ void fs_close_custom(struct fs_file *file)
 {
 	if (file && file->is_custom_file && file->pextension)
 	{
-		mem_free(file->pextension);
+		StreamState* state = static_cast<StreamState*>(file->pextension);
+		state->handler->close(state->source);
+		mem_free(state);
 		file->pextension = NULL;
 	}
 }
+
+int fs_read_custom(struct fs_file *file, char *buffer, int count)
+{
+	const StreamState* state = static_cast<const StreamState*>(file->pextension);
+	if (state == NULL || file->index >= file->len)
+		return FS_READ_EOF;
+
+	int read = 0;
+	if (file->index < state->headerLength)
+	{
+		read = std::min(count, state->headerLength - file->index);
+		memcpy(buffer, state->header + file->index, read);
+	}
+	if (read < count)
+		read += state->handler->read(state->source, buffer + read, file->index + read - state->headerLength, count - read);
+
+	file->index += read;
+	return read > 0 ? read : FS_READ_EOF;
+}
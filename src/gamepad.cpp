@@ -5,12 +5,15 @@
 
 // GP2040 Libraries
 #include "gamepad.h"
+#include "gamepad/GamepadEdgeInput.h"
 #include "enums.pb.h"
 #include "storagemanager.h"
 
 #include "FlashPROM.h"
 #include "CRC32.h"
 
+#include <stddef.h>
+
 #include "storagemanager.h"
 
 // MUST BE DEFINED for mpgs
@@ -75,6 +78,48 @@ static XInputReport xinputReport
 	._reserved = { },
 };
 
+// Dpad bits (up, down, left, right) to hat switch value, opposing directions report nothing
+#define HAT_TABLE(NOTHING) { \
+	NOTHING,           HID_HAT_UP,        HID_HAT_DOWN,      NOTHING,           \
+	HID_HAT_LEFT,      HID_HAT_UPLEFT,    HID_HAT_DOWNLEFT,  NOTHING,           \
+	HID_HAT_RIGHT,     HID_HAT_UPRIGHT,   HID_HAT_DOWNRIGHT, NOTHING,           \
+	NOTHING,           NOTHING,           NOTHING,           NOTHING            \
+}
+
+static const uint8_t hidHatTable[16] = HAT_TABLE(HID_HAT_NOTHING);
+static const uint8_t ps4HatTable[16] = HAT_TABLE(PS4_HAT_NOTHING);
+
+// B1-B4 nibble to the square/cross/circle/triangle order shared by HID, PS4 and Switch (Y/B/A/X)
+static const uint8_t faceButtonTable[16] = {
+	0x0, 0x2, 0x4, 0x6, 0x1, 0x3, 0x5, 0x7,
+	0x8, 0xA, 0xC, 0xE, 0x9, 0xB, 0xD, 0xF,
+};
+
+// S1/S2/L3/R3 nibble to XInput BACK/START/LS/RS
+static const uint8_t xinputMenuTable[16] = {
+	0x00, 0x20, 0x10, 0x30, 0x40, 0x60, 0x50, 0x70,
+	0x80, 0xA0, 0x90, 0xB0, 0xC0, 0xE0, 0xD0, 0xF0,
+};
+
+// L1 through A2 already sit at HID_MASK_L1 through HID_MASK_TP
+#define HID_PASSTHROUGH_MASK (GAMEPAD_MASK_L1 | GAMEPAD_MASK_R1 | GAMEPAD_MASK_L2 | GAMEPAD_MASK_R2 \
+	| GAMEPAD_MASK_S1 | GAMEPAD_MASK_S2 | GAMEPAD_MASK_L3 | GAMEPAD_MASK_R3 | GAMEPAD_MASK_A1 | GAMEPAD_MASK_A2)
+
+static inline uint16_t hidButtonMask(uint16_t buttons)
+{
+	return faceButtonTable[buttons & 0xF] | (buttons & HID_PASSTHROUGH_MASK);
+}
+
+// PS4Report bytes 5-8: dpad, 14 buttons, 6-bit report counter and left trigger
+#define PS4_BUTTONS_OFFSET (offsetof(PS4Report, right_stick_y) + 1)
+#define PS4_BUTTONS_SHIFT 4
+#define PS4_COUNTER_SHIFT 18
+#define PS4_LEFT_TRIGGER_SHIFT 24
+
+// Packed layout of Gamepad::pinLUT entries
+#define PIN_LUT_DPAD_SHIFT 16
+#define PIN_LUT_AUX_FUNCTION (1UL << 31)
+
 static TouchpadData touchpadData;
 static uint8_t last_report_counter = 0;
 
@@ -84,12 +129,15 @@ static KeyboardReport keyboardReport
 	.multimedia = 0
 };
 
-Gamepad::Gamepad(int debounceMS) :
+Gamepad::Gamepad(int debounceMS, DebounceMode debounceMode) :
 	debounceMS(debounceMS)
-	, debouncer(debounceMS)
+	, debouncer(debounceMS, debounceMode)
 	, options(Storage::getInstance().getGamepadOptions())
 	, hotkeyOptions(Storage::getInstance().getHotkeyOptions())
-{}
+{
+	selectReportEncoder();
+	reportedState.dpad = 0xFF; // Nothing has been reported yet
+}
 
 void Gamepad::setup()
 {
@@ -141,6 +189,47 @@ void Gamepad::setup()
 		gpio_set_dir(pinMappings.pinButtonFn, GPIO_IN); // Set as INPUT
 		gpio_pull_up(pinMappings.pinButtonFn);          // Set as PULLUP
 	}
+
+	buildPinLUT(pinMappings);
+
+#if GAMEPAD_EDGE_TRIGGERED
+	uint32_t edgePinMask = 0;
+	for (int i = 0; i < GAMEPAD_DIGITAL_INPUT_COUNT; i++)
+		edgePinMask |= gamepadMappings[i]->pinMask;
+	if (isValidPin(pinMappings.pinButtonFn))
+		edgePinMask |= 1UL << pinMappings.pinButtonFn;
+	GamepadEdgeInput::getInstance().setup(edgePinMask);
+#endif
+}
+
+/**
+ * @brief Flatten the pin mappings into per-nibble lookup tables for read().
+ */
+void Gamepad::buildPinLUT(const PinMappings& pinMappings)
+{
+	memset(pinLUT, 0, sizeof(pinLUT));
+
+	const auto addPin = [this](uint8_t pin, uint32_t packedMask) {
+		if (pin >= NUM_BANK0_GPIOS)
+			return;
+
+		const uint8_t pinBit = 1 << (pin % 4);
+		for (uint8_t value = 0; value < 16; value++) {
+			if (value & pinBit)
+				pinLUT[pin / 4][value] |= packedMask;
+		}
+	};
+
+	// First four mappings are the dpad, the rest are buttons
+	for (int i = 0; i < GAMEPAD_DIGITAL_INPUT_COUNT; i++)
+	{
+		const uint32_t packedMask = (i < 4) ?
+			(gamepadMappings[i]->buttonMask << PIN_LUT_DPAD_SHIFT) : gamepadMappings[i]->buttonMask;
+		addPin(gamepadMappings[i]->pin, packedMask);
+	}
+
+	if (isValidPin(pinMappings.pinButtonFn))
+		addPin(pinMappings.pinButtonFn, PIN_LUT_AUX_FUNCTION);
 }
 
 /**
@@ -149,6 +238,9 @@ void Gamepad::setup()
 void Gamepad::teardown_and_reinit(const uint32_t profileNum)
 {
 	const PinMappings& pinMappings = Storage::getInstance().getProfilePinMappings();
+#if GAMEPAD_EDGE_TRIGGERED
+	GamepadEdgeInput::getInstance().teardown();
+#endif
 	// deinitialize the GPIO pins so we don't have orphans
 	for (int i = 0; i < GAMEPAD_DIGITAL_INPUT_COUNT; i++)
 	{
@@ -237,36 +329,16 @@ void Gamepad::process()
 
 void Gamepad::read()
 {
-	const PinMappings& pinMappings = Storage::getInstance().getProfilePinMappings();
 	// Need to invert since we're using pullups
 	uint32_t values = ~gpio_get_all();
 
-	state.aux = 0
-		| (values & (1 << pinMappings.pinButtonFn)) ? AUX_MASK_FUNCTION : 0;
-
-	state.dpad = 0
-		| ((values & mapDpadUp->pinMask)    ? mapDpadUp->buttonMask : 0)
-		| ((values & mapDpadDown->pinMask)  ? mapDpadDown->buttonMask : 0)
-		| ((values & mapDpadLeft->pinMask)  ? mapDpadLeft->buttonMask  : 0)
-		| ((values & mapDpadRight->pinMask) ? mapDpadRight->buttonMask : 0)
-	;
+	uint32_t packed = 0;
+	for (uint8_t i = 0; i < GAMEPAD_PIN_LUT_NIBBLES; i++)
+		packed |= pinLUT[i][(values >> (i * 4)) & 0xF];
 
-	state.buttons = 0
-		| ((values & mapButtonB1->pinMask)  ? mapButtonB1->buttonMask  : 0)
-		| ((values & mapButtonB2->pinMask)  ? mapButtonB2->buttonMask  : 0)
-		| ((values & mapButtonB3->pinMask)  ? mapButtonB3->buttonMask  : 0)
-		| ((values & mapButtonB4->pinMask)  ? mapButtonB4->buttonMask  : 0)
-		| ((values & mapButtonL1->pinMask)  ? mapButtonL1->buttonMask  : 0)
-		| ((values & mapButtonR1->pinMask)  ? mapButtonR1->buttonMask  : 0)
-		| ((values & mapButtonL2->pinMask)  ? mapButtonL2->buttonMask  : 0)
-		| ((values & mapButtonR2->pinMask)  ? mapButtonR2->buttonMask  : 0)
-		| ((values & mapButtonS1->pinMask)  ? mapButtonS1->buttonMask  : 0)
-		| ((values & mapButtonS2->pinMask)  ? mapButtonS2->buttonMask  : 0)
-		| ((values & mapButtonL3->pinMask)  ? mapButtonL3->buttonMask  : 0)
-		| ((values & mapButtonR3->pinMask)  ? mapButtonR3->buttonMask  : 0)
-		| ((values & mapButtonA1->pinMask)  ? mapButtonA1->buttonMask  : 0)
-		| ((values & mapButtonA2->pinMask)  ? mapButtonA2->buttonMask  : 0)
-	;
+	state.aux = (packed & PIN_LUT_AUX_FUNCTION) ? AUX_MASK_FUNCTION : 0;
+	state.dpad = (packed >> PIN_LUT_DPAD_SHIFT) & GAMEPAD_MASK_DPAD;
+	state.buttons = packed & 0xFFFF;
 
 	state.lx = GAMEPAD_JOYSTICK_MID;
 	state.ly = GAMEPAD_JOYSTICK_MID;
@@ -400,228 +472,207 @@ void Gamepad::processHotkeyIfNewAction(GamepadHotkey action)
 }
 
 
-void * Gamepad::getReport()
-{
-	switch (options.inputMode)
-	{
-		case INPUT_MODE_XINPUT:
-			return getXInputReport();
+template<>
+void Gamepad::encodeReportAs<HIDReport>(void *report) { fillHIDReport(*static_cast<HIDReport *>(report)); }
 
-		case INPUT_MODE_SWITCH:
-			return getSwitchReport();
+template<>
+void Gamepad::encodeReportAs<SwitchReport>(void *report) { fillSwitchReport(*static_cast<SwitchReport *>(report)); }
 
-		case INPUT_MODE_PS4:
-			return getPS4Report();
+template<>
+void Gamepad::encodeReportAs<XInputReport>(void *report) { fillXInputReport(*static_cast<XInputReport *>(report)); }
 
-		case INPUT_MODE_KEYBOARD:
-			return getKeyboardReport();
+template<>
+void Gamepad::encodeReportAs<PS4Report>(void *report) { fillPS4Report(*static_cast<PS4Report *>(report)); }
 
-		default:
-			return getHIDReport();
-	}
+// The keyboard report ID carries over from the previous report, so it is built in place and copied
+template<>
+void Gamepad::encodeReportAs<KeyboardReport>(void *report) { memcpy(report, getKeyboardReport(), sizeof(KeyboardReport)); }
+
+
+template<typename Report>
+void Gamepad::useReportEncoder(const Report *reportTemplate)
+{
+	reportEncoder = &Gamepad::encodeReportAs<Report>;
+	this->reportTemplate = reportTemplate;
+	reportSize = sizeof(Report);
 }
 
 
-uint16_t Gamepad::getReportSize()
+void Gamepad::selectReportEncoder()
 {
 	switch (options.inputMode)
 	{
 		case INPUT_MODE_XINPUT:
-			return sizeof(XInputReport);
+			useReportEncoder(&xinputReport);
+			break;
 
 		case INPUT_MODE_SWITCH:
-			return sizeof(SwitchReport);
+			useReportEncoder(&switchReport);
+			break;
 
 		case INPUT_MODE_PS4:
-			return sizeof(PS4Report);
+			useReportEncoder(&ps4Report);
+			break;
 
 		case INPUT_MODE_KEYBOARD:
-			return sizeof(KeyboardReport);
+			useReportEncoder(&keyboardReport);
+			break;
 
 		default:
-			return sizeof(HIDReport);
+			useReportEncoder(&hidReport);
+			break;
 	}
 }
 
 
-HIDReport *Gamepad::getHIDReport()
+bool Gamepad::isReportDirty() const
 {
-	switch (state.dpad & GAMEPAD_MASK_DPAD)
-	{
-		case GAMEPAD_MASK_UP:                        hidReport.direction = HID_HAT_UP;        break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   hidReport.direction = HID_HAT_UPRIGHT;   break;
-		case GAMEPAD_MASK_RIGHT:                     hidReport.direction = HID_HAT_RIGHT;     break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: hidReport.direction = HID_HAT_DOWNRIGHT; break;
-		case GAMEPAD_MASK_DOWN:                      hidReport.direction = HID_HAT_DOWN;      break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  hidReport.direction = HID_HAT_DOWNLEFT;  break;
-		case GAMEPAD_MASK_LEFT:                      hidReport.direction = HID_HAT_LEFT;      break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    hidReport.direction = HID_HAT_UPLEFT;    break;
-		default:                                     hidReport.direction = HID_HAT_NOTHING;   break;
-	}
+	// PS4 reports carry a running counter and go out whenever the endpoint is free
+	if (options.inputMode == INPUT_MODE_PS4)
+		return true;
+
+	return state.dpad != reportedState.dpad
+		|| state.buttons != reportedState.buttons
+		|| state.lx != reportedState.lx
+		|| state.ly != reportedState.ly
+		|| state.rx != reportedState.rx
+		|| state.ry != reportedState.ry
+		|| state.lt != reportedState.lt
+		|| state.rt != reportedState.rt
+	;
+}
+
+
+void Gamepad::setInputMode(InputMode inputMode)
+{
+	options.inputMode = inputMode;
+	selectReportEncoder();
+}
 
-	hidReport.cross_btn    = pressedB1();
-	hidReport.circle_btn   = pressedB2();
-	hidReport.square_btn   = pressedB3();
-	hidReport.triangle_btn = pressedB4();
-	hidReport.l1_btn       = pressedL1();
-	hidReport.r1_btn       = pressedR1();
-	hidReport.l2_btn       = pressedL2();
-	hidReport.r2_btn       = pressedR2();
-	hidReport.select_btn   = pressedS1();
-	hidReport.start_btn    = pressedS2();
-	hidReport.l3_btn       = pressedL3();
-	hidReport.r3_btn       = pressedR3();
-	hidReport.ps_btn       = pressedA1();
-	hidReport.tp_btn       = pressedA2();
-
-	hidReport.l_x_axis = static_cast<uint8_t>(state.lx >> 8);
-	hidReport.l_y_axis = static_cast<uint8_t>(state.ly >> 8);
-	hidReport.r_x_axis = static_cast<uint8_t>(state.rx >> 8);
-	hidReport.r_y_axis = static_cast<uint8_t>(state.ry >> 8);
 
+HIDReport *Gamepad::getHIDReport()
+{
+	fillHIDReport(hidReport);
 	return &hidReport;
 }
 
 
+void Gamepad::fillHIDReport(HIDReport& report)
+{
+	// HID_MASK_* mirrors the button bitfields at the start of HIDReport
+	uint16_t buttons = hidButtonMask(state.buttons);
+	memcpy(&report, &buttons, sizeof(buttons));
+	report.direction = hidHatTable[state.dpad & GAMEPAD_MASK_DPAD];
+
+	report.l_x_axis = static_cast<uint8_t>(state.lx >> 8);
+	report.l_y_axis = static_cast<uint8_t>(state.ly >> 8);
+	report.r_x_axis = static_cast<uint8_t>(state.rx >> 8);
+	report.r_y_axis = static_cast<uint8_t>(state.ry >> 8);
+}
+
+
 SwitchReport *Gamepad::getSwitchReport()
 {
-	switch (state.dpad & GAMEPAD_MASK_DPAD)
-	{
-		case GAMEPAD_MASK_UP:                        switchReport.hat = SWITCH_HAT_UP;        break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   switchReport.hat = SWITCH_HAT_UPRIGHT;   break;
-		case GAMEPAD_MASK_RIGHT:                     switchReport.hat = SWITCH_HAT_RIGHT;     break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: switchReport.hat = SWITCH_HAT_DOWNRIGHT; break;
-		case GAMEPAD_MASK_DOWN:                      switchReport.hat = SWITCH_HAT_DOWN;      break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  switchReport.hat = SWITCH_HAT_DOWNLEFT;  break;
-		case GAMEPAD_MASK_LEFT:                      switchReport.hat = SWITCH_HAT_LEFT;      break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    switchReport.hat = SWITCH_HAT_UPLEFT;    break;
-		default:                                     switchReport.hat = SWITCH_HAT_NOTHING;   break;
-	}
+	fillSwitchReport(switchReport);
+	return &switchReport;
+}
 
-	switchReport.buttons = 0
-		| (pressedB1() ? SWITCH_MASK_B       : 0)
-		| (pressedB2() ? SWITCH_MASK_A       : 0)
-		| (pressedB3() ? SWITCH_MASK_Y       : 0)
-		| (pressedB4() ? SWITCH_MASK_X       : 0)
-		| (pressedL1() ? SWITCH_MASK_L       : 0)
-		| (pressedR1() ? SWITCH_MASK_R       : 0)
-		| (pressedL2() ? SWITCH_MASK_ZL      : 0)
-		| (pressedR2() ? SWITCH_MASK_ZR      : 0)
-		| (pressedS1() ? SWITCH_MASK_MINUS   : 0)
-		| (pressedS2() ? SWITCH_MASK_PLUS    : 0)
-		| (pressedL3() ? SWITCH_MASK_L3      : 0)
-		| (pressedR3() ? SWITCH_MASK_R3      : 0)
-		| (pressedA1() ? SWITCH_MASK_HOME    : 0)
-		| (pressedA2() ? SWITCH_MASK_CAPTURE : 0)
-	;
 
-	switchReport.lx = static_cast<uint8_t>(state.lx >> 8);
-	switchReport.ly = static_cast<uint8_t>(state.ly >> 8);
-	switchReport.rx = static_cast<uint8_t>(state.rx >> 8);
-	switchReport.ry = static_cast<uint8_t>(state.ry >> 8);
+void Gamepad::fillSwitchReport(SwitchReport& report)
+{
+	report.hat = hidHatTable[state.dpad & GAMEPAD_MASK_DPAD];
+	report.buttons = hidButtonMask(state.buttons);
 
-	return &switchReport;
+	report.lx = static_cast<uint8_t>(state.lx >> 8);
+	report.ly = static_cast<uint8_t>(state.ly >> 8);
+	report.rx = static_cast<uint8_t>(state.rx >> 8);
+	report.ry = static_cast<uint8_t>(state.ry >> 8);
 }
 
 
 XInputReport *Gamepad::getXInputReport()
 {
-	xinputReport.buttons1 = 0
-		| (pressedUp()    ? XBOX_MASK_UP    : 0)
-		| (pressedDown()  ? XBOX_MASK_DOWN  : 0)
-		| (pressedLeft()  ? XBOX_MASK_LEFT  : 0)
-		| (pressedRight() ? XBOX_MASK_RIGHT : 0)
-		| (pressedS2()    ? XBOX_MASK_START : 0)
-		| (pressedS1()    ? XBOX_MASK_BACK  : 0)
-		| (pressedL3()    ? XBOX_MASK_LS    : 0)
-		| (pressedR3()    ? XBOX_MASK_RS    : 0)
-	;
+	fillXInputReport(xinputReport);
+	return &xinputReport;
+}
+
+
+void Gamepad::fillXInputReport(XInputReport& report)
+{
+	// XBOX_MASK_UP through XBOX_MASK_RIGHT match the dpad bits
+	report.buttons1 = (state.dpad & GAMEPAD_MASK_DPAD)
+		| xinputMenuTable[(state.buttons >> 8) & 0xF];
 
-	xinputReport.buttons2 = 0
-		| (pressedL1() ? XBOX_MASK_LB   : 0)
-		| (pressedR1() ? XBOX_MASK_RB   : 0)
+	report.buttons2 = ((state.buttons & 0xF) << 4)
+		| ((state.buttons >> 4) & (XBOX_MASK_LB | XBOX_MASK_RB))
 		| (pressedA1() ? XBOX_MASK_HOME : 0)
-		| (pressedB1() ? XBOX_MASK_A    : 0)
-		| (pressedB2() ? XBOX_MASK_B    : 0)
-		| (pressedB3() ? XBOX_MASK_X    : 0)
-		| (pressedB4() ? XBOX_MASK_Y    : 0)
 	;
 
-	xinputReport.lx = static_cast<int16_t>(state.lx) + INT16_MIN;
-	xinputReport.ly = static_cast<int16_t>(~state.ly) + INT16_MIN;
-	xinputReport.rx = static_cast<int16_t>(state.rx) + INT16_MIN;
-	xinputReport.ry = static_cast<int16_t>(~state.ry) + INT16_MIN;
+	report.lx = static_cast<int16_t>(state.lx) + INT16_MIN;
+	report.ly = static_cast<int16_t>(~state.ly) + INT16_MIN;
+	report.rx = static_cast<int16_t>(state.rx) + INT16_MIN;
+	report.ry = static_cast<int16_t>(~state.ry) + INT16_MIN;
 
 	if (hasAnalogTriggers)
 	{
-		xinputReport.lt = state.lt;
-		xinputReport.rt = state.rt;
+		report.lt = state.lt;
+		report.rt = state.rt;
 	}
 	else
 	{
-		xinputReport.lt = pressedL2() ? 0xFF : 0;
-		xinputReport.rt = pressedR2() ? 0xFF : 0;
+		report.lt = pressedL2() ? 0xFF : 0;
+		report.rt = pressedR2() ? 0xFF : 0;
 	}
-
-	return &xinputReport;
 }
 
 
 PS4Report *Gamepad::getPS4Report()
 {
-	switch (state.dpad & GAMEPAD_MASK_DPAD)
-	{
-		case GAMEPAD_MASK_UP:                        ps4Report.dpad = HID_HAT_UP;        break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   ps4Report.dpad = HID_HAT_UPRIGHT;   break;
-		case GAMEPAD_MASK_RIGHT:                     ps4Report.dpad = HID_HAT_RIGHT;     break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: ps4Report.dpad = HID_HAT_DOWNRIGHT; break;
-		case GAMEPAD_MASK_DOWN:                      ps4Report.dpad = HID_HAT_DOWN;      break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  ps4Report.dpad = HID_HAT_DOWNLEFT;  break;
-		case GAMEPAD_MASK_LEFT:                      ps4Report.dpad = HID_HAT_LEFT;      break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    ps4Report.dpad = HID_HAT_UPLEFT;    break;
-		default:                                     ps4Report.dpad = PS4_HAT_NOTHING;   break;
-	}
-
-	ps4Report.button_south    = pressedB1();
-	ps4Report.button_east     = pressedB2();
-	ps4Report.button_west     = pressedB3();
-	ps4Report.button_north    = pressedB4();
-	ps4Report.button_l1       = pressedL1();
-	ps4Report.button_r1       = pressedR1();
-	ps4Report.button_l2       = pressedL2();
-	ps4Report.button_r2       = pressedR2();
-	ps4Report.button_select   = options.switchTpShareForDs4 ? pressedA2() : pressedS1();
-	ps4Report.button_start    = pressedS2();
-	ps4Report.button_l3       = pressedL3();
-	ps4Report.button_r3       = pressedR3();
-	ps4Report.button_home     = pressedA1();
-	ps4Report.button_touchpad = options.switchTpShareForDs4 ? pressedS1() : pressedA2();
+	fillPS4Report(ps4Report);
+	return &ps4Report;
+}
 
-	// report counter is 6 bits, but we circle 0-255
-	ps4Report.report_counter = last_report_counter++;
 
-	ps4Report.left_stick_x = static_cast<uint8_t>(state.lx >> 8);
-	ps4Report.left_stick_y = static_cast<uint8_t>(state.ly >> 8);
-	ps4Report.right_stick_x = static_cast<uint8_t>(state.rx >> 8);
-	ps4Report.right_stick_y = static_cast<uint8_t>(state.ry >> 8);
+void Gamepad::fillPS4Report(PS4Report& report)
+{
+	uint32_t buttons = hidButtonMask(state.buttons);
+	if (options.switchTpShareForDs4)
+	{
+		buttons = (buttons & ~(HID_MASK_SELECT | HID_MASK_TP))
+			| ((buttons & HID_MASK_SELECT) ? HID_MASK_TP : 0)
+			| ((buttons & HID_MASK_TP) ? HID_MASK_SELECT : 0)
+		;
+	}
 
+	uint8_t leftTrigger;
 	if (hasAnalogTriggers)
 	{
-		ps4Report.left_trigger = state.lt;
-		ps4Report.right_trigger = state.rt;
+		leftTrigger = state.lt;
+		report.right_trigger = state.rt;
 	}
 	else
 	{
-		ps4Report.left_trigger = pressedL2() ? 0xFF : 0;
-		ps4Report.right_trigger = pressedR2() ? 0xFF : 0;
+		leftTrigger = pressedL2() ? 0xFF : 0;
+		report.right_trigger = pressedR2() ? 0xFF : 0;
 	}
 
+	// report counter is 6 bits, but we circle 0-255
+	uint32_t packed = ps4HatTable[state.dpad & GAMEPAD_MASK_DPAD]
+		| (buttons << PS4_BUTTONS_SHIFT)
+		| ((last_report_counter++ & 0x3Fu) << PS4_COUNTER_SHIFT)
+		| (static_cast<uint32_t>(leftTrigger) << PS4_LEFT_TRIGGER_SHIFT)
+	;
+	memcpy(reinterpret_cast<uint8_t *>(&report) + PS4_BUTTONS_OFFSET, &packed, sizeof(packed));
+
+	report.left_stick_x = static_cast<uint8_t>(state.lx >> 8);
+	report.left_stick_y = static_cast<uint8_t>(state.ly >> 8);
+	report.right_stick_x = static_cast<uint8_t>(state.rx >> 8);
+	report.right_stick_y = static_cast<uint8_t>(state.ry >> 8);
+
 	// set touchpad to nothing
 	touchpadData.p1.unpressed = 1;
 	touchpadData.p2.unpressed = 1;
-	ps4Report.touchpad_data = touchpadData;
-
-	return &ps4Report;
+	report.touchpad_data = touchpadData;
 }
 
 uint8_t Gamepad::getModifier(uint8_t code) {
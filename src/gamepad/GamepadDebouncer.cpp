@@ -5,28 +5,64 @@
 
 #include "gamepad/GamepadDebouncer.h"
 
+#define DEBOUNCE_BITS_MASK ((1UL << DEBOUNCE_BIT_COUNT) - 1)
+
+// Run body for each set bit of mask, with the bit index in bit
+#define FOR_EACH_BIT(mask, bit) \
+	for (uint32_t _bits = (mask), bit; _bits && ((bit = __builtin_ctz(_bits)), true); _bits &= _bits - 1)
+
 void GamepadDebouncer::debounce(GamepadState *state)
 {
-	uint32_t now = getMillis();
+	const uint32_t raw = state->buttons | (static_cast<uint32_t>(state->dpad) << DEBOUNCE_DPAD_SHIFT);
+	const uint32_t result = debounceBits(raw, static_cast<uint32_t>(getMicro()));
+
+	state->dpad = (result >> DEBOUNCE_DPAD_SHIFT) & GAMEPAD_MASK_DPAD;
+	state->buttons = result & 0xFFFF;
+}
 
-	for (int i = 0; i < 4; i++)
+uint32_t GamepadDebouncer::debounceBits(uint32_t raw, uint32_t now)
+{
+	raw &= DEBOUNCE_BITS_MASK;
+
+	// Release eager bits whose lockout window has passed
+	FOR_EACH_BIT(lockedMask, bit)
 	{
-		if ((debounceState.dpad & dpadMasks[i]) != (state->dpad & dpadMasks[i]) && (now - dpadTime[i]) > debounceMS)
-		{
-			debounceState.dpad ^= dpadMasks[i];
-			dpadTime[i] = now;
-		}
+		if ((now - bitTime[bit]) >= debounceUs)
+			lockedMask &= ~(1UL << bit);
 	}
 
-	for (int i = 0; i < GAMEPAD_BUTTON_COUNT; i++)
+	const uint32_t changed = (raw ^ debounced) & ~lockedMask;
+
+	uint32_t eagerSelect;
+	switch (mode)
+	{
+		case DEBOUNCE_MODE_DEFER:      eagerSelect = 0;   break;
+		case DEBOUNCE_MODE_ASYMMETRIC: eagerSelect = raw; break; // presses only
+		default:                       eagerSelect = ~0U; break;
+	}
+
+	// Eager changes are reported now and lock the bit
+	const uint32_t eagerBits = changed & eagerSelect;
+	debounced ^= eagerBits;
+	lockedMask |= eagerBits;
+	FOR_EACH_BIT(eagerBits, bit)
+		bitTime[bit] = now;
+
+	// Deferred changes restart their timer whenever the input bounces back
+	const uint32_t deferBits = changed & ~eagerSelect;
+	pendingMask &= deferBits;
+	FOR_EACH_BIT(deferBits & ~pendingMask, bit)
+		bitTime[bit] = now;
+	pendingMask |= deferBits;
+
+	FOR_EACH_BIT(pendingMask, bit)
 	{
-		if ((debounceState.buttons & buttonMasks[i]) != (state->buttons & buttonMasks[i]) && (now - buttonTime[i]) > debounceMS)
+		if ((now - bitTime[bit]) >= debounceUs)
 		{
-			debounceState.buttons ^= buttonMasks[i];
-			buttonTime[i] = now;
+			debounced ^= (1UL << bit);
+			pendingMask &= ~(1UL << bit);
 		}
 	}
 
-	state->dpad = debounceState.dpad;
-	state->buttons = debounceState.buttons;
+	return debounced;
 }
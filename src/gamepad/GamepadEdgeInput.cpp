@@ -0,0 +1,118 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2021 Jason Skuby (mytechtoybox.com)
+ */
+
+#include "gamepad/GamepadEdgeInput.h"
+
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#define GAMEPAD_EDGE_EVENTS (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+
+void GamepadEdgeInput::setup(uint32_t mask)
+{
+	teardown();
+
+	pinMask = mask;
+	head = tail = 0;
+	if (pinMask == 0)
+		return;
+
+	gpio_add_raw_irq_handler_masked(pinMask, &GamepadEdgeInput::irqHandler);
+	for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+	{
+		if (pinMask & (1UL << pin))
+			gpio_set_irq_enabled(pin, GAMEPAD_EDGE_EVENTS, true);
+	}
+	irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void GamepadEdgeInput::teardown()
+{
+	if (pinMask == 0)
+		return;
+
+	for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+	{
+		if (pinMask & (1UL << pin))
+			gpio_set_irq_enabled(pin, GAMEPAD_EDGE_EVENTS, false);
+	}
+	gpio_remove_raw_irq_handler_masked(pinMask, &GamepadEdgeInput::irqHandler);
+	pinMask = 0;
+}
+
+void GamepadEdgeInput::irqHandler()
+{
+	GamepadEdgeInput& edgeInput = getInstance();
+	const uint32_t timestamp = time_us_32();
+
+	for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+	{
+		if (edgeInput.pinMask & (1UL << pin))
+		{
+			const uint32_t events = gpio_get_irq_event_mask(pin) & GAMEPAD_EDGE_EVENTS;
+			if (events)
+				gpio_acknowledge_irq(pin, events);
+		}
+	}
+
+	const uint32_t next = (edgeInput.head + 1) & (GAMEPAD_EDGE_QUEUE_SIZE - 1);
+	if (next == edgeInput.tail)
+	{
+		edgeInput.droppedEvents = edgeInput.droppedEvents + 1;
+	}
+	else
+	{
+		edgeInput.queue[edgeInput.head] = { timestamp, ~gpio_get_all() };
+		__dmb();
+		edgeInput.head = next;
+	}
+
+	// Wake the core0 loop if it is waiting for the next poll
+	__sev();
+}
+
+/**
+ * @brief Consume queued edges, starting a latency measurement at the oldest one.
+ *
+ * @return true if any edges were queued.
+ */
+bool GamepadEdgeInput::drain()
+{
+	if (!pending())
+		return false;
+
+	if (!reportPending)
+	{
+		reportPending = true;
+		reportPendingSince = queue[tail].timestamp;
+	}
+
+	while (tail != head)
+	{
+		lastEvent = queue[tail];
+		tail = (tail + 1) & (GAMEPAD_EDGE_QUEUE_SIZE - 1);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Close the latency measurement for the edges drained since the last report.
+ */
+void GamepadEdgeInput::reportSent()
+{
+	if (!reportPending)
+		return;
+
+	const uint32_t latency = time_us_32() - reportPendingSince;
+	uint8_t bucket = latency ? (32 - __builtin_clz(latency)) : 0;
+	if (bucket >= GAMEPAD_EDGE_LATENCY_BUCKETS)
+		bucket = GAMEPAD_EDGE_LATENCY_BUCKETS - 1;
+
+	latencyHistogram[bucket]++;
+	reportPending = false;
+}
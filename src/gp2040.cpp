@@ -8,6 +8,8 @@
 #include "configmanager.h" // Global Managers
 #include "storagemanager.h"
 #include "addonmanager.h"
+#include "gamepad/GamepadEdgeInput.h"
+#include "perfstats.h"
 
 #include "addons/analog.h" // Inputs for Core0
 #include "addons/bootsel_button.h"
@@ -29,6 +31,7 @@
 #include "pico/bootrom.h"
 #include "pico/time.h"
 #include "hardware/adc.h"
+#include "hardware/clocks.h"
 
 // TinyUSB
 #include "usb_driver.h"
@@ -36,12 +39,35 @@
 
 #define GAMEPAD_DEBOUNCE_MILLIS 5 // make this a class object
 
+#ifndef GAMEPAD_DEBOUNCE_MODE
+#define GAMEPAD_DEBOUNCE_MODE DEBOUNCE_MODE_EAGER // DEBOUNCE_MODE_EAGER, DEBOUNCE_MODE_DEFER, DEBOUNCE_MODE_ASYMMETRIC
+#endif
+
+#if GAMEPAD_SOF_SYNC && GAMEPAD_EDGE_TRIGGERED
+#error "GAMEPAD_SOF_SYNC and GAMEPAD_EDGE_TRIGGERED cannot be used together"
+#endif
+
+#if GAMEPAD_SOF_SYNC
+// Suffix for the per input mode input age stage
+static const char* getInputModeName(InputMode inputMode) {
+	switch (inputMode) {
+		case INPUT_MODE_XINPUT: return "xinput";
+		case INPUT_MODE_SWITCH: return "switch";
+		case INPUT_MODE_PS4: return "ps4";
+		case INPUT_MODE_KEYBOARD: return "keyboard";
+		default: return "hid";
+	}
+}
+#endif
+
 static const uint32_t REBOOT_HOTKEY_ACTIVATION_TIME_MS = 50;
 static const uint32_t REBOOT_HOTKEY_HOLD_TIME_MS = 4000;
 
-GP2040::GP2040() : nextRuntime(0) {
-	Storage::getInstance().SetGamepad(new Gamepad(GAMEPAD_DEBOUNCE_MILLIS));
-	Storage::getInstance().SetProcessedGamepad(new Gamepad(GAMEPAD_DEBOUNCE_MILLIS));
+GP2040::GP2040() : nextRuntime(0),
+	perfStages({ PERF_STATS_NONE, PERF_STATS_NONE, PERF_STATS_NONE, PERF_STATS_NONE,
+		PERF_STATS_NONE, PERF_STATS_NONE, PERF_STATS_NONE, PERF_STATS_NONE, PERF_STATS_NONE }) {
+	Storage::getInstance().SetGamepad(new Gamepad(GAMEPAD_DEBOUNCE_MILLIS, GAMEPAD_DEBOUNCE_MODE));
+	Storage::getInstance().SetProcessedGamepad(new Gamepad(GAMEPAD_DEBOUNCE_MILLIS, GAMEPAD_DEBOUNCE_MODE));
 }
 
 GP2040::~GP2040() {
@@ -99,9 +125,35 @@ void GP2040::setup() {
 			}
 	}
 
+	// Prime the endpoint buffers with the constant fields of the active report
+	init_report_buffers(gamepad->getReportTemplate(), gamepad->getReportSize());
+
 	// Initialize our ADC (various add-ons)
 	adc_init();
 
+	// Profile the gamepad loop only, web config keeps the previous session for inspection
+	if (!Storage::getInstance().GetConfigMode()) {
+		PerfStats::start();
+		perfStages.loop = PerfStats::addStage("loop");
+		perfStages.read = PerfStats::addStage("read");
+		perfStages.debounce = PerfStats::addStage("debounce");
+		perfStages.hotkey = PerfStats::addStage("hotkey");
+		perfStages.process = PerfStats::addStage("process");
+		perfStages.sendReport = PerfStats::addStage("send_report");
+		perfStages.tudTask = PerfStats::addStage("tud_task");
+		perfStages.flashCommit = PerfStats::addStage("flash_commit"); // Longest stall config saves add to a pass
+	#if GAMEPAD_SOF_SYNC
+		perfStages.inputAge = PerfStats::addStage("input_age_", getInputModeName(gamepad->getOptions().inputMode));
+	#endif
+	}
+
+#if GAMEPAD_SOF_SYNC
+	sofAwaitingPoll = false;
+	cyclesPerMicro = clock_get_hz(clk_sys) / 1000000;
+	if (!Storage::getInstance().GetConfigMode())
+		set_usb_sof_tracking(true);
+#endif
+
 	// Setup Add-ons
   	addons.LoadAddon(new KeyboardHostAddon(), CORE0_INPUT);
 	addons.LoadAddon(new AnalogInput(), CORE0_INPUT);
@@ -122,14 +174,17 @@ void GP2040::setup() {
 
 void GP2040::run() {
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
-	Gamepad * processedGamepad = Storage::getInstance().GetProcessedGamepad();
 	bool configMode = Storage::getInstance().GetConfigMode();
+#if GAMEPAD_EDGE_TRIGGERED
+	GamepadEdgeInput& edgeInput = GamepadEdgeInput::getInstance();
+#endif
 	while (1) { // LOOP
 		Storage::getInstance().performEnqueuedSaves();
 		// Config Loop (Web-Config does not require gamepad)
 		if (configMode == true) {
 			ConfigManager& configManager = ConfigManager::getInstance();
 			ConfigManager::getInstance().loop();
+			EEPROM.process();
 
 			gamepad->read();
 			rebootHotkeys.process(gamepad, configMode);
@@ -137,43 +192,133 @@ void GP2040::run() {
 			continue;
 		}
 
+#if GAMEPAD_EDGE_TRIGGERED
+		// A button edge runs the loop right away, otherwise sleep until the next poll
+		if (nextRuntime > getMicro() && !edgeInput.pending()) { // fix for unsigned
+			best_effort_wfe_or_timeout(from_us_since_boot(nextRuntime));
+			continue;
+		}
+		edgeInput.drain();
+#elif GAMEPAD_SOF_SYNC
+		recordInputAge();
+		if (nextRuntime > getMicro()) { // fix for unsigned
+			sleep_until(from_us_since_boot(nextRuntime)); // Timer alarm, sleep_us(50) would add its own jitter
+			continue;
+		}
+#else
 		if (nextRuntime > getMicro()) { // fix for unsigned
 			sleep_us(50); // Give some time back to our CPU (lower power consumption)
 			continue;
 		}
+#endif
+
+		const uint32_t perfLoopStart = PerfStats::now();
+		uint32_t perfStart = perfLoopStart;
+
+	#if GAMEPAD_SOF_SYNC
+		const uint64_t sampleTime = getMicro();
+	#endif
 
 		// Gamepad Features
 		gamepad->read(); 	// gpio pin reads
+		perfStart = PerfStats::lap(perfStages.read, perfStart);
 	#if GAMEPAD_DEBOUNCE_MILLIS > 0
 		gamepad->debounce();
+		perfStart = PerfStats::lap(perfStages.debounce, perfStart);
 	#endif
 		gamepad->hotkey(); 	// check for MPGS hotkeys
 		rebootHotkeys.process(gamepad, configMode);
+		PerfStats::lap(perfStages.hotkey, perfStart);
 
 		// Pre-Process add-ons for MPGS
 		addons.PreprocessAddons(ADDON_PROCESS::CORE0_INPUT);
-		
+
+		perfStart = PerfStats::now();
 		gamepad->process(); // process through MPGS
+		PerfStats::lap(perfStages.process, perfStart);
 
 		// (Post) Process for add-ons
 		addons.ProcessAddons(ADDON_PROCESS::CORE0_INPUT);
 
-		// Copy Processed Gamepad for Core1 (race condition otherwise)
-		memcpy(&processedGamepad->state, &gamepad->state, sizeof(GamepadState));
-
 		// USB FEATURES : Send/Get USB Features (including Player LEDs on X-Input)
-		send_report(gamepad->getReport(), gamepad->getReportSize());
+		perfStart = PerfStats::now();
+		bool reportSent = false;
+		if (gamepad->isReportDirty()) {
+			// Encode straight into the driver's free endpoint buffer, nothing to do when the state is unchanged
+			gamepad->encodeReport(get_report_buffer());
+			reportSent = send_report(gamepad->getReportSize());
+			if (reportSent)
+				gamepad->markReportSent();
+		}
+		PerfStats::lap(perfStages.sendReport, perfStart);
+	#if GAMEPAD_SOF_SYNC
+		if (reportSent) {
+			sofSampleTime = sampleTime;
+			sofAwaitingPoll = true;
+		}
+	#elif GAMEPAD_EDGE_TRIGGERED
+		// Edges that have not reached the host yet stay pending until a report actually goes out
+		if (reportSent)
+			edgeInput.reportSent();
+	#else
+		(void)reportSent;
+	#endif
 		Storage::getInstance().ClearFeatureData();
 		receive_report(Storage::getInstance().GetFeatureData());
 
+		// Hand the processed state and feature data to core1 without waiting on it
+		Storage::getInstance().PublishProcessedGamepad(gamepad->state);
+
 		// Process USB Reports
 		addons.ProcessAddons(ADDON_PROCESS::CORE0_USBREPORT);
 
+		perfStart = PerfStats::now();
 		tud_task(); // TinyUSB Task update
+		PerfStats::lap(perfStages.tudTask, perfStart);
+		PerfStats::lap(perfStages.loop, perfLoopStart);
+
+		// Persist config changes one page program or sector erase per pass, right after the report went out
+		perfStart = PerfStats::now();
+		if (EEPROM.process())
+			PerfStats::lap(perfStages.flashCommit, perfStart);
 
+	#if GAMEPAD_SOF_SYNC
+		nextRuntime = nextSofRuntime(getMicro());
+	#else
 		nextRuntime = getMicro() + GAMEPAD_POLL_MICRO;
+	#endif
+	}
+}
+
+#if GAMEPAD_SOF_SYNC
+uint64_t GP2040::nextSofRuntime(uint64_t now) {
+	uint64_t sofTime;
+	uint32_t frameMicro;
+	if (!get_usb_sof(&sofTime, &frameMicro)) {
+		// Unmounted or suspended, fall back to the free running poll
+		return now + GAMEPAD_POLL_MICRO;
+	}
+
+	// Start the pass just ahead of the next frame so the endpoint holds fresh input when the host polls
+	uint64_t target = sofTime + frameMicro - GAMEPAD_SOF_LEAD_MICRO;
+	while (target <= now) {
+		target += frameMicro;
 	}
+	return target;
+}
+
+void GP2040::recordInputAge() {
+	uint64_t sofTime;
+	uint32_t frameMicro;
+	if (!sofAwaitingPoll || !get_usb_sof(&sofTime, &frameMicro) || sofTime <= sofSampleTime) {
+		return;
+	}
+
+	// The report was armed before this frame started, the host poll lands in it
+	sofAwaitingPoll = false;
+	PerfStats::record(perfStages.inputAge, static_cast<uint32_t>(sofTime - sofSampleTime) * cyclesPerMicro);
 }
+#endif
 
 GP2040::BootAction GP2040::getBootAction() {
 	switch (System::takeBootMode()) {
@@ -4,6 +4,7 @@
 
 #include "storagemanager.h" // Global Managers
 #include "addonmanager.h"
+#include "perfstats.h"
 
 #include "addons/i2cdisplay.h" // Add-Ons
 #include "addons/neopicoleds.h"
@@ -14,13 +15,18 @@
 
 #include <iterator>
 
-GP2040Aux::GP2040Aux() : nextRuntime(0) {
+GP2040Aux::GP2040Aux() : perfLoopStage(PERF_STATS_NONE) {
 }
 
 GP2040Aux::~GP2040Aux() {
 }
 
 void GP2040Aux::setup() {
+	if (!Storage::getInstance().GetConfigMode()) {
+		PerfStats::start();
+		perfLoopStage = PerfStats::addStage("loop");
+	}
+
 	addons.LoadAddon(new I2CDisplayAddon(), CORE1_LOOP);
 	addons.LoadAddon(new NeoPicoLEDAddon(), CORE1_LOOP);
 	addons.LoadAddon(new PlayerLEDAddon(), CORE1_LOOP);
@@ -31,11 +37,14 @@ void GP2040Aux::setup() {
 
 void GP2040Aux::run() {
 	while (1) {
-		if (nextRuntime > getMicro()) { // fix for unsigned
-			sleep_us(50); // Give some time back to our CPU (lower power consumption)
-			continue;
+		const uint32_t perfStart = PerfStats::now();
+		Storage::getInstance().SyncProcessedGamepad();
+		const uint64_t nextDue = addons.ProcessDueAddons(CORE1_LOOP);
+		PerfStats::lap(perfLoopStage, perfStart);
+
+		// Sleep until the earliest addon deadline rather than waking every poll to check them all
+		if (nextDue > getMicro()) {
+			sleep_until(from_us_since_boot(nextDue));
 		}
-		addons.ProcessAddons(CORE1_LOOP);
-		nextRuntime = getMicro() + GAMEPAD_POLL_MICRO;
 	}
 }
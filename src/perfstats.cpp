@@ -0,0 +1,124 @@
+#include "perfstats.h"
+
+#include <cstring>
+
+#include "pico/platform.h"
+#include "hardware/sync.h"
+
+#define PERF_STATS_MAGIC 0x50524631
+#define PERF_STATS_CYCLE_MASK 0x00FFFFFF
+
+uint32_t PerfStage::getPercentile(uint8_t percent) const {
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < PERF_STATS_BUCKETS; i++) {
+        count += histogram[i];
+    }
+
+    const uint32_t target = (count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < PERF_STATS_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= target && histogram[i] != 0) {
+            if (i == 0) {
+                return 15;
+            }
+            // Upper bound of the bucket, see record() for the layout
+            const uint8_t msb = 4 + (i - 1) / 2;
+            const uint32_t upper = (1UL << msb) + (((i - 1) % 2) + 1) * (1UL << (msb - 1)) - 1;
+            return upper < maxCycles ? upper : maxCycles;
+        }
+    }
+    return maxCycles;
+}
+
+#if PERF_STATS_ENABLED
+
+static PerfStatsCore __uninitialized_ram(perfStatsCores)[2];
+static bool recording[2] = { false, false };
+
+const PerfStatsCore* PerfStats::getCoreStats(uint8_t core) {
+    if (core > 1 || perfStatsCores[core].magic != PERF_STATS_MAGIC ||
+        perfStatsCores[core].stageCount > PERF_STATS_MAX_STAGES) {
+        return nullptr;
+    }
+    return &perfStatsCores[core];
+}
+
+void PerfStats::start() {
+    const uint core = get_core_num();
+    memset(&perfStatsCores[core], 0, sizeof(PerfStatsCore));
+    perfStatsCores[core].magic = PERF_STATS_MAGIC;
+
+    // SysTick is per core, free running on the processor clock
+    systick_hw->rvr = PERF_STATS_CYCLE_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // ENABLE | CLKSOURCE
+    recording[core] = true;
+}
+
+uint8_t PerfStats::addStage(const char* name, const char* suffix) {
+    const uint core = get_core_num();
+    PerfStatsCore& stats = perfStatsCores[core];
+    if (!recording[core] || stats.stageCount >= PERF_STATS_MAX_STAGES) {
+        return PERF_STATS_NONE;
+    }
+
+    PerfStage& stage = stats.stages[stats.stageCount];
+    strncpy(stage.name, name, PERF_STATS_NAME_LENGTH - 1);
+    if (suffix != nullptr) {
+        const size_t length = strlen(stage.name);
+        strncpy(stage.name + length, suffix, PERF_STATS_NAME_LENGTH - 1 - length);
+    }
+    stage.minCycles = UINT32_MAX;
+    return stats.stageCount++;
+}
+
+uint32_t PerfStats::lap(uint8_t stageIndex, uint32_t start) {
+    const uint32_t end = now();
+    if (stageIndex >= perfStatsCores[get_core_num()].stageCount) {
+        return end;
+    }
+
+    record(stageIndex, (start - end) & PERF_STATS_CYCLE_MASK);
+
+    // Exclude the bookkeeping from the next stage
+    return now();
+}
+
+void PerfStats::record(uint8_t stageIndex, uint32_t cycles) {
+    const uint core = get_core_num();
+    if (stageIndex >= perfStatsCores[core].stageCount) {
+        return;
+    }
+
+    PerfStage& stage = perfStatsCores[core].stages[stageIndex];
+    stage.samples++;
+    stage.totalCycles += cycles;
+    if (cycles < stage.minCycles) stage.minCycles = cycles;
+    if (cycles > stage.maxCycles) stage.maxCycles = cycles;
+
+    // Bucket 0 holds [0, 16), then two buckets per power of two
+    uint8_t bucket = 0;
+    if (cycles >= 16) {
+        const uint8_t msb = 31 - __builtin_clz(cycles);
+        bucket = 1 + (msb - 4) * 2 + ((cycles >> (msb - 1)) & 1);
+        if (bucket >= PERF_STATS_BUCKETS) {
+            bucket = PERF_STATS_BUCKETS - 1;
+        }
+    }
+
+    if (stage.histogram[bucket] == UINT16_MAX) {
+        for (uint8_t i = 0; i < PERF_STATS_BUCKETS; i++) {
+            stage.histogram[i] >>= 1;
+        }
+    }
+    stage.histogram[bucket]++;
+}
+
+#else
+
+const PerfStatsCore* PerfStats::getCoreStats(uint8_t core) {
+    return nullptr;
+}
+
+#endif
@@ -130,6 +130,7 @@ void Storage::enqueueAnimationOptionsSave(const AnimationOptions& animationOptio
 void Storage::ResetSettings()
 {
 	EEPROM.reset();
+	EEPROM.flush();
 	watchdog_reboot(0, SRAM_END, 2000);
 }
 
@@ -196,6 +197,27 @@ Gamepad * Storage::GetProcessedGamepad()
 	return processedGamepad;
 }
 
+void Storage::PublishProcessedGamepad(const GamepadState& state)
+{
+	PublishedGamepadData data;
+	data.state = state;
+	memcpy(data.featureData, featureData, sizeof(data.featureData));
+	publishedGamepad.write(data);
+}
+
+uint32_t Storage::SyncProcessedGamepad()
+{
+	const uint32_t version = publishedGamepad.read(processedGamepadData);
+	if (processedGamepad != nullptr)
+		processedGamepad->state = processedGamepadData.state;
+	return version;
+}
+
+uint8_t * Storage::GetProcessedFeatureData()
+{
+	return processedGamepadData.featureData;
+}
+
 void Storage::SetFeatureData(uint8_t * newData)
 {
 	memcpy(newData, featureData, sizeof(uint8_t)*sizeof(featureData));
@@ -7,23 +7,28 @@
 
 #include <malloc.h>
 
+#include "FlashPROM.h"
+
 extern char __flash_binary_start;
 extern char __flash_binary_end;
 extern char __bss_end__;
 extern char __StackLimit;
 extern char __StackTop;
 
+// The FlashPROM journal sits at a fixed address at the end of the first 2MB, the program can never grow past it
 uint32_t System::getTotalFlash() {
+    const uint32_t journalEnd = EEPROM_JOURNAL_START + EEPROM_JOURNAL_SIZE - XIP_BASE;
 #if defined(PICO_FLASH_SIZE_BYTES)
-    return PICO_FLASH_SIZE_BYTES;
+    return PICO_FLASH_SIZE_BYTES < journalEnd ? PICO_FLASH_SIZE_BYTES : journalEnd;
 #else
     #warning PICO_FLASH_SIZE_BYTES is not set, defaulting to 2MB
     return 2 * 1024 * 1024;
 #endif
 }
 
+// The program image plus the flash reserved for the FlashPROM journal
 uint32_t System::getUsedFlash() {
-    return &__flash_binary_end - &__flash_binary_start;
+    return (&__flash_binary_end - &__flash_binary_start) + EEPROM_JOURNAL_SIZE;
 }
 
 uint32_t System::getStaticAllocs() {
@@ -41,6 +46,9 @@ uint32_t System::getUsedHeap() {
 }
 
 void System::reboot(BootMode bootMode) {
+    // Write out any config change that is still pending
+    EEPROM.flush();
+
     // Make sure that the other core is halted
     // We do not want it to be talking to devices (e.g. OLED display) while we reboot
 	multicore_lockout_start_timeout_us(0xfffffffffffffff);
@@ -0,0 +1,91 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Throughput of CRC32 against the nibble table implementation it replaced, on buffers the size of
+ * the configs ConfigUtils and AnimationStore checksum, checking both agree on every buffer.
+ *
+ *   bench_crc32 [--repeat N]
+ *
+ * Timings are host nanoseconds. They show the gain of the table path, not RP2040 cycle counts or
+ * the DMA sniffer, which only runs on the target.
+ */
+
+#include "CRC32.h"
+
+#include "reference_crc32.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+#define TIMING_ROUNDS 5
+
+namespace
+{
+	template<typename T>
+	inline void keep(T& value) { asm volatile("" : : "g"(&value) : "memory"); }
+
+	// Nanoseconds per call of body, the fastest of the rounds since a descheduled round only ever adds time
+	double timeCalls(int calls, const std::function<void()>& body)
+	{
+		using namespace std::chrono;
+		double best = 0;
+		for (int round = 0; round <= TIMING_ROUNDS; round++) {
+			const auto start = steady_clock::now();
+			for (int i = 0; i < calls; i++)
+				body();
+			const double ns = duration<double, std::nano>(steady_clock::now() - start).count() / calls;
+			if (round == 1 || (round > 1 && ns < best))
+				best = ns; // round 0 warms up
+		}
+		return best;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int repeats = 200;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: bench_crc32 [--repeat N]\n");
+			return 2;
+		}
+	}
+
+	std::mt19937 rng(1);
+	std::vector<uint8_t> buffer(8192);
+	for (uint8_t& byte : buffer)
+		byte = rng() & 0xff;
+
+	// AnimationOptions is a few dozen bytes, a serialized Config one or two KB, the FlashPROM image 8 KB
+	const uint32_t sizes[] = { 64, 256, 1024, 2048, 4096, 8192 };
+	bool ok = true;
+	printf("  %-8s %12s %12s %12s %12s %8s\n", "bytes", "ns", "reference", "MB/s", "ref MB/s", "speedup");
+	for (uint32_t size : sizes) {
+		uint32_t crc = 0;
+		uint32_t reference = 0;
+		const double ns = timeCalls(repeats, [&]() {
+			CRC32 engine;
+			engine.update(buffer.data(), size);
+			crc = engine.finalize();
+			keep(crc);
+		});
+		const double referenceNs = timeCalls(repeats, [&]() {
+			reference = Reference::crc32(buffer.data(), size);
+			keep(reference);
+		});
+		ok &= crc == reference;
+		printf("  %-8u %12.1f %12.1f %12.1f %12.1f %7.1fx%s\n", size, ns, referenceNs,
+			size * 1000.0 / ns, size * 1000.0 / referenceNs, referenceNs / ns, crc == reference ? "" : "  MISMATCH");
+	}
+
+	printf(ok ? "every checksum matches the reference\n" : "MISMATCH against the reference\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,325 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Replays button traces through Gamepad::read/debounce/hotkey/process and every report encoder,
+ * reporting nanoseconds per stage and checking the read and report stages against the reference
+ * pipeline in support/reference_gamepad.cpp.
+ *
+ *   bench_input [--frames N] [--repeat N] [trace files...]
+ *
+ * Timings are host nanoseconds. They show relative cost between stages and against the reference,
+ * not RP2040 cycle counts. Debounce has its own reference in test_debouncer.
+ */
+
+#include "gamepad.h"
+#include "storagemanager.h"
+
+#include "button_trace.h"
+#include "host_sdk.h"
+#include "host_storage.h"
+#include "reference_gamepad.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#define BENCH_POLL_US GAMEPAD_POLL_MICRO
+#define TIMING_ROUNDS 5
+
+namespace
+{
+	template<typename T>
+	inline void keep(T& value) { asm volatile("" : : "g"(&value) : "memory"); }
+
+	struct ModeInfo
+	{
+		InputMode mode;
+		const char *name;
+	};
+
+	const ModeInfo modes[] = {
+		{ INPUT_MODE_XINPUT,   "xinput" },
+		{ INPUT_MODE_SWITCH,   "switch" },
+		{ INPUT_MODE_HID,      "hid" },
+		{ INPUT_MODE_PS4,      "ps4" },
+		{ INPUT_MODE_KEYBOARD, "keyboard" },
+	};
+
+	// Per trace frame, the state going into each stage
+	struct Recording
+	{
+		std::vector<uint32_t> levels;
+		std::vector<uint64_t> times;
+		std::vector<GamepadState> debounceIn;
+		std::vector<GamepadState> hotkeyIn;
+		std::vector<GamepadState> processIn;
+		std::vector<GamepadState> reportIn;
+	};
+
+	struct Equivalence
+	{
+		size_t frames = 0;
+		size_t mismatches = 0;
+		void check(bool same) { frames++; mismatches += same ? 0 : 1; }
+	};
+
+	uint64_t clockOffset = 0;
+
+	// Nanoseconds per call of body over the recording, less the cost of an empty loop doing the same setup
+	double timeStage(size_t frames, int repeats, const std::function<void(size_t)>& setup, const std::function<void(size_t)>& body)
+	{
+		using namespace std::chrono;
+		const auto run = [&](bool withBody) {
+			const auto start = steady_clock::now();
+			for (int r = 0; r < repeats; r++) {
+				for (size_t i = 0; i < frames; i++) {
+					setup(i);
+					if (withBody)
+						body(i);
+				}
+			}
+			return duration<double, std::nano>(steady_clock::now() - start).count();
+		};
+
+		// Interleave the rounds and keep the fastest of each, a descheduled round only ever adds time
+		run(true); // warm up
+		double overhead = run(false);
+		double total = run(true);
+		for (int round = 1; round < TIMING_ROUNDS; round++) {
+			overhead = std::min(overhead, run(false));
+			total = std::min(total, run(true));
+		}
+		const double perCall = (total - overhead) / (frames * repeats);
+		return perCall > 0 ? perCall : 0;
+	}
+
+	// Timestamps keep moving forward across passes, debounce windows are measured against them
+	void setTime(uint64_t traceTime)
+	{
+		HostSDK::advanceTo(clockOffset + traceTime);
+	}
+
+	void nextPass(const ButtonTrace& trace)
+	{
+		clockOffset += trace.samples.back().timeUs + 1000000;
+	}
+
+	bool sameBytes(const void *a, const void *b, size_t size) { return memcmp(a, b, size) == 0; }
+
+	void reportBench(Gamepad& gamepad, const ButtonTrace& trace, int repeats, bool& ok)
+	{
+		const PinMappings& pinMappings = Storage::getInstance().getProfilePinMappings();
+		const KeyboardMapping& keyboardMapping = Storage::getInstance().getKeyboardMapping();
+		const size_t frames = trace.samples.size();
+
+		Recording rec;
+		rec.levels.resize(frames);
+		rec.times.resize(frames);
+		rec.debounceIn.resize(frames);
+		rec.hotkeyIn.resize(frames);
+		rec.processIn.resize(frames);
+		rec.reportIn.resize(frames);
+
+		// Run the pipeline once, recording each stage's input and checking read against the reference
+		Equivalence readEquivalence;
+		for (size_t i = 0; i < frames; i++) {
+			const TraceSample& sample = trace.samples[i];
+			rec.times[i] = sample.timeUs;
+			setTime(sample.timeUs);
+			HostSDK::setPressedPins(sample.pressedPins);
+			rec.levels[i] = HostSDK::getGpioLevels();
+
+			gamepad.read();
+			GamepadState expected;
+			Reference::read(expected, rec.levels[i], pinMappings);
+			readEquivalence.check(gamepad.state.dpad == expected.dpad && gamepad.state.buttons == expected.buttons
+				&& gamepad.state.aux == expected.aux);
+
+			rec.debounceIn[i] = gamepad.state;
+			gamepad.debounce();
+			rec.hotkeyIn[i] = gamepad.state;
+			gamepad.hotkey();
+			rec.processIn[i] = gamepad.state;
+			gamepad.process();
+			rec.reportIn[i] = gamepad.state;
+		}
+		nextPass(trace);
+
+		printf("trace %s: %zu frames, %d repeats\n", trace.name.c_str(), frames, repeats);
+		printf("  %-16s %12s %12s %14s\n", "stage", "ns/frame", "reference", "equivalence");
+
+		double readNs = timeStage(frames, repeats,
+			[&](size_t i) { HostSDK::setGpioLevels(rec.levels[i]); },
+			[&](size_t) { gamepad.read(); keep(gamepad.state); });
+		GamepadState refState;
+		double refReadNs = timeStage(frames, repeats,
+			[&](size_t i) { HostSDK::setGpioLevels(rec.levels[i]); },
+			[&](size_t i) { Reference::read(refState, rec.levels[i], pinMappings); keep(refState); });
+		printf("  %-16s %12.1f %12.1f %8zu/%zu\n", "read", readNs, refReadNs,
+			readEquivalence.frames - readEquivalence.mismatches, readEquivalence.frames);
+		ok &= readEquivalence.mismatches == 0;
+
+		double debounceNs = timeStage(frames, repeats,
+			[&](size_t i) { setTime(rec.times[i]); gamepad.state = rec.debounceIn[i]; },
+			[&](size_t) { gamepad.debounce(); keep(gamepad.state); });
+		nextPass(trace);
+		printf("  %-16s %12.1f %12s %14s\n", "debounce", debounceNs, "-", "-");
+
+		double hotkeyNs = timeStage(frames, repeats,
+			[&](size_t i) { gamepad.state = rec.hotkeyIn[i]; },
+			[&](size_t) { gamepad.hotkey(); keep(gamepad.state); });
+		printf("  %-16s %12.1f %12s %14s\n", "hotkey", hotkeyNs, "-", "-");
+
+		double processNs = timeStage(frames, repeats,
+			[&](size_t i) { gamepad.state = rec.processIn[i]; },
+			[&](size_t) { gamepad.process(); keep(gamepad.state); });
+		printf("  %-16s %12.1f %12s %14s\n", "process", processNs, "-", "-");
+
+		const InputMode savedMode = gamepad.getOptions().inputMode;
+		for (const ModeInfo& info : modes) {
+			gamepad.setInputMode(info.mode);
+
+			// Reports built by get*Report() and by encodeReport() into a primed buffer must both match
+			Equivalence reportEquivalence;
+			uint8_t encoded[64];
+			uint8_t ps4Counter = 0;
+			bool ps4CounterKnown = false;
+			for (size_t i = 0; i < frames; i++) {
+				gamepad.state = rec.reportIn[i];
+				memcpy(encoded, gamepad.getReportTemplate(), gamepad.getReportSize());
+				gamepad.encodeReport(encoded);
+
+				switch (info.mode) {
+					case INPUT_MODE_XINPUT: {
+						XInputReport expected = Reference::xinputReportTemplate;
+						Reference::fillXInputReport(gamepad.state, gamepad.hasAnalogTriggers, expected);
+						reportEquivalence.check(sameBytes(gamepad.getXInputReport(), &expected, sizeof(expected))
+							&& sameBytes(encoded, &expected, sizeof(expected)));
+						break;
+					}
+					case INPUT_MODE_SWITCH: {
+						SwitchReport expected = Reference::switchReportTemplate;
+						Reference::fillSwitchReport(gamepad.state, expected);
+						reportEquivalence.check(sameBytes(gamepad.getSwitchReport(), &expected, sizeof(expected))
+							&& sameBytes(encoded, &expected, sizeof(expected)));
+						break;
+					}
+					case INPUT_MODE_HID: {
+						HIDReport expected = Reference::hidReportTemplate;
+						Reference::fillHIDReport(gamepad.state, expected);
+						reportEquivalence.check(sameBytes(gamepad.getHIDReport(), &expected, sizeof(expected))
+							&& sameBytes(encoded, &expected, sizeof(expected)));
+						break;
+					}
+					case INPUT_MODE_PS4: {
+						// The counter is shared by every PS4 report built so far, follow it from the first one
+						if (!ps4CounterKnown) {
+							ps4Counter = reinterpret_cast<const PS4Report *>(encoded)->report_counter;
+							ps4CounterKnown = true;
+						}
+						PS4Report fromEncoder = Reference::ps4ReportTemplate;
+						Reference::fillPS4Report(gamepad.state, gamepad.getOptions(), gamepad.hasAnalogTriggers, ps4Counter++, fromEncoder);
+						PS4Report fromGetter = Reference::ps4ReportTemplate;
+						Reference::fillPS4Report(gamepad.state, gamepad.getOptions(), gamepad.hasAnalogTriggers, ps4Counter++, fromGetter);
+						reportEquivalence.check(sameBytes(encoded, &fromEncoder, sizeof(fromEncoder))
+							&& sameBytes(gamepad.getPS4Report(), &fromGetter, sizeof(fromGetter)));
+						break;
+					}
+					case INPUT_MODE_KEYBOARD: {
+						KeyboardReport expected = Reference::keyboardReportTemplate;
+						Reference::fillKeyboardReport(gamepad.state, keyboardMapping, expected);
+						const KeyboardReport *actual = gamepad.getKeyboardReport();
+						reportEquivalence.check(sameBytes(actual->keycode, expected.keycode, sizeof(expected.keycode))
+							&& actual->multimedia == expected.multimedia
+							&& sameBytes(encoded, actual, sizeof(KeyboardReport)));
+						break;
+					}
+					default:
+						break;
+				}
+			}
+
+			double reportNs = timeStage(frames, repeats,
+				[&](size_t i) { gamepad.state = rec.reportIn[i]; },
+				[&](size_t) { gamepad.encodeReport(encoded); keep(encoded); });
+
+			double refReportNs = timeStage(frames, repeats,
+				[&](size_t i) { gamepad.state = rec.reportIn[i]; },
+				[&](size_t) {
+					switch (info.mode) {
+						case INPUT_MODE_XINPUT: Reference::fillXInputReport(gamepad.state, false, *reinterpret_cast<XInputReport *>(encoded)); break;
+						case INPUT_MODE_SWITCH: Reference::fillSwitchReport(gamepad.state, *reinterpret_cast<SwitchReport *>(encoded)); break;
+						case INPUT_MODE_HID:    Reference::fillHIDReport(gamepad.state, *reinterpret_cast<HIDReport *>(encoded)); break;
+						case INPUT_MODE_PS4:    Reference::fillPS4Report(gamepad.state, gamepad.getOptions(), false, 0, *reinterpret_cast<PS4Report *>(encoded)); break;
+						default:                Reference::fillKeyboardReport(gamepad.state, keyboardMapping, *reinterpret_cast<KeyboardReport *>(encoded)); break;
+					}
+					keep(encoded);
+				});
+
+			char label[32];
+			snprintf(label, sizeof(label), "report %s", info.name);
+			printf("  %-16s %12.1f %12.1f %8zu/%zu\n", label, reportNs, refReportNs,
+				reportEquivalence.frames - reportEquivalence.mismatches, reportEquivalence.frames);
+			ok &= reportEquivalence.mismatches == 0;
+		}
+		gamepad.setInputMode(savedMode);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	size_t frames = 20000;
+	int repeats = 5;
+	std::vector<ButtonTrace> traces;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+			frames = strtoul(argv[++i], nullptr, 10);
+		} else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else {
+			ButtonTrace trace;
+			if (!loadTrace(argv[i], trace)) {
+				fprintf(stderr, "cannot read trace %s\n", argv[i]);
+				return 2;
+			}
+			traces.push_back(trace);
+		}
+	}
+
+	HostSDK::reset();
+	HostStorage::resetConfig();
+
+	if (traces.empty()) {
+		const PinMappings& pinMappings = Storage::getInstance().getProfilePinMappings();
+		const std::vector<uint8_t> pins = {
+			(uint8_t)pinMappings.pinDpadUp, (uint8_t)pinMappings.pinDpadDown,
+			(uint8_t)pinMappings.pinDpadLeft, (uint8_t)pinMappings.pinDpadRight,
+			(uint8_t)pinMappings.pinButtonB1, (uint8_t)pinMappings.pinButtonB2,
+			(uint8_t)pinMappings.pinButtonB3, (uint8_t)pinMappings.pinButtonB4,
+			(uint8_t)pinMappings.pinButtonL1, (uint8_t)pinMappings.pinButtonR1,
+			(uint8_t)pinMappings.pinButtonL2, (uint8_t)pinMappings.pinButtonR2,
+			(uint8_t)pinMappings.pinButtonA1, 22, 26, // and two unmapped pins
+		};
+		traces.push_back(makeTrace(TRACE_IDLE, pins, frames, BENCH_POLL_US, 1));
+		traces.push_back(makeTrace(TRACE_MASH, pins, frames, BENCH_POLL_US, 2));
+		traces.push_back(makeTrace(TRACE_SOCD, pins, frames, BENCH_POLL_US, 3));
+		traces.push_back(makeTrace(TRACE_HOTKEYS, pins, frames, BENCH_POLL_US, 4));
+	}
+
+	Gamepad gamepad(5);
+	gamepad.setup();
+
+	bool ok = true;
+	for (const ButtonTrace& trace : traces) {
+		HostStorage::resetConfig();
+		reportBench(gamepad, trace, repeats, ok);
+	}
+
+	printf(ok ? "all stages match the reference\n" : "MISMATCH against the reference\n");
+	return ok ? 0 : 1;
+}
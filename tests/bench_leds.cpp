@@ -0,0 +1,155 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Cost of one NeoPicoLEDAddon::process() LED tick, from the button state to a drawn frame, on the
+ * flat PixelMatrix against the nested layout and pressed vectors it replaced, with the heap
+ * allocations of each. Runs the stickless layout at two LEDs per button in the static color effect
+ * and checks both paths draw the same frame every tick.
+ *
+ *   bench_leds [--repeat N]
+ *
+ * Timings are host nanoseconds and show the gain, not RP2040 cycle counts. The flat path must
+ * not allocate at all, the bench fails if it does.
+ */
+
+#include "AnimationStation.hpp"
+#include "GamepadState.h"
+
+#include "host_heap.h"
+#include "reference_leds.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#define TIMING_ROUNDS 5
+#define STATES 256
+
+namespace
+{
+	template<typename T>
+	inline void keep(T& value) { asm volatile("" : : "g"(&value) : "memory"); }
+
+	// Nanoseconds per call of body, the fastest of the rounds since a descheduled round only ever adds time
+	double timeCalls(int calls, const std::function<void()>& body)
+	{
+		using namespace std::chrono;
+		double best = 0;
+		for (int round = 0; round <= TIMING_ROUNDS; round++) {
+			const auto start = steady_clock::now();
+			for (int i = 0; i < calls; i++)
+				body();
+			const double ns = duration<double, std::nano>(steady_clock::now() - start).count() / calls;
+			if (round == 1 || (round > 1 && ns < best))
+				best = ns; // round 0 warms up
+		}
+		return best;
+	}
+
+	// Heap allocations per call of body
+	double countAllocations(int calls, const std::function<void()>& body)
+	{
+		HostHeap::reset();
+		for (int i = 0; i < calls; i++)
+			body();
+		return (double)HostHeap::allocations() / calls;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int repeats = 20;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: bench_leds [--repeat N]\n");
+			return 2;
+		}
+	}
+
+	// Every button on its own LED pair, in the order of the stickless rows
+	std::map<uint32_t, int> ledIndex;
+	for (const std::vector<uint32_t> &row : ReferenceLeds::sticklessMasks) {
+		for (uint32_t mask : row) {
+			if (mask != 0)
+				ledIndex.emplace(mask, ledIndex.size());
+		}
+	}
+	const ReferenceLeds::Layout layout = ReferenceLeds::makeLayout(ReferenceLeds::sticklessMasks, ledIndex, 2);
+
+	// Zero to three buttons held, a few frames of play
+	std::mt19937 rng(1);
+	std::vector<uint32_t> states(STATES);
+	for (uint32_t &state : states) {
+		state = 0;
+		for (int held = rng() % 4; held > 0; held--) {
+			auto button = ledIndex.begin();
+			std::advance(button, rng() % ledIndex.size());
+			state |= button->first;
+		}
+	}
+
+	AnimationOptions options = {};
+	options.staticColorIndex = 2;
+	options.buttonColorIndex = 10;
+	AnimationStation::options = options;
+
+	PixelMatrix matrix;
+	matrix.setup(layout, 2);
+	AnimationStation as;
+	as.SetMatrix(matrix);
+	as.SetMode(EFFECT_STATIC_COLOR);
+	ReferenceLeds::Station reference(layout);
+	RGB referenceFrame[100] = {};
+
+	size_t tick = 0;
+	auto flat = [&]() {
+		const uint32_t pressed = matrix.getPressed(states[tick++ % STATES]);
+		if (pressed != 0)
+			as.HandlePressed(pressed);
+		else
+			as.ClearPressed();
+		as.Animate();
+		keep(as.frame);
+	};
+	auto nested = [&]() {
+		std::vector<Pixel> pressed = ReferenceLeds::pressedPixels(layout, states[tick++ % STATES]);
+		if (!pressed.empty())
+			reference.handlePressed(pressed);
+		else
+			reference.clearPressed();
+		reference.drawColor(colors[options.staticColorIndex], false, referenceFrame);
+		reference.drawColor(colors[options.buttonColorIndex], true, referenceFrame);
+		keep(referenceFrame);
+	};
+
+	bool ok = true;
+	for (int i = 0; i < STATES; i++) {
+		tick = i;
+		flat();
+		tick = i;
+		nested();
+		ok &= !memcmp(as.frame, referenceFrame, sizeof(referenceFrame));
+	}
+
+	const int calls = repeats * STATES;
+	const double ns = timeCalls(calls, flat);
+	const double referenceNs = timeCalls(calls, nested);
+	const double allocations = countAllocations(STATES, flat);
+	const double referenceAllocations = countAllocations(STATES, nested);
+	ok &= allocations == 0;
+
+	printf("  %-10s %12s %12s\n", "path", "ns/tick", "allocs/tick");
+	printf("  %-10s %12.1f %12.2f\n", "flat", ns, allocations);
+	printf("  %-10s %12.1f %12.2f\n", "nested", referenceNs, referenceAllocations);
+	printf("  speedup %.1fx\n", referenceNs / ns);
+
+	printf(ok ? "every frame matches the reference, the flat path never allocates\n" : "MISMATCH against the reference, or the flat path allocated\n");
+	return ok ? 0 : 1;
+}
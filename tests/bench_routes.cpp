@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Cost of resolving a web config request path: the binary search over the sorted route tables
+ * against the strcmp scan it replaced, for every route, for the SPA pages and for paths that miss,
+ * checking both give the same answer. fs_open_custom tries the handler table, then the SPA pages.
+ *
+ *   bench_routes [--repeat N]
+ *
+ * Timings are host nanoseconds, they show the relative gain and not RP2040 cycle counts.
+ */
+
+#include "configs/webconfig_routes.h"
+
+#include "webconfig_paths.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#define TIMING_ROUNDS 5
+
+namespace
+{
+	template<typename T>
+	inline void keep(T& value) { asm volatile("" : : "g"(&value) : "memory"); }
+
+	// Nanoseconds per call of body, the fastest of the rounds since a descheduled round only ever adds time
+	double timeCalls(int calls, const std::function<void()>& body)
+	{
+		using namespace std::chrono;
+		double best = 0;
+		for (int round = 0; round <= TIMING_ROUNDS; round++) {
+			const auto start = steady_clock::now();
+			for (int i = 0; i < calls; i++)
+				body();
+			const double ns = duration<double, std::nano>(steady_clock::now() - start).count() / calls;
+			if (round == 1 || (round > 1 && ns < best))
+				best = ns; // round 0 warms up
+		}
+		return best;
+	}
+
+	struct PathSet
+	{
+		const char *name;
+		std::vector<const char *> paths;
+	};
+
+	// What fs_open_custom does with a path, -1 when neither table has it
+	int sortedLookup(const char *path)
+	{
+		if (const auto *route = findRoute(WebConfigPaths::api, path))
+			return route->second;
+		if (const auto *page = findRoute(WebConfigPaths::spa, path))
+			return 100 + static_cast<int>(page - WebConfigPaths::spa);
+		return -1;
+	}
+
+	int scanLookup(const char *path)
+	{
+		if (const auto *route = WebConfigPaths::linearScan(WebConfigPaths::api, path))
+			return route->second;
+		if (const auto *page = WebConfigPaths::linearScan(WebConfigPaths::spa, path))
+			return 100 + static_cast<int>(page - WebConfigPaths::spa);
+		return -1;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int repeats = 2000;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: bench_routes [--repeat N]\n");
+			return 2;
+		}
+	}
+
+	PathSet sets[] = {
+		{ "api", {} },
+		{ "spa", {} },
+		{ "miss", { "/", "/index.html", "/css/main.css", "/js/app.js", "/images/logo.png", "/api/getConfig", "/api/setConfig", "/favicon.ico" } },
+	};
+	for (const auto& route : WebConfigPaths::api)
+		sets[0].paths.push_back(route.first);
+	for (const char *page : WebConfigPaths::spa)
+		sets[1].paths.push_back(page);
+
+	bool ok = true;
+	printf("  %-6s %6s %12s %12s %8s\n", "paths", "count", "sorted ns", "scan ns", "speedup");
+	for (const PathSet& set : sets) {
+		for (const char *path : set.paths)
+			ok &= sortedLookup(path) == scanLookup(path);
+
+		int result = 0;
+		const double sortedNs = timeCalls(repeats, [&]() {
+			for (const char *path : set.paths) {
+				result = sortedLookup(path);
+				keep(result);
+			}
+		}) / set.paths.size();
+		const double scanNs = timeCalls(repeats, [&]() {
+			for (const char *path : set.paths) {
+				result = scanLookup(path);
+				keep(result);
+			}
+		}) / set.paths.size();
+		printf("  %-6s %6zu %12.1f %12.1f %7.1fx\n", set.name, set.paths.size(), sortedNs, scanNs, scanNs / sortedNs);
+	}
+
+	printf(ok ? "every path resolves the same way\n" : "MISMATCH between the lookups\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for TinyUSB's class/hid/hid.h, the HID types live in the stub tusb.h
+ */
+
+#ifndef _HOST_CLASS_HID_H_
+#define _HOST_CLASS_HID_H_
+
+#include "tusb.h"
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for TinyUSB's class/hid/hid_device.h, see host_sdk.h
+ *
+ * hidd_open() takes the interface's endpoints, the first IN endpoint carries tud_hid_report().
+ */
+
+#ifndef _HOST_CLASS_HID_DEVICE_H_
+#define _HOST_CLASS_HID_DEVICE_H_
+
+#include "class/hid/hid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void hidd_init(void);
+void hidd_reset(uint8_t rhport);
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const *desc_itf, uint16_t max_len);
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request);
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
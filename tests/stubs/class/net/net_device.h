@@ -0,0 +1,25 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for TinyUSB's class/net/net_device.h, the network class is not modelled
+ */
+
+#ifndef _HOST_CLASS_NET_DEVICE_H_
+#define _HOST_CLASS_NET_DEVICE_H_
+
+#include "tusb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void netd_init(void);
+void netd_reset(uint8_t rhport);
+uint16_t netd_open(uint8_t rhport, tusb_desc_interface_t const *itf_desc, uint16_t max_len);
+bool netd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request);
+bool netd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
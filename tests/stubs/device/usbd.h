@@ -0,0 +1,11 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for TinyUSB's device/usbd.h, see host_sdk.h
+ */
+
+#ifndef _HOST_USBD_H_
+#define _HOST_USBD_H_
+
+#include "tusb.h"
+
+#endif
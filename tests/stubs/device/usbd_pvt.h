@@ -0,0 +1,36 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for TinyUSB's device/usbd_pvt.h, see host_sdk.h
+ */
+
+#ifndef _HOST_USBD_PVT_H_
+#define _HOST_USBD_PVT_H_
+
+#include "tusb.h"
+
+typedef struct {
+	char const *name;
+	void (*init)(void);
+	void (*reset)(uint8_t rhport);
+	uint16_t (*open)(uint8_t rhport, tusb_desc_interface_t const *desc_intf, uint16_t max_len);
+	bool (*control_xfer_cb)(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request);
+	bool (*xfer_cb)(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+	void (*sof)(uint8_t rhport, uint32_t frame_count);
+} usbd_class_driver_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const *desc_ep);
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr);
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr);
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint16_t total_bytes);
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr);
+void usbd_sof_enable(uint8_t rhport, bool en);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
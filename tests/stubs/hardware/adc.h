@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/adc.h, see host_sdk.h
+ *
+ * Inputs read what HostSDK::setAdcSource() gives for the time a conversion finishes. adc_read()
+ * lets one conversion time pass on the virtual clock. Run free, the ADC converts every 96 cycles of
+ * its 48MHz clock, or the divider's period when that is longer, stepping through the round-robin
+ * mask upwards from the selected input. Results of both queue in the 4 deep FIFO when it is enabled,
+ * ones that find it full are lost and set OVER in fcs. DMA reading fifo pops it, paced by DREQ_ADC
+ * at the conversion rate.
+ */
+
+#ifndef _HOST_HARDWARE_ADC_H_
+#define _HOST_HARDWARE_ADC_H_
+
+#include "pico/platform.h"
+
+#define NUM_ADC_CHANNELS 5
+
+#define ADC_FCS_OVER_BITS 0x00000800u
+
+// Only the registers the firmware touches, in the hardware order
+typedef struct {
+	volatile uint32_t cs;
+	volatile uint32_t result;
+	volatile uint32_t fcs;
+	volatile uint32_t fifo;
+	volatile uint32_t div;
+} adc_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern adc_hw_t host_adc_hw;
+
+#ifdef __cplusplus
+}
+#endif
+
+#define adc_hw (&host_adc_hw)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+void adc_set_round_robin(uint input_mask);
+uint16_t adc_read(void);
+void adc_run(bool run);
+void adc_set_clkdiv(float clkdiv);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_fifo_drain(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/address_mapped.h, see host_sdk.h
+ *
+ * The set, clear and xor aliases of a register are plain read-modify-writes of the stub register.
+ */
+
+#ifndef _HOST_HARDWARE_ADDRESS_MAPPED_H_
+#define _HOST_HARDWARE_ADDRESS_MAPPED_H_
+
+#include "pico/platform.h"
+
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+typedef volatile uint32_t io_wo_32;
+
+static inline void hw_set_bits(io_rw_32 *addr, uint32_t mask) { *addr |= mask; }
+static inline void hw_clear_bits(io_rw_32 *addr, uint32_t mask) { *addr &= ~mask; }
+static inline void hw_xor_bits(io_rw_32 *addr, uint32_t mask) { *addr ^= mask; }
+
+static inline void hw_write_masked(io_rw_32 *addr, uint32_t values, uint32_t write_mask)
+{
+	*addr = (*addr & ~write_mask) | (values & write_mask);
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/dma.h, see host_sdk.h
+ *
+ * A triggered channel moves one element each time its DREQ comes up on the virtual clock, see
+ * HostSDK::setDreqPeriod(), or its whole transfer at once for DREQ_FORCE. When it is done it triggers
+ * its chain_to channel. Words written to an I2C controller's data_cmd go to the I2C model, see hardware/i2c.h,
+ * and reads of the ADC fifo pop its FIFO, see hardware/adc.h. A channel writing another one's read_addr or
+ * write_addr, or the al3_read_addr_trig and al2_write_addr_trig aliases that also trigger it, moves a whole
+ * host pointer, so a control channel can restart a data channel as on the hardware.
+ * The sniffer follows the reads of its channel in the CRC32 modes, seeded from sniff_data when the channel
+ * is triggered, and shows its result in sniff_data after every transfer with OUT_REV and OUT_INV applied.
+ */
+
+#ifndef _HOST_HARDWARE_DMA_H_
+#define _HOST_HARDWARE_DMA_H_
+
+#include "pico/platform.h"
+#include "hardware/address_mapped.h"
+
+#define DREQ_PIO0_TX0 0
+#define DREQ_PIO1_TX0 8
+#define DREQ_PIO0_RX0 4
+#define DREQ_PIO1_RX0 12
+#define DREQ_ADC 36
+#define DREQ_FORCE 63
+
+#define DMA_SNIFF_CTRL_EN_BITS 0x00000001u
+#define DMA_SNIFF_CTRL_DMACH_LSB 1
+#define DMA_SNIFF_CTRL_DMACH_BITS 0x0000001eu
+#define DMA_SNIFF_CTRL_CALC_LSB 5
+#define DMA_SNIFF_CTRL_CALC_BITS 0x000001e0u
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32 0x0
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32R 0x1
+#define DMA_SNIFF_CTRL_OUT_REV_BITS 0x00000400u
+#define DMA_SNIFF_CTRL_OUT_INV_BITS 0x00000800u
+
+enum dma_channel_transfer_size {
+	DMA_SIZE_8 = 0,
+	DMA_SIZE_16 = 1,
+	DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+	uint32_t ctrl;
+} dma_channel_config;
+
+typedef struct {
+	volatile uint32_t read_addr;
+	volatile uint32_t write_addr;
+	volatile uint32_t transfer_count;
+	volatile uint32_t ctrl_trig;
+	volatile uint32_t al1_ctrl;
+	volatile uint32_t al1_read_addr;
+	volatile uint32_t al1_write_addr;
+	volatile uint32_t al1_transfer_count_trig;
+	volatile uint32_t al2_ctrl;
+	volatile uint32_t al2_transfer_count;
+	volatile uint32_t al2_read_addr;
+	volatile uint32_t al2_write_addr_trig;
+	volatile uint32_t al3_ctrl;
+	volatile uint32_t al3_write_addr;
+	volatile uint32_t al3_transfer_count;
+	volatile uint32_t al3_read_addr_trig;
+} dma_channel_hw_t;
+
+// Addresses are kept as full pointers on the host, the 32 bit registers above are not used for them
+typedef struct {
+	dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+	volatile uint32_t sniff_ctrl;
+	volatile uint32_t sniff_data;
+} dma_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern dma_hw_t host_dma_hw;
+
+#ifdef __cplusplus
+}
+#endif
+
+#define dma_hw (&host_dma_hw)
+
+// Layout of dma_channel_config.ctrl, private to the stubs
+#define HOST_DMA_CTRL_SIZE_SHIFT 0
+#define HOST_DMA_CTRL_INCR_READ  (1u << 2)
+#define HOST_DMA_CTRL_INCR_WRITE (1u << 3)
+#define HOST_DMA_CTRL_SNIFF      (1u << 4)
+#define HOST_DMA_CTRL_DREQ_SHIFT 8
+#define HOST_DMA_CTRL_CHAIN_SHIFT 16
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+	c->ctrl = (c->ctrl & ~(3u << HOST_DMA_CTRL_SIZE_SHIFT)) | ((uint32_t)size << HOST_DMA_CTRL_SIZE_SHIFT);
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+	c->ctrl = incr ? (c->ctrl | HOST_DMA_CTRL_INCR_READ) : (c->ctrl & ~HOST_DMA_CTRL_INCR_READ);
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+	c->ctrl = incr ? (c->ctrl | HOST_DMA_CTRL_INCR_WRITE) : (c->ctrl & ~HOST_DMA_CTRL_INCR_WRITE);
+}
+
+static inline void channel_config_set_sniff_enable(dma_channel_config *c, bool sniff)
+{
+	c->ctrl = sniff ? (c->ctrl | HOST_DMA_CTRL_SNIFF) : (c->ctrl & ~HOST_DMA_CTRL_SNIFF);
+}
+
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+	c->ctrl = (c->ctrl & ~(0x3fu << HOST_DMA_CTRL_DREQ_SHIFT)) | ((uint32_t)dreq << HOST_DMA_CTRL_DREQ_SHIFT);
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+	c->ctrl = (c->ctrl & ~(0xfu << HOST_DMA_CTRL_CHAIN_SHIFT)) | ((uint32_t)chain_to << HOST_DMA_CTRL_CHAIN_SHIFT);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+void dma_sniffer_enable(uint channel, uint mode, bool force_channel_enable);
+void dma_sniffer_disable(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/flash.h, see host_sdk.h
+ *
+ * Programs and erases go to the simulated flash image from HostSDK::flash(), which is
+ * also what XIP_BASE addresses read through host_xip_read().
+ */
+
+#ifndef _HOST_HARDWARE_FLASH_H_
+#define _HOST_HARDWARE_FLASH_H_
+
+#include "pico/platform.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_BLOCK_SIZE (1u << 16)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/i2c.h, see host_sdk.h
+ *
+ * The controllers talk to devices attached with HostSDK::attachI2CDevice(), an address nobody
+ * answers at is NACKed. Blocking calls let the bus time pass on the virtual clock. Words that
+ * DMA writes to data_cmd are framed into writes by their STOP and RESTART bits, to the address
+ * in tar. A NACK sets TX_ABRT in raw_intr_stat and the rest of the run is flushed.
+ *
+ * The CPU gets the 16 deep TX and RX FIFOs: words it writes to data_cmd go out one byte time apart,
+ * a read frame has to be queued up to its STOP before it starts, and the bytes read land in the RX
+ * FIFO for data_cmd reads. Interrupts the mask lets through call the I2C0_IRQ/I2C1_IRQ handlers as
+ * the bus moves, and must be cleared by the time they return. In C++ the FIFO registers are proxies
+ * that see the firmware's reads, but not a read whose value is thrown away: returning from a handler
+ * counts as the clr_tx_abrt read, and an abort empties the RX FIFO too, so drain loops end.
+ */
+
+#ifndef _HOST_HARDWARE_I2C_H_
+#define _HOST_HARDWARE_I2C_H_
+
+#include "pico/platform.h"
+#include "pico/time.h"
+
+#define NUM_I2CS 2
+
+#define DREQ_I2C0_TX 32
+#define DREQ_I2C0_RX 33
+#define DREQ_I2C1_TX 34
+#define DREQ_I2C1_RX 35
+
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_RAW_INTR_STAT_RX_FULL_BITS 0x00000004u
+#define I2C_IC_RAW_INTR_STAT_RX_OVER_BITS 0x00000002u
+#define I2C_IC_RAW_INTR_STAT_RX_UNDER_BITS 0x00000001u
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_STAT_R_RX_FULL_BITS 0x00000004u
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_MASK_M_RX_FULL_BITS 0x00000004u
+#define I2C_IC_STATUS_TFE_BITS 0x00000004u
+#define I2C_IC_STATUS_MST_ACTIVITY_BITS 0x00000020u
+
+#ifdef __cplusplus
+// A FIFO register the stub answers itself, with the layout of the plain word C code sees
+struct host_i2c_register {
+	volatile uint32_t value;
+
+	operator uint32_t() const volatile;
+	void operator=(uint32_t word) volatile;
+};
+#define HOST_I2C_FIFO_REGISTER host_i2c_register
+#else
+#define HOST_I2C_FIFO_REGISTER volatile uint32_t
+#endif
+
+// Only the registers the firmware touches, in the hardware order
+typedef struct {
+	volatile uint32_t con;
+	volatile uint32_t tar;
+	volatile uint32_t sar;
+	uint32_t _pad0;
+	HOST_I2C_FIFO_REGISTER data_cmd;
+	uint32_t _pad1[6];
+	HOST_I2C_FIFO_REGISTER intr_stat;
+	volatile uint32_t intr_mask;
+	volatile uint32_t raw_intr_stat;
+	volatile uint32_t rx_tl;
+	volatile uint32_t tx_tl;
+	HOST_I2C_FIFO_REGISTER clr_intr;
+	uint32_t _pad2[3];
+	HOST_I2C_FIFO_REGISTER clr_tx_abrt;
+	uint32_t _pad3[6];
+	volatile uint32_t enable;
+	volatile uint32_t status;
+	HOST_I2C_FIFO_REGISTER txflr;
+	HOST_I2C_FIFO_REGISTER rxflr;
+} i2c_hw_t;
+
+typedef struct i2c_inst {
+	i2c_hw_t *hw;
+	bool restart_on_next;
+} i2c_inst_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern i2c_hw_t host_i2c_hw[NUM_I2CS];
+extern i2c_inst_t host_i2c_inst[NUM_I2CS];
+
+#ifdef __cplusplus
+}
+#endif
+
+#define i2c0 (&host_i2c_inst[0])
+#define i2c1 (&host_i2c_inst[1])
+
+static inline uint i2c_hw_index(i2c_inst_t *i2c) { return i2c == i2c1 ? 1 : 0; }
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) { return i2c->hw; }
+
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx)
+{
+	return DREQ_I2C0_TX + 2 * i2c_hw_index(i2c) + (is_tx ? 0 : 1);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
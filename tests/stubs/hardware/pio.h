@@ -0,0 +1,135 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/pio.h, see host_sdk.h
+ *
+ * Loaded programs run on the virtual clock, one instruction per cycle of the state machine's divided
+ * clock plus its delay, side-set applied even while an instruction stalls. JMP, OUT, PULL, MOV and SET
+ * are modelled, anything else panics, and so does a read of an RX FIFO. TX FIFOs take words from the
+ * CPU or from DMA writing txf, DMA waits while the FIFO is full. Levels the state machines drive are
+ * kept apart from the GPIO levels, see HostSDK::takePioEdges().
+ */
+
+#ifndef _HOST_HARDWARE_PIO_H_
+#define _HOST_HARDWARE_PIO_H_
+
+#include "pico/platform.h"
+#include "hardware/gpio.h"
+
+#define NUM_PIOS 2
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+typedef struct pio_hw {
+	volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+	volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern pio_hw_t host_pio_hw[NUM_PIOS];
+
+#ifdef __cplusplus
+}
+#endif
+
+#define pio0 (&host_pio_hw[0])
+#define pio1 (&host_pio_hw[1])
+
+typedef struct pio_program {
+	const uint16_t *instructions;
+	uint8_t length;
+	int8_t origin;
+} pio_program_t;
+
+enum pio_fifo_join {
+	PIO_FIFO_JOIN_NONE = 0,
+	PIO_FIFO_JOIN_TX = 1,
+	PIO_FIFO_JOIN_RX = 2,
+};
+
+// The fields the setters fill rather than the register encoding, clkdiv to 1/256 like the hardware
+typedef struct {
+	float clkdiv;
+	uint wrap_target;
+	uint wrap;
+	uint sideset_count; // including the enable bit when optional
+	bool sideset_optional;
+	bool sideset_pindirs;
+	uint sideset_base;
+	uint out_base;
+	uint out_count;
+	uint set_base;
+	uint set_count;
+	bool out_shift_right;
+	bool autopull;
+	uint pull_threshold;
+	enum pio_fifo_join fifo_join;
+} pio_sm_config;
+
+static inline pio_sm_config pio_get_default_sm_config(void)
+{
+	pio_sm_config c = { 1.0f, 0, 31, 0, false, false, 0, 0, 32, 0, 0, true, false, 32, PIO_FIFO_JOIN_NONE };
+	return c;
+}
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) { c->wrap_target = wrap_target; c->wrap = wrap; }
+
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs)
+{
+	c->sideset_count = bit_count;
+	c->sideset_optional = optional;
+	c->sideset_pindirs = pindirs;
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) { c->sideset_base = sideset_base; }
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count) { c->out_base = out_base; c->out_count = out_count; }
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count) { c->set_base = set_base; c->set_count = set_count; }
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint in_base) { (void)c; (void)in_base; }
+static inline void sm_config_set_jmp_pin(pio_sm_config *c, uint pin) { (void)c; (void)pin; }
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+	c->out_shift_right = shift_right;
+	c->autopull = autopull;
+	c->pull_threshold = pull_threshold ? pull_threshold : 32;
+}
+
+static inline void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold) { (void)c; (void)shift_right; (void)autopush; (void)push_threshold; }
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { c->fifo_join = join; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) { c->clkdiv = (float)(int)(div * 256) / 256; }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+void pio_gpio_init(PIO pio, uint pin);
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+uint pio_get_index(PIO pio);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
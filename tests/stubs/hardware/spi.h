@@ -0,0 +1,48 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/spi.h, see host_sdk.h
+ *
+ * Nothing is attached, writes only let the bus time pass.
+ */
+
+#ifndef _HOST_HARDWARE_SPI_H_
+#define _HOST_HARDWARE_SPI_H_
+
+#include "pico/platform.h"
+
+typedef struct spi_inst spi_inst_t;
+
+typedef enum {
+	SPI_CPHA_0 = 0,
+	SPI_CPHA_1 = 1,
+} spi_cpha_t;
+
+typedef enum {
+	SPI_CPOL_0 = 0,
+	SPI_CPOL_1 = 1,
+} spi_cpol_t;
+
+typedef enum {
+	SPI_LSB_FIRST = 0,
+	SPI_MSB_FIRST = 1,
+} spi_order_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern spi_inst_t *const host_spi_inst[2];
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+void spi_deinit(spi_inst_t *spi);
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define spi0 (host_spi_inst[0])
+#define spi1 (host_spi_inst[1])
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/structs/systick.h, see host_sdk.h
+ */
+
+#ifndef _HOST_HARDWARE_STRUCTS_SYSTICK_H_
+#define _HOST_HARDWARE_STRUCTS_SYSTICK_H_
+
+#include "pico/types.h"
+
+typedef struct {
+	volatile uint32_t csr;
+	volatile uint32_t rvr;
+	volatile uint32_t cvr;
+	volatile uint32_t calib;
+} systick_hw_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// cvr is a plain register here, HostSDK::advanceTime() counts it down at the clk_sys rate
+extern systick_hw_t host_systick_hw;
+
+#ifdef __cplusplus
+}
+#endif
+
+#define systick_hw (&host_systick_hw)
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/sync.h, see host_sdk.h
+ */
+
+#ifndef _HOST_HARDWARE_SYNC_H_
+#define _HOST_HARDWARE_SYNC_H_
+
+#include "pico/platform.h"
+
+typedef volatile uint32_t spin_lock_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+spin_lock_t *spin_lock_instance(uint lock_num);
+uint spin_lock_get_num(spin_lock_t *lock);
+int spin_lock_claim_unused(bool required);
+void spin_lock_unclaim(uint lock_num);
+uint next_striped_spin_lock_num(void);
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock)
+{
+	const uint32_t save = save_and_disable_interrupts();
+	while (__atomic_exchange_n(lock, 1u, __ATOMIC_ACQUIRE))
+		;
+	return save;
+}
+
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq)
+{
+	__atomic_store_n(lock, 0u, __ATOMIC_RELEASE);
+	restore_interrupts(saved_irq);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
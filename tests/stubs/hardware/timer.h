@@ -0,0 +1,27 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/timer.h, see host_sdk.h
+ */
+
+#ifndef _HOST_HARDWARE_TIMER_H_
+#define _HOST_HARDWARE_TIMER_H_
+
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+void busy_wait_us(uint64_t delay_us);
+static inline void busy_wait_us_32(uint32_t delay_us) { busy_wait_us(delay_us); }
+static inline void busy_wait_ms(uint32_t delay_ms) { busy_wait_us((uint64_t)delay_ms * 1000); }
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_unclaim(uint alarm_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK hardware/watchdog.h, see host_sdk.h
+ */
+
+#ifndef _HOST_HARDWARE_WATCHDOG_H_
+#define _HOST_HARDWARE_WATCHDOG_H_
+
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1986 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Host implementation of the Pico SDK stand-ins, see host_sdk.h.
+ */
+
+#include "host_sdk.h"
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/spi.h"
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "class/hid/hid_device.h"
+#include "device/usbd_pvt.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
+
+#define HOST_SYS_CLOCK_HZ 125000000
+#define HOST_SPIN_LOCK_COUNT 32
+#define HOST_HARDWARE_ALARM_COUNT 4
+#define HOST_DREQ_COUNT 64
+#define HOST_I2C_BITS_PER_BYTE 9 // 8 data bits and the ACK
+#define HOST_I2C_FIFO_DEPTH 16
+#define HOST_ADC_CLOCK_HZ 48000000
+#define HOST_ADC_CONVERSION_CYCLES 96
+#define HOST_ADC_FIFO_DEPTH 4
+
+const absolute_time_t nil_time = 0;
+const absolute_time_t at_the_end_of_time = UINT64_MAX;
+
+systick_hw_t host_systick_hw;
+pio_hw_t host_pio_hw[NUM_PIOS];
+dma_hw_t host_dma_hw;
+i2c_hw_t host_i2c_hw[NUM_I2CS];
+adc_hw_t host_adc_hw;
+i2c_inst_t host_i2c_inst[NUM_I2CS] = { { &host_i2c_hw[0], false }, { &host_i2c_hw[1], false } };
+
+struct spi_inst
+{
+	uint baudrate;
+};
+
+static spi_inst_t hostSpi[2];
+spi_inst_t *const host_spi_inst[2] = { &hostSpi[0], &hostSpi[1] };
+
+struct alarm_pool
+{
+	uint hardwareAlarm;
+	uint core;
+};
+
+namespace
+{
+	struct Alarm
+	{
+		alarm_id_t id;
+		uint64_t time;
+		alarm_callback_t callback;
+		void *userData;
+		alarm_pool_t *pool;
+	};
+
+	struct GpioIrqHandler
+	{
+		uint32_t mask;
+		irq_handler_t handler;
+	};
+
+	uint64_t hostNow = HOST_BOOT_TIME_US;
+	thread_local uint hostCore = 0;
+
+	alarm_pool_t defaultPool = { 3, 0 };
+	std::vector<Alarm> alarms;
+	alarm_id_t nextAlarmId = 1;
+	uint32_t claimedHardwareAlarms = 1u << 3; // The default pool's
+	uint32_t claimedSpinLocks = 0;
+	spin_lock_t spinLocks[HOST_SPIN_LOCK_COUNT];
+
+	uint32_t gpioLevels = (1UL << NUM_BANK0_GPIOS) - 1;
+	uint32_t gpioOutputs = 0;
+	uint32_t gpioDirections = 0;
+	uint32_t gpioIrqRise = 0;
+	uint32_t gpioIrqFall = 0;
+	uint32_t gpioIrqEvents[NUM_BANK0_GPIOS] = {};
+	std::vector<GpioIrqHandler> gpioIrqHandlers;
+
+	uint32_t irqEnabled = 0;
+	std::vector<irq_handler_t> irqHandlers[NUM_IRQS];
+
+	uint8_t *flashImage = nullptr;
+	int64_t flashPowerCountdown = -1; // Operations left before the power cut, -1 for none
+	size_t flashPowerBytes = 0;
+
+	// TinyUSB endpoint state, busy while a transfer is queued and claimed until it starts or is released
+	struct UsbEndpoint
+	{
+		bool opened;
+		bool claimed;
+		bool busy;
+		uint8_t *buffer;
+		uint16_t length;
+	};
+
+	bool usbMounted = false;
+	UsbEndpoint usbEndpoints[16][2];
+	uint8_t usbHidIn = 0;
+	uint8_t usbHidBuffer[CFG_TUD_HID_EP_BUFSIZE];
+
+	UsbEndpoint &usbEndpoint(uint8_t addr) { return usbEndpoints[tu_edpt_number(addr) & 15][tu_edpt_dir(addr)]; }
+
+	// A running channel moves one element at nextNs, then every DREQ period after that
+	struct DmaChannel
+	{
+		bool claimed;
+		bool busy;
+		uint32_t ctrl;
+		volatile void *write;
+		const volatile void *read;
+		uint32_t count;
+		uint32_t remaining;
+		uint64_t nextNs;
+	};
+
+	DmaChannel dmaChannels[NUM_DMA_CHANNELS];
+	uint32_t dreqPeriods[HOST_DREQ_COUNT];
+	uint32_t sniffState; // CRC register as the sniffer computes it, sniff_data shows it through OUT_REV and OUT_INV
+
+	// Bytes written to data_cmd since the last START, sent as one write at the STOP. Words the CPU queues
+	// go out from tx, the next one at nextNs. A read frame gets all its bytes from the device when it
+	// starts, they move to rx one byte time apart
+	struct I2CBus
+	{
+		uint baudrate;
+		std::map<uint8_t, HostSDK::I2CDevice *> devices;
+		bool inWrite;
+		std::vector<uint8_t> pending;
+		std::deque<uint32_t> tx;
+		std::deque<uint8_t> rx;
+		uint64_t nextNs;
+		bool inRead;
+		std::vector<uint8_t> readData;
+		size_t readNext;
+		bool inHandler;
+	};
+
+	I2CBus i2cBuses[NUM_I2CS];
+
+	HostSDK::Counters hostCounters = {};
+
+	bool deliverI2CWrite(uint bus, uint8_t address, const uint8_t *data, size_t length)
+	{
+		auto found = i2cBuses[bus].devices.find(address);
+		if (found == i2cBuses[bus].devices.end() || !found->second->write(data, length))
+			return false;
+		hostCounters.i2cWrites++;
+		hostCounters.i2cBytes += length;
+		return true;
+	}
+
+	bool deliverI2CRead(uint bus, uint8_t address, uint8_t *data, size_t length)
+	{
+		auto found = i2cBuses[bus].devices.find(address);
+		if (found == i2cBuses[bus].devices.end() || !found->second->read(data, length))
+			return false;
+		hostCounters.i2cReads++;
+		return true;
+	}
+
+	// A NACK flushes the TX FIFO, the stub empties the RX FIFO as well, see the stub hardware/i2c.h
+	void abortI2C(uint bus)
+	{
+		I2CBus &b = i2cBuses[bus];
+		host_i2c_hw[bus].raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+		b.tx.clear();
+		b.rx.clear();
+		b.pending.clear();
+		b.inWrite = false;
+		b.inRead = false;
+	}
+
+	void finishI2CWrite(uint bus)
+	{
+		I2CBus &b = i2cBuses[bus];
+		if (!deliverI2CWrite(bus, host_i2c_hw[bus].tar & 0x7f, b.pending.data(), b.pending.size())) {
+			abortI2C(bus);
+			return;
+		}
+		b.pending.clear();
+		b.inWrite = false;
+	}
+
+	void writeI2CDataCmd(uint bus, uint32_t word)
+	{
+		I2CBus &b = i2cBuses[bus];
+		if (host_i2c_hw[bus].raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+			return; // the controller flushes everything until the abort is cleared
+		if (word & I2C_IC_DATA_CMD_CMD_BITS)
+			panic("reads through data_cmd by DMA are not modelled");
+		if (b.inWrite && (word & I2C_IC_DATA_CMD_RESTART_BITS))
+			finishI2CWrite(bus);
+		b.inWrite = true;
+		b.pending.push_back(word & 0xff);
+		if (word & I2C_IC_DATA_CMD_STOP_BITS)
+			finishI2CWrite(bus);
+	}
+
+	int i2cBusForDataCmd(const volatile void *addr)
+	{
+		for (uint bus = 0; bus < NUM_I2CS; bus++) {
+			if (addr == &host_i2c_hw[bus].data_cmd)
+				return bus;
+		}
+		return -1;
+	}
+
+	uint32_t i2cByteNs(uint bus) { return static_cast<uint32_t>(HOST_I2C_BITS_PER_BYTE * 1000000000ULL / i2cBuses[bus].baudrate); }
+
+	// A frame starts with the address byte, words inside one take a byte time each
+	uint64_t i2cWordNs(uint bus)
+	{
+		const I2CBus &b = i2cBuses[bus];
+		return i2cByteNs(bus) * ((b.inWrite || b.inRead) ? 1 : 2);
+	}
+
+	void refreshI2CStatus(uint bus)
+	{
+		const I2CBus &b = i2cBuses[bus];
+		i2c_hw_t &hw = host_i2c_hw[bus];
+		if (b.rx.size() > hw.rx_tl)
+			hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_RX_FULL_BITS;
+		else
+			hw.raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_RX_FULL_BITS;
+		hw.txflr.value = b.tx.size();
+		hw.rxflr.value = b.rx.size();
+		hw.intr_stat.value = hw.raw_intr_stat & hw.intr_mask;
+	}
+
+	// Words the CPU writes to data_cmd, see the stub hardware/i2c.h
+	void queueI2CDataCmd(uint bus, uint32_t word)
+	{
+		I2CBus &b = i2cBuses[bus];
+		if (b.baudrate == 0)
+			panic("i2c%u used before i2c_init()", bus);
+		if (host_i2c_hw[bus].raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+			return;
+		if (b.tx.size() >= HOST_I2C_FIFO_DEPTH)
+			panic("i2c%u TX FIFO overflow, data_cmd written with %u words queued", bus, static_cast<uint>(b.tx.size()));
+		if (b.tx.empty())
+			b.nextNs = hostNow * 1000 + i2cWordNs(bus);
+		b.tx.push_back(word);
+		host_i2c_hw[bus].status = I2C_IC_STATUS_MST_ACTIVITY_BITS;
+		refreshI2CStatus(bus);
+	}
+
+	// One word from the TX FIFO goes out. Reads look ahead to the STOP that ends their frame
+	void sendI2CWord(uint bus, uint32_t word)
+	{
+		I2CBus &b = i2cBuses[bus];
+		if (!(word & I2C_IC_DATA_CMD_CMD_BITS)) {
+			b.inRead = false;
+			writeI2CDataCmd(bus, word);
+			return;
+		}
+
+		if (b.inWrite)
+			finishI2CWrite(bus); // RESTART into the read
+		if (host_i2c_hw[bus].raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+			return;
+		if (!b.inRead || (word & I2C_IC_DATA_CMD_RESTART_BITS)) {
+			size_t length = 1;
+			bool stopped = word & I2C_IC_DATA_CMD_STOP_BITS;
+			for (auto next = b.tx.begin(); !stopped && next != b.tx.end(); ++next) {
+				if (!(*next & I2C_IC_DATA_CMD_CMD_BITS) || (*next & I2C_IC_DATA_CMD_RESTART_BITS))
+					panic("i2c%u read frame interrupted before its STOP", bus);
+				length++;
+				stopped = *next & I2C_IC_DATA_CMD_STOP_BITS;
+			}
+			if (!stopped)
+				panic("i2c%u read frame started without its STOP queued", bus);
+			b.readData.assign(length, 0);
+			b.readNext = 0;
+			if (!deliverI2CRead(bus, host_i2c_hw[bus].tar & 0x7f, b.readData.data(), length)) {
+				abortI2C(bus);
+				return;
+			}
+			b.inRead = true;
+		}
+
+		if (b.rx.size() < HOST_I2C_FIFO_DEPTH)
+			b.rx.push_back(b.readData[b.readNext]);
+		else
+			host_i2c_hw[bus].raw_intr_stat |= I2C_IC_RAW_INTR_STAT_RX_OVER_BITS;
+		b.readNext++;
+		if (word & I2C_IC_DATA_CMD_STOP_BITS)
+			b.inRead = false;
+	}
+
+	// The interrupt line is a level, the handlers have to clear what raised it
+	void raiseI2CInterrupt(uint bus)
+	{
+		I2CBus &b = i2cBuses[bus];
+		i2c_hw_t &hw = host_i2c_hw[bus];
+		refreshI2CStatus(bus);
+		const uint num = I2C0_IRQ + bus;
+		if (!hw.intr_stat.value || b.inHandler || !(irqEnabled & (1u << num)))
+			return;
+
+		const bool aborted = hw.intr_stat.value & I2C_IC_INTR_STAT_R_TX_ABRT_BITS;
+		b.inHandler = true;
+		const std::vector<irq_handler_t> handlers = irqHandlers[num];
+		for (irq_handler_t handler : handlers)
+			handler();
+		b.inHandler = false;
+		if (aborted)
+			hw.raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+		refreshI2CStatus(bus);
+		if (hw.intr_stat.value)
+			panic("i2c%u interrupt 0x%x still raised after its handlers returned", bus, static_cast<uint>(hw.intr_stat.value));
+	}
+
+	// Every word the CPU queued that is due by untilNs, across buses in time order
+	void runI2C(uint64_t untilNs)
+	{
+		for (;;) {
+			int bus = -1;
+			for (uint i = 0; i < NUM_I2CS; i++) {
+				const I2CBus &b = i2cBuses[i];
+				if (!b.tx.empty() && b.nextNs <= untilNs && (bus < 0 || b.nextNs < i2cBuses[bus].nextNs))
+					bus = i;
+			}
+			if (bus < 0)
+				return;
+
+			I2CBus &b = i2cBuses[bus];
+			const uint64_t at = b.nextNs;
+			if (at / 1000 > hostNow)
+				hostNow = at / 1000;
+			const uint32_t word = b.tx.front();
+			b.tx.pop_front();
+			sendI2CWord(bus, word);
+			if (!b.tx.empty())
+				b.nextNs = at + i2cWordNs(bus);
+			else
+				host_i2c_hw[bus].status = I2C_IC_STATUS_TFE_BITS;
+			raiseI2CInterrupt(bus);
+		}
+	}
+
+	// Reads of the FIFO registers, see host_i2c_register
+	uint32_t readI2CRegister(uint bus, const volatile host_i2c_register *reg)
+	{
+		I2CBus &b = i2cBuses[bus];
+		i2c_hw_t &hw = host_i2c_hw[bus];
+		uint32_t value = 0;
+		if (reg == &hw.data_cmd) {
+			if (b.rx.empty()) {
+				hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_RX_UNDER_BITS;
+			} else {
+				value = b.rx.front();
+				b.rx.pop_front();
+			}
+		} else if (reg == &hw.clr_tx_abrt) {
+			value = (hw.raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) ? 1 : 0;
+			hw.raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+		} else if (reg == &hw.clr_intr) {
+			value = (hw.raw_intr_stat & (I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS | I2C_IC_RAW_INTR_STAT_RX_OVER_BITS | I2C_IC_RAW_INTR_STAT_RX_UNDER_BITS)) ? 1 : 0;
+			hw.raw_intr_stat &= ~(I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS | I2C_IC_RAW_INTR_STAT_RX_OVER_BITS | I2C_IC_RAW_INTR_STAT_RX_UNDER_BITS);
+		} else {
+			refreshI2CStatus(bus);
+			return reg->value;
+		}
+		refreshI2CStatus(bus);
+		return value;
+	}
+
+	uint i2cBusForRegister(const volatile host_i2c_register *reg)
+	{
+		for (uint bus = 0; bus < NUM_I2CS; bus++) {
+			if (reinterpret_cast<const volatile void *>(reg) >= &host_i2c_hw[bus] && reinterpret_cast<const volatile void *>(reg) < &host_i2c_hw[bus + 1])
+				return bus;
+		}
+		panic("I2C register proxy outside the controllers");
+	}
+
+	// Free-running conversions finish at nextNs and every periodNs after it, the FIFO catches up on them
+	// whenever something looks at it
+	struct Adc
+	{
+		HostSDK::AdcSource source;
+		uint input;
+		uint32_t roundRobin;
+		bool running;
+		bool fifoEnabled;
+		uint32_t periodNs;
+		uint64_t nextNs;
+		std::deque<uint16_t> fifo;
+	};
+
+	Adc hostAdc;
+
+	uint16_t convertAdc(uint64_t atNs)
+	{
+		const uint16_t value = hostAdc.source ? std::min<uint16_t>(hostAdc.source(hostAdc.input, atNs), 0xfff) : 0;
+		host_adc_hw.result = value;
+		if (hostAdc.roundRobin) {
+			do {
+				hostAdc.input = (hostAdc.input + 1) % NUM_ADC_CHANNELS;
+			} while (!(hostAdc.roundRobin & (1u << hostAdc.input)));
+		}
+		return value;
+	}
+
+	void pushAdcFifo(uint16_t value)
+	{
+		if (!hostAdc.fifoEnabled)
+			return;
+		if (hostAdc.fifo.size() < HOST_ADC_FIFO_DEPTH) {
+			hostAdc.fifo.push_back(value);
+		} else {
+			host_adc_hw.fcs |= ADC_FCS_OVER_BITS;
+			hostCounters.adcOverflows++;
+		}
+	}
+
+	void catchUpAdc(uint64_t untilNs)
+	{
+		while (hostAdc.running && hostAdc.nextNs <= untilNs) {
+			pushAdcFifo(convertAdc(hostAdc.nextNs));
+			hostAdc.nextNs += hostAdc.periodNs;
+		}
+	}
+
+	void resetAdc()
+	{
+		memset((void *)&host_adc_hw, 0, sizeof(host_adc_hw));
+		hostAdc.input = 0;
+		hostAdc.roundRobin = 0;
+		hostAdc.running = false;
+		hostAdc.fifoEnabled = false;
+		hostAdc.periodNs = 1000000000ULL * HOST_ADC_CONVERSION_CYCLES / HOST_ADC_CLOCK_HZ;
+		hostAdc.fifo.clear();
+		dreqPeriods[DREQ_ADC] = hostAdc.periodNs;
+	}
+
+	bool readsAdcFifo(const DmaChannel &ch) { return ch.read == &host_adc_hw.fifo; }
+
+	// Channel whose registers addr is in, -1 for anywhere else
+	int dmaChannelForRegister(const volatile void *addr)
+	{
+		const volatile uint8_t *byte = static_cast<const volatile uint8_t *>(addr);
+		for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+			const dma_channel_hw_t &regs = host_dma_hw.ch[channel];
+			if (byte >= reinterpret_cast<const volatile uint8_t *>(&regs) && byte < reinterpret_cast<const volatile uint8_t *>(&regs + 1))
+				return channel;
+		}
+		return -1;
+	}
+
+	uint32_t dmaPeriod(const DmaChannel &ch) { return dreqPeriods[(ch.ctrl >> HOST_DMA_CTRL_DREQ_SHIFT) & 0x3f]; }
+
+	bool dmaSniffed(const DmaChannel &ch)
+	{
+		const uint32_t ctrl = host_dma_hw.sniff_ctrl;
+		return (ch.ctrl & HOST_DMA_CTRL_SNIFF) && (ctrl & DMA_SNIFF_CTRL_EN_BITS) &&
+			((ctrl & DMA_SNIFF_CTRL_DMACH_BITS) >> DMA_SNIFF_CTRL_DMACH_LSB) == static_cast<uint32_t>(&ch - dmaChannels);
+	}
+
+	uint32_t reverseBits(uint32_t value, uint bits)
+	{
+		uint32_t reversed = 0;
+		for (uint i = 0; i < bits; i++)
+			reversed |= ((value >> i) & 1) << (bits - 1 - i);
+		return reversed;
+	}
+
+	// The IEEE 802.3 CRC register shifted MSB first over the transfer, CRC32R bit reverses the data first
+	void sniffTransfer(uint32_t value, uint size)
+	{
+		const uint32_t ctrl = host_dma_hw.sniff_ctrl;
+		const uint32_t calc = (ctrl & DMA_SNIFF_CTRL_CALC_BITS) >> DMA_SNIFF_CTRL_CALC_LSB;
+		if (calc != DMA_SNIFF_CTRL_CALC_VALUE_CRC32 && calc != DMA_SNIFF_CTRL_CALC_VALUE_CRC32R)
+			panic("sniffer mode %u is not modelled", calc);
+		const uint bits = size * 8;
+		if (calc == DMA_SNIFF_CTRL_CALC_VALUE_CRC32R)
+			value = reverseBits(value, bits);
+		for (int bit = bits - 1; bit >= 0; bit--) {
+			const bool feedback = ((sniffState >> 31) ^ (value >> bit)) & 1;
+			sniffState = (sniffState << 1) ^ (feedback ? 0x04c11db7 : 0);
+		}
+
+		uint32_t shown = sniffState;
+		if (ctrl & DMA_SNIFF_CTRL_OUT_REV_BITS)
+			shown = reverseBits(shown, 32);
+		if (ctrl & DMA_SNIFF_CTRL_OUT_INV_BITS)
+			shown = ~shown;
+		host_dma_hw.sniff_data = shown;
+	}
+
+	// A state machine runs the instruction at pc on cycle, counted at its divided clock from startNs.
+	// Side-set is applied whenever an instruction starts, stalled or not, its delay once it completes
+	struct PioStateMachine
+	{
+		bool claimed;
+		bool enabled;
+		pio_sm_config config;
+		uint32_t div256;        // Clock divider in 1/256ths
+		uint pc;
+		uint32_t x;
+		uint32_t y;
+		uint32_t osr;
+		uint osrShifted;        // Bits shifted out of the OSR, 32 once it is empty
+		uint64_t startNs;
+		uint64_t cycle;
+		std::deque<uint32_t> tx;
+	};
+
+	struct Pio
+	{
+		uint16_t instructions[PIO_INSTRUCTION_COUNT];
+		uint32_t used;
+		PioStateMachine sms[NUM_PIO_STATE_MACHINES];
+	};
+
+	Pio pios[NUM_PIOS];
+	uint32_t pioPins = 0;
+	std::vector<HostSDK::PinEdge> pioEdges;
+
+	Pio &pioFor(PIO pio)
+	{
+		if (pio != pio0 && pio != pio1)
+			panic("not a PIO block");
+		return pios[pio - host_pio_hw];
+	}
+
+	uint64_t pioCycleNs(const PioStateMachine &sm, uint64_t cycle)
+	{
+		return sm.startNs + cycle * sm.div256 * 1000 / (HOST_SYS_CLOCK_HZ / 1000000) / 256;
+	}
+
+	// First cycle that starts after ns
+	uint64_t pioCycleAfter(const PioStateMachine &sm, uint64_t ns)
+	{
+		uint64_t cycle = (ns - sm.startNs) * (HOST_SYS_CLOCK_HZ / 1000000) * 256 / 1000 / sm.div256;
+		while (pioCycleNs(sm, cycle) <= ns)
+			cycle++;
+		return cycle;
+	}
+
+	uint pioTxDepth(const PioStateMachine &sm)
+	{
+		switch (sm.config.fifo_join) {
+		case PIO_FIFO_JOIN_TX: return 8;
+		case PIO_FIFO_JOIN_RX: return 0;
+		default: return 4;
+		}
+	}
+
+	void drivePioPins(uint base, uint count, uint32_t value, uint64_t ns)
+	{
+		for (uint i = 0; i < count; i++) {
+			const uint pin = (base + i) % 32;
+			const bool high = (value >> i) & 1;
+			if (((pioPins >> pin) & 1) != high) {
+				pioPins ^= 1UL << pin;
+				pioEdges.push_back({ pin, high, ns });
+			}
+		}
+	}
+
+	uint32_t shiftPioOsr(PioStateMachine &sm, uint bits)
+	{
+		uint32_t data;
+		if (bits == 32) {
+			data = sm.osr;
+			sm.osr = 0;
+		} else if (sm.config.out_shift_right) {
+			data = sm.osr & ((1u << bits) - 1);
+			sm.osr >>= bits;
+		} else {
+			data = sm.osr >> (32 - bits);
+			sm.osr <<= bits;
+		}
+		sm.osrShifted = std::min(sm.osrShifted + bits, 32u);
+		return data;
+	}
+
+	[[noreturn]] void unmodelledPioInstruction(uint p, uint s, uint16_t instr)
+	{
+		panic("PIO%u SM%u instruction 0x%04x at %u is not modelled", p, s, instr, pios[p].sms[s].pc);
+	}
+
+	// Runs the instruction at pc, false when it stalls. Stalls here all wait on the TX FIFO
+	bool stepPio(uint p, uint s)
+	{
+		PioStateMachine &sm = pios[p].sms[s];
+		const pio_sm_config &c = sm.config;
+		const uint16_t instr = pios[p].instructions[sm.pc];
+		const uint64_t ns = pioCycleNs(sm, sm.cycle);
+
+		const uint delayBits = 5 - c.sideset_count;
+		const uint delay = (instr >> 8) & ((1u << delayBits) - 1);
+		if (c.sideset_count) {
+			uint side = (instr >> (8 + delayBits)) & ((1u << c.sideset_count) - 1);
+			uint sideBits = c.sideset_count;
+			bool apply = true;
+			if (c.sideset_optional) {
+				sideBits--;
+				apply = (side >> sideBits) & 1;
+				side &= (1u << sideBits) - 1;
+			}
+			if (apply && c.sideset_pindirs)
+				unmodelledPioInstruction(p, s, instr);
+			if (apply)
+				drivePioPins(c.sideset_base, sideBits, side, ns);
+		}
+
+		bool jumped = false;
+		const uint dest = (instr >> 5) & 7;
+		const uint bits = instr & 0x1f;
+		switch (instr >> 13) {
+		case 0: { // JMP
+			bool take;
+			switch (dest) {
+			case 0: take = true; break;
+			case 1: take = sm.x == 0; break;
+			case 2: take = sm.x-- != 0; break;
+			case 3: take = sm.y == 0; break;
+			case 4: take = sm.y-- != 0; break;
+			case 5: take = sm.x != sm.y; break;
+			case 7: take = sm.osrShifted < c.pull_threshold; break;
+			default: unmodelledPioInstruction(p, s, instr);
+			}
+			if (take) {
+				sm.pc = bits;
+				jumped = true;
+			}
+			break;
+		}
+		case 3: { // OUT, autopull refills an empty OSR before shifting
+			if (c.autopull && sm.osrShifted >= c.pull_threshold) {
+				if (sm.tx.empty())
+					return false;
+				sm.osr = sm.tx.front();
+				sm.tx.pop_front();
+				sm.osrShifted = 0;
+			}
+			const uint32_t data = shiftPioOsr(sm, bits ? bits : 32);
+			switch (dest) {
+			case 0: drivePioPins(c.out_base, c.out_count, data, ns); break;
+			case 1: sm.x = data; break;
+			case 2: sm.y = data; break;
+			case 3: break;
+			case 5: sm.pc = data & 0x1f; jumped = true; break;
+			default: unmodelledPioInstruction(p, s, instr);
+			}
+			break;
+		}
+		case 4: { // PULL, PUSH is not modelled
+			if (!(instr & 0x80))
+				unmodelledPioInstruction(p, s, instr);
+			const bool ifEmpty = instr & 0x40;
+			const bool block = instr & 0x20;
+			if (ifEmpty && sm.osrShifted < c.pull_threshold)
+				break;
+			if (sm.tx.empty()) {
+				if (block)
+					return false;
+				sm.osr = sm.x;
+			} else {
+				sm.osr = sm.tx.front();
+				sm.tx.pop_front();
+			}
+			sm.osrShifted = 0;
+			break;
+		}
+		case 5: { // MOV
+			uint32_t value;
+			switch (instr & 7) {
+			case 1: value = sm.x; break;
+			case 2: value = sm.y; break;
+			case 3: value = 0; break;
+			case 7: value = sm.osr; break;
+			default: unmodelledPioInstruction(p, s, instr);
+			}
+			const uint op = (instr >> 3) & 3;
+			if (op == 1)
+				value = ~value;
+			else if (op == 2)
+				value = reverseBits(value, 32);
+			switch (dest) {
+			case 0: drivePioPins(c.out_base, c.out_count, value, ns); break;
+			case 1: sm.x = value; break;
+			case 2: sm.y = value; break;
+			case 5: sm.pc = value & 0x1f; jumped = true; break;
+			case 7: sm.osr = value; sm.osrShifted = 0; break;
+			default: unmodelledPioInstruction(p, s, instr);
+			}
+			break;
+		}
+		case 7: // SET, pin directions are not modelled
+			switch (dest) {
+			case 0: drivePioPins(c.set_base, c.set_count, bits, ns); break;
+			case 1: sm.x = bits; break;
+			case 2: sm.y = bits; break;
+			case 4: break;
+			default: unmodelledPioInstruction(p, s, instr);
+			}
+			break;
+		default:
+			unmodelledPioInstruction(p, s, instr);
+		}
+
+		if (!jumped)
+			sm.pc = (sm.pc == c.wrap) ? c.wrap_target : (sm.pc + 1) % PIO_INSTRUCTION_COUNT;
+		sm.cycle += 1 + delay;
+		return true;
+	}
+
+	// Every instruction that starts by untilNs. A stall lasts past it, only a word the CPU or DMA pushes
+	// later can end one
+	void catchUpPio(uint p, uint s, uint64_t untilNs)
+	{
+		PioStateMachine &sm = pios[p].sms[s];
+		if (!sm.enabled)
+			return;
+		while (pioCycleNs(sm, sm.cycle) <= untilNs) {
+			if (!stepPio(p, s)) {
+				sm.cycle = pioCycleAfter(sm, untilNs);
+				return;
+			}
+		}
+	}
+
+	void runPio(uint64_t untilNs)
+	{
+		for (uint p = 0; p < NUM_PIOS; p++) {
+			for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++)
+				catchUpPio(p, s, untilNs);
+		}
+	}
+
+	// PIO index times 4 plus the state machine whose TX FIFO addr is, -1 for anywhere else
+	int pioTxForRegister(const volatile void *addr)
+	{
+		for (uint p = 0; p < NUM_PIOS; p++) {
+			for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+				if (addr == &host_pio_hw[p].txf[s])
+					return p * NUM_PIO_STATE_MACHINES + s;
+			}
+		}
+		return -1;
+	}
+
+	PioStateMachine &pioTx(int fifo) { return pios[fifo / NUM_PIO_STATE_MACHINES].sms[fifo % NUM_PIO_STATE_MACHINES]; }
+
+	void resetPio()
+	{
+		for (Pio &pio : pios) {
+			memset(pio.instructions, 0, sizeof(pio.instructions));
+			pio.used = 0;
+			for (PioStateMachine &sm : pio.sms)
+				sm = PioStateMachine();
+		}
+		pioPins = 0;
+		pioEdges.clear();
+	}
+
+	void triggerDma(uint channel, uint64_t atNs);
+
+	// A word written to a channel's address registers is a whole host pointer, see the stub hardware/dma.h
+	void writeDmaRegister(uint channel, const volatile void *addr, const volatile void *read, uint64_t atNs)
+	{
+		dma_channel_hw_t &regs = host_dma_hw.ch[channel];
+		volatile void *address;
+		memcpy(&address, (const void *)read, sizeof(address));
+		if (addr == &regs.write_addr || addr == &regs.al2_write_addr_trig)
+			dmaChannels[channel].write = address;
+		else if (addr == &regs.read_addr || addr == &regs.al3_read_addr_trig)
+			dmaChannels[channel].read = address;
+		else
+			panic("DMA writes to DMA register 0x%x are not modelled", static_cast<uint>(static_cast<const volatile uint8_t *>(addr) - reinterpret_cast<volatile uint8_t *>(&regs)));
+		if (addr == &regs.al2_write_addr_trig || addr == &regs.al3_read_addr_trig)
+			triggerDma(channel, atNs);
+	}
+
+	void dmaTransfer(DmaChannel &ch, uint64_t atNs)
+	{
+		uint size = 1u << ((ch.ctrl >> HOST_DMA_CTRL_SIZE_SHIFT) & 3);
+		const int target = dmaChannelForRegister(ch.write);
+		if (target >= 0) {
+			size = sizeof(void *);
+			writeDmaRegister(target, ch.write, ch.read, atNs);
+		} else {
+			uint32_t value = 0;
+			if (readsAdcFifo(ch)) {
+				value = hostAdc.fifo.front();
+				hostAdc.fifo.pop_front();
+			} else {
+				memcpy(&value, (const void *)ch.read, size);
+			}
+			if (dmaSniffed(ch))
+				sniffTransfer(value, size);
+			const int bus = i2cBusForDataCmd(ch.write);
+			const int fifo = pioTxForRegister(ch.write);
+			if (bus >= 0)
+				writeI2CDataCmd(bus, value);
+			else if (fifo >= 0)
+				pioTx(fifo).tx.push_back(value);
+			else
+				memcpy((void *)ch.write, &value, size);
+		}
+		if (ch.ctrl & HOST_DMA_CTRL_INCR_READ)
+			ch.read = static_cast<const volatile uint8_t *>(ch.read) + size;
+		if (ch.ctrl & HOST_DMA_CTRL_INCR_WRITE)
+			ch.write = static_cast<volatile uint8_t *>(ch.write) + size;
+		ch.remaining--;
+	}
+
+	void triggerDma(uint channel, uint64_t atNs)
+	{
+		DmaChannel &ch = dmaChannels[channel];
+		ch.remaining = ch.count;
+		ch.busy = ch.count > 0;
+		ch.nextNs = atNs + dmaPeriod(ch);
+		if (ch.busy && dmaSniffed(ch))
+			sniffState = host_dma_hw.sniff_data;
+		const int bus = i2cBusForDataCmd(ch.write);
+		if (bus >= 0 && ch.busy) {
+			// The firmware reads clr_tx_abrt before it starts again, a plain read the stub can't see
+			host_i2c_hw[bus].raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+			host_i2c_hw[bus].status = I2C_IC_STATUS_MST_ACTIVITY_BITS;
+		}
+	}
+
+	// Every transfer due by untilNs, across channels in time order
+	void runDma(uint64_t untilNs)
+	{
+		for (;;) {
+			DmaChannel *next = nullptr;
+			for (DmaChannel &ch : dmaChannels) {
+				if (ch.busy && ch.nextNs <= untilNs && (next == nullptr || ch.nextNs < next->nextNs))
+					next = &ch;
+			}
+			if (next == nullptr)
+				return;
+
+			const uint64_t at = next->nextNs;
+			const int fifo = pioTxForRegister(next->write);
+			if (fifo >= 0) {
+				// DREQ is the TX FIFO having room, the state machine makes it by pulling a word. A stopped one
+				// is looked at again every microsecond
+				PioStateMachine &sm = pioTx(fifo);
+				const uint p = fifo / NUM_PIO_STATE_MACHINES;
+				const uint s = fifo % NUM_PIO_STATE_MACHINES;
+				const uint dreq = (next->ctrl >> HOST_DMA_CTRL_DREQ_SHIFT) & 0x3f;
+				if (dreq != (p ? DREQ_PIO1_TX0 : DREQ_PIO0_TX0) + s)
+					panic("DMA channel %u writes the PIO%u SM%u TX FIFO paced by DREQ %u", static_cast<uint>(next - dmaChannels), p, s, dreq);
+				catchUpPio(p, s, at);
+				if (sm.tx.size() >= pioTxDepth(sm)) {
+					next->nextNs = sm.enabled ? pioCycleNs(sm, sm.cycle) : at + 1000;
+					continue;
+				}
+			}
+			if (readsAdcFifo(*next)) {
+				// DREQ_ADC is the FIFO holding a result, a channel that comes early waits for the next one
+				catchUpAdc(at);
+				if (hostAdc.fifo.empty()) {
+					if (!hostAdc.running)
+						panic("DMA channel %u waits on the ADC FIFO, but the ADC is not running", static_cast<uint>(next - dmaChannels));
+					next->nextNs = hostAdc.nextNs;
+					continue;
+				}
+			}
+			if (at / 1000 > hostNow)
+				hostNow = at / 1000; // devices see the time the word arrives
+			dmaTransfer(*next, at);
+			if (next->remaining) {
+				next->nextNs = at + dmaPeriod(*next);
+				continue;
+			}
+
+			next->busy = false;
+			hostCounters.dmaRuns++;
+			const int bus = i2cBusForDataCmd(next->write);
+			if (bus >= 0)
+				host_i2c_hw[bus].status = I2C_IC_STATUS_TFE_BITS;
+			const uint chain = (next->ctrl >> HOST_DMA_CTRL_CHAIN_SHIFT) & 0xf;
+			if (chain != static_cast<uint>(next - dmaChannels))
+				triggerDma(chain, at);
+		}
+	}
+
+	void startDma(uint channel)
+	{
+		triggerDma(channel, hostNow * 1000);
+		runDma(hostNow * 1000); // unpaced channels are done before this returns
+	}
+
+	void resetI2C(uint bus)
+	{
+		memset((void *)&host_i2c_hw[bus], 0, sizeof(host_i2c_hw[bus]));
+		host_i2c_hw[bus].status = I2C_IC_STATUS_TFE_BITS;
+		host_i2c_inst[bus].restart_on_next = false;
+		I2CBus &b = i2cBuses[bus];
+		b.inWrite = false;
+		b.pending.clear();
+		b.tx.clear();
+		b.rx.clear();
+		b.inRead = false;
+		b.inHandler = false;
+	}
+
+	// Blocking transfers keep the caller busy for the whole time on the wire
+	void waitI2C(uint bus, size_t bytes)
+	{
+		const uint baudrate = i2cBuses[bus].baudrate;
+		if (baudrate == 0)
+			panic("i2c%u used before i2c_init()", bus);
+		if (host_i2c_hw[bus].status & I2C_IC_STATUS_MST_ACTIVITY_BITS)
+			panic("blocking transfer on i2c%u while DMA or its TX FIFO is still writing to it", bus);
+		HostSDK::advanceTime((bytes * HOST_I2C_BITS_PER_BYTE * 1000000ULL + baudrate - 1) / baudrate);
+	}
+
+	void tickSysTick(uint64_t us)
+	{
+		const uint32_t period = (systick_hw->rvr & 0xFFFFFF) + 1;
+		if (!(systick_hw->csr & 1) || period <= 1)
+			return;
+		const uint64_t cycles = us * (HOST_SYS_CLOCK_HZ / 1000000);
+		systick_hw->cvr = static_cast<uint32_t>((systick_hw->cvr + period - (cycles % period)) % period);
+	}
+
+	void setNow(uint64_t time)
+	{
+		if (time > hostNow) {
+			const uint64_t from = hostNow;
+			runDma(time * 1000);
+			runI2C(time * 1000);
+			runPio(time * 1000);
+			tickSysTick(time - from);
+			hostNow = time;
+		}
+	}
+
+	// Fire every alarm due by target, moving the clock to each deadline as it goes
+	void runAlarmsUntil(uint64_t target)
+	{
+		for (;;) {
+			auto due = std::min_element(alarms.begin(), alarms.end(),
+				[](const Alarm &a, const Alarm &b) { return a.time < b.time || (a.time == b.time && a.id < b.id); });
+			if (due == alarms.end() || due->time > target)
+				break;
+
+			const Alarm alarm = *due;
+			alarms.erase(due);
+			setNow(alarm.time);
+
+			const uint core = hostCore;
+			hostCore = alarm.pool->core;
+			hostCounters.alarmsFired++;
+			const int64_t next = alarm.callback(alarm.id, alarm.userData);
+			hostCore = core;
+
+			if (next != 0) {
+				Alarm again = alarm;
+				again.time = (next > 0) ? alarm.time + next : hostNow - next;
+				alarms.push_back(again);
+			}
+		}
+		setNow(target);
+	}
+
+	void raiseGpioEvents(uint32_t oldLevels, uint32_t newLevels)
+	{
+		const uint32_t rose = ~oldLevels & newLevels & gpioIrqRise;
+		const uint32_t fell = oldLevels & ~newLevels & gpioIrqFall;
+		const uint32_t raised = rose | fell;
+		if (!raised || !(irqEnabled & (1u << IO_IRQ_BANK0)))
+			return;
+
+		for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+			if (rose & (1UL << pin))
+				gpioIrqEvents[pin] |= GPIO_IRQ_EDGE_RISE;
+			if (fell & (1UL << pin))
+				gpioIrqEvents[pin] |= GPIO_IRQ_EDGE_FALL;
+		}
+
+		const std::vector<GpioIrqHandler> handlers = gpioIrqHandlers;
+		for (const GpioIrqHandler &entry : handlers) {
+			if (entry.mask & raised)
+				entry.handler();
+		}
+
+		// IO_IRQ_BANK0 stays raised while an edge is latched, the core would take it again forever
+		for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+			if ((raised & (1UL << pin)) && gpioIrqEvents[pin])
+				panic("GPIO %u edge 0x%x still latched after its handlers returned", pin, static_cast<uint>(gpioIrqEvents[pin]));
+		}
+	}
+}
+
+namespace HostSDK
+{
+	void reset()
+	{
+		memset(flash(), 0xFF, flashSize());
+		powerCycle();
+	}
+
+	void powerCycle()
+	{
+		hostNow = HOST_BOOT_TIME_US;
+		hostCore = 0;
+		alarms.clear();
+		nextAlarmId = 1;
+		claimedHardwareAlarms = 1u << defaultPool.hardwareAlarm;
+		claimedSpinLocks = 0;
+		memset((void *)spinLocks, 0, sizeof(spinLocks));
+
+		gpioLevels = (1UL << NUM_BANK0_GPIOS) - 1;
+		gpioOutputs = 0;
+		gpioDirections = 0;
+		gpioIrqRise = 0;
+		gpioIrqFall = 0;
+		memset(gpioIrqEvents, 0, sizeof(gpioIrqEvents));
+		gpioIrqHandlers.clear();
+		irqEnabled = 0;
+		for (std::vector<irq_handler_t> &handlers : irqHandlers)
+			handlers.clear();
+
+		memset(&host_systick_hw, 0, sizeof(host_systick_hw));
+		memset((void *)host_pio_hw, 0, sizeof(host_pio_hw));
+		resetPio();
+
+		flashPowerCountdown = -1;
+
+		usbMounted = false;
+		memset(usbEndpoints, 0, sizeof(usbEndpoints));
+		usbHidIn = 0;
+
+		memset((void *)&host_dma_hw, 0, sizeof(host_dma_hw));
+		memset(dmaChannels, 0, sizeof(dmaChannels));
+		memset(dreqPeriods, 0, sizeof(dreqPeriods));
+		sniffState = 0;
+		hostAdc.source = nullptr;
+		resetAdc();
+		for (uint bus = 0; bus < NUM_I2CS; bus++) {
+			resetI2C(bus);
+			i2cBuses[bus].baudrate = 0;
+			i2cBuses[bus].devices.clear();
+		}
+		memset(hostSpi, 0, sizeof(hostSpi));
+
+		hostCounters = {};
+	}
+
+	uint64_t now() { return hostNow; }
+
+	void advanceTime(uint64_t us) { runAlarmsUntil(hostNow + us); }
+
+	void advanceTo(uint64_t us)
+	{
+		if (us > hostNow)
+			runAlarmsUntil(us);
+	}
+
+	void setCore(uint core) { hostCore = core; }
+
+	void setGpioLevels(uint32_t levels)
+	{
+		const uint32_t oldLevels = gpioLevels;
+		gpioLevels = levels & ((1UL << NUM_BANK0_GPIOS) - 1);
+		raiseGpioEvents(oldLevels, gpioLevels);
+	}
+
+	uint32_t getGpioLevels() { return gpioLevels; }
+
+	uint32_t getGpioOutputs() { return gpioOutputs; }
+
+	bool raiseIrq(uint num)
+	{
+		if (!(irqEnabled & (1u << num)) || irqHandlers[num].empty())
+			return false;
+		const std::vector<irq_handler_t> handlers = irqHandlers[num];
+		for (irq_handler_t handler : handlers)
+			handler();
+		return true;
+	}
+
+	uint8_t *flash()
+	{
+		if (flashImage == nullptr) {
+			void *mapped = mmap(reinterpret_cast<void *>(XIP_BASE), PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+			if (mapped != reinterpret_cast<void *>(XIP_BASE))
+				panic("cannot map the simulated flash at XIP_BASE");
+			flashImage = static_cast<uint8_t *>(mapped);
+			memset(flashImage, 0xFF, PICO_FLASH_SIZE_BYTES);
+		}
+		return flashImage;
+	}
+
+	size_t flashSize() { return PICO_FLASH_SIZE_BYTES; }
+
+	void cutFlashPower(uint32_t operations, size_t bytes)
+	{
+		flashPowerCountdown = operations;
+		flashPowerBytes = bytes;
+	}
+
+	void setUsbMounted(bool mounted) { usbMounted = mounted; }
+
+	bool usbInFlight(uint8_t endpoint) { return usbEndpoint(endpoint).busy; }
+
+	std::vector<uint8_t> pollUsbIn(uint8_t endpoint)
+	{
+		UsbEndpoint &ep = usbEndpoint(endpoint);
+		if (!ep.busy)
+			return {};
+		std::vector<uint8_t> read(ep.buffer, ep.buffer + ep.length);
+		ep.busy = false;
+		ep.claimed = false;
+		return read;
+	}
+
+	uint8_t usbHidEndpoint() { return usbHidIn; }
+
+	void attachI2CDevice(uint bus, uint8_t address, I2CDevice *device)
+	{
+		if (device != nullptr)
+			i2cBuses[bus].devices[address] = device;
+		else
+			i2cBuses[bus].devices.erase(address);
+	}
+
+	void setAdcSource(AdcSource source) { hostAdc.source = source; }
+
+	void setDreqPeriod(uint dreq, uint32_t ns) { dreqPeriods[dreq] = ns; }
+
+	std::vector<PinEdge> takePioEdges()
+	{
+		runPio(hostNow * 1000);
+		std::vector<PinEdge> edges;
+		edges.swap(pioEdges);
+		std::stable_sort(edges.begin(), edges.end(), [](const PinEdge &a, const PinEdge &b) { return a.ns < b.ns; });
+		return edges;
+	}
+
+	Counters &counters() { return hostCounters; }
+}
+
+extern "C" {
+
+uint get_core_num(void) { return hostCore; }
+
+void panic(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	fputs("panic: ", stderr);
+	vfprintf(stderr, fmt, args);
+	fputc('\n', stderr);
+	va_end(args);
+	abort();
+}
+
+// Time
+
+absolute_time_t get_absolute_time(void) { return hostNow; }
+uint64_t time_us_64(void) { return hostNow; }
+void busy_wait_us(uint64_t delay_us) { HostSDK::advanceTime(delay_us); }
+void sleep_until(absolute_time_t target) { HostSDK::advanceTo(target); }
+void sleep_us(uint64_t us) { HostSDK::advanceTime(us); }
+void sleep_ms(uint32_t ms) { HostSDK::advanceTime(static_cast<uint64_t>(ms) * 1000); }
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp)
+{
+	HostSDK::advanceTo(timeout_timestamp);
+	return true;
+}
+
+int hardware_alarm_claim_unused(bool required)
+{
+	for (uint alarm = 0; alarm < HOST_HARDWARE_ALARM_COUNT; alarm++) {
+		if (!(claimedHardwareAlarms & (1u << alarm))) {
+			claimedHardwareAlarms |= 1u << alarm;
+			return alarm;
+		}
+	}
+	if (required)
+		panic("no hardware alarms available");
+	return -1;
+}
+
+void hardware_alarm_unclaim(uint alarm_num) { claimedHardwareAlarms &= ~(1u << alarm_num); }
+
+alarm_pool_t *alarm_pool_get_default(void) { return &defaultPool; }
+
+// Like the SDK, a pool's alarms fire on the core that created it
+alarm_pool_t *alarm_pool_create(uint hardware_alarm_num, uint max_timers)
+{
+	(void)max_timers;
+	if (claimedHardwareAlarms & (1u << hardware_alarm_num))
+		panic("hardware alarm %u already claimed", hardware_alarm_num);
+	claimedHardwareAlarms |= 1u << hardware_alarm_num;
+	return new alarm_pool_t { hardware_alarm_num, hostCore };
+}
+
+void alarm_pool_destroy(alarm_pool_t *pool)
+{
+	alarms.erase(std::remove_if(alarms.begin(), alarms.end(), [pool](const Alarm &a) { return a.pool == pool; }), alarms.end());
+	hardware_alarm_unclaim(pool->hardwareAlarm);
+	delete pool;
+}
+
+uint alarm_pool_hardware_alarm_num(alarm_pool_t *pool) { return pool->hardwareAlarm; }
+uint alarm_pool_core_num(alarm_pool_t *pool) { return pool->core; }
+
+alarm_id_t alarm_pool_add_alarm_at(alarm_pool_t *pool, absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+	if (time <= hostNow) {
+		if (!fire_if_past)
+			return 0;
+		time = hostNow;
+	}
+	const alarm_id_t id = nextAlarmId++;
+	alarms.push_back({ id, time, callback, user_data, pool });
+	return id;
+}
+
+alarm_id_t alarm_pool_add_alarm_in_us(alarm_pool_t *pool, uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+	return alarm_pool_add_alarm_at(pool, hostNow + us, callback, user_data, fire_if_past);
+}
+
+bool alarm_pool_cancel_alarm(alarm_pool_t *pool, alarm_id_t alarm_id)
+{
+	auto found = std::find_if(alarms.begin(), alarms.end(), [=](const Alarm &a) { return a.pool == pool && a.id == alarm_id; });
+	if (found == alarms.end())
+		return false;
+	alarms.erase(found);
+	return true;
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+	return alarm_pool_add_alarm_at(&defaultPool, time, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+	return alarm_pool_add_alarm_in_us(&defaultPool, us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+	return alarm_pool_add_alarm_in_us(&defaultPool, static_cast<uint64_t>(ms) * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) { return alarm_pool_cancel_alarm(&defaultPool, alarm_id); }
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+	switch (clk_index) {
+		case clk_usb:
+		case clk_adc:
+			return 48000000;
+		case clk_ref:
+			return 12000000;
+		default:
+			return HOST_SYS_CLOCK_HZ;
+	}
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required)
+{
+	(void)required;
+	return freq_khz == HOST_SYS_CLOCK_HZ / 1000;
+}
+
+// GPIO
+
+void gpio_init(uint gpio)
+{
+	gpioDirections &= ~(1UL << gpio);
+	gpioOutputs &= ~(1UL << gpio);
+}
+
+void gpio_deinit(uint gpio)
+{
+	gpio_init(gpio);
+	gpioIrqRise &= ~(1UL << gpio);
+	gpioIrqFall &= ~(1UL << gpio);
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+	if (out)
+		gpioDirections |= 1UL << gpio;
+	else
+		gpioDirections &= ~(1UL << gpio);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+void gpio_pull_up(uint gpio) { (void)gpio; }
+void gpio_pull_down(uint gpio) { (void)gpio; }
+void gpio_disable_pulls(uint gpio) { (void)gpio; }
+
+bool gpio_get(uint gpio) { return (gpio_get_all() >> gpio) & 1; }
+
+uint32_t gpio_get_all(void) { return (gpioLevels & ~gpioDirections) | (gpioOutputs & gpioDirections); }
+
+void gpio_put(uint gpio, bool value)
+{
+	if (value)
+		gpioOutputs |= 1UL << gpio;
+	else
+		gpioOutputs &= ~(1UL << gpio);
+}
+
+void gpio_put_all(uint32_t value) { gpioOutputs = value; }
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+{
+	const uint32_t bit = 1UL << gpio;
+	if (event_mask & GPIO_IRQ_EDGE_RISE)
+		gpioIrqRise = enabled ? (gpioIrqRise | bit) : (gpioIrqRise & ~bit);
+	if (event_mask & GPIO_IRQ_EDGE_FALL)
+		gpioIrqFall = enabled ? (gpioIrqFall | bit) : (gpioIrqFall & ~bit);
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio) { return gpioIrqEvents[gpio]; }
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask) { gpioIrqEvents[gpio] &= ~event_mask; }
+
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler)
+{
+	gpioIrqHandlers.push_back({ gpio_mask, handler });
+}
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler) { gpio_add_raw_irq_handler_masked(1UL << gpio, handler); }
+
+void gpio_remove_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler)
+{
+	gpioIrqHandlers.erase(std::remove_if(gpioIrqHandlers.begin(), gpioIrqHandlers.end(),
+		[=](const GpioIrqHandler &entry) { return entry.mask == gpio_mask && entry.handler == handler; }), gpioIrqHandlers.end());
+}
+
+void gpio_remove_raw_irq_handler(uint gpio, irq_handler_t handler) { gpio_remove_raw_irq_handler_masked(1UL << gpio, handler); }
+
+// IRQ, only the enable bits and handler lists, priorities are ignored
+
+void irq_set_enabled(uint num, bool enabled)
+{
+	irqEnabled = enabled ? (irqEnabled | (1u << num)) : (irqEnabled & ~(1u << num));
+}
+
+bool irq_is_enabled(uint num) { return irqEnabled & (1u << num); }
+void irq_set_priority(uint num, uint8_t hardware_priority) { (void)num; (void)hardware_priority; }
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+	if (!irqHandlers[num].empty())
+		panic("irq %u already has a handler", num);
+	irqHandlers[num].push_back(handler);
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+	(void)order_priority;
+	irqHandlers[num].push_back(handler);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler)
+{
+	std::vector<irq_handler_t> &handlers = irqHandlers[num];
+	handlers.erase(std::remove(handlers.begin(), handlers.end(), handler), handlers.end());
+}
+
+// Sync
+
+uint32_t save_and_disable_interrupts(void) { return 0; }
+void restore_interrupts(uint32_t status) { (void)status; }
+
+spin_lock_t *spin_lock_instance(uint lock_num) { return &spinLocks[lock_num]; }
+uint spin_lock_get_num(spin_lock_t *lock) { return static_cast<uint>(lock - spinLocks); }
+uint next_striped_spin_lock_num(void) { return 16; }
+
+int spin_lock_claim_unused(bool required)
+{
+	for (uint lock = 24; lock < HOST_SPIN_LOCK_COUNT; lock++) {
+		if (!(claimedSpinLocks & (1u << lock))) {
+			claimedSpinLocks |= 1u << lock;
+			return lock;
+		}
+	}
+	if (required)
+		panic("no spin locks available");
+	return -1;
+}
+
+void spin_lock_unclaim(uint lock_num) { claimedSpinLocks &= ~(1u << lock_num); }
+
+void multicore_launch_core1(void (*entry)(void)) { (void)entry; }
+void multicore_reset_core1(void) {}
+void multicore_lockout_victim_init(void) {}
+void multicore_lockout_start_blocking(void) { hostCounters.lockouts++; }
+void multicore_lockout_end_blocking(void) {}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms)
+{
+	(void)pc; (void)sp; (void)delay_ms;
+	hostCounters.watchdogReboots++;
+}
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) { (void)delay_ms; (void)pause_on_debug; }
+void watchdog_update(void) {}
+
+// Flash, erased bits read as 1 and programming can only clear them
+
+// Shortens the operation to what gets done before a pending power cut, true if it is the one cut short
+static bool flashPowerFails(size_t &count)
+{
+	if (flashPowerCountdown < 0 || flashPowerCountdown-- > 0)
+		return false;
+	count = std::min(count, flashPowerBytes);
+	return true;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+	if ((flash_offs % FLASH_SECTOR_SIZE) || (count % FLASH_SECTOR_SIZE) || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+		panic("flash_range_erase(0x%x, %zu) is not sector aligned", flash_offs, count);
+	const bool cut = flashPowerFails(count);
+	memset(HostSDK::flash() + flash_offs, 0xFF, count);
+	if (cut)
+		throw HostSDK::PowerLoss();
+	hostCounters.flashErases += count / FLASH_SECTOR_SIZE;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+	if ((flash_offs % FLASH_PAGE_SIZE) || (count % FLASH_PAGE_SIZE) || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+		panic("flash_range_program(0x%x, %zu) is not page aligned", flash_offs, count);
+	const bool cut = flashPowerFails(count);
+	uint8_t *target = HostSDK::flash() + flash_offs;
+	for (size_t i = 0; i < count; i++)
+		target[i] &= data[i];
+	if (cut)
+		throw HostSDK::PowerLoss();
+	hostCounters.flashPrograms += count / FLASH_PAGE_SIZE;
+}
+
+// DMA, see the stub hardware/dma.h
+
+int dma_claim_unused_channel(bool required)
+{
+	for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+		if (!dmaChannels[channel].claimed) {
+			dmaChannels[channel].claimed = true;
+			return channel;
+		}
+	}
+	if (required)
+		panic("no DMA channels available");
+	return -1;
+}
+
+void dma_channel_claim(uint channel)
+{
+	if (dmaChannels[channel].claimed)
+		panic("DMA channel %u already claimed", channel);
+	dmaChannels[channel].claimed = true;
+}
+
+void dma_channel_unclaim(uint channel) { dmaChannels[channel].claimed = false; }
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+	dma_channel_config c = { 0 };
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_dreq(&c, DREQ_FORCE);
+	channel_config_set_chain_to(&c, channel);
+	return c;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+	DmaChannel &ch = dmaChannels[channel];
+	ch.ctrl = config->ctrl;
+	ch.write = write_addr;
+	ch.read = read_addr;
+	ch.count = transfer_count;
+	if (trigger)
+		startDma(channel);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger)
+{
+	dmaChannels[channel].read = read_addr;
+	if (trigger)
+		startDma(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+	dmaChannels[channel].read = read_addr;
+	dmaChannels[channel].count = transfer_count;
+	startDma(channel);
+}
+
+void dma_channel_start(uint channel) { startDma(channel); }
+
+void dma_channel_abort(uint channel) { dmaChannels[channel].busy = false; }
+
+// A poll that finds the channel busy lets a microsecond pass, so loops spinning on it get to the end
+bool dma_channel_is_busy(uint channel)
+{
+	if (!dmaChannels[channel].busy)
+		return false;
+	HostSDK::advanceTime(1);
+	return dmaChannels[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+	while (dmaChannels[channel].busy) {
+		const DmaChannel &ch = dmaChannels[channel];
+		const uint64_t doneNs = ch.nextNs + static_cast<uint64_t>(ch.remaining - 1) * dmaPeriod(ch);
+		HostSDK::advanceTo((doneNs + 999) / 1000);
+	}
+}
+
+void dma_sniffer_enable(uint channel, uint mode, bool force_channel_enable)
+{
+	if (force_channel_enable)
+		dmaChannels[channel].ctrl |= HOST_DMA_CTRL_SNIFF;
+	host_dma_hw.sniff_ctrl = DMA_SNIFF_CTRL_EN_BITS | (channel << DMA_SNIFF_CTRL_DMACH_LSB) | (mode << DMA_SNIFF_CTRL_CALC_LSB);
+}
+
+void dma_sniffer_disable(void)
+{
+	host_dma_hw.sniff_ctrl = 0;
+}
+
+// PIO, see the stub hardware/pio.h
+
+static uint32_t pioProgramMask(const pio_program_t *program)
+{
+	return program->length >= PIO_INSTRUCTION_COUNT ? 0xffffffffu : (1u << program->length) - 1;
+}
+
+// Like the SDK, the highest free offset unless the program has an origin
+static int findPioOffset(const Pio &pio, const pio_program_t *program)
+{
+	const uint32_t mask = pioProgramMask(program);
+	if (program->origin >= 0)
+		return (program->origin + program->length <= PIO_INSTRUCTION_COUNT && !(pio.used & (mask << program->origin))) ? program->origin : -1;
+	for (int offset = PIO_INSTRUCTION_COUNT - program->length; offset >= 0; offset--) {
+		if (!(pio.used & (mask << offset)))
+			return offset;
+	}
+	return -1;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program) { return findPioOffset(pioFor(pio), program) >= 0; }
+
+// JMP targets move with the program
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+	Pio &p = pioFor(pio);
+	const int offset = findPioOffset(p, program);
+	if (offset < 0)
+		panic("No program space");
+	for (uint i = 0; i < program->length; i++) {
+		const uint16_t instr = program->instructions[i];
+		p.instructions[offset + i] = (instr >> 13) ? instr : ((instr & ~0x1f) | ((instr + offset) & 0x1f));
+	}
+	p.used |= pioProgramMask(program) << offset;
+	return offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset)
+{
+	pioFor(pio).used &= ~(pioProgramMask(program) << loaded_offset);
+}
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+	Pio &p = pioFor(pio);
+	for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+		if (!p.sms[sm].claimed) {
+			p.sms[sm].claimed = true;
+			return sm;
+		}
+	}
+	if (required)
+		panic("No PIO state machines are available");
+	return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm)
+{
+	PioStateMachine &s = pioFor(pio).sms[sm];
+	if (s.claimed)
+		panic("PIO%u SM%u already claimed", pio_get_index(pio), sm);
+	s.claimed = true;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) { pioFor(pio).sms[sm].claimed = false; }
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+	(void)pio;
+	if (pin >= NUM_BANK0_GPIOS)
+		panic("GPIO %u does not exist", pin);
+}
+
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out)
+{
+	(void)pio; (void)sm; (void)pin_base; (void)pin_count; (void)is_out;
+	return 0;
+}
+
+// Stops the state machine, empties its FIFOs and OSR and puts it at initial_pc
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+	PioStateMachine &s = pioFor(pio).sms[sm];
+	s.enabled = false;
+	s.config = config ? *config : pio_get_default_sm_config();
+	s.div256 = static_cast<uint32_t>(s.config.clkdiv * 256);
+	if (s.div256 < 256)
+		panic("PIO%u SM%u clock divider %f below 1", pio_get_index(pio), sm, s.config.clkdiv);
+	s.pc = initial_pc;
+	s.x = 0;
+	s.y = 0;
+	s.osr = 0;
+	s.osrShifted = 32;
+	s.tx.clear();
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+	PioStateMachine &s = pioFor(pio).sms[sm];
+	if (enabled == s.enabled)
+		return;
+	if (enabled) {
+		s.startNs = hostNow * 1000;
+		s.cycle = 0;
+	} else {
+		catchUpPio(pio_get_index(pio), sm, hostNow * 1000);
+	}
+	s.enabled = enabled;
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) { pioFor(pio).sms[sm].tx.clear(); }
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) { return pio_sm_get_tx_fifo_level(pio, sm) >= pioTxDepth(pioFor(pio).sms[sm]); }
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) { return pio_sm_get_tx_fifo_level(pio, sm) == 0; }
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm)
+{
+	catchUpPio(pio_get_index(pio), sm, hostNow * 1000);
+	return pioFor(pio).sms[sm].tx.size();
+}
+
+// A word that finds the FIFO full is lost, as on the chip
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+	if (!pio_sm_is_tx_fifo_full(pio, sm))
+		pioFor(pio).sms[sm].tx.push_back(data);
+}
+
+// Lets time pass a cycle of the state machine at a time until it makes room
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+	PioStateMachine &s = pioFor(pio).sms[sm];
+	while (pio_sm_is_tx_fifo_full(pio, sm)) {
+		if (!s.enabled)
+			panic("pio_sm_put_blocking() waits on PIO%u SM%u, but it is not running", pio_get_index(pio), sm);
+		HostSDK::advanceTo((pioCycleNs(s, s.cycle) + 999) / 1000);
+	}
+	s.tx.push_back(data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) { panic("PIO%u SM%u RX FIFO is not modelled", pio_get_index(pio), sm); }
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) { return pio_sm_get(pio, sm); }
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) { (void)pio; (void)sm; return true; }
+
+uint pio_get_index(PIO pio) { return &pioFor(pio) - pios; }
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { return (pio_get_index(pio) ? DREQ_PIO1_TX0 : DREQ_PIO0_TX0) + sm + (is_tx ? 0 : 4); }
+
+// ADC, see the stub hardware/adc.h
+
+void adc_init(void) { resetAdc(); }
+
+void adc_gpio_init(uint gpio)
+{
+	if (gpio < 26 || gpio > 29)
+		panic("GPIO %u has no ADC input", gpio);
+}
+
+void adc_select_input(uint input)
+{
+	if (input >= NUM_ADC_CHANNELS)
+		panic("ADC input %u does not exist", input);
+	catchUpAdc(hostNow * 1000);
+	hostAdc.input = input;
+}
+
+uint adc_get_selected_input(void) { return hostAdc.input; }
+
+void adc_set_round_robin(uint input_mask)
+{
+	catchUpAdc(hostNow * 1000);
+	hostAdc.roundRobin = input_mask & ((1u << NUM_ADC_CHANNELS) - 1);
+}
+
+// A one-shot conversion takes its 96 cycles whatever the divider says
+uint16_t adc_read(void)
+{
+	if (hostAdc.running)
+		panic("adc_read() while the ADC runs free gets whichever input the round-robin is on");
+	HostSDK::advanceTime(1000000ULL * HOST_ADC_CONVERSION_CYCLES / HOST_ADC_CLOCK_HZ);
+	hostCounters.adcReads++;
+	const uint16_t value = convertAdc(hostNow * 1000);
+	pushAdcFifo(value);
+	return value;
+}
+
+void adc_run(bool run)
+{
+	catchUpAdc(hostNow * 1000);
+	if (run && !hostAdc.running)
+		hostAdc.nextNs = hostNow * 1000 + hostAdc.periodNs;
+	hostAdc.running = run;
+}
+
+// One conversion every 1 + clkdiv cycles, but never faster than a conversion takes
+void adc_set_clkdiv(float clkdiv)
+{
+	catchUpAdc(hostNow * 1000);
+	const double cycles = std::max<double>(HOST_ADC_CONVERSION_CYCLES, 1.0 + clkdiv);
+	hostAdc.periodNs = static_cast<uint32_t>(cycles * 1e9 / HOST_ADC_CLOCK_HZ + 0.5);
+	dreqPeriods[DREQ_ADC] = hostAdc.periodNs;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift)
+{
+	if (err_in_fifo || byte_shift || (dreq_en && dreq_thresh != 1))
+		panic("only a FIFO of plain 12 bit results with DREQ at one entry is modelled");
+	catchUpAdc(hostNow * 1000);
+	hostAdc.fifoEnabled = en;
+}
+
+void adc_fifo_drain(void)
+{
+	catchUpAdc(hostNow * 1000);
+	hostAdc.fifo.clear();
+}
+
+// I2C, see the stub hardware/i2c.h
+
+host_i2c_register::operator uint32_t() const volatile { return readI2CRegister(i2cBusForRegister(this), this); }
+
+void host_i2c_register::operator=(uint32_t word) volatile
+{
+	const uint bus = i2cBusForRegister(this);
+	if (this != &host_i2c_hw[bus].data_cmd)
+		panic("i2c%u FIFO register at 0x%x is read only", bus, static_cast<uint>(reinterpret_cast<const volatile uint8_t *>(this) - reinterpret_cast<volatile uint8_t *>(&host_i2c_hw[bus])));
+	queueI2CDataCmd(bus, word);
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+	const uint bus = i2c_hw_index(i2c);
+	resetI2C(bus);
+	i2c->hw->enable = 1;
+	return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+	resetI2C(i2c_hw_index(i2c));
+	i2cBuses[i2c_hw_index(i2c)].baudrate = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+	const uint bus = i2c_hw_index(i2c);
+	i2cBuses[bus].baudrate = baudrate;
+	const uint32_t byteNs = i2cByteNs(bus);
+	dreqPeriods[i2c_get_dreq(i2c, true)] = byteNs;
+	dreqPeriods[i2c_get_dreq(i2c, false)] = byteNs;
+	return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+	const uint bus = i2c_hw_index(i2c);
+	i2c->hw->tar = addr;
+	i2c->hw->raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+	i2c->restart_on_next = nostop;
+	if (!i2cBuses[bus].devices.count(addr)) {
+		waitI2C(bus, 1); // NACKed address byte
+		return PICO_ERROR_GENERIC;
+	}
+	waitI2C(bus, len + 1);
+	return deliverI2CWrite(bus, addr, src, len) ? static_cast<int>(len) : PICO_ERROR_GENERIC;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+	const uint bus = i2c_hw_index(i2c);
+	i2c->hw->tar = addr;
+	i2c->hw->raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+	i2c->restart_on_next = nostop;
+	auto found = i2cBuses[bus].devices.find(addr);
+	if (found == i2cBuses[bus].devices.end()) {
+		waitI2C(bus, 1);
+		return PICO_ERROR_GENERIC;
+	}
+	waitI2C(bus, len + 1);
+	return found->second->read(dst, len) ? static_cast<int>(len) : PICO_ERROR_GENERIC;
+}
+
+// SPI, nothing attached
+
+uint spi_init(spi_inst_t *spi, uint baudrate)
+{
+	spi->baudrate = baudrate;
+	return baudrate;
+}
+
+void spi_deinit(spi_inst_t *spi) { spi->baudrate = 0; }
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order)
+{
+	(void)spi; (void)data_bits; (void)cpol; (void)cpha; (void)order;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+	(void)src;
+	if (spi->baudrate == 0)
+		panic("spi used before spi_init()");
+	HostSDK::advanceTime((len * 8 * 1000000ULL + spi->baudrate - 1) / spi->baudrate);
+	return static_cast<int>(len);
+}
+
+// USB device, see the stub tusb.h
+
+bool tud_init(uint8_t rhport) { (void)rhport; return true; }
+bool tud_mounted(void) { return usbMounted; }
+bool tud_ready(void) { return usbMounted; }
+bool tud_suspended(void) { return false; }
+bool tud_remote_wakeup(void) { return false; }
+void tud_task(void) {}
+
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const *request, void *buffer, uint16_t len)
+{
+	(void)rhport; (void)request; (void)buffer; (void)len;
+	return true;
+}
+
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const *desc_ep)
+{
+	(void)rhport;
+	usbEndpoint(desc_ep->bEndpointAddress).opened = true;
+	return true;
+}
+
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr)
+{
+	(void)rhport;
+	UsbEndpoint &ep = usbEndpoint(ep_addr);
+	if (ep.busy || ep.claimed)
+		return false;
+	ep.claimed = true;
+	return true;
+}
+
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr)
+{
+	(void)rhport;
+	UsbEndpoint &ep = usbEndpoint(ep_addr);
+	const bool claimed = ep.claimed;
+	ep.claimed = false;
+	return claimed;
+}
+
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint16_t total_bytes)
+{
+	(void)rhport;
+	UsbEndpoint &ep = usbEndpoint(ep_addr);
+	if (!ep.opened)
+		panic("usbd_edpt_xfer() on endpoint 0x%02x, which was never opened", ep_addr);
+	if (ep.busy)
+		panic("usbd_edpt_xfer() on busy endpoint 0x%02x", ep_addr); // TU_ASSERT in TinyUSB
+	ep.busy = true;
+	ep.buffer = buffer;
+	ep.length = total_bytes;
+	hostCounters.usbTransfers++;
+	return true;
+}
+
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr)
+{
+	(void)rhport;
+	return usbEndpoint(ep_addr).busy;
+}
+
+void usbd_sof_enable(uint8_t rhport, bool en) { (void)rhport; (void)en; }
+
+void hidd_init(void) {}
+void hidd_reset(uint8_t rhport) { (void)rhport; }
+
+uint16_t hidd_open(uint8_t rhport, tusb_desc_interface_t const *desc_itf, uint16_t max_len)
+{
+	const uint8_t *desc = reinterpret_cast<const uint8_t *>(desc_itf);
+	const uint8_t *end = desc + max_len;
+	const uint8_t *current = tu_desc_next(desc);
+	while (current < end && tu_desc_type(current) != TUSB_DESC_INTERFACE) {
+		if (tu_desc_type(current) == TUSB_DESC_ENDPOINT) {
+			const tusb_desc_endpoint_t *endpoint = reinterpret_cast<const tusb_desc_endpoint_t *>(current);
+			usbd_edpt_open(rhport, endpoint);
+			if (tu_edpt_dir(endpoint->bEndpointAddress) == TUSB_DIR_IN && usbHidIn == 0)
+				usbHidIn = endpoint->bEndpointAddress;
+		}
+		current = tu_desc_next(current);
+	}
+	return static_cast<uint16_t>(current - desc);
+}
+
+bool hidd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request)
+{
+	(void)rhport; (void)stage; (void)request;
+	return true;
+}
+
+bool hidd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes)
+{
+	(void)rhport; (void)ep_addr; (void)result; (void)xferred_bytes;
+	return true;
+}
+
+bool tud_hid_ready(void) { return usbMounted && usbHidIn != 0 && !usbEndpoint(usbHidIn).busy; }
+
+// Like TinyUSB, the report is copied behind its ID into the class driver's own buffer
+bool tud_hid_report(uint8_t report_id, void const *report, uint16_t len)
+{
+	if (!tud_hid_ready() || !usbd_edpt_claim(0, usbHidIn))
+		return false;
+	uint16_t offset = 0;
+	if (report_id != 0)
+		usbHidBuffer[offset++] = report_id;
+	if (len > sizeof(usbHidBuffer) - offset)
+		len = sizeof(usbHidBuffer) - offset;
+	memcpy(usbHidBuffer + offset, report, len);
+	return usbd_edpt_xfer(0, usbHidIn, usbHidBuffer, offset + len);
+}
+
+}
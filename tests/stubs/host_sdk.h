@@ -0,0 +1,121 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Host side of the Pico SDK stand-ins under tests/stubs.
+ *
+ * The stubs let firmware sources build and run on the development machine. Peripherals are
+ * modelled only as far as the tests need: a virtual microsecond clock with alarm pools, GPIO
+ * levels and edge interrupts, interrupt lines, a simulated flash image that can lose power part of
+ * the way through an operation, a USB device stack, DMA channels paced on the virtual clock,
+ * I2C controllers with devices attached, an ADC sampling test signals and PIO state machines running
+ * their programs.
+ * Tests drive them through here.
+ */
+
+#ifndef _HOST_SDK_H_
+#define _HOST_SDK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional>
+#include <vector>
+
+#include "pico/types.h"
+
+namespace HostSDK
+{
+	// Start over: clock at HOST_BOOT_TIME_US, all pins pulled high, flash erased, no alarms
+	void reset();
+	// The same, but the flash keeps what was on it, as it does when a board loses power
+	void powerCycle();
+
+	// Virtual time, alarms that come due while it advances fire in deadline order
+	uint64_t now();
+	void advanceTime(uint64_t us);
+	void advanceTo(uint64_t us);
+
+	// Core the calling code pretends to run on, alarm callbacks run on their pool's core
+	void setCore(uint core);
+
+	// Raw pin levels, edges on pins with interrupts enabled call the registered handlers, which have to
+	// acknowledge them
+	void setGpioLevels(uint32_t levels);
+	uint32_t getGpioLevels();
+	// Buttons pull to ground, so a pressed pin reads low
+	inline void setPressedPins(uint32_t pressed) { setGpioLevels(~pressed & ((1UL << 30) - 1)); }
+	uint32_t getGpioOutputs();
+
+	// Run the handlers for an enabled interrupt line, false if nothing would have been called
+	bool raiseIrq(uint num);
+
+	// Simulated flash, mapped at XIP_BASE so firmware reads it through its usual pointers
+	uint8_t *flash();
+	size_t flashSize();
+	// Power fails during the flash operation that follows the next operations ones: only the first bytes of
+	// its range are erased or programmed, then PowerLoss is thrown out of the flash call like a reset would.
+	// Called off by powerCycle()
+	struct PowerLoss {};
+	void cutFlashPower(uint32_t operations, size_t bytes);
+
+	// USB device, ready once mounted. IN transfers stay in flight until the host polls the endpoint
+	void setUsbMounted(bool mounted);
+	bool usbInFlight(uint8_t endpoint);
+	// Completes an in-flight IN transfer and returns what the host read, taken from the buffer as it is now
+	std::vector<uint8_t> pollUsbIn(uint8_t endpoint);
+	// IN endpoint used by tud_hid_report(), found by hidd_open()
+	uint8_t usbHidEndpoint();
+
+	// Device on an I2C bus. A write or read is everything between START and STOP, returning false NACKs it
+	class I2CDevice
+	{
+	public:
+		virtual ~I2CDevice() {}
+		virtual bool write(const uint8_t *data, size_t length) = 0;
+		virtual bool read(uint8_t *data, size_t length) = 0;
+	};
+	// Answer at address on bus 0 or 1, nullptr detaches. The device is not owned
+	void attachI2CDevice(uint bus, uint8_t address, I2CDevice *device);
+
+	// ADC inputs 0-3 on GPIO 26-29 and 4, the temperature sensor. A conversion finishing at ns reads
+	// source(input, ns), clamped to 12 bits. Without a source every input reads 0
+	typedef std::function<uint16_t(uint input, uint64_t ns)> AdcSource;
+	void setAdcSource(AdcSource source);
+
+	// Time between transfers of a DMA channel paced by dreq, I2C DREQs follow the bus speed
+	// and DREQ_ADC the conversion rate by default
+	void setDreqPeriod(uint dreq, uint32_t ns);
+
+	// Pin a PIO state machine drove to a new level, at the virtual time in ns
+	struct PinEdge
+	{
+		uint pin;
+		bool high;
+		uint64_t ns;
+	};
+	// Edges the state machines made since the last call, in time order. State machines are caught up to
+	// now first, their levels are kept apart from the GPIO ones
+	std::vector<PinEdge> takePioEdges();
+
+	struct Counters
+	{
+		uint32_t flashErases;      // Sectors erased
+		uint32_t flashPrograms;    // Pages programmed
+		uint32_t lockouts;         // multicore_lockout_start_blocking() calls
+		uint32_t alarmsFired;
+		uint32_t watchdogReboots;
+		uint32_t usbTransfers;     // usbd_edpt_xfer() calls, including the ones tud_hid_report() makes
+		uint32_t i2cWrites;        // Writes a device acked, blocking or by DMA
+		uint32_t i2cBytes;         // Data bytes in those writes
+		uint32_t i2cReads;         // Reads a device answered, blocking or from the RX FIFO
+		uint32_t dmaRuns;          // DMA channel runs that finished
+		uint32_t adcReads;         // Blocking adc_read() conversions
+		uint32_t adcOverflows;     // Free-running conversions lost to a full FIFO
+	};
+	Counters &counters();
+}
+
+// Virtual clock reading after HostSDK::reset(), keeps early deadlines clear of nil_time
+#define HOST_BOOT_TIME_US 1000000ULL
+
+#endif
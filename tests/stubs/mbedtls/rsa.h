@@ -0,0 +1,20 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for mbedtls/rsa.h from the Pico SDK's mbedtls, see host_sdk.h
+ *
+ * Only the types PS4ModeAddon and the legacy config layout use, nothing here signs anything.
+ */
+
+#ifndef _HOST_MBEDTLS_RSA_H_
+#define _HOST_MBEDTLS_RSA_H_
+
+#include <stdint.h>
+
+typedef uint32_t mbedtls_mpi_uint; // 32 bit limbs on the Cortex-M0+
+
+struct mbedtls_rsa_context
+{
+	int unused;
+};
+
+#endif
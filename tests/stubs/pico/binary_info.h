@@ -0,0 +1,14 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK pico/binary_info.h, see host_sdk.h
+ *
+ * There is no binary to tag, the declarations compile to nothing.
+ */
+
+#ifndef _HOST_PICO_BINARY_INFO_H_
+#define _HOST_PICO_BINARY_INFO_H_
+
+#define bi_decl(...)
+#define bi_decl_if_func_used(...)
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK pico/critical_section.h, see host_sdk.h
+ */
+
+#ifndef _HOST_PICO_CRITICAL_SECTION_H_
+#define _HOST_PICO_CRITICAL_SECTION_H_
+
+#include "pico/lock_core.h"
+
+typedef struct critical_section {
+	spin_lock_t lock;
+	uint32_t save;
+	bool initialized;
+} critical_section_t;
+
+static inline void critical_section_init(critical_section_t *crit_sec)
+{
+	crit_sec->lock = 0;
+	crit_sec->save = 0;
+	crit_sec->initialized = true;
+}
+
+static inline void critical_section_init_with_lock_num(critical_section_t *crit_sec, uint lock_num)
+{
+	(void)lock_num;
+	critical_section_init(crit_sec);
+}
+
+static inline void critical_section_enter_blocking(critical_section_t *crit_sec)
+{
+	crit_sec->save = spin_lock_blocking(&crit_sec->lock);
+}
+
+static inline void critical_section_exit(critical_section_t *crit_sec)
+{
+	spin_unlock(&crit_sec->lock, crit_sec->save);
+}
+
+static inline void critical_section_deinit(critical_section_t *crit_sec)
+{
+	crit_sec->initialized = false;
+}
+
+static inline bool critical_section_is_initialized(critical_section_t *crit_sec)
+{
+	return crit_sec->initialized;
+}
+
+#endif
@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK pico/lock_core.h, see host_sdk.h
+ */
+
+#ifndef _HOST_PICO_LOCK_CORE_H_
+#define _HOST_PICO_LOCK_CORE_H_
+
+#include "hardware/sync.h"
+
+typedef struct lock_core {
+	spin_lock_t *spin_lock;
+} lock_core_t;
+
+#endif
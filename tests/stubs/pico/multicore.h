@@ -0,0 +1,27 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK pico/multicore.h, see host_sdk.h
+ *
+ * Core1 is not started on the host, tests call its loop body directly. Lockouts are counted.
+ */
+
+#ifndef _HOST_PICO_MULTICORE_H_
+#define _HOST_PICO_MULTICORE_H_
+
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+void multicore_lockout_victim_init(void);
+void multicore_lockout_start_blocking(void);
+void multicore_lockout_end_blocking(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK pico/platform.h, see host_sdk.h
+ */
+
+#ifndef _HOST_PICO_PLATFORM_H_
+#define _HOST_PICO_PLATFORM_H_
+
+#include "pico/types.h"
+
+#include <assert.h>
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+#define _u(x) x ## u
+
+#define XIP_BASE 0x10000000
+#define SRAM_END 0x20042000
+
+#define NUM_BANK0_GPIOS 30
+#define NUM_CORES 2
+#define NUM_DMA_CHANNELS 12
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name) func_name
+#define __no_inline_not_in_flash_func(func_name) __attribute__((noinline)) func_name
+#define __time_critical_func(func_name) func_name
+#define __in_flash(group)
+#define __uninitialized_ram(var) var
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __force_inline inline __attribute__((always_inline))
+
+enum pico_error_codes {
+	PICO_OK = 0,
+	PICO_ERROR_GENERIC = -1,
+	PICO_ERROR_TIMEOUT = -2,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint get_core_num(void);
+
+static inline void tight_loop_contents(void) {}
+
+static inline void __dmb(void) { __sync_synchronize(); }
+static inline void __sev(void) {}
+static inline void __wfe(void) {}
+static inline void __wfi(void) {}
+
+void panic(const char *fmt, ...) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK pico/sync.h, see host_sdk.h
+ */
+
+#ifndef _HOST_PICO_SYNC_H_
+#define _HOST_PICO_SYNC_H_
+
+#include "pico/critical_section.h"
+#include "pico/mutex.h"
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the Pico SDK pico/types.h, see host_sdk.h
+ */
+
+#ifndef _HOST_PICO_TYPES_H_
+#define _HOST_PICO_TYPES_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+typedef uint64_t absolute_time_t;
+
+#endif
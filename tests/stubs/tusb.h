@@ -0,0 +1,294 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Host stand-in for the parts of TinyUSB's tusb.h the gamepad descriptors and USB drivers use, see host_sdk.h
+ *
+ * The device stack is modelled in host_sdk.cpp: endpoints follow TinyUSB's claim and busy rules, and an
+ * IN transfer stays in flight, reading from its buffer, until the test polls it as the host would.
+ */
+
+#ifndef _HOST_TUSB_H_
+#define _HOST_TUSB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#define OPT_MCU_RP2040 1900
+#define OPT_OS_NONE 1
+#define OPT_OS_PICO 5
+#define OPT_MODE_DEVICE 0x0001
+#define OPT_MODE_FULL_SPEED 0x0000
+#define OPT_MODE_HIGH_SPEED 0x0400
+#define OPT_MODE_DEFAULT_SPEED 0x0000
+
+#define TUD_OPT_RHPORT 0
+#define CFG_TUD_HID_EP_BUFSIZE 64
+
+typedef struct __attribute__((packed)) {
+	uint8_t  bLength;
+	uint8_t  bDescriptorType;
+	uint16_t bcdUSB;
+	uint8_t  bDeviceClass;
+	uint8_t  bDeviceSubClass;
+	uint8_t  bDeviceProtocol;
+	uint8_t  bMaxPacketSize0;
+	uint16_t idVendor;
+	uint16_t idProduct;
+	uint16_t bcdDevice;
+	uint8_t  iManufacturer;
+	uint8_t  iProduct;
+	uint8_t  iSerialNumber;
+	uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+enum {
+	TUSB_DESC_DEVICE = 0x01,
+	TUSB_DESC_CONFIGURATION = 0x02,
+	TUSB_DESC_STRING = 0x03,
+	TUSB_DESC_INTERFACE = 0x04,
+	TUSB_DESC_ENDPOINT = 0x05,
+};
+
+enum {
+	TUSB_XFER_CONTROL = 0,
+	TUSB_XFER_ISOCHRONOUS,
+	TUSB_XFER_BULK,
+	TUSB_XFER_INTERRUPT
+};
+
+enum {
+	TUSB_CLASS_HID = 3,
+	TUSB_CLASS_VENDOR_SPECIFIC = 0xFF,
+};
+
+enum {
+	HID_DESC_TYPE_HID = 0x21,
+	HID_DESC_TYPE_REPORT = 0x22,
+};
+
+enum {
+	HID_ITF_PROTOCOL_NONE = 0,
+	HID_ITF_PROTOCOL_KEYBOARD = 1,
+	HID_ITF_PROTOCOL_MOUSE = 2,
+};
+
+#define TU_U16_HIGH(_u16) ((uint8_t)(((_u16) >> 8) & 0x00ff))
+#define TU_U16_LOW(_u16) ((uint8_t)((_u16) & 0x00ff))
+#define U16_TO_U8S_LE(_u16) TU_U16_LOW(_u16), TU_U16_HIGH(_u16)
+
+#define TUD_CONFIG_DESC_LEN (9)
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+	9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, TU_BIT(7) | _attribute, (_power_ma)/2
+
+#define TUD_HID_DESC_LEN (9 + 9 + 7)
+#define TUD_HID_DESCRIPTOR(_itfnum, _stridx, _boot_protocol, _report_desc_len, _epin, _epsize, _ep_interval) \
+	9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_HID, (uint8_t)((_boot_protocol) ? 1 : 0), _boot_protocol, _stridx, \
+	9, HID_DESC_TYPE_HID, U16_TO_U8S_LE(0x0111), 0, 1, HID_DESC_TYPE_REPORT, U16_TO_U8S_LE(_report_desc_len), \
+	7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_epsize), _ep_interval
+
+#define TU_BIT(n) (1UL << (n))
+
+#define TU_VERIFY(_cond, _ret) do { if (!(_cond)) return _ret; } while (0)
+#define TU_ASSERT(_cond) TU_VERIFY(_cond, false)
+
+typedef enum {
+	TUSB_DIR_OUT = 0,
+	TUSB_DIR_IN = 1,
+	TUSB_DIR_IN_MASK = 0x80,
+} tusb_dir_t;
+
+typedef enum {
+	XFER_RESULT_SUCCESS = 0,
+	XFER_RESULT_FAILED,
+	XFER_RESULT_STALLED,
+	XFER_RESULT_TIMEOUT,
+} xfer_result_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bInterfaceNumber;
+	uint8_t bAlternateSetting;
+	uint8_t bNumEndpoints;
+	uint8_t bInterfaceClass;
+	uint8_t bInterfaceSubClass;
+	uint8_t bInterfaceProtocol;
+	uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bEndpointAddress;
+	uint8_t bmAttributes;
+	uint16_t wMaxPacketSize;
+	uint8_t bInterval;
+} tusb_desc_endpoint_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} tusb_control_request_t;
+
+static inline uint8_t tu_desc_len(void const *desc) { return ((uint8_t const *)desc)[0]; }
+static inline uint8_t tu_desc_type(void const *desc) { return ((uint8_t const *)desc)[1]; }
+static inline uint8_t const *tu_desc_next(void const *desc) { return (uint8_t const *)desc + tu_desc_len(desc); }
+static inline tusb_dir_t tu_edpt_dir(uint8_t addr) { return (addr & TUSB_DIR_IN_MASK) ? TUSB_DIR_IN : TUSB_DIR_OUT; }
+static inline uint8_t tu_edpt_number(uint8_t addr) { return (uint8_t)(addr & (~TUSB_DIR_IN_MASK)); }
+
+typedef enum {
+	HID_REPORT_TYPE_INVALID = 0,
+	HID_REPORT_TYPE_INPUT,
+	HID_REPORT_TYPE_OUTPUT,
+	HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+enum {
+	HID_REQ_CONTROL_GET_REPORT = 0x01,
+	HID_REQ_CONTROL_GET_IDLE = 0x02,
+	HID_REQ_CONTROL_GET_PROTOCOL = 0x03,
+	HID_REQ_CONTROL_SET_REPORT = 0x09,
+	HID_REQ_CONTROL_SET_IDLE = 0x0a,
+	HID_REQ_CONTROL_SET_PROTOCOL = 0x0b,
+};
+
+typedef enum {
+	KEYBOARD_MODIFIER_LEFTCTRL   = TU_BIT(0),
+	KEYBOARD_MODIFIER_LEFTSHIFT  = TU_BIT(1),
+	KEYBOARD_MODIFIER_LEFTALT    = TU_BIT(2),
+	KEYBOARD_MODIFIER_LEFTGUI    = TU_BIT(3),
+	KEYBOARD_MODIFIER_RIGHTCTRL  = TU_BIT(4),
+	KEYBOARD_MODIFIER_RIGHTSHIFT = TU_BIT(5),
+	KEYBOARD_MODIFIER_RIGHTALT   = TU_BIT(6),
+	KEYBOARD_MODIFIER_RIGHTGUI   = TU_BIT(7)
+} hid_keyboard_modifier_bm_t;
+
+#define HID_KEY_NONE                  0x00
+#define HID_KEY_A                     0x04
+#define HID_KEY_B                     0x05
+#define HID_KEY_C                     0x06
+#define HID_KEY_D                     0x07
+#define HID_KEY_E                     0x08
+#define HID_KEY_F                     0x09
+#define HID_KEY_G                     0x0A
+#define HID_KEY_H                     0x0B
+#define HID_KEY_I                     0x0C
+#define HID_KEY_J                     0x0D
+#define HID_KEY_K                     0x0E
+#define HID_KEY_L                     0x0F
+#define HID_KEY_M                     0x10
+#define HID_KEY_N                     0x11
+#define HID_KEY_O                     0x12
+#define HID_KEY_P                     0x13
+#define HID_KEY_Q                     0x14
+#define HID_KEY_R                     0x15
+#define HID_KEY_S                     0x16
+#define HID_KEY_T                     0x17
+#define HID_KEY_U                     0x18
+#define HID_KEY_V                     0x19
+#define HID_KEY_W                     0x1A
+#define HID_KEY_X                     0x1B
+#define HID_KEY_Y                     0x1C
+#define HID_KEY_Z                     0x1D
+#define HID_KEY_1                     0x1E
+#define HID_KEY_2                     0x1F
+#define HID_KEY_3                     0x20
+#define HID_KEY_4                     0x21
+#define HID_KEY_5                     0x22
+#define HID_KEY_6                     0x23
+#define HID_KEY_7                     0x24
+#define HID_KEY_8                     0x25
+#define HID_KEY_9                     0x26
+#define HID_KEY_0                     0x27
+#define HID_KEY_ENTER                 0x28
+#define HID_KEY_ESCAPE                0x29
+#define HID_KEY_BACKSPACE             0x2A
+#define HID_KEY_TAB                   0x2B
+#define HID_KEY_SPACE                 0x2C
+#define HID_KEY_MINUS                 0x2D
+#define HID_KEY_EQUAL                 0x2E
+#define HID_KEY_BRACKET_LEFT          0x2F
+#define HID_KEY_BRACKET_RIGHT         0x30
+#define HID_KEY_BACKSLASH             0x31
+#define HID_KEY_EUROPE_1              0x32
+#define HID_KEY_SEMICOLON             0x33
+#define HID_KEY_APOSTROPHE            0x34
+#define HID_KEY_GRAVE                 0x35
+#define HID_KEY_COMMA                 0x36
+#define HID_KEY_PERIOD                0x37
+#define HID_KEY_SLASH                 0x38
+#define HID_KEY_CAPS_LOCK             0x39
+#define HID_KEY_F1                    0x3A
+#define HID_KEY_F2                    0x3B
+#define HID_KEY_F3                    0x3C
+#define HID_KEY_F4                    0x3D
+#define HID_KEY_F5                    0x3E
+#define HID_KEY_F6                    0x3F
+#define HID_KEY_F7                    0x40
+#define HID_KEY_F8                    0x41
+#define HID_KEY_F9                    0x42
+#define HID_KEY_F10                   0x43
+#define HID_KEY_F11                   0x44
+#define HID_KEY_F12                   0x45
+#define HID_KEY_PRINT_SCREEN          0x46
+#define HID_KEY_SCROLL_LOCK           0x47
+#define HID_KEY_PAUSE                 0x48
+#define HID_KEY_INSERT                0x49
+#define HID_KEY_HOME                  0x4A
+#define HID_KEY_PAGE_UP               0x4B
+#define HID_KEY_DELETE                0x4C
+#define HID_KEY_END                   0x4D
+#define HID_KEY_PAGE_DOWN             0x4E
+#define HID_KEY_ARROW_RIGHT           0x4F
+#define HID_KEY_ARROW_LEFT            0x50
+#define HID_KEY_ARROW_DOWN            0x51
+#define HID_KEY_ARROW_UP              0x52
+#define HID_KEY_NUM_LOCK              0x53
+#define HID_KEY_KEYPAD_DIVIDE         0x54
+#define HID_KEY_KEYPAD_MULTIPLY       0x55
+#define HID_KEY_KEYPAD_SUBTRACT       0x56
+#define HID_KEY_KEYPAD_ADD            0x57
+#define HID_KEY_KEYPAD_ENTER          0x58
+#define HID_KEY_KEYPAD_1              0x59
+#define HID_KEY_KEYPAD_2              0x5A
+#define HID_KEY_KEYPAD_3              0x5B
+#define HID_KEY_KEYPAD_4              0x5C
+#define HID_KEY_KEYPAD_5              0x5D
+#define HID_KEY_KEYPAD_6              0x5E
+#define HID_KEY_KEYPAD_7              0x5F
+#define HID_KEY_KEYPAD_8              0x60
+#define HID_KEY_KEYPAD_9              0x61
+#define HID_KEY_KEYPAD_0              0x62
+#define HID_KEY_KEYPAD_DECIMAL        0x63
+#define HID_KEY_CONTROL_LEFT  0xE0
+#define HID_KEY_SHIFT_LEFT    0xE1
+#define HID_KEY_ALT_LEFT      0xE2
+#define HID_KEY_GUI_LEFT      0xE3
+#define HID_KEY_CONTROL_RIGHT 0xE4
+#define HID_KEY_SHIFT_RIGHT   0xE5
+#define HID_KEY_ALT_RIGHT     0xE6
+#define HID_KEY_GUI_RIGHT     0xE7
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool tud_init(uint8_t rhport);
+bool tud_ready(void);
+bool tud_mounted(void);
+bool tud_suspended(void);
+bool tud_remote_wakeup(void);
+bool tud_hid_ready(void);
+bool tud_hid_report(uint8_t report_id, void const *report, uint16_t len);
+bool tud_control_xfer(uint8_t rhport, tusb_control_request_t const *request, void *buffer, uint16_t len);
+void tud_task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Button trace generation and loading, see button_trace.h.
+ */
+
+#include "button_trace.h"
+
+#include "BoardConfig.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+// Contact bounce after an edge, and how often a bouncing contact flips
+#define TRACE_BOUNCE_US 1500
+#define TRACE_BOUNCE_FLIP_US 120
+
+namespace
+{
+	struct PinModel
+	{
+		uint8_t pin;
+		bool held = false;
+		uint64_t nextEdge = 0;
+		uint64_t bounceUntil = 0;
+		uint64_t nextFlip = 0;
+		bool level = false;
+	};
+
+	const char *traceName(TraceKind kind)
+	{
+		switch (kind) {
+			case TRACE_IDLE:    return "idle";
+			case TRACE_MASH:    return "mash";
+			case TRACE_SOCD:    return "socd";
+			case TRACE_HOTKEYS: return "hotkeys";
+		}
+		return "?";
+	}
+}
+
+ButtonTrace makeTrace(TraceKind kind, const std::vector<uint8_t>& pins, size_t samples, uint32_t pollUs, uint32_t seed)
+{
+	ButtonTrace trace;
+	trace.name = traceName(kind);
+	trace.samples.reserve(samples);
+
+	std::mt19937 random(seed);
+	const auto between = [&random](uint32_t low, uint32_t high) {
+		return std::uniform_int_distribution<uint32_t>(low, high)(random);
+	};
+
+	std::vector<PinModel> models;
+	for (uint8_t pin : pins) {
+		PinModel model;
+		model.pin = pin;
+		model.nextEdge = between(0, 50000);
+		models.push_back(model);
+	}
+
+	// Held for 30-250ms, released for 20-600ms, close to a player mashing a few buttons at once
+	const auto holdTime = [&]() { return between(30000, 250000); };
+	const auto releaseTime = [&]() { return between(20000, 600000); };
+
+	uint64_t now = 0;
+	for (size_t i = 0; i < samples; i++, now += pollUs) {
+		uint32_t pressed = 0;
+
+		if (kind != TRACE_IDLE) {
+			for (PinModel& model : models) {
+				if (now >= model.nextEdge) {
+					model.held = !model.held;
+					model.nextEdge = now + (model.held ? holdTime() : releaseTime());
+					model.bounceUntil = now + between(0, TRACE_BOUNCE_US);
+					model.nextFlip = now;
+				}
+				if (now < model.bounceUntil) {
+					if (now >= model.nextFlip) {
+						model.level = between(0, 1);
+						model.nextFlip = now + between(TRACE_BOUNCE_FLIP_US / 2, TRACE_BOUNCE_FLIP_US * 2);
+					}
+				} else {
+					model.level = model.held;
+				}
+				if (model.level)
+					pressed |= 1UL << model.pin;
+			}
+		}
+
+		if (kind == TRACE_SOCD) {
+			// Roll left to right and up to down through a frame or two where both are held
+			const uint64_t phase = (now / 8000) % 8;
+			static const uint32_t rolls[8] = {
+				1UL << PIN_DPAD_LEFT, (1UL << PIN_DPAD_LEFT) | (1UL << PIN_DPAD_RIGHT),
+				1UL << PIN_DPAD_RIGHT, (1UL << PIN_DPAD_RIGHT) | (1UL << PIN_DPAD_LEFT),
+				1UL << PIN_DPAD_UP, (1UL << PIN_DPAD_UP) | (1UL << PIN_DPAD_DOWN),
+				1UL << PIN_DPAD_DOWN, (1UL << PIN_DPAD_DOWN) | (1UL << PIN_DPAD_UP),
+			};
+			const uint32_t dpadPins = (1UL << PIN_DPAD_LEFT) | (1UL << PIN_DPAD_RIGHT) | (1UL << PIN_DPAD_UP) | (1UL << PIN_DPAD_DOWN);
+			pressed = (pressed & ~dpadPins) | rolls[phase];
+		} else if (kind == TRACE_HOTKEYS) {
+			// S1 + S2 + a direction for 100ms out of every second
+			const uint64_t second = now / 1000000;
+			if ((now % 1000000) < 100000) {
+				static const uint8_t directions[4] = { PIN_DPAD_UP, PIN_DPAD_DOWN, PIN_DPAD_LEFT, PIN_DPAD_RIGHT };
+				pressed |= (1UL << PIN_BUTTON_S1) | (1UL << PIN_BUTTON_S2) | (1UL << directions[second % 4]);
+			}
+		}
+
+		trace.samples.push_back({ now, pressed });
+	}
+
+	return trace;
+}
+
+bool loadTrace(const char *path, ButtonTrace& trace)
+{
+	FILE *file = fopen(path, "r");
+	if (file == nullptr)
+		return false;
+
+	const char *slash = strrchr(path, '/');
+	trace.name = slash ? slash + 1 : path;
+	trace.samples.clear();
+
+	char line[256];
+	while (fgets(line, sizeof(line), file)) {
+		char *comment = strchr(line, '#');
+		if (comment)
+			*comment = '\0';
+
+		uint64_t timeUs;
+		uint32_t pressed;
+		if (sscanf(line, "%" SCNu64 " %" SCNx32, &timeUs, &pressed) == 2)
+			trace.samples.push_back({ timeUs, pressed });
+	}
+
+	fclose(file);
+	return !trace.samples.empty();
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Button traces for the host benchmarks: the pressed pin mask sampled at each poll.
+ *
+ * A trace file has one sample per line, "<microseconds> <pressed pin mask in hex>", with '#'
+ * starting a comment. Without a file the benchmarks use the synthetic traces from makeTrace(),
+ * which are seeded so every run replays the same input.
+ */
+
+#ifndef _BUTTON_TRACE_H_
+#define _BUTTON_TRACE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct TraceSample
+{
+	uint64_t timeUs;
+	uint32_t pressedPins;
+};
+
+struct ButtonTrace
+{
+	std::string name;
+	std::vector<TraceSample> samples;
+};
+
+enum TraceKind
+{
+	TRACE_IDLE,      // Nothing pressed
+	TRACE_MASH,      // Buttons pressed and released at random, with contact bounce on every edge
+	TRACE_SOCD,      // Rolling between opposing directions, both held during the roll
+	TRACE_HOTKEYS,   // S1 + S2 with a direction held now and then, on top of mashing
+};
+
+// Samples every pollUs, pins are the candidates for presses
+ButtonTrace makeTrace(TraceKind kind, const std::vector<uint8_t>& pins, size_t samples, uint32_t pollUs, uint32_t seed);
+
+bool loadTrace(const char *path, ButtonTrace& trace);
+
+#endif
@@ -0,0 +1,22 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * CRC32.cpp with the DMA sniffer backend, its class renamed so it links next to the table build.
+ */
+
+#define CRC32_DMA_SNIFFER 1
+#define CRC32 SnifferCRC32
+#include "CRC32.cpp"
+#undef CRC32
+
+#include "crc32_sniffer.h"
+
+uint32_t CRC32Sniffer::calculate(const uint8_t *data, const std::vector<uint32_t>& pieces)
+{
+	SnifferCRC32 crc;
+	for (uint32_t size : pieces) {
+		crc.update(data, size);
+		data += size;
+	}
+	return crc.finalize();
+}
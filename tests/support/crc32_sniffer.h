@@ -0,0 +1,20 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * lib/CRC32 built a second time with CRC32_DMA_SNIFFER, so both backends run in one test binary.
+ */
+
+#ifndef _CRC32_SNIFFER_H_
+#define _CRC32_SNIFFER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace CRC32Sniffer
+{
+	// One CRC32 fed data in pieces of the given sizes in turn, then finalized
+	uint32_t calculate(const uint8_t *data, const std::vector<uint32_t>& pieces);
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Global operator new and delete that keep the size in front of every block and count what goes
+ * through them. Not thread safe, the host tests run on one thread.
+ */
+
+#include "host_heap.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// Keeps the block after it aligned like malloc's
+	union Header
+	{
+		size_t size;
+		max_align_t align;
+	};
+
+	size_t allocationCount = 0;
+	size_t bytesInUse = 0;
+	size_t baseline = 0;
+	size_t peakInUse = 0;
+
+	void *allocate(size_t size)
+	{
+		Header *header = static_cast<Header *>(std::malloc(sizeof(Header) + size));
+		if (!header)
+			return nullptr;
+		header->size = size;
+		allocationCount++;
+		bytesInUse += size;
+		if (bytesInUse > peakInUse)
+			peakInUse = bytesInUse;
+		return header + 1;
+	}
+
+	void release(void *pointer)
+	{
+		if (!pointer)
+			return;
+		Header *header = static_cast<Header *>(pointer) - 1;
+		bytesInUse -= header->size;
+		std::free(header);
+	}
+}
+
+void HostHeap::reset()
+{
+	allocationCount = 0;
+	baseline = bytesInUse;
+	peakInUse = bytesInUse;
+}
+
+size_t HostHeap::allocations() { return allocationCount; }
+size_t HostHeap::inUse() { return bytesInUse > baseline ? bytesInUse - baseline : 0; }
+size_t HostHeap::peak() { return peakInUse - baseline; }
+
+void *operator new(size_t size)
+{
+	void *pointer = allocate(size);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void *operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void *pointer) noexcept { release(pointer); }
+void operator delete[](void *pointer) noexcept { release(pointer); }
+void operator delete(void *pointer, size_t) noexcept { release(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { release(pointer); }
+void operator delete(void *pointer, const std::nothrow_t&) noexcept { release(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept { release(pointer); }
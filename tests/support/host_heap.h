@@ -0,0 +1,22 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Counts the heap use of the host binaries. host_heap.cpp replaces the global operator new and
+ * delete, so everything allocated through them between reset() and a read of the counters shows up.
+ */
+
+#ifndef _HOST_HEAP_H_
+#define _HOST_HEAP_H_
+
+#include <stddef.h>
+
+namespace HostHeap
+{
+	// Starts counting from here, the peak from what is in use now
+	void reset();
+	size_t allocations();
+	size_t inUse();
+	size_t peak(); // Most bytes in use at once since reset(), above what was in use at reset()
+}
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement for src/storagemanager.cpp.
+ *
+ * The real Storage loads the config from flash through ConfigUtils, which pulls in every addon
+ * and ArduinoJson. Here the config starts from the BoardConfig.h defaults the input pipeline
+ * reads, and tests change it through Storage::getInstance().getConfig(). Saves are counted.
+ */
+
+#include "storagemanager.h"
+
+#include "BoardConfig.h"
+#include "GamepadConfig.h"
+#include "helper.h"
+#include "host_storage.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#define HOST_SET(parent, property, value) \
+	do { parent.property = value; parent.has_##property = true; } while (0)
+
+#define HOST_SET_HOTKEY(hotkey, N) \
+	do { \
+		HOST_SET(hotkey, auxMask, HOTKEY_##N##_AUX_MASK); \
+		HOST_SET(hotkey, buttonsMask, HOTKEY_##N##_BUTTONS_MASK); \
+		HOST_SET(hotkey, dpadMask, HOTKEY_##N##_DPAD_MASK); \
+		HOST_SET(hotkey, action, GamepadHotkey(HOTKEY_##N##_ACTION)); \
+	} while (0)
+
+#ifndef DEFAULT_INPUT_MODE
+#define DEFAULT_INPUT_MODE INPUT_MODE_XINPUT
+#endif
+#ifndef DEFAULT_DPAD_MODE
+#define DEFAULT_DPAD_MODE DPAD_MODE_DIGITAL
+#endif
+#ifndef DEFAULT_SOCD_MODE
+#define DEFAULT_SOCD_MODE SOCD_MODE_NEUTRAL
+#endif
+
+static uint32_t hostSaveCount = 0;
+
+void HostStorage::resetConfig()
+{
+	Config& config = Storage::getInstance().getConfig();
+	memset(&config, 0, sizeof(config));
+
+	HOST_SET(config.gamepadOptions, inputMode, DEFAULT_INPUT_MODE);
+	HOST_SET(config.gamepadOptions, dpadMode, DEFAULT_DPAD_MODE);
+	HOST_SET(config.gamepadOptions, socdMode, DEFAULT_SOCD_MODE);
+	HOST_SET(config.gamepadOptions, invertXAxis, false);
+	HOST_SET(config.gamepadOptions, switchTpShareForDs4, false);
+	HOST_SET(config.gamepadOptions, lockHotkeys, DEFAULT_LOCK_HOTKEYS);
+	HOST_SET(config.gamepadOptions, fourWayMode, false);
+	HOST_SET(config.gamepadOptions, profileNumber, 1);
+
+	HotkeyOptions& hotkeyOptions = config.hotkeyOptions;
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey01, 01);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey02, 02);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey03, 03);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey04, 04);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey05, 05);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey06, 06);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey07, 07);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey08, 08);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey09, 09);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey10, 10);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey11, 11);
+	HOST_SET_HOTKEY(hotkeyOptions.hotkey12, 12);
+
+	HOST_SET(config.pinMappings, pinDpadUp, PIN_DPAD_UP);
+	HOST_SET(config.pinMappings, pinDpadDown, PIN_DPAD_DOWN);
+	HOST_SET(config.pinMappings, pinDpadLeft, PIN_DPAD_LEFT);
+	HOST_SET(config.pinMappings, pinDpadRight, PIN_DPAD_RIGHT);
+	HOST_SET(config.pinMappings, pinButtonB1, PIN_BUTTON_B1);
+	HOST_SET(config.pinMappings, pinButtonB2, PIN_BUTTON_B2);
+	HOST_SET(config.pinMappings, pinButtonB3, PIN_BUTTON_B3);
+	HOST_SET(config.pinMappings, pinButtonB4, PIN_BUTTON_B4);
+	HOST_SET(config.pinMappings, pinButtonL1, PIN_BUTTON_L1);
+	HOST_SET(config.pinMappings, pinButtonR1, PIN_BUTTON_R1);
+	HOST_SET(config.pinMappings, pinButtonL2, PIN_BUTTON_L2);
+	HOST_SET(config.pinMappings, pinButtonR2, PIN_BUTTON_R2);
+	HOST_SET(config.pinMappings, pinButtonS1, PIN_BUTTON_S1);
+	HOST_SET(config.pinMappings, pinButtonS2, PIN_BUTTON_S2);
+	HOST_SET(config.pinMappings, pinButtonL3, PIN_BUTTON_L3);
+	HOST_SET(config.pinMappings, pinButtonR3, PIN_BUTTON_R3);
+	HOST_SET(config.pinMappings, pinButtonA1, PIN_BUTTON_A1);
+	HOST_SET(config.pinMappings, pinButtonA2, PIN_BUTTON_A2);
+	HOST_SET(config.pinMappings, pinButtonFn, PIN_BUTTON_FN);
+
+	HOST_SET(config.keyboardMapping, keyDpadUp, KEY_DPAD_UP);
+	HOST_SET(config.keyboardMapping, keyDpadDown, KEY_DPAD_DOWN);
+	HOST_SET(config.keyboardMapping, keyDpadRight, KEY_DPAD_RIGHT);
+	HOST_SET(config.keyboardMapping, keyDpadLeft, KEY_DPAD_LEFT);
+	HOST_SET(config.keyboardMapping, keyButtonB1, KEY_BUTTON_B1);
+	HOST_SET(config.keyboardMapping, keyButtonB2, KEY_BUTTON_B2);
+	HOST_SET(config.keyboardMapping, keyButtonR2, KEY_BUTTON_R2);
+	HOST_SET(config.keyboardMapping, keyButtonL2, KEY_BUTTON_L2);
+	HOST_SET(config.keyboardMapping, keyButtonB3, KEY_BUTTON_B3);
+	HOST_SET(config.keyboardMapping, keyButtonB4, KEY_BUTTON_B4);
+	HOST_SET(config.keyboardMapping, keyButtonR1, KEY_BUTTON_R1);
+	HOST_SET(config.keyboardMapping, keyButtonL1, KEY_BUTTON_L1);
+	HOST_SET(config.keyboardMapping, keyButtonS1, KEY_BUTTON_S1);
+	HOST_SET(config.keyboardMapping, keyButtonS2, KEY_BUTTON_S2);
+	HOST_SET(config.keyboardMapping, keyButtonL3, KEY_BUTTON_L3);
+	HOST_SET(config.keyboardMapping, keyButtonR3, KEY_BUTTON_R3);
+	HOST_SET(config.keyboardMapping, keyButtonA1, KEY_BUTTON_A1);
+	HOST_SET(config.keyboardMapping, keyButtonA2, KEY_BUTTON_A2);
+
+	Storage::getInstance().setProfile(config.gamepadOptions.profileNumber);
+	hostSaveCount = 0;
+}
+
+uint32_t HostStorage::saveCount()
+{
+	return hostSaveCount;
+}
+
+Storage::Storage()
+{
+	critical_section_init(&animationOptionsCs);
+}
+
+bool Storage::save()
+{
+	hostSaveCount++;
+	return true;
+}
+
+PinMappings& Storage::getProfilePinMappings() {
+	if (functionalPinMappings == nullptr) {
+		functionalPinMappings = (PinMappings*)malloc(sizeof(PinMappings));
+		setFunctionalPinMappings(config.gamepadOptions.profileNumber);
+	}
+	return *functionalPinMappings;
+}
+
+void Storage::setProfile(const uint32_t profileNum)
+{
+	getProfilePinMappings();
+	setFunctionalPinMappings(profileNum);
+}
+
+void Storage::setFunctionalPinMappings(const uint32_t profileNum)
+{
+	memcpy(functionalPinMappings, &config.pinMappings, sizeof(PinMappings));
+	if (profileNum < 2 || profileNum > 4) return;
+
+	AlternativePinMappings alts = this->config.profileOptions.alternativePinMappings[profileNum-2];
+	if (isValidPin(alts.pinButtonB1)) functionalPinMappings->pinButtonB1 = alts.pinButtonB1;
+	if (isValidPin(alts.pinButtonB2)) functionalPinMappings->pinButtonB2 = alts.pinButtonB2;
+	if (isValidPin(alts.pinButtonB3)) functionalPinMappings->pinButtonB3 = alts.pinButtonB3;
+	if (isValidPin(alts.pinButtonB4)) functionalPinMappings->pinButtonB4 = alts.pinButtonB4;
+	if (isValidPin(alts.pinButtonL1)) functionalPinMappings->pinButtonL1 = alts.pinButtonL1;
+	if (isValidPin(alts.pinButtonR1)) functionalPinMappings->pinButtonR1 = alts.pinButtonR1;
+	if (isValidPin(alts.pinButtonL2)) functionalPinMappings->pinButtonL2 = alts.pinButtonL2;
+	if (isValidPin(alts.pinButtonR2)) functionalPinMappings->pinButtonR2 = alts.pinButtonR2;
+	if (isValidPin(alts.pinDpadUp)) functionalPinMappings->pinDpadUp = alts.pinDpadUp;
+	if (isValidPin(alts.pinDpadDown)) functionalPinMappings->pinDpadDown = alts.pinDpadDown;
+	if (isValidPin(alts.pinDpadLeft)) functionalPinMappings->pinDpadLeft = alts.pinDpadLeft;
+	if (isValidPin(alts.pinDpadRight)) functionalPinMappings->pinDpadRight = alts.pinDpadRight;
+}
+
+void Storage::SetConfigMode(bool mode) {
+	CONFIG_MODE = mode;
+	previewDisplayOptions = config.displayOptions;
+}
+
+bool Storage::GetConfigMode() { return CONFIG_MODE; }
+
+void Storage::SetGamepad(Gamepad * newpad) { gamepad = newpad; }
+
+Gamepad * Storage::GetGamepad() { return gamepad; }
+
+void Storage::SetProcessedGamepad(Gamepad * newpad) { processedGamepad = newpad; }
+
+Gamepad * Storage::GetProcessedGamepad() { return processedGamepad; }
+
+void Storage::PublishProcessedGamepad(const GamepadState& state)
+{
+	PublishedGamepadData data;
+	data.state = state;
+	memcpy(data.featureData, featureData, sizeof(data.featureData));
+	publishedGamepad.write(data);
+}
+
+uint32_t Storage::SyncProcessedGamepad()
+{
+	const uint32_t version = publishedGamepad.read(processedGamepadData);
+	if (processedGamepad != nullptr)
+		processedGamepad->state = processedGamepadData.state;
+	return version;
+}
+
+uint8_t * Storage::GetProcessedFeatureData() { return processedGamepadData.featureData; }
+
+void Storage::SetFeatureData(uint8_t * newData) { memcpy(newData, featureData, sizeof(featureData)); }
+
+void Storage::ClearFeatureData() { memset(featureData, 0, sizeof(featureData)); }
+
+uint8_t * Storage::GetFeatureData() { return featureData; }
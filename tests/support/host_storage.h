@@ -0,0 +1,19 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Test controls for the host Storage in host_storage.cpp.
+ */
+
+#ifndef _HOST_STORAGE_H_
+#define _HOST_STORAGE_H_
+
+#include <stdint.h>
+
+namespace HostStorage
+{
+	// Back to the BoardConfig.h defaults, profile 1 and no saves counted
+	void resetConfig();
+	uint32_t saveCount();
+}
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The PS4 and network class drivers, reduced to what tusb_driver.cpp links against. The real ones need
+ * mbedtls and lwIP. PS4 reports go out through send_hid_report() in hid_driver.cpp, which is built as is.
+ */
+
+#include "hid_driver.h"
+#include "net_driver.h"
+#include "ps4_driver.h"
+#include "usb_driver.h"
+#include "class/hid/hid_device.h"
+
+const usbd_class_driver_t net_driver = {
+	.name = "NET",
+};
+
+// As in ps4_driver.cpp, without the auth feature reports
+const usbd_class_driver_t ps4_driver = {
+	.name = "PS4",
+	.init = hidd_init,
+	.reset = hidd_reset,
+	.open = hid_open,
+	.control_xfer_cb = hidd_control_xfer_cb,
+	.xfer_cb = hidd_xfer_cb,
+	.sof = usb_sof_cb,
+};
+
+ssize_t get_ps4_report(uint8_t report_id, uint8_t *buf, uint16_t reqlen)
+{
+	(void)report_id; (void)buf; (void)reqlen;
+	return 0;
+}
+
+void set_ps4_report(uint8_t report_id, uint8_t const *buf, uint16_t reqlen)
+{
+	(void)report_id; (void)buf; (void)reqlen;
+}
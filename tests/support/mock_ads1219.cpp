@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * ADS1219 model, see mock_ads1219.h. Command and register layout from the datasheet, section 8.5.
+ */
+
+#include "mock_ads1219.h"
+
+#include <algorithm>
+
+#define ADS1219_STATUS_DRDY 0x80
+#define ADS1219_STATUS_ID 0x60
+#define ADS1219_CONFIG_CONTINUOUS 0x02
+
+MockADS1219::MockADS1219(uint drdyPin, Signal signal)
+	: config(0), frames(0), dataReads(0), restarts(0), nackEvery(0), pulseUnread(true), drdyPin(drdyPin),
+	  signal(signal), running(false), drdy(false), nextUs(0), result(0), command(0)
+{
+}
+
+uint MockADS1219::conversionUs() const
+{
+	static const uint rates[] = { 20, 90, 330, 1000 };
+	return 1000000 / rates[(config >> 2) & 3];
+}
+
+uint8_t MockADS1219::channel() const
+{
+	const uint mux = config >> 5;
+	return (mux >= 3 && mux <= 6) ? mux - 3 : MOCK_ADS1219_NO_CHANNEL;
+}
+
+void MockADS1219::setDrdy(bool high)
+{
+	const uint32_t bit = 1UL << drdyPin;
+	const uint32_t levels = HostSDK::getGpioLevels();
+	HostSDK::setGpioLevels(high ? (levels | bit) : (levels & ~bit));
+}
+
+// The digital filter resets, the result in progress is lost
+void MockADS1219::restart()
+{
+	if (running)
+		restarts++;
+	running = true;
+	nextUs = HostSDK::now() + conversionUs();
+	setDrdy(true);
+}
+
+bool MockADS1219::write(const uint8_t *data, size_t length)
+{
+	frames++;
+	if ((nackEvery && frames % nackEvery == 0) || length == 0)
+		return false;
+
+	const uint8_t c = data[0];
+	if ((c & 0xfe) == 0x06) {
+		config = 0;
+		running = false;
+		drdy = false;
+		setDrdy(true);
+	} else if ((c & 0xfe) == 0x08) {
+		restart();
+	} else if ((c & 0xfe) == 0x02) {
+		running = false;
+	} else if ((c & 0xf0) == 0x10 || (c & 0xf8) == 0x20) {
+		command = c;
+	} else if ((c & 0xfc) == 0x40 && length == 2) {
+		config = data[1];
+		if (running)
+			restart();
+	} else {
+		return false;
+	}
+	return length == 1 || (c & 0xfc) == 0x40;
+}
+
+bool MockADS1219::read(uint8_t *data, size_t length)
+{
+	frames++;
+	if (nackEvery && frames % nackEvery == 0)
+		return false;
+
+	if ((command & 0xf0) == 0x10) {
+		for (size_t i = 0; i < length; i++)
+			data[i] = i < 3 ? (result >> (16 - 8 * i)) & 0xff : 0;
+		dataReads++;
+		drdy = false;
+		setDrdy(true);
+	} else {
+		const uint8_t value = (command & 0x04) ? (ADS1219_STATUS_ID | (drdy ? ADS1219_STATUS_DRDY : 0)) : config;
+		for (size_t i = 0; i < length; i++)
+			data[i] = value;
+	}
+	return true;
+}
+
+uint64_t MockADS1219::nextConversion() const { return running ? nextUs : UINT64_MAX; }
+
+void MockADS1219::update()
+{
+	if (!running || HostSDK::now() < nextUs)
+		return;
+
+	const uint8_t converted = channel();
+	const int32_t value = converted == MOCK_ADS1219_NO_CHANNEL ? 0 : std::min(std::max(signal(converted, nextUs), -0x800000), 0x7fffff);
+	conversions.push_back({ converted, nextUs, value });
+	result = value;
+
+	if (drdy && pulseUnread)
+		setDrdy(true);
+	drdy = true;
+	setDrdy(false);
+
+	if (config & ADS1219_CONFIG_CONTINUOUS)
+		nextUs += conversionUs();
+	else
+		running = false;
+}
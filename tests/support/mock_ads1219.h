@@ -0,0 +1,68 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * ADS1219 on the host I2C bus, converting on the virtual clock. It answers the RESET, START,
+ * POWERDOWN, RDATA, RREG and WREG commands, and drives its DRDY pin low when a conversion
+ * finishes: high again once the result is read or a conversion restarts, pulsing high when a new
+ * result replaces one nobody read. Every conversion is kept so tests can tell which channel and
+ * moment a result the firmware stored came from.
+ */
+
+#ifndef _MOCK_ADS1219_H_
+#define _MOCK_ADS1219_H_
+
+#include "host_sdk.h"
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#define MOCK_ADS1219_NO_CHANNEL 0xff // MUX on a differential or shorted input
+
+class MockADS1219 : public HostSDK::I2CDevice
+{
+public:
+	// Code a single ended channel converts to at a time in µs, clamped to 24 bits
+	typedef std::function<int32_t(uint channel, uint64_t us)> Signal;
+
+	struct Conversion
+	{
+		uint8_t channel;
+		uint64_t us;
+		int32_t value;
+	};
+
+	MockADS1219(uint drdyPin, Signal signal);
+
+	virtual bool write(const uint8_t *data, size_t length);
+	virtual bool read(uint8_t *data, size_t length);
+
+	// Finishes the conversion due by now. Call with the clock at nextConversion()
+	void update();
+	// Virtual time the running conversion finishes, UINT64_MAX when there is none
+	uint64_t nextConversion() const;
+
+	uint8_t config;
+	std::vector<Conversion> conversions;
+	uint32_t frames;       // Frames addressed to the chip, NACKed ones included
+	uint32_t dataReads;    // RDATA results read out
+	uint32_t restarts;     // Conversions a WREG or START threw away
+	uint32_t nackEvery;    // NACK every frame numbered a multiple of it, 0 for none
+	bool pulseUnread;      // DRDY pulses when a new result replaces an unread one, else it just stays low
+
+private:
+	uint conversionUs() const;
+	uint8_t channel() const;
+	void restart();
+	void setDrdy(bool high);
+
+	uint drdyPin;
+	Signal signal;
+	bool running;
+	bool drdy;             // Status register DRDY bit, a result nobody read
+	uint64_t nextUs;
+	int32_t result;
+	uint8_t command;       // Last RDATA or RREG, what the next read returns
+};
+
+#endif
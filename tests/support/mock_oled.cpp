@@ -0,0 +1,99 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * SSD1306/SH1106 panel model, see mock_oled.h.
+ */
+
+#include "mock_oled.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+MockOled::MockOled(uint8_t status)
+	: nack(false), status(status), page(0), column(0)
+{
+	memset(ram, 0, sizeof(ram));
+}
+
+// A control byte says whether commands or display data follow. With Co set it covers one byte
+// and another control byte comes after it, otherwise it covers the rest of the write
+bool MockOled::write(const uint8_t *data, size_t length)
+{
+	if (nack)
+		return false;
+	size_t i = 0;
+	while (i < length) {
+		const uint8_t control = data[i++];
+		if ((control & 0x3f) != 0) {
+			if (error.empty()) {
+				char message[64];
+				snprintf(message, sizeof(message), "write with control byte 0x%02x", control);
+				error = message;
+			}
+			return true;
+		}
+		const size_t count = (control & 0x80) ? std::min<size_t>(1, length - i) : length - i;
+		if (control & 0x40) {
+			storeData(data + i, count);
+		} else {
+			command(data + i, count);
+		}
+		i += count;
+	}
+	return true;
+}
+
+void MockOled::storeData(const uint8_t *data, size_t length)
+{
+	if (column >= MOCK_OLED_COLUMNS && error.empty())
+		error = "data written past the end of the display RAM";
+	for (size_t i = 0; i < length; i++) {
+		column %= MOCK_OLED_COLUMNS;
+		ram[page][column] = data[i];
+		column = (column + 1) % MOCK_OLED_COLUMNS; // page mode wraps within the page
+	}
+}
+
+bool MockOled::read(uint8_t *data, size_t length)
+{
+	if (nack)
+		return false;
+	memset(data, status, length);
+	return true;
+}
+
+void MockOled::command(const uint8_t *data, size_t length)
+{
+	for (size_t i = 0; i < length; i++) {
+		const uint8_t c = data[i];
+		if (c <= 0x0f) {
+			column = (column & 0xf0) | c;
+		} else if (c <= 0x1f) {
+			column = (column & 0x0f) | ((c & 0x0f) << 4);
+		} else if (c >= 0xb0 && c <= 0xb7) {
+			page = c & 0x07;
+		} else {
+			switch (c) {
+				// One argument byte follows, it must not be taken for a command
+				case 0x20: case 0x81: case 0x8d: case 0xa8: case 0xad:
+				case 0xd3: case 0xd5: case 0xd9: case 0xda: case 0xdb:
+					i++;
+					break;
+				case 0x21: case 0x22:
+					i += 2;
+					break;
+				default:
+					break; // display on/off, remap, contrast mode and the like, no effect on the RAM
+			}
+		}
+	}
+}
+
+std::vector<uint8_t> MockOled::shown(int width, int height, int offset) const
+{
+	std::vector<uint8_t> buffer;
+	for (int p = 0; p < height / 8; p++)
+		buffer.insert(buffer.end(), &ram[p][offset], &ram[p][offset] + width);
+	return buffer;
+}
@@ -0,0 +1,49 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * SSD1306/SH1106 panel on the host I2C bus. It decodes the command and data writes OneBitDisplay
+ * sends in page addressing mode into its own display RAM, so tests can check what the panel
+ * would show rather than what was sent.
+ */
+
+#ifndef _MOCK_OLED_H_
+#define _MOCK_OLED_H_
+
+#include "host_sdk.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define MOCK_OLED_STATUS_SSD1306 0x06
+#define MOCK_OLED_STATUS_SH1106 0x08
+
+#define MOCK_OLED_COLUMNS 132 // SH1106 RAM, an SSD1306 only has the first 128
+#define MOCK_OLED_PAGES 8
+
+class MockOled : public HostSDK::I2CDevice
+{
+public:
+	// status is the byte reads return, OneBitDisplay tells the controllers apart by it
+	explicit MockOled(uint8_t status = MOCK_OLED_STATUS_SSD1306);
+
+	virtual bool write(const uint8_t *data, size_t length);
+	virtual bool read(uint8_t *data, size_t length);
+
+	// Display RAM as a width x height back buffer laid out by OneBitDisplay, from column offset on
+	std::vector<uint8_t> shown(int width, int height, int offset = 0) const;
+
+	uint8_t ram[MOCK_OLED_PAGES][MOCK_OLED_COLUMNS];
+	bool nack;         // NACK every write while set
+	std::string error; // first write the panel could not make sense of
+
+private:
+	void command(const uint8_t *data, size_t length);
+	void storeData(const uint8_t *data, size_t length);
+
+	const uint8_t status;
+	int page;
+	int column;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Reference analog math, see reference_analog.h. The bodies follow src/addons/analog.cpp before
+ * the DMA sampling and the integer axis math replaced them.
+ */
+
+#include "reference_analog.h"
+
+#include "helper.h"
+
+#include <math.h>
+
+#define ADC_MAX ((1 << 12) - 1)
+#define ANALOG_CENTER 0.5f
+#define ANALOG_MAX 1.0f
+
+namespace
+{
+	uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max)
+	{
+		return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+	}
+
+	float readPin(uint16_t adc_hold, uint16_t center, bool autoCalibrate, float deadzone)
+	{
+		uint16_t adc_calibrated;
+		if (autoCalibrate) {
+			if (adc_hold > center)
+				adc_calibrated = map(adc_hold, center, ADC_MAX, ADC_MAX / 2, ADC_MAX);
+			else if (adc_hold == center)
+				adc_calibrated = ADC_MAX / 2;
+			else
+				adc_calibrated = map(adc_hold, 0, center, 0, ADC_MAX / 2);
+		} else {
+			adc_calibrated = adc_hold;
+		}
+
+		float adc_value = ((float)adc_calibrated) / ADC_MAX;
+		if (fabsf(adc_value - ANALOG_CENTER) < deadzone)
+			adc_value = ANALOG_CENTER;
+		return adc_value;
+	}
+
+	void adjustCircularity(float& x, float& y)
+	{
+		float x_magnitude = x - ANALOG_CENTER;
+		float y_magnitude = y - ANALOG_CENTER;
+		float magnitude = sqrt((x_magnitude * x_magnitude) + (y_magnitude * y_magnitude));
+		if (magnitude > ANALOG_CENTER) {
+			x = ((x_magnitude / magnitude) * ANALOG_CENTER + ANALOG_CENTER);
+			y = ((y_magnitude / magnitude) * ANALOG_CENTER + ANALOG_CENTER);
+		}
+	}
+
+	void setSticks(DpadMode mode, float x, float y, GamepadState& state)
+	{
+		if (mode == DpadMode::DPAD_MODE_LEFT_ANALOG) {
+			state.lx = (uint16_t)(65535.0f * x);
+			state.ly = (uint16_t)(65535.0f * y);
+		} else if (mode == DpadMode::DPAD_MODE_RIGHT_ANALOG) {
+			state.rx = (uint16_t)(65535.0f * x);
+			state.ry = (uint16_t)(65535.0f * y);
+		}
+	}
+}
+
+void Reference::analogProcess(const AnalogOptions& options, const uint16_t adc[4], const uint16_t centers[4], GamepadState& state)
+{
+	const int32_t pins[4] = { options.analogAdc1PinX, options.analogAdc1PinY, options.analogAdc2PinX, options.analogAdc2PinY };
+	const InvertMode inverts[2] = { options.analogAdc1Invert, options.analogAdc2Invert };
+	const float deadzone = options.analog_deadzone / 200.0f;
+
+	float axes[4] = { ANALOG_CENTER, ANALOG_CENTER, ANALOG_CENTER, ANALOG_CENTER };
+	for (int axis = 0; axis < 4; axis++) {
+		if (!isValidPin(pins[axis]))
+			continue;
+		axes[axis] = readPin(adc[axis], centers[axis], options.auto_calibrate, deadzone);
+		const InvertMode invert = inverts[axis / 2];
+		if (invert == InvertMode::INVERT_XY || invert == ((axis & 1) ? InvertMode::INVERT_Y : InvertMode::INVERT_X))
+			axes[axis] = ANALOG_MAX - axes[axis];
+	}
+
+	if (options.forced_circularity) {
+		adjustCircularity(axes[0], axes[1]);
+		adjustCircularity(axes[2], axes[3]);
+	}
+
+	setSticks(options.analogAdc1Mode, axes[0], axes[1], state);
+	setSticks(options.analogAdc2Mode, axes[2], axes[3], state);
+}
@@ -0,0 +1,20 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The analog addon's axis math as it was before the integer rewrite, kept as the reference the
+ * host tests compare the firmware against.
+ */
+
+#ifndef _REFERENCE_ANALOG_H_
+#define _REFERENCE_ANALOG_H_
+
+#include "gamepad.h"
+
+namespace Reference
+{
+	// AnalogInput::process() in floats from 0.0 to 1.0 with the center at 0.5, on one reading per axis.
+	// adc and centers are in the order stick 1 X, 1 Y, 2 X, 2 Y, centers only count with auto_calibrate
+	void analogProcess(const AnalogOptions& options, const uint16_t adc[4], const uint16_t centers[4], GamepadState& state);
+}
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Reference CRC32, see reference_crc32.h. The body follows lib/CRC32/src/CRC32.cpp before the
+ * slice-by-8 tables replaced it.
+ */
+
+#include "reference_crc32.h"
+
+static const uint32_t crc32_table[] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+	0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+	0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+uint32_t Reference::crc32Update(uint32_t state, const uint8_t *data, size_t size)
+{
+	for (size_t i = 0; i < size; i++) {
+		uint8_t tbl_idx = state ^ (data[i] >> (0 * 4));
+		state = crc32_table[tbl_idx & 0x0f] ^ (state >> 4);
+		tbl_idx = state ^ (data[i] >> (1 * 4));
+		state = crc32_table[tbl_idx & 0x0f] ^ (state >> 4);
+	}
+	return state;
+}
+
+uint32_t Reference::crc32(const uint8_t *data, size_t size)
+{
+	return ~crc32Update(~0u, data, size);
+}
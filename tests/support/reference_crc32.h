@@ -0,0 +1,21 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * lib/CRC32 as it was before the slice-by-8 tables, kept as the reference the host benchmark and
+ * tests compare the firmware against.
+ */
+
+#ifndef _REFERENCE_CRC32_H_
+#define _REFERENCE_CRC32_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Reference
+{
+	// Four bits a step through a 16 entry table, state starts at ~0 and is inverted at the end like CRC32's
+	uint32_t crc32Update(uint32_t state, const uint8_t *data, size_t size);
+	uint32_t crc32(const uint8_t *data, size_t size);
+}
+
+#endif
@@ -0,0 +1,314 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Reference input pipeline, see reference_gamepad.h. The bodies follow src/gamepad.cpp before
+ * the pin lookup table and report encoder tables replaced them.
+ */
+
+#include "reference_gamepad.h"
+
+#include "helper.h"
+
+const HIDReport Reference::hidReportTemplate
+{
+	.square_btn = 0, .cross_btn = 0, .circle_btn = 0, .triangle_btn = 0,
+	.l1_btn = 0, .r1_btn = 0, .l2_btn = 0, .r2_btn = 0,
+	.select_btn = 0, .start_btn = 0, .l3_btn = 0, .r3_btn = 0, .ps_btn = 0, .tp_btn = 0,
+	.direction = 0x08,
+	.l_x_axis = 0x80, .l_y_axis = 0x80, .r_x_axis = 0x80, .r_y_axis = 0x80,
+	.right_axis = 0x00, .left_axis = 0x00, .up_axis = 0x00, .down_axis = 0x00,
+	.triangle_axis = 0x00, .circle_axis = 0x00, .cross_axis = 0x00, .square_axis = 0x00,
+	.l1_axis = 0x00, .r1_axis = 0x00, .l2_axis = 0x00, .r2_axis = 0x00
+};
+
+const PS4Report Reference::ps4ReportTemplate
+{
+	.report_id = 0x01,
+	.left_stick_x = 0x80, .left_stick_y = 0x80, .right_stick_x = 0x80, .right_stick_y = 0x80,
+	.dpad = 0x08,
+	.button_west = 0, .button_south = 0, .button_east = 0, .button_north = 0,
+	.button_l1 = 0, .button_r1 = 0, .button_l2 = 0, .button_r2 = 0,
+	.button_select = 0, .button_start = 0, .button_l3 = 0, .button_r3 = 0, .button_home = 0,
+	.padding = 0,
+	.mystery = { },
+	.touchpad_data = TouchpadData(),
+	.mystery_2 = { }
+};
+
+const SwitchReport Reference::switchReportTemplate
+{
+	.buttons = 0,
+	.hat = SWITCH_HAT_NOTHING,
+	.lx = SWITCH_JOYSTICK_MID,
+	.ly = SWITCH_JOYSTICK_MID,
+	.rx = SWITCH_JOYSTICK_MID,
+	.ry = SWITCH_JOYSTICK_MID,
+	.vendor = 0,
+};
+
+const XInputReport Reference::xinputReportTemplate
+{
+	.report_id = 0,
+	.report_size = XINPUT_ENDPOINT_SIZE,
+	.buttons1 = 0,
+	.buttons2 = 0,
+	.lt = 0,
+	.rt = 0,
+	.lx = GAMEPAD_JOYSTICK_MID,
+	.ly = GAMEPAD_JOYSTICK_MID,
+	.rx = GAMEPAD_JOYSTICK_MID,
+	.ry = GAMEPAD_JOYSTICK_MID,
+	._reserved = { },
+};
+
+const KeyboardReport Reference::keyboardReportTemplate
+{
+	.keycode = { 0 },
+	.multimedia = 0
+};
+
+static inline bool pressedButton(const GamepadState& state, uint16_t mask) { return (state.buttons & mask) == mask; }
+static inline bool pressedDpad(const GamepadState& state, uint8_t mask) { return (state.dpad & mask) == mask; }
+
+static inline uint8_t hatFor(uint8_t dpad, uint8_t nothing)
+{
+	switch (dpad & GAMEPAD_MASK_DPAD)
+	{
+		case GAMEPAD_MASK_UP:                        return HID_HAT_UP;
+		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   return HID_HAT_UPRIGHT;
+		case GAMEPAD_MASK_RIGHT:                     return HID_HAT_RIGHT;
+		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: return HID_HAT_DOWNRIGHT;
+		case GAMEPAD_MASK_DOWN:                      return HID_HAT_DOWN;
+		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  return HID_HAT_DOWNLEFT;
+		case GAMEPAD_MASK_LEFT:                      return HID_HAT_LEFT;
+		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    return HID_HAT_UPLEFT;
+		default:                                     return nothing;
+	}
+}
+
+void Reference::read(GamepadState& state, uint32_t gpioLevels, const PinMappings& pinMappings)
+{
+	// Need to invert since we're using pullups
+	const uint32_t values = ~gpioLevels;
+	const auto pinMask = [](int32_t pin) -> uint32_t { return isValidPin(pin) ? (1UL << pin) : 0; };
+
+	state.aux = (values & pinMask(pinMappings.pinButtonFn)) ? AUX_MASK_FUNCTION : 0;
+
+	state.dpad = 0
+		| ((values & pinMask(pinMappings.pinDpadUp))    ? GAMEPAD_MASK_UP    : 0)
+		| ((values & pinMask(pinMappings.pinDpadDown))  ? GAMEPAD_MASK_DOWN  : 0)
+		| ((values & pinMask(pinMappings.pinDpadLeft))  ? GAMEPAD_MASK_LEFT  : 0)
+		| ((values & pinMask(pinMappings.pinDpadRight)) ? GAMEPAD_MASK_RIGHT : 0)
+	;
+
+	state.buttons = 0
+		| ((values & pinMask(pinMappings.pinButtonB1)) ? GAMEPAD_MASK_B1 : 0)
+		| ((values & pinMask(pinMappings.pinButtonB2)) ? GAMEPAD_MASK_B2 : 0)
+		| ((values & pinMask(pinMappings.pinButtonB3)) ? GAMEPAD_MASK_B3 : 0)
+		| ((values & pinMask(pinMappings.pinButtonB4)) ? GAMEPAD_MASK_B4 : 0)
+		| ((values & pinMask(pinMappings.pinButtonL1)) ? GAMEPAD_MASK_L1 : 0)
+		| ((values & pinMask(pinMappings.pinButtonR1)) ? GAMEPAD_MASK_R1 : 0)
+		| ((values & pinMask(pinMappings.pinButtonL2)) ? GAMEPAD_MASK_L2 : 0)
+		| ((values & pinMask(pinMappings.pinButtonR2)) ? GAMEPAD_MASK_R2 : 0)
+		| ((values & pinMask(pinMappings.pinButtonS1)) ? GAMEPAD_MASK_S1 : 0)
+		| ((values & pinMask(pinMappings.pinButtonS2)) ? GAMEPAD_MASK_S2 : 0)
+		| ((values & pinMask(pinMappings.pinButtonL3)) ? GAMEPAD_MASK_L3 : 0)
+		| ((values & pinMask(pinMappings.pinButtonR3)) ? GAMEPAD_MASK_R3 : 0)
+		| ((values & pinMask(pinMappings.pinButtonA1)) ? GAMEPAD_MASK_A1 : 0)
+		| ((values & pinMask(pinMappings.pinButtonA2)) ? GAMEPAD_MASK_A2 : 0)
+	;
+
+	state.lx = GAMEPAD_JOYSTICK_MID;
+	state.ly = GAMEPAD_JOYSTICK_MID;
+	state.rx = GAMEPAD_JOYSTICK_MID;
+	state.ry = GAMEPAD_JOYSTICK_MID;
+	state.lt = 0;
+	state.rt = 0;
+}
+
+void Reference::fillHIDReport(const GamepadState& state, HIDReport& report)
+{
+	report.direction = hatFor(state.dpad, HID_HAT_NOTHING);
+
+	report.cross_btn    = pressedButton(state, GAMEPAD_MASK_B1);
+	report.circle_btn   = pressedButton(state, GAMEPAD_MASK_B2);
+	report.square_btn   = pressedButton(state, GAMEPAD_MASK_B3);
+	report.triangle_btn = pressedButton(state, GAMEPAD_MASK_B4);
+	report.l1_btn       = pressedButton(state, GAMEPAD_MASK_L1);
+	report.r1_btn       = pressedButton(state, GAMEPAD_MASK_R1);
+	report.l2_btn       = pressedButton(state, GAMEPAD_MASK_L2);
+	report.r2_btn       = pressedButton(state, GAMEPAD_MASK_R2);
+	report.select_btn   = pressedButton(state, GAMEPAD_MASK_S1);
+	report.start_btn    = pressedButton(state, GAMEPAD_MASK_S2);
+	report.l3_btn       = pressedButton(state, GAMEPAD_MASK_L3);
+	report.r3_btn       = pressedButton(state, GAMEPAD_MASK_R3);
+	report.ps_btn       = pressedButton(state, GAMEPAD_MASK_A1);
+	report.tp_btn       = pressedButton(state, GAMEPAD_MASK_A2);
+
+	report.l_x_axis = static_cast<uint8_t>(state.lx >> 8);
+	report.l_y_axis = static_cast<uint8_t>(state.ly >> 8);
+	report.r_x_axis = static_cast<uint8_t>(state.rx >> 8);
+	report.r_y_axis = static_cast<uint8_t>(state.ry >> 8);
+}
+
+void Reference::fillSwitchReport(const GamepadState& state, SwitchReport& report)
+{
+	report.hat = hatFor(state.dpad, SWITCH_HAT_NOTHING);
+
+	report.buttons = 0
+		| (pressedButton(state, GAMEPAD_MASK_B1) ? SWITCH_MASK_B       : 0)
+		| (pressedButton(state, GAMEPAD_MASK_B2) ? SWITCH_MASK_A       : 0)
+		| (pressedButton(state, GAMEPAD_MASK_B3) ? SWITCH_MASK_Y       : 0)
+		| (pressedButton(state, GAMEPAD_MASK_B4) ? SWITCH_MASK_X       : 0)
+		| (pressedButton(state, GAMEPAD_MASK_L1) ? SWITCH_MASK_L       : 0)
+		| (pressedButton(state, GAMEPAD_MASK_R1) ? SWITCH_MASK_R       : 0)
+		| (pressedButton(state, GAMEPAD_MASK_L2) ? SWITCH_MASK_ZL      : 0)
+		| (pressedButton(state, GAMEPAD_MASK_R2) ? SWITCH_MASK_ZR      : 0)
+		| (pressedButton(state, GAMEPAD_MASK_S1) ? SWITCH_MASK_MINUS   : 0)
+		| (pressedButton(state, GAMEPAD_MASK_S2) ? SWITCH_MASK_PLUS    : 0)
+		| (pressedButton(state, GAMEPAD_MASK_L3) ? SWITCH_MASK_L3      : 0)
+		| (pressedButton(state, GAMEPAD_MASK_R3) ? SWITCH_MASK_R3      : 0)
+		| (pressedButton(state, GAMEPAD_MASK_A1) ? SWITCH_MASK_HOME    : 0)
+		| (pressedButton(state, GAMEPAD_MASK_A2) ? SWITCH_MASK_CAPTURE : 0)
+	;
+
+	report.lx = static_cast<uint8_t>(state.lx >> 8);
+	report.ly = static_cast<uint8_t>(state.ly >> 8);
+	report.rx = static_cast<uint8_t>(state.rx >> 8);
+	report.ry = static_cast<uint8_t>(state.ry >> 8);
+}
+
+void Reference::fillXInputReport(const GamepadState& state, bool hasAnalogTriggers, XInputReport& report)
+{
+	report.buttons1 = 0
+		| (pressedDpad(state, GAMEPAD_MASK_UP)    ? XBOX_MASK_UP    : 0)
+		| (pressedDpad(state, GAMEPAD_MASK_DOWN)  ? XBOX_MASK_DOWN  : 0)
+		| (pressedDpad(state, GAMEPAD_MASK_LEFT)  ? XBOX_MASK_LEFT  : 0)
+		| (pressedDpad(state, GAMEPAD_MASK_RIGHT) ? XBOX_MASK_RIGHT : 0)
+		| (pressedButton(state, GAMEPAD_MASK_S2)  ? XBOX_MASK_START : 0)
+		| (pressedButton(state, GAMEPAD_MASK_S1)  ? XBOX_MASK_BACK  : 0)
+		| (pressedButton(state, GAMEPAD_MASK_L3)  ? XBOX_MASK_LS    : 0)
+		| (pressedButton(state, GAMEPAD_MASK_R3)  ? XBOX_MASK_RS    : 0)
+	;
+
+	report.buttons2 = 0
+		| (pressedButton(state, GAMEPAD_MASK_L1) ? XBOX_MASK_LB   : 0)
+		| (pressedButton(state, GAMEPAD_MASK_R1) ? XBOX_MASK_RB   : 0)
+		| (pressedButton(state, GAMEPAD_MASK_A1) ? XBOX_MASK_HOME : 0)
+		| (pressedButton(state, GAMEPAD_MASK_B1) ? XBOX_MASK_A    : 0)
+		| (pressedButton(state, GAMEPAD_MASK_B2) ? XBOX_MASK_B    : 0)
+		| (pressedButton(state, GAMEPAD_MASK_B3) ? XBOX_MASK_X    : 0)
+		| (pressedButton(state, GAMEPAD_MASK_B4) ? XBOX_MASK_Y    : 0)
+	;
+
+	report.lx = static_cast<int16_t>(state.lx) + INT16_MIN;
+	report.ly = static_cast<int16_t>(~state.ly) + INT16_MIN;
+	report.rx = static_cast<int16_t>(state.rx) + INT16_MIN;
+	report.ry = static_cast<int16_t>(~state.ry) + INT16_MIN;
+
+	if (hasAnalogTriggers)
+	{
+		report.lt = state.lt;
+		report.rt = state.rt;
+	}
+	else
+	{
+		report.lt = pressedButton(state, GAMEPAD_MASK_L2) ? 0xFF : 0;
+		report.rt = pressedButton(state, GAMEPAD_MASK_R2) ? 0xFF : 0;
+	}
+}
+
+void Reference::fillPS4Report(const GamepadState& state, const GamepadOptions& options, bool hasAnalogTriggers,
+	uint8_t reportCounter, PS4Report& report)
+{
+	report.dpad = hatFor(state.dpad, PS4_HAT_NOTHING);
+
+	report.button_south    = pressedButton(state, GAMEPAD_MASK_B1);
+	report.button_east     = pressedButton(state, GAMEPAD_MASK_B2);
+	report.button_west     = pressedButton(state, GAMEPAD_MASK_B3);
+	report.button_north    = pressedButton(state, GAMEPAD_MASK_B4);
+	report.button_l1       = pressedButton(state, GAMEPAD_MASK_L1);
+	report.button_r1       = pressedButton(state, GAMEPAD_MASK_R1);
+	report.button_l2       = pressedButton(state, GAMEPAD_MASK_L2);
+	report.button_r2       = pressedButton(state, GAMEPAD_MASK_R2);
+	report.button_select   = options.switchTpShareForDs4 ? pressedButton(state, GAMEPAD_MASK_A2) : pressedButton(state, GAMEPAD_MASK_S1);
+	report.button_start    = pressedButton(state, GAMEPAD_MASK_S2);
+	report.button_l3       = pressedButton(state, GAMEPAD_MASK_L3);
+	report.button_r3       = pressedButton(state, GAMEPAD_MASK_R3);
+	report.button_home     = pressedButton(state, GAMEPAD_MASK_A1);
+	report.button_touchpad = options.switchTpShareForDs4 ? pressedButton(state, GAMEPAD_MASK_S1) : pressedButton(state, GAMEPAD_MASK_A2);
+
+	// report counter is 6 bits, but we circle 0-255
+	report.report_counter = reportCounter;
+
+	report.left_stick_x = static_cast<uint8_t>(state.lx >> 8);
+	report.left_stick_y = static_cast<uint8_t>(state.ly >> 8);
+	report.right_stick_x = static_cast<uint8_t>(state.rx >> 8);
+	report.right_stick_y = static_cast<uint8_t>(state.ry >> 8);
+
+	if (hasAnalogTriggers)
+	{
+		report.left_trigger = state.lt;
+		report.right_trigger = state.rt;
+	}
+	else
+	{
+		report.left_trigger = pressedButton(state, GAMEPAD_MASK_L2) ? 0xFF : 0;
+		report.right_trigger = pressedButton(state, GAMEPAD_MASK_R2) ? 0xFF : 0;
+	}
+
+	// set touchpad to nothing
+	TouchpadData touchpadData;
+	touchpadData.p1.unpressed = 1;
+	touchpadData.p2.unpressed = 1;
+	report.touchpad_data = touchpadData;
+}
+
+static uint8_t getMultimedia(uint8_t code)
+{
+	switch (code) {
+		case KEYBOARD_MULTIMEDIA_NEXT_TRACK : return 0x01;
+		case KEYBOARD_MULTIMEDIA_PREV_TRACK : return 0x02;
+		case KEYBOARD_MULTIMEDIA_STOP 	    : return 0x04;
+		case KEYBOARD_MULTIMEDIA_PLAY_PAUSE : return 0x08;
+		case KEYBOARD_MULTIMEDIA_MUTE 	    : return 0x10;
+		case KEYBOARD_MULTIMEDIA_VOLUME_UP  : return 0x20;
+		case KEYBOARD_MULTIMEDIA_VOLUME_DOWN: return 0x40;
+	}
+	return 0;
+}
+
+static void pressKey(KeyboardReport& report, uint8_t code)
+{
+	if (code > HID_KEY_GUI_RIGHT) {
+		report.reportId = KEYBOARD_MULTIMEDIA_REPORT_ID;
+		report.multimedia = getMultimedia(code);
+	} else {
+		report.reportId = KEYBOARD_KEY_REPORT_ID;
+		report.keycode[code / 8] |= 1 << (code % 8);
+	}
+}
+
+void Reference::fillKeyboardReport(const GamepadState& state, const KeyboardMapping& keyboardMapping, KeyboardReport& report)
+{
+	memset(report.keycode, 0, sizeof(report.keycode));
+	report.multimedia = 0;
+	if (pressedDpad(state, GAMEPAD_MASK_UP))      { pressKey(report, keyboardMapping.keyDpadUp); }
+	if (pressedDpad(state, GAMEPAD_MASK_DOWN))    { pressKey(report, keyboardMapping.keyDpadDown); }
+	if (pressedDpad(state, GAMEPAD_MASK_LEFT))    { pressKey(report, keyboardMapping.keyDpadLeft); }
+	if (pressedDpad(state, GAMEPAD_MASK_RIGHT))   { pressKey(report, keyboardMapping.keyDpadRight); }
+	if (pressedButton(state, GAMEPAD_MASK_B1))    { pressKey(report, keyboardMapping.keyButtonB1); }
+	if (pressedButton(state, GAMEPAD_MASK_B2))    { pressKey(report, keyboardMapping.keyButtonB2); }
+	if (pressedButton(state, GAMEPAD_MASK_B3))    { pressKey(report, keyboardMapping.keyButtonB3); }
+	if (pressedButton(state, GAMEPAD_MASK_B4))    { pressKey(report, keyboardMapping.keyButtonB4); }
+	if (pressedButton(state, GAMEPAD_MASK_L1))    { pressKey(report, keyboardMapping.keyButtonL1); }
+	if (pressedButton(state, GAMEPAD_MASK_R1))    { pressKey(report, keyboardMapping.keyButtonR1); }
+	if (pressedButton(state, GAMEPAD_MASK_L2))    { pressKey(report, keyboardMapping.keyButtonL2); }
+	if (pressedButton(state, GAMEPAD_MASK_R2))    { pressKey(report, keyboardMapping.keyButtonR2); }
+	if (pressedButton(state, GAMEPAD_MASK_S1))    { pressKey(report, keyboardMapping.keyButtonS1); }
+	if (pressedButton(state, GAMEPAD_MASK_S2))    { pressKey(report, keyboardMapping.keyButtonS2); }
+	if (pressedButton(state, GAMEPAD_MASK_L3))    { pressKey(report, keyboardMapping.keyButtonL3); }
+	if (pressedButton(state, GAMEPAD_MASK_R3))    { pressKey(report, keyboardMapping.keyButtonR3); }
+	if (pressedButton(state, GAMEPAD_MASK_A1))    { pressKey(report, keyboardMapping.keyButtonA1); }
+	if (pressedButton(state, GAMEPAD_MASK_A2))    { pressKey(report, keyboardMapping.keyButtonA2); }
+}
@@ -0,0 +1,33 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The input pipeline's read and report encoders as they were before the lookup table rewrites,
+ * kept as the reference the host benchmarks and tests compare the firmware against.
+ */
+
+#ifndef _REFERENCE_GAMEPAD_H_
+#define _REFERENCE_GAMEPAD_H_
+
+#include "gamepad.h"
+
+namespace Reference
+{
+	// One ternary per mapped pin, as Gamepad::read() used to do it
+	void read(GamepadState& state, uint32_t gpioLevels, const PinMappings& pinMappings);
+
+	// Bitfield and switch statement encoders, the report is built from a copy of the template
+	void fillHIDReport(const GamepadState& state, HIDReport& report);
+	void fillSwitchReport(const GamepadState& state, SwitchReport& report);
+	void fillXInputReport(const GamepadState& state, bool hasAnalogTriggers, XInputReport& report);
+	void fillPS4Report(const GamepadState& state, const GamepadOptions& options, bool hasAnalogTriggers,
+		uint8_t reportCounter, PS4Report& report);
+	void fillKeyboardReport(const GamepadState& state, const KeyboardMapping& keyboardMapping, KeyboardReport& report);
+
+	extern const HIDReport hidReportTemplate;
+	extern const SwitchReport switchReportTemplate;
+	extern const XInputReport xinputReportTemplate;
+	extern const PS4Report ps4ReportTemplate;
+	extern const KeyboardReport keyboardReportTemplate;
+}
+
+#endif
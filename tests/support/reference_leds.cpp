@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The nested LED press path, see reference_leds.h. The copies are on purpose, they are what it cost.
+ */
+
+#include "reference_leds.h"
+
+#include "GamepadState.h"
+
+namespace
+{
+	// Animation::notInFilter() before, the pixel came by value
+	bool notInFilter(Pixel pixel, const std::vector<Pixel> &pixels)
+	{
+		for (size_t i = 0; i < pixels.size(); i++) {
+			if (pixel == pixels.at(i))
+				return false;
+		}
+		return true;
+	}
+}
+
+namespace ReferenceLeds
+{
+	const std::vector<std::vector<uint32_t>> sticklessMasks = {
+		{ GAMEPAD_MASK_DL, 0, 0 },
+		{ GAMEPAD_MASK_DD, 0, 0 },
+		{ GAMEPAD_MASK_DR, 0, 0 },
+		{ GAMEPAD_MASK_DU, 0, 0 },
+		{ GAMEPAD_MASK_B3, GAMEPAD_MASK_B1, 0 },
+		{ GAMEPAD_MASK_B4, GAMEPAD_MASK_B2, 0 },
+		{ GAMEPAD_MASK_R1, GAMEPAD_MASK_R2, 0 },
+		{ GAMEPAD_MASK_L1, GAMEPAD_MASK_L2, 0 },
+		{ GAMEPAD_MASK_S1, GAMEPAD_MASK_S2, GAMEPAD_MASK_L3, GAMEPAD_MASK_R3, GAMEPAD_MASK_A1, GAMEPAD_MASK_A2 },
+	};
+
+	Layout makeLayout(const std::vector<std::vector<uint32_t>> &masks, const std::map<uint32_t, int> &ledIndex, uint8_t ledsPerPixel)
+	{
+		Layout layout;
+		for (const std::vector<uint32_t> &row : masks) {
+			layout.emplace_back();
+			for (uint32_t mask : row) {
+				if (mask == 0) {
+					layout.back().push_back(NO_PIXEL);
+					continue;
+				}
+				auto found = ledIndex.find(mask);
+				const int index = (found != ledIndex.end()) ? found->second : -1;
+				std::vector<uint8_t> positions;
+				for (int l = 0; index >= 0 && l != ledsPerPixel; l++)
+					positions.push_back(index * ledsPerPixel + l);
+				layout.back().push_back(Pixel(index, mask, positions));
+			}
+		}
+		return layout;
+	}
+
+	std::vector<Pixel> pressedPixels(const Layout &layout, uint32_t buttonState)
+	{
+		std::vector<Pixel> pressed;
+		for (auto row : layout) {
+			for (auto pixel : row) {
+				if (buttonState & pixel.mask)
+					pressed.push_back(pixel);
+			}
+		}
+		return pressed;
+	}
+
+	void Station::handlePressed(std::vector<Pixel> pressed)
+	{
+		lastPressed = pressed;
+		basePixels = pressed;
+		buttonPixels = pressed;
+	}
+
+	void Station::clearPressed()
+	{
+		basePixels.clear();
+		buttonPixels.clear();
+		lastPressed.clear();
+	}
+
+	void Station::drawColor(const RGB &color, bool filtered, RGB (&frame)[100])
+	{
+		for (size_t r = 0; r != layout.size(); r++) {
+			for (size_t c = 0; c != layout[r].size(); c++) {
+				if (layout[r][c].index == NO_PIXEL.index || (filtered && notInFilter(layout[r][c], buttonPixels)))
+					continue;
+				for (size_t p = 0; p != layout[r][c].positions.size(); p++)
+					frame[layout[r][c].positions[p]] = color;
+			}
+		}
+	}
+
+	void Station::drawTheme(const std::map<uint32_t, RGB> &theme, const RGB &defaultColor, bool filtered, RGB (&frame)[100])
+	{
+		for (size_t r = 0; r != layout.size(); r++) {
+			for (size_t c = 0; c != layout[r].size(); c++) {
+				if (layout[r][c].index == NO_PIXEL.index || (filtered && notInFilter(layout[r][c], buttonPixels)))
+					continue;
+				auto itr = theme.find(layout[r][c].mask);
+				for (size_t p = 0; p != layout[r][c].positions.size(); p++)
+					frame[layout[r][c].positions[p]] = (itr != theme.end()) ? itr->second : defaultColor;
+			}
+		}
+	}
+}
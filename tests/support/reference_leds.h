@@ -0,0 +1,55 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The LED press path as it was before the matrix was flattened, kept to check the flat one against
+ * and to measure it: the addon walks the nested layout copying every Pixel, collects the pressed ones
+ * in a fresh vector, and AnimationStation keeps copies of that vector for itself and each effect,
+ * which test a pixel against the filter by value.
+ */
+
+#ifndef _REFERENCE_LEDS_H_
+#define _REFERENCE_LEDS_H_
+
+#include "Animation.hpp"
+#include "Pixel.hpp"
+
+#include <map>
+#include <vector>
+
+namespace ReferenceLeds
+{
+	typedef std::vector<std::vector<Pixel>> Layout;
+
+	// The button rows of NeoPicoLEDAddon::generatedLEDStickless(), 0 for the holes
+	extern const std::vector<std::vector<uint32_t>> sticklessMasks;
+
+	// What NeoPicoLEDAddon::createLEDLayout() builds from rows of masks: the button with mask m is pixel
+	// ledIndex[m] and lights the ledsPerPixel LEDs from ledIndex[m] * ledsPerPixel. Buttons ledIndex
+	// leaves out get index -1 and no LEDs, like an unset LED option
+	Layout makeLayout(const std::vector<std::vector<uint32_t>> &masks, const std::map<uint32_t, int> &ledIndex, uint8_t ledsPerPixel);
+
+	// NeoPicoLEDAddon::process() before, the pixels whose mask is in buttonState in row order
+	std::vector<Pixel> pressedPixels(const Layout &layout, uint32_t buttonState);
+
+	class Station
+	{
+	public:
+		explicit Station(const Layout &layout) : layout(layout) {}
+
+		// AnimationStation::HandlePressed() and ClearPressed() before
+		void handlePressed(std::vector<Pixel> pressed);
+		void clearPressed();
+
+		// StaticColor, filtered to the pressed pixels for the button effect
+		void drawColor(const RGB &color, bool filtered, RGB (&frame)[100]);
+		// StaticTheme and CustomTheme, CustomThemePressed with filtered
+		void drawTheme(const std::map<uint32_t, RGB> &theme, const RGB &defaultColor, bool filtered, RGB (&frame)[100]);
+
+		Layout layout;
+		std::vector<Pixel> lastPressed;
+		std::vector<Pixel> basePixels;
+		std::vector<Pixel> buttonPixels;
+	};
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The paths of the route tables in src/configs/webconfig.cpp, for the route lookup tests and
+ * benchmark, and the scan lookup they replaced. The index of each entry stands in for its handler.
+ * Keep in step with webconfig.cpp.
+ */
+
+#ifndef _WEBCONFIG_PATHS_H_
+#define _WEBCONFIG_PATHS_H_
+
+#include "configs/webconfig_routes.h"
+
+namespace WebConfigPaths
+{
+	constexpr std::pair<const char*, int> api[] =
+	{
+		{ "/api/echo", 0 },
+		{ "/api/getAddonsOptions", 1 },
+		{ "/api/getCustomTheme", 2 },
+		{ "/api/getDisplayOptions", 3 },
+		{ "/api/getFirmwareVersion", 4 },
+		{ "/api/getGamepadOptions", 5 },
+		{ "/api/getKeyMappings", 6 },
+		{ "/api/getLedOptions", 7 },
+		{ "/api/getMemoryReport", 8 },
+		{ "/api/getPerfStats", 9 },
+		{ "/api/getPinMappings", 10 },
+		{ "/api/getProfileOptions", 11 },
+		{ "/api/getSplashImage", 12 },
+		{ "/api/getUsedPins", 13 },
+		{ "/api/reboot", 14 },
+		{ "/api/resetSettings", 15 },
+		{ "/api/setAddonsOptions", 16 },
+		{ "/api/setCustomTheme", 17 },
+		{ "/api/setDisplayOptions", 18 },
+		{ "/api/setGamepadOptions", 19 },
+		{ "/api/setKeyMappings", 20 },
+		{ "/api/setLedOptions", 21 },
+		{ "/api/setPS4Options", 22 },
+		{ "/api/setPinMappings", 23 },
+		{ "/api/setPreviewDisplayOptions", 24 },
+		{ "/api/setProfileOptions", 25 },
+		{ "/api/setSplashImage", 26 },
+	};
+
+	constexpr const char* spa[] = { "/add-ons", "/custom-theme", "/display-config", "/keyboard-mapping", "/led-config", "/pin-mapping", "/reset-settings", "/settings" };
+
+	static_assert(isSortedByPath(api), "WebConfigPaths::api must be sorted by path");
+	static_assert(isSortedByPath(spa), "WebConfigPaths::spa must be sorted");
+
+	// How fs_open_custom looked paths up before the tables were sorted
+	template <typename T, size_t N>
+	const T* linearScan(const T (&routes)[N], const char* name)
+	{
+		for (const T& route : routes)
+			if (strcmp(routePath(route), name) == 0)
+				return &route;
+		return nullptr;
+	}
+}
+
+#endif
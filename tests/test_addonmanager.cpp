@@ -0,0 +1,125 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * AddonManager with stand-in addons that log every call, checking which addons each pass runs.
+ */
+
+#include "addonmanager.h"
+
+#include "host_sdk.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::vector<std::string> calls;
+	std::vector<std::string> deleted;
+
+	class LoggingAddon : public GPAddon
+	{
+	public:
+		LoggingAddon(const std::string& name, bool isAvailable = true) : addonName(name), isAvailable(isAvailable) {}
+		virtual ~LoggingAddon() { deleted.push_back(addonName); }
+		virtual bool available() { return isAvailable; }
+		virtual void setup() { calls.push_back(addonName + ".setup"); }
+		virtual void process() { calls.push_back(addonName + ".process"); }
+		virtual std::string name() { return addonName; }
+	private:
+		const std::string addonName;
+		const bool isAvailable;
+	};
+
+	class InputAddon : public LoggingAddon
+	{
+	public:
+		using LoggingAddon::LoggingAddon;
+		virtual void preprocess() { calls.push_back(name() + ".preprocess"); }
+	};
+
+	// Inherits InputAddon::preprocess(), so it still needs the preprocess pass
+	class DerivedInputAddon : public InputAddon
+	{
+	public:
+		using InputAddon::InputAddon;
+	};
+
+	class AddonManagerTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			calls.clear();
+			deleted.clear();
+		}
+
+		std::vector<std::string> takeCalls()
+		{
+			std::vector<std::string> taken;
+			taken.swap(calls);
+			return taken;
+		}
+	};
+}
+
+TEST_F(AddonManagerTest, UnavailableAddonsAreDeletedWithoutSetup)
+{
+	AddonManager addons;
+	addons.LoadAddon(new LoggingAddon("missing", false), CORE0_INPUT);
+
+	EXPECT_TRUE(takeCalls().empty());
+	EXPECT_EQ(deleted, std::vector<std::string>({ "missing" }));
+	EXPECT_EQ(addons.GetAddon("missing"), nullptr);
+
+	addons.ProcessAddons(CORE0_INPUT);
+	EXPECT_TRUE(takeCalls().empty());
+}
+
+TEST_F(AddonManagerTest, EachPassRunsOnlyItsOwnAddonsInLoadOrder)
+{
+	AddonManager addons;
+	addons.LoadAddon(new LoggingAddon("a"), CORE0_INPUT);
+	addons.LoadAddon(new LoggingAddon("b"), CORE0_USBREPORT);
+	addons.LoadAddon(new LoggingAddon("c"), CORE0_INPUT);
+	EXPECT_EQ(takeCalls(), std::vector<std::string>({ "a.setup", "b.setup", "c.setup" }));
+
+	addons.ProcessAddons(CORE0_INPUT);
+	EXPECT_EQ(takeCalls(), std::vector<std::string>({ "a.process", "c.process" }));
+
+	addons.ProcessAddons(CORE0_USBREPORT);
+	EXPECT_EQ(takeCalls(), std::vector<std::string>({ "b.process" }));
+
+	addons.ProcessAddons(CORE1_LOOP);
+	EXPECT_TRUE(takeCalls().empty());
+}
+
+TEST_F(AddonManagerTest, PreprocessPassSkipsAddonsWithoutPreprocess)
+{
+	AddonManager addons;
+	addons.LoadAddon(new LoggingAddon("plain"), CORE0_INPUT);
+	addons.LoadAddon(new InputAddon("input"), CORE0_INPUT);
+	addons.LoadAddon(new DerivedInputAddon("derived"), CORE0_INPUT);
+	takeCalls();
+
+	addons.PreprocessAddons(CORE0_INPUT);
+	EXPECT_EQ(takeCalls(), std::vector<std::string>({ "input.preprocess", "derived.preprocess" }));
+
+	addons.ProcessAddons(CORE0_INPUT);
+	EXPECT_EQ(takeCalls(), std::vector<std::string>({ "plain.process", "input.process", "derived.process" }));
+}
+
+TEST_F(AddonManagerTest, GetAddonFindsAddonsOnAnyPass)
+{
+	AddonManager addons;
+	LoggingAddon *input = new LoggingAddon("input");
+	LoggingAddon *leds = new LoggingAddon("leds");
+	addons.LoadAddon(input, CORE0_INPUT);
+	addons.LoadAddon(leds, CORE1_LOOP);
+
+	EXPECT_EQ(addons.GetAddon("input"), input);
+	EXPECT_EQ(addons.GetAddon("leds"), leds);
+	EXPECT_EQ(addons.GetAddon("display"), nullptr);
+}
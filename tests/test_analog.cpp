@@ -0,0 +1,406 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The analog addon sampling the stick inputs through the stub ADC's free-running round-robin and
+ * the two chained DMA channels, checked against the float pipeline in support/reference_analog.cpp
+ * on stick traces across calibration, deadzone, invert and circularity settings, and for what the
+ * DMA buffer is for: every slot keeping its input, no blocking reads in process(), oversampling.
+ */
+
+#include "addons/analog.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "storagemanager.h"
+
+#include "host_sdk.h"
+#include "host_storage.h"
+#include "reference_analog.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+
+#define FRAME_US 100 // long enough for every slot of the buffer to take a new sample
+#define CONVERSION_US 2
+#define OUTPUT_TOLERANCE 2
+#define STEP_TOLERANCE (65535 / 4095 + OUTPUT_TOLERANCE) // an ADC step in output LSB
+
+namespace
+{
+	class AnalogTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			HostStorage::resetConfig();
+			Storage::getInstance().SetGamepad(&gamepad);
+			levels.fill(ADC_CENTER);
+			HostSDK::setAdcSource([this](uint input, uint64_t ns) {
+				(void)ns;
+				const int noisy = levels[input] + (noise ? static_cast<int>(rng() % (2 * noise + 1)) - noise : 0);
+				return static_cast<uint16_t>(std::max(0, std::min(noisy, 4095)));
+			});
+
+			// Stick 1 on ADC inputs 0 and 1, stick 2 on 2 and 3
+			AnalogOptions& options = analogOptions();
+			options.enabled = true;
+			options.analogAdc1PinX = 26;
+			options.analogAdc1PinY = 27;
+			options.analogAdc2PinX = 28;
+			options.analogAdc2PinY = 29;
+			options.analogAdc1Mode = DPAD_MODE_LEFT_ANALOG;
+			options.analogAdc2Mode = DPAD_MODE_RIGHT_ANALOG;
+			options.analogAdc1Invert = INVERT_NONE;
+			options.analogAdc2Invert = INVERT_NONE;
+			options.analog_deadzone = 0;
+			options.forced_circularity = false;
+			options.auto_calibrate = false;
+		}
+
+		static AnalogOptions& analogOptions() { return Storage::getInstance().getAddonOptions().analogOptions; }
+
+		std::unique_ptr<AnalogInput> startAnalog()
+		{
+			std::unique_ptr<AnalogInput> analog(new AnalogInput());
+			EXPECT_TRUE(analog->available());
+			analog->setup();
+			return analog;
+		}
+
+		// What each axis reads right now, in the order of Reference::analogProcess()
+		std::array<uint16_t, 4> axisLevels() const
+		{
+			const AnalogOptions& options = analogOptions();
+			const int32_t pins[4] = { options.analogAdc1PinX, options.analogAdc1PinY, options.analogAdc2PinX, options.analogAdc2PinY };
+			std::array<uint16_t, 4> adc = {};
+			for (int axis = 0; axis < 4; axis++)
+				adc[axis] = (pins[axis] >= 26 && pins[axis] <= 29) ? levels[pins[axis] - 26] : 0;
+			return adc;
+		}
+
+		// The firmware's reading after the levels were held for a frame, and the reference's for the same levels
+		void frame(AnalogInput& analog, GamepadState& expected)
+		{
+			HostSDK::advanceTime(FRAME_US);
+			expected = gamepad.state;
+			const std::array<uint16_t, 4> adc = axisLevels();
+			Reference::analogProcess(analogOptions(), adc.data(), centers.data(), expected);
+			analog.process();
+		}
+
+		// Within the tolerance of the float pipeline, or within a step of what it gives with one axis reading one
+		// step off: the deadzone edge and the rounding on the circle can fall a step differently
+		bool matchesReference(const GamepadState& expected, const GamepadState& before, bool& nudged)
+		{
+			nudged = false;
+			if (close(gamepad.state, expected, OUTPUT_TOLERANCE))
+				return true;
+			const std::array<uint16_t, 4> adc = axisLevels();
+			for (int axis = 0; axis < 4; axis++) {
+				for (int step : { -1, 1 }) {
+					std::array<uint16_t, 4> near = adc;
+					near[axis] = std::max(0, std::min(near[axis] + step, 4095));
+					GamepadState nearState = before;
+					Reference::analogProcess(analogOptions(), near.data(), centers.data(), nearState);
+					if (close(gamepad.state, nearState, STEP_TOLERANCE)) {
+						nudged = true;
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+
+		static bool close(const GamepadState& state, const GamepadState& expected, int tolerance)
+		{
+			return abs(state.lx - expected.lx) <= tolerance && abs(state.ly - expected.ly) <= tolerance &&
+				abs(state.rx - expected.rx) <= tolerance && abs(state.ry - expected.ry) <= tolerance;
+		}
+
+		static const uint16_t ADC_CENTER = 2048;
+
+		Gamepad gamepad;
+		std::array<uint16_t, NUM_ADC_CHANNELS> levels;
+		std::array<uint16_t, 4> centers = {};
+		int noise = 0;
+		std::mt19937 rng;
+	};
+
+	// A stick position as ADC levels, radius 1 being the edge of travel
+	void setStick(std::array<uint16_t, NUM_ADC_CHANNELS>& levels, uint input, double angle, double radius)
+	{
+		levels[input] = std::max(0, std::min(static_cast<int>(2047.5 + 2047.5 * radius * cos(angle)), 4095));
+		levels[input + 1] = std::max(0, std::min(static_cast<int>(2047.5 + 2047.5 * radius * sin(angle)), 4095));
+	}
+}
+
+// Circle sweeps past the edge, random walks, jitter around the center and points on a grid, on random configs
+TEST_F(AnalogTest, MatchesTheFloatPipeline)
+{
+	std::mt19937 configs(1);
+	const DpadMode modes[] = { DPAD_MODE_LEFT_ANALOG, DPAD_MODE_RIGHT_ANALOG, DPAD_MODE_DIGITAL };
+	uint32_t frames = 0;
+	uint32_t nudged = 0;
+	for (int run = 0; run < 48; run++) {
+		SetUp();
+		AnalogOptions& options = analogOptions();
+		options.analog_deadzone = (run % 4) ? configs() % 31 : 0;
+		options.forced_circularity = configs() & 1;
+		options.auto_calibrate = configs() & 1;
+		options.analogAdc1Invert = static_cast<InvertMode>(configs() % 4);
+		options.analogAdc2Invert = static_cast<InvertMode>(configs() % 4);
+		options.analogAdc1Mode = (run % 3) ? DPAD_MODE_LEFT_ANALOG : modes[configs() % 3];
+		options.analogAdc2Mode = (run % 3) ? DPAD_MODE_RIGHT_ANALOG : modes[configs() % 3];
+
+		// Off-center sticks for the calibration to take out
+		for (uint input = 0; input < 4; input++)
+			levels[input] = options.auto_calibrate ? ADC_CENTER - 200 + configs() % 401 : ADC_CENTER;
+		centers = axisLevels();
+		std::unique_ptr<AnalogInput> analog = startAnalog();
+
+		std::mt19937 trace(run);
+		double angle = 0;
+		for (int i = 0; i < 400; i++) {
+			switch ((i / 100) % 4) {
+				case 0:
+					angle += 0.07;
+					setStick(levels, 0, angle, 0.2 + (i % 100) / 80.0);
+					setStick(levels, 2, -angle, 1.25 - (i % 100) / 80.0);
+					break;
+				case 1:
+					for (uint input = 0; input < 4; input++)
+						levels[input] = std::max(0, std::min(levels[input] + static_cast<int>(trace() % 401) - 200, 4095));
+					break;
+				case 2:
+					for (uint input = 0; input < 4; input++)
+						levels[input] = centers[input] + static_cast<int>(trace() % 7) - 3;
+					break;
+				default:
+					for (uint input = 0; input < 4; input++)
+						levels[input] = trace() % 4096;
+					break;
+			}
+
+			const GamepadState before = gamepad.state;
+			GamepadState expected;
+			frame(*analog, expected);
+			bool near = false;
+			ASSERT_TRUE(matchesReference(expected, before, near)) << "config " << run << " frame " << i
+				<< ": lx " << gamepad.state.lx << "/" << expected.lx << " ly " << gamepad.state.ly << "/" << expected.ly
+				<< " rx " << gamepad.state.rx << "/" << expected.rx << " ry " << gamepad.state.ry << "/" << expected.ry;
+			nudged += near;
+			frames++;
+		}
+	}
+	EXPECT_LT(nudged, frames / 100);
+	EXPECT_EQ(HostSDK::counters().adcOverflows, 0u);
+	RecordProperty("frames", std::to_string(frames));
+	RecordProperty("one_step_off", std::to_string(nudged));
+}
+
+// With a 20% deadzone the edge falls on whole readings: 2457 and 1638 are exactly on it, and outside on both
+// sides. The float pipeline rounded 1638 inside, one of the edge cases matchesReference() lets through
+TEST_F(AnalogTest, DeadzoneEdgeIsOutside)
+{
+	analogOptions().analog_deadzone = 20;
+	std::unique_ptr<AnalogInput> analog = startAnalog();
+	const uint16_t edges[][2] = { { 2457, 1638 }, { 2456, 1639 } };
+	for (const uint16_t *edge : edges) {
+		levels = { edge[0], edge[1], ADC_CENTER, ADC_CENTER, 0 };
+		const GamepadState before = gamepad.state;
+		GamepadState expected;
+		frame(*analog, expected);
+		bool near = false;
+		EXPECT_TRUE(matchesReference(expected, before, near));
+		const bool outside = edge[0] == 2457;
+		EXPECT_EQ(gamepad.state.lx != 32767, outside) << edge[0];
+		EXPECT_EQ(gamepad.state.ly != 32767, outside) << edge[1];
+		if (outside)
+			EXPECT_EQ(gamepad.state.lx + gamepad.state.ly, 65535) << "the same distance either side of the middle";
+	}
+}
+
+// Sticks on some of the inputs, in any order: each slot of the round-robin buffer has to keep holding its input
+TEST_F(AnalogTest, EverySlotKeepsItsInput)
+{
+	const int32_t layouts[][4] = {
+		{ 28, 26, -1, -1 },
+		{ -1, -1, 27, 29 },
+		{ 29, -1, -1, -1 },
+		{ 29, 27, 26, 28 },
+		{ 26, 29, 28, -1 },
+	};
+	for (const int32_t *pins : layouts) {
+		SetUp();
+		AnalogOptions& options = analogOptions();
+		options.analogAdc1PinX = pins[0];
+		options.analogAdc1PinY = pins[1];
+		options.analogAdc2PinX = pins[2];
+		options.analogAdc2PinY = pins[3];
+		levels = { 300, 1300, 2300, 3300, 3900 };
+		std::unique_ptr<AnalogInput> analog = startAnalog();
+
+		for (int i = 0; i < 500; i++) {
+			const GamepadState before = gamepad.state;
+			GamepadState expected;
+			frame(*analog, expected);
+			bool near = false;
+			ASSERT_TRUE(matchesReference(expected, before, near)) << "pins " << pins[0] << " " << pins[1] << " " << pins[2] << " " << pins[3]
+				<< " frame " << i;
+			ASSERT_FALSE(near);
+		}
+		EXPECT_EQ(HostSDK::counters().adcOverflows, 0u);
+		EXPECT_EQ(host_adc_hw.fcs & ADC_FCS_OVER_BITS, 0u);
+	}
+}
+
+// The point of the DMA buffer: process() neither waits on the ADC nor lets time pass
+TEST_F(AnalogTest, ProcessDoesNotBlock)
+{
+	std::unique_ptr<AnalogInput> analog = startAnalog();
+	EXPECT_EQ(HostSDK::counters().adcReads, 4u) << "one read to seed the slots of each input";
+
+	for (int i = 0; i < 200; i++) {
+		HostSDK::advanceTime(FRAME_US);
+		const uint64_t now = HostSDK::now();
+		analog->process();
+		ASSERT_EQ(HostSDK::now(), now);
+	}
+	EXPECT_EQ(HostSDK::counters().adcReads, 4u);
+}
+
+// Each read averages ANALOG_ADC_OVERSAMPLE samples, which should take the noise down by about its square root
+TEST_F(AnalogTest, OversamplingAveragesTheNoise)
+{
+	noise = 64;
+	std::unique_ptr<AnalogInput> analog = startAnalog();
+	double sum = 0;
+	double squares = 0;
+	double referenceSum = 0;
+	double referenceSquares = 0;
+	const int count = 4000;
+	for (int i = 0; i < count; i++) {
+		HostSDK::advanceTime(FRAME_US);
+		analog->process();
+		sum += gamepad.state.lx;
+		squares += double(gamepad.state.lx) * gamepad.state.lx;
+
+		// One noisy reading a frame, as the blocking reads took
+		uint16_t adc[4] = { static_cast<uint16_t>(ADC_CENTER - noise + rng() % (2 * noise + 1)), ADC_CENTER, ADC_CENTER, ADC_CENTER };
+		GamepadState state = {};
+		Reference::analogProcess(analogOptions(), adc, centers.data(), state);
+		referenceSum += state.lx;
+		referenceSquares += double(state.lx) * state.lx;
+	}
+	const double deviation = sqrt(squares / count - (sum / count) * (sum / count));
+	const double referenceDeviation = sqrt(referenceSquares / count - (referenceSum / count) * (referenceSum / count));
+	EXPECT_LT(deviation * 2, referenceDeviation);
+	EXPECT_NEAR(sum / count, 32767, 64);
+	RecordProperty("deviation", std::to_string(deviation));
+	RecordProperty("reference_deviation", std::to_string(referenceDeviation));
+}
+
+// A step reaches the output in stages as it fills the buffer, and all of it once every slot has been written
+TEST_F(AnalogTest, StepSettlesWithinTheBuffer)
+{
+	levels.fill(1000);
+	std::unique_ptr<AnalogInput> analog = startAnalog();
+	HostSDK::advanceTime(FRAME_US);
+	analog->process();
+	const uint16_t low = gamepad.state.lx;
+
+	levels.fill(3000);
+	const uint32_t roundUs = 4 * CONVERSION_US;
+	HostSDK::advanceTime(ANALOG_ADC_OVERSAMPLE / 2 * roundUs);
+	analog->process();
+	const uint16_t halfway = gamepad.state.lx;
+	HostSDK::advanceTime((ANALOG_ADC_OVERSAMPLE / 2 + 1) * roundUs);
+	analog->process();
+	const uint16_t settled = gamepad.state.lx;
+
+	GamepadState expected = {};
+	const std::array<uint16_t, 4> adc = axisLevels();
+	Reference::analogProcess(analogOptions(), adc.data(), centers.data(), expected);
+	EXPECT_GT(halfway, low);
+	EXPECT_LT(halfway, settled);
+	EXPECT_NEAR(settled, expected.lx, OUTPUT_TOLERANCE);
+}
+
+// Auto-calibration takes the centers with blocking reads before sampling starts. A stick at rest then reads
+// ADC_MAX / 2, a few LSB under the middle as it always did, which the smallest deadzone takes out
+TEST_F(AnalogTest, CalibratedCentersReadCentered)
+{
+	analogOptions().auto_calibrate = true;
+	levels = { 1700, 2400, 2050, 1990, 0 };
+	centers = axisLevels();
+	std::unique_ptr<AnalogInput> analog = startAnalog();
+	EXPECT_EQ(HostSDK::counters().adcReads, 8u) << "the calibration reads, then the ones seeding the buffer";
+	for (int i = 0; i < 20; i++) {
+		const GamepadState before = gamepad.state;
+		GamepadState expected;
+		frame(*analog, expected);
+		bool near = false;
+		EXPECT_TRUE(matchesReference(expected, before, near));
+		EXPECT_FALSE(near);
+	}
+
+	analogOptions().analog_deadzone = 1;
+	HostSDK::advanceTime(FRAME_US);
+	analog->process();
+	EXPECT_EQ(gamepad.state.lx, 32767);
+	EXPECT_EQ(gamepad.state.ly, 32767);
+	EXPECT_EQ(gamepad.state.rx, 32767);
+	EXPECT_EQ(gamepad.state.ry, 32767);
+}
+
+// The shmup dial does its own adc_read(), so the sticks stay on blocking reads and no DMA channel is taken
+TEST_F(AnalogTest, TurboDialKeepsBlockingReads)
+{
+	TurboOptions& turbo = Storage::getInstance().getAddonOptions().turboOptions;
+	turbo.enabled = true;
+	turbo.shmupDialPin = 29;
+	AnalogOptions& options = analogOptions();
+	options.analogAdc2PinX = -1;
+	options.analogAdc2PinY = -1;
+	levels = { 500, 3500, 0, 0, 0 };
+	std::unique_ptr<AnalogInput> analog = startAnalog();
+	EXPECT_EQ(dma_claim_unused_channel(false), 0);
+
+	for (int i = 0; i < 10; i++) {
+		const uint32_t reads = HostSDK::counters().adcReads;
+		const GamepadState before = gamepad.state;
+		GamepadState expected;
+		frame(*analog, expected);
+		bool near = false;
+		EXPECT_TRUE(matchesReference(expected, before, near));
+		EXPECT_EQ(HostSDK::counters().adcReads - reads, 2u);
+	}
+}
+
+// With fewer than the two channels it needs free, sampling gives back what it claimed and reads blocking
+TEST_F(AnalogTest, FallsBackWithoutDmaChannels)
+{
+	for (int free : { 0, 1 }) {
+		SetUp();
+		for (int channel = 0; channel < NUM_DMA_CHANNELS - free; channel++)
+			dma_channel_claim(channel);
+		levels = { 100, 4000, 1024, 3072, 0 };
+		std::unique_ptr<AnalogInput> analog = startAnalog();
+		if (free) {
+			EXPECT_EQ(dma_claim_unused_channel(false), NUM_DMA_CHANNELS - 1);
+		}
+
+		const uint32_t reads = HostSDK::counters().adcReads;
+		const GamepadState before = gamepad.state;
+		GamepadState expected;
+		frame(*analog, expected);
+		bool near = false;
+		EXPECT_TRUE(matchesReference(expected, before, near)) << free << " channels free";
+		EXPECT_EQ(HostSDK::counters().adcReads - reads, 4u);
+		EXPECT_EQ(HostSDK::counters().dmaRuns, 0u);
+	}
+}
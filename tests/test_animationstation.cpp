@@ -0,0 +1,300 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The flat PixelMatrix and the pressed bitmask against the nested layout and pressed vectors they
+ * replaced, see support/reference_leds.cpp: the same pixels lit, the same frames drawn, and the
+ * press-to-frame step of every effect without a heap allocation.
+ */
+
+#include "AnimationStation.hpp"
+#include "GamepadState.h"
+
+#include "host_heap.h"
+#include "host_sdk.h"
+#include "reference_leds.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+
+#define STATIC_COLOR_INDEX 2  // ColorRed
+#define BUTTON_COLOR_INDEX 10 // ColorBlue
+#define LAYOUTS 200
+#define TICKS 500
+
+namespace
+{
+	const uint32_t buttonMasks[] = {
+		GAMEPAD_MASK_DU, GAMEPAD_MASK_DD, GAMEPAD_MASK_DL, GAMEPAD_MASK_DR,
+		GAMEPAD_MASK_B1, GAMEPAD_MASK_B2, GAMEPAD_MASK_B3, GAMEPAD_MASK_B4,
+		GAMEPAD_MASK_L1, GAMEPAD_MASK_R1, GAMEPAD_MASK_L2, GAMEPAD_MASK_R2,
+		GAMEPAD_MASK_S1, GAMEPAD_MASK_S2, GAMEPAD_MASK_L3, GAMEPAD_MASK_R3,
+		GAMEPAD_MASK_A1, GAMEPAD_MASK_A2,
+	};
+
+	// A layout like the addon builds: the buttons shuffled into rows with holes, some without an LED index,
+	// the others in a random order along the chain
+	ReferenceLeds::Layout randomLayout(std::mt19937 &random)
+	{
+		std::vector<uint32_t> masks(std::begin(buttonMasks), std::end(buttonMasks));
+		std::shuffle(masks.begin(), masks.end(), random);
+		std::vector<int> order(masks.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), random);
+
+		std::map<uint32_t, int> ledIndex;
+		for (size_t i = 0; i < masks.size(); i++) {
+			if (random() % 5)
+				ledIndex[masks[i]] = order[i];
+		}
+
+		std::vector<std::vector<uint32_t>> rows(1);
+		for (uint32_t mask : masks) {
+			if (random() % 4 == 0)
+				rows.emplace_back();
+			while (random() % 3 == 0)
+				rows.back().push_back(0);
+			rows.back().push_back(mask);
+		}
+		return ReferenceLeds::makeLayout(rows, ledIndex, 1 + random() % 3);
+	}
+
+	// Up to four buttons held, sometimes none
+	uint32_t randomButtons(std::mt19937 &random)
+	{
+		uint32_t state = 0;
+		for (int held = random() % 5; held > 0; held--)
+			state |= buttonMasks[random() % std::size(buttonMasks)];
+		return state;
+	}
+
+	bool sameFrame(const RGB (&a)[100], const RGB (&b)[100])
+	{
+		for (int i = 0; i < 100; i++) {
+			if (a[i].r != b[i].r || a[i].g != b[i].g || a[i].b != b[i].b || a[i].w != b[i].w)
+				return false;
+		}
+		return true;
+	}
+
+	class AnimationStationTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			AnimationOptions options = {};
+			options.staticColorIndex = STATIC_COLOR_INDEX;
+			options.buttonColorIndex = BUTTON_COLOR_INDEX;
+			options.chaseCycleTime = 85;
+			options.rainbowCycleTime = 40;
+			AnimationStation::options = options;
+
+			theme = { { GAMEPAD_MASK_B1, ColorGreen }, { GAMEPAD_MASK_DL, ColorPink }, { GAMEPAD_MASK_S2, ColorAqua } };
+			pressedTheme = { { GAMEPAD_MASK_B1, ColorWhite }, { GAMEPAD_MASK_DU, ColorOrange } };
+			StaticTheme::ClearThemes();
+			StaticTheme::AddTheme(theme);
+			CustomTheme::SetCustomTheme(theme);
+			CustomThemePressed::SetCustomTheme(pressedTheme);
+		}
+
+		void TearDown() override
+		{
+			StaticTheme::ClearThemes();
+			CustomTheme::SetCustomTheme({});
+			CustomThemePressed::SetCustomTheme({});
+		}
+
+		// What the effects of mode draw, on the nested path
+		void drawReference(ReferenceLeds::Station &reference, AnimationEffects mode, RGB (&frame)[100])
+		{
+			switch (mode) {
+			case EFFECT_STATIC_COLOR:
+				reference.drawColor(colors[STATIC_COLOR_INDEX], false, frame);
+				reference.drawColor(colors[BUTTON_COLOR_INDEX], true, frame);
+				break;
+			case EFFECT_STATIC_THEME:
+				reference.drawTheme(theme, ColorBlack, false, frame);
+				reference.drawColor(colors[BUTTON_COLOR_INDEX], true, frame);
+				break;
+			case EFFECT_CUSTOM_THEME:
+				reference.drawTheme(theme, ColorBlack, false, frame);
+				reference.drawTheme(pressedTheme, ColorBlack, true, frame);
+				break;
+			default:
+				FAIL() << "no reference for effect " << mode;
+			}
+		}
+
+		std::map<uint32_t, RGB> theme;
+		std::map<uint32_t, RGB> pressedTheme;
+	};
+}
+
+TEST(PixelMatrixTest, FlattensLikeTheNestedLayout)
+{
+	std::mt19937 random(22);
+	for (int n = 0; n < LAYOUTS; n++) {
+		SCOPED_TRACE(n);
+		const ReferenceLeds::Layout layout = randomLayout(random);
+		PixelMatrix matrix;
+		matrix.setup(layout, 2);
+
+		uint16_t pixelCount = 0;
+		int ledCount = 0;
+		uint8_t lit = 0;
+		for (const std::vector<Pixel> &row : layout) {
+			for (const Pixel &pixel : row) {
+				pixelCount++;
+				if (pixel.index == NO_PIXEL.index)
+					continue;
+				ledCount += pixel.positions.size();
+				ASSERT_LT(lit, matrix.size);
+				EXPECT_EQ(matrix.indexes[lit], pixel.index);
+				EXPECT_EQ(matrix.masks[lit], pixel.mask);
+				const std::vector<uint8_t> run(matrix.positions + matrix.offsets[lit], matrix.positions + matrix.offsets[lit] + matrix.lengths[lit]);
+				EXPECT_EQ(run, pixel.positions);
+				lit++;
+			}
+		}
+		EXPECT_EQ(matrix.size, lit);
+		EXPECT_EQ(matrix.getPixelCount(), pixelCount);
+		EXPECT_EQ(matrix.getLedCount(), ledCount);
+	}
+}
+
+TEST(PixelMatrixTest, PressedBitsAreThePressedPixels)
+{
+	std::mt19937 random(22);
+	for (int n = 0; n < LAYOUTS; n++) {
+		const ReferenceLeds::Layout layout = randomLayout(random);
+		PixelMatrix matrix;
+		matrix.setup(layout);
+		for (int t = 0; t < 20; t++) {
+			const uint32_t buttons = randomButtons(random);
+			std::vector<int> expected;
+			for (const Pixel &pixel : ReferenceLeds::pressedPixels(layout, buttons)) {
+				if (pixel.index != NO_PIXEL.index)
+					expected.push_back(pixel.index);
+			}
+			const uint32_t pressed = matrix.getPressed(buttons);
+			std::vector<int> lit;
+			for (uint8_t i = 0; i < 32; i++) {
+				if (pressed & (1u << i)) {
+					ASSERT_LT(i, matrix.size) << "bit past the last pixel";
+					lit.push_back(matrix.indexes[i]);
+				}
+			}
+			EXPECT_EQ(lit, expected) << "layout " << n << " buttons 0x" << std::hex << buttons;
+		}
+	}
+}
+
+TEST_F(AnimationStationTest, FramesMatchTheNestedPath)
+{
+	std::mt19937 random(22);
+	for (AnimationEffects mode : { EFFECT_STATIC_COLOR, EFFECT_STATIC_THEME, EFFECT_CUSTOM_THEME }) {
+		for (int n = 0; n < LAYOUTS / 10; n++) {
+			SCOPED_TRACE(testing::Message() << "effect " << mode << " layout " << n);
+			const ReferenceLeds::Layout layout = randomLayout(random);
+			PixelMatrix matrix;
+			matrix.setup(layout);
+			AnimationStation as;
+			as.SetMatrix(matrix);
+			as.SetMode(mode);
+			ReferenceLeds::Station reference(layout);
+			RGB expected[100] = {};
+
+			for (int t = 0; t < TICKS / 10; t++) {
+				// NeoPicoLEDAddon::process()
+				const uint32_t buttons = randomButtons(random);
+				const uint32_t pressed = matrix.getPressed(buttons);
+				if (pressed != 0)
+					as.HandlePressed(pressed);
+				else
+					as.ClearPressed();
+				as.Animate();
+
+				std::vector<Pixel> pressedPixels = ReferenceLeds::pressedPixels(layout, buttons);
+				if (!pressedPixels.empty())
+					reference.handlePressed(pressedPixels);
+				else
+					reference.clearPressed();
+				drawReference(reference, mode, expected);
+				ASSERT_TRUE(sameFrame(as.frame, expected)) << "tick " << t << " buttons 0x" << std::hex << buttons;
+			}
+		}
+	}
+}
+
+// The button effect a mode change builds starts with what is held
+TEST_F(AnimationStationTest, ModeChangeKeepsThePressedPixels)
+{
+	const ReferenceLeds::Layout layout = ReferenceLeds::makeLayout(ReferenceLeds::sticklessMasks,
+		{ { GAMEPAD_MASK_B1, 0 }, { GAMEPAD_MASK_B2, 1 }, { GAMEPAD_MASK_DU, 2 }, { GAMEPAD_MASK_DL, 3 } }, 2);
+	PixelMatrix matrix;
+	matrix.setup(layout);
+	AnimationStation as;
+	as.SetMatrix(matrix);
+	as.SetMode(EFFECT_STATIC_COLOR);
+	as.HandlePressed(matrix.getPressed(GAMEPAD_MASK_B2 | GAMEPAD_MASK_DL));
+
+	as.SetMode(EFFECT_STATIC_THEME);
+	as.Animate();
+	ReferenceLeds::Station reference(layout);
+	reference.handlePressed(ReferenceLeds::pressedPixels(layout, GAMEPAD_MASK_B2 | GAMEPAD_MASK_DL));
+	RGB expected[100] = {};
+	drawReference(reference, EFFECT_STATIC_THEME, expected);
+	EXPECT_TRUE(sameFrame(as.frame, expected));
+	EXPECT_EQ(as.frame[0].g, 255); // B1 up, in its theme color
+	EXPECT_EQ(as.frame[2].b, 255); // B2 held, in the button color
+	EXPECT_EQ(as.frame[6].r, 0);   // DL held, the button color over its theme color
+	EXPECT_EQ(as.frame[6].b, 255);
+}
+
+// Everything NeoPicoLEDAddon::process() does with the LEDs between reading the buttons and Show()
+TEST_F(AnimationStationTest, PressToFrameNeverTouchesTheHeap)
+{
+	std::mt19937 random(22);
+	const ReferenceLeds::Layout layout = randomLayout(random);
+	PixelMatrix matrix;
+	matrix.setup(layout);
+	AnimationStation as;
+	as.SetMatrix(matrix);
+	uint32_t values[100];
+
+	for (AnimationEffects mode : { EFFECT_STATIC_COLOR, EFFECT_RAINBOW, EFFECT_CHASE, EFFECT_STATIC_THEME, EFFECT_CUSTOM_THEME }) {
+		SCOPED_TRACE(mode);
+		HostHeap::reset();
+		as.SetMode(mode);
+		for (int t = 0; t < TICKS; t++) {
+			const uint32_t pressed = matrix.getPressed(randomButtons(random));
+			if (pressed != 0)
+				as.HandlePressed(pressed);
+			else
+				as.ClearPressed();
+			as.Animate();
+			as.ApplyBrightness(values);
+			HostSDK::advanceTime(10000);
+		}
+		EXPECT_EQ(HostHeap::allocations(), 0u);
+	}
+
+	// What the same ticks cost on the nested path
+	ReferenceLeds::Station reference(layout);
+	RGB frame[100];
+	HostHeap::reset();
+	for (int t = 0; t < TICKS; t++) {
+		std::vector<Pixel> pressed = ReferenceLeds::pressedPixels(layout, randomButtons(random));
+		if (!pressed.empty())
+			reference.handlePressed(pressed);
+		else
+			reference.clearPressed();
+		reference.drawColor(colors[STATIC_COLOR_INDEX], false, frame);
+		reference.drawColor(colors[BUTTON_COLOR_INDEX], true, frame);
+	}
+	EXPECT_GT(HostHeap::allocations(), static_cast<size_t>(TICKS));
+}
@@ -0,0 +1,221 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The DMA write queue in BitBang_I2C against the stub I2C controller: queued writes have to reach
+ * the device in order and framed as they were queued, without the caller waiting on the bus, and
+ * the blocking calls must never interleave with a run that is still going out.
+ */
+
+#include "BitBang_I2C.h"
+
+#include "host_sdk.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#define DEVICE_ADDRESS 0x20
+#define OTHER_ADDRESS 0x21
+
+namespace
+{
+	typedef std::vector<uint8_t> Bytes;
+
+	// Keeps every write it was offered, NACKs the one numbered nackAt
+	class RecordingDevice : public HostSDK::I2CDevice
+	{
+	public:
+		bool write(const uint8_t *data, size_t length) override
+		{
+			writes.push_back(Bytes(data, data + length));
+			times.push_back(HostSDK::now());
+			return writes.size() - 1 != nackAt;
+		}
+
+		bool read(uint8_t *data, size_t length) override
+		{
+			for (size_t i = 0; i < length; i++)
+				data[i] = static_cast<uint8_t>(0xA0 + i);
+			return true;
+		}
+
+		std::vector<Bytes> writes;
+		std::vector<uint64_t> times;
+		size_t nackAt = SIZE_MAX;
+	};
+
+	struct Completion
+	{
+		int calls = 0;
+		int bError = -1;
+	};
+
+	void onDone(void *pUser, int bError)
+	{
+		Completion *completion = static_cast<Completion *>(pUser);
+		completion->calls++;
+		completion->bError = bError;
+	}
+
+	class BitBangI2CTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			HostSDK::attachI2CDevice(0, DEVICE_ADDRESS, &device);
+			HostSDK::attachI2CDevice(0, OTHER_ADDRESS, &other);
+			bus.iSDA = 0;
+			bus.iSCL = 1;
+			bus.picoI2C = i2c0;
+			I2CInit(&bus, 400000);
+		}
+
+		// The queue outlives the test, nothing may be left running for the next one
+		void TearDown() override
+		{
+			I2CAsyncWait(&bus);
+		}
+
+		int queue(uint8_t address, Bytes bytes)
+		{
+			return I2CWriteQueue(&bus, address, bytes.data(), static_cast<int>(bytes.size()));
+		}
+
+		BBI2C bus = {};
+		RecordingDevice device;
+		RecordingDevice other;
+		Completion completion;
+	};
+}
+
+TEST_F(BitBangI2CTest, QueuedWritesArriveInOrderFromOneRun)
+{
+	EXPECT_EQ(queue(DEVICE_ADDRESS, { 0x00, 0xB0, 0x10 }), 3);
+	EXPECT_EQ(queue(DEVICE_ADDRESS, { 0x40 }), 1);
+	EXPECT_EQ(queue(DEVICE_ADDRESS, { 0x40, 0x55, 0xAA }), 3);
+	EXPECT_TRUE(device.writes.empty()) << "nothing goes out before I2CWriteStart()";
+
+	const uint32_t runs = HostSDK::counters().dmaRuns;
+	I2CWriteStart(&bus, onDone, &completion);
+	I2CAsyncWait(&bus);
+
+	const std::vector<Bytes> expected = { { 0x00, 0xB0, 0x10 }, { 0x40 }, { 0x40, 0x55, 0xAA } };
+	EXPECT_EQ(device.writes, expected);
+	EXPECT_EQ(HostSDK::counters().dmaRuns - runs, 1u);
+	EXPECT_EQ(completion.calls, 1);
+	EXPECT_EQ(completion.bError, 0);
+}
+
+TEST_F(BitBangI2CTest, StartReturnsBeforeTheBytesAreOnTheWire)
+{
+	queue(DEVICE_ADDRESS, Bytes(100, 0x40));
+	const uint64_t start = HostSDK::now();
+	I2CWriteStart(&bus, onDone, &completion);
+	EXPECT_EQ(HostSDK::now(), start);
+	EXPECT_TRUE(I2CAsyncBusy(&bus));
+	EXPECT_EQ(completion.calls, 0);
+
+	// 101 bytes of 9 bits at 400 kHz
+	HostSDK::advanceTime(3000);
+	ASSERT_EQ(device.writes.size(), 1u);
+	EXPECT_GE(device.times[0] - start, 2000u);
+	EXPECT_EQ(completion.calls, 0) << "the callback runs from I2CAsyncBusy() or I2CAsyncWait(), never from the DMA";
+	EXPECT_FALSE(I2CAsyncBusy(&bus));
+	EXPECT_EQ(completion.calls, 1);
+	EXPECT_EQ(completion.bError, 0);
+	EXPECT_FALSE(I2CAsyncBusy(&bus));
+	EXPECT_EQ(completion.calls, 1);
+}
+
+TEST_F(BitBangI2CTest, NackedWriteIsReportedAndTheRestDropped)
+{
+	device.nackAt = 1;
+	queue(DEVICE_ADDRESS, { 1, 2 });
+	queue(DEVICE_ADDRESS, { 3, 4 });
+	queue(DEVICE_ADDRESS, { 5, 6 });
+	I2CWriteStart(&bus, onDone, &completion);
+	I2CAsyncWait(&bus);
+	EXPECT_EQ(device.writes.size(), 2u);
+	EXPECT_EQ(completion.calls, 1);
+	EXPECT_EQ(completion.bError, 1);
+
+	// The error belongs to that run only
+	Completion next;
+	queue(DEVICE_ADDRESS, { 7, 8 });
+	I2CWriteStart(&bus, onDone, &next);
+	I2CAsyncWait(&bus);
+	EXPECT_EQ(device.writes.back(), Bytes({ 7, 8 }));
+	EXPECT_EQ(next.calls, 1);
+	EXPECT_EQ(next.bError, 0);
+}
+
+// The stub panics on a blocking transfer while DMA is still feeding the controller
+TEST_F(BitBangI2CTest, BlockingCallsWaitForTheQueue)
+{
+	queue(DEVICE_ADDRESS, Bytes(50, 0x40));
+	I2CWriteStart(&bus, onDone, &completion);
+	uint8_t command[] = { 0x00, 0xAF };
+	EXPECT_EQ(I2CWrite(&bus, DEVICE_ADDRESS, command, sizeof(command)), 2);
+	EXPECT_EQ(completion.calls, 1);
+	ASSERT_EQ(device.writes.size(), 2u);
+	EXPECT_EQ(device.writes[1], Bytes({ 0x00, 0xAF }));
+
+	queue(DEVICE_ADDRESS, Bytes(50, 0x40));
+	I2CWriteStart(&bus, nullptr, nullptr);
+	uint8_t status = 0;
+	EXPECT_TRUE(I2CReadRegister(&bus, DEVICE_ADDRESS, 0x00, &status, 1));
+	EXPECT_EQ(status, 0xA0);
+	ASSERT_EQ(device.writes.size(), 4u);
+	EXPECT_EQ(device.writes[2], Bytes(50, 0x40));
+	EXPECT_EQ(device.writes[3], Bytes({ 0x00 }));
+
+	// A write that kept the bus is picked up by the next run
+	queue(DEVICE_ADDRESS, { 0x40, 0x01 });
+	I2CWriteStart(&bus, onDone, &completion);
+	I2CAsyncWait(&bus);
+	EXPECT_EQ(device.writes.back(), Bytes({ 0x40, 0x01 }));
+	EXPECT_EQ(completion.calls, 2);
+	EXPECT_EQ(completion.bError, 0);
+}
+
+TEST_F(BitBangI2CTest, ChangingTargetSendsWhatIsQueuedFirst)
+{
+	queue(DEVICE_ADDRESS, { 1, 2, 3 });
+	queue(OTHER_ADDRESS, { 4, 5 });
+	ASSERT_EQ(device.writes.size(), 1u);
+	EXPECT_EQ(device.writes[0], Bytes({ 1, 2, 3 }));
+	EXPECT_TRUE(other.writes.empty());
+
+	I2CWriteStart(&bus, onDone, &completion);
+	I2CAsyncWait(&bus);
+	ASSERT_EQ(other.writes.size(), 1u);
+	EXPECT_EQ(other.writes[0], Bytes({ 4, 5 }));
+	EXPECT_EQ(device.writes.size(), 1u);
+	EXPECT_EQ(completion.calls, 1);
+}
+
+TEST_F(BitBangI2CTest, WriteLargerThanTheQueueGoesOutBlocking)
+{
+	queue(DEVICE_ADDRESS, { 1, 2 });
+	const Bytes large(I2C_ASYNC_QUEUE_SIZE + 1, 0x40);
+	const uint64_t start = HostSDK::now();
+	EXPECT_EQ(queue(DEVICE_ADDRESS, large), I2C_ASYNC_QUEUE_SIZE + 1);
+	EXPECT_GT(HostSDK::now(), start);
+	ASSERT_EQ(device.writes.size(), 2u);
+	EXPECT_EQ(device.writes[0], Bytes({ 1, 2 }));
+	EXPECT_EQ(device.writes[1], large);
+
+	// Nothing left to start, the callback comes straight away
+	I2CWriteStart(&bus, onDone, &completion);
+	EXPECT_EQ(completion.calls, 1);
+	EXPECT_EQ(completion.bError, 0);
+
+	// and still reports a NACK on the blocking path
+	device.nackAt = 2;
+	Completion failed;
+	EXPECT_EQ(queue(DEVICE_ADDRESS, large), 0);
+	I2CWriteStart(&bus, onDone, &failed);
+	EXPECT_EQ(failed.calls, 1);
+	EXPECT_EQ(failed.bError, 1);
+}
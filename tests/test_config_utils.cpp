@@ -0,0 +1,221 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * ConfigUtils::toJSON streamed in chunks against the whole text in a std::string, on random configs
+ * filled through the nanopb field descriptors: the chunks have to reassemble to the same bytes, the
+ * length has to match without producing the text, and the chunked path must not touch the heap.
+ */
+
+#include "config_utils.h"
+#include "configs/base64.h"
+
+#include "host_heap.h"
+#include "host_sdk.h"
+
+#include "pb_common.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CHUNK_BUFFER_SIZE 4096 // larger than any chunk lwIP asks for
+
+namespace
+{
+	void randomMessage(std::mt19937& rng, const pb_msgdesc_t *descriptor, void *message);
+
+	void randomValue(std::mt19937& rng, const pb_field_iter_t& field, uint8_t *value)
+	{
+		switch (PB_LTYPE(field.type)) {
+			case PB_LTYPE_BOOL:
+				*reinterpret_cast<bool *>(value) = rng() & 1;
+				break;
+			case PB_LTYPE_VARINT:
+			case PB_LTYPE_UVARINT:
+			case PB_LTYPE_SVARINT:
+			case PB_LTYPE_FIXED32:
+			case PB_LTYPE_FIXED64: {
+				// Small values most of the time, the extremes now and then
+				const uint32_t random = (rng() % 4) ? rng() % 100 : rng();
+				for (size_t i = 0; i < field.data_size; i++)
+					value[i] = i < sizeof(random) ? (random >> (8 * i)) & 0xff : 0;
+				break;
+			}
+			case PB_LTYPE_STRING: {
+				static const char characters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 -_";
+				const size_t length = rng() % field.data_size;
+				for (size_t i = 0; i < length; i++)
+					value[i] = characters[rng() % (sizeof(characters) - 1)];
+				value[length] = '\0';
+				break;
+			}
+			case PB_LTYPE_BYTES: {
+				pb_bytes_array_t *bytes = reinterpret_cast<pb_bytes_array_t *>(value);
+				const size_t capacity = field.data_size - offsetof(pb_bytes_array_t, bytes);
+				bytes->size = (rng() % 3) ? rng() % (capacity + 1) : capacity;
+				for (size_t i = 0; i < bytes->size; i++)
+					bytes->bytes[i] = rng() & 0xff;
+				break;
+			}
+			case PB_LTYPE_SUBMESSAGE:
+				randomMessage(rng, field.submsg_desc, value);
+				break;
+			default:
+				FAIL() << "field " << field.tag << " has a type the JSON code does not handle";
+		}
+	}
+
+	// Every field of every submessage gets a value, repeated fields a random count, options are all set
+	void randomMessage(std::mt19937& rng, const pb_msgdesc_t *descriptor, void *message)
+	{
+		pb_field_iter_t field;
+		if (!pb_field_iter_begin(&field, descriptor, message))
+			return;
+		do {
+			uint8_t *data = static_cast<uint8_t *>(field.pData);
+			if (PB_HTYPE(field.type) == PB_HTYPE_REPEATED) {
+				const pb_size_t count = rng() % (field.array_size + 1);
+				*static_cast<pb_size_t *>(field.pSize) = count;
+				for (pb_size_t i = 0; i < count; i++)
+					randomValue(rng, field, data + i * field.data_size);
+			} else {
+				if (PB_HTYPE(field.type) == PB_HTYPE_OPTIONAL && field.pSize)
+					*static_cast<bool *>(field.pSize) = true;
+				randomValue(rng, field, data);
+			}
+		} while (pb_field_iter_next(&field));
+	}
+
+	// Chunk sizes the way lwIP asks for them, bounded by the send buffer and what the connection has drained
+	std::string streamed(std::mt19937& rng, const Config& config, size_t length)
+	{
+		static char chunk[CHUNK_BUFFER_SIZE];
+		std::string text;
+		text.reserve(length);
+		size_t offset = 0;
+		while (offset < length) {
+			const size_t size = 1 + ((rng() % 4) ? rng() % 1460 : rng() % CHUNK_BUFFER_SIZE);
+			memset(chunk, 0, sizeof(chunk));
+			const size_t copied = ConfigUtils::toJSON(config, chunk, offset, size);
+			EXPECT_EQ(copied, std::min(size, length - offset));
+			if (copied == 0)
+				break;
+			text.append(chunk, copied);
+			offset += copied;
+		}
+		return text;
+	}
+
+	// The quoted value of the first "name": in the text
+	std::string quotedValue(const std::string& text, const std::string& name)
+	{
+		const size_t at = text.find("\"" + name + "\": \"");
+		if (at == std::string::npos)
+			return "<missing>";
+		const size_t start = at + name.size() + 5;
+		return text.substr(start, text.find('"', start) - start);
+	}
+
+	class ConfigUtilsTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+		}
+
+		Config config = Config_init_zero;
+	};
+}
+
+TEST_F(ConfigUtilsTest, DefaultConfigStreamsTheSameText)
+{
+	ConfigUtils::initUnsetPropertiesWithDefaults(config);
+	const std::string text = ConfigUtils::toJSON(config);
+	ASSERT_GT(text.size(), 1000u);
+	EXPECT_EQ(text.front(), '{');
+	EXPECT_EQ(text.substr(text.size() - 2), "}\n");
+	EXPECT_EQ(ConfigUtils::jsonLength(config), text.size());
+
+	std::mt19937 rng(1);
+	EXPECT_EQ(streamed(rng, config, text.size()), text);
+}
+
+TEST_F(ConfigUtilsTest, RandomConfigsStreamTheSameText)
+{
+	std::mt19937 rng(2);
+	for (int run = 0; run < 300; run++) {
+		config = Config_init_zero;
+		randomMessage(rng, Config_fields, &config);
+		const std::string text = ConfigUtils::toJSON(config);
+		ASSERT_EQ(ConfigUtils::jsonLength(config), text.size()) << "config " << run;
+		ASSERT_EQ(streamed(rng, config, text.size()), text) << "config " << run;
+	}
+}
+
+TEST_F(ConfigUtilsTest, WindowAtEveryOffset)
+{
+	std::mt19937 rng(3);
+	randomMessage(rng, Config_fields, &config);
+	const std::string text = ConfigUtils::toJSON(config);
+	char chunk[64];
+	for (size_t offset = 0; offset <= text.size() + 8; offset += 1 + rng() % 7) {
+		const size_t size = 1 + rng() % sizeof(chunk);
+		const size_t expected = offset < text.size() ? std::min(size, text.size() - offset) : 0;
+		memset(chunk, '~', sizeof(chunk));
+		ASSERT_EQ(ConfigUtils::toJSON(config, chunk, offset, size), expected) << "offset " << offset;
+		ASSERT_EQ(std::string(chunk, expected), text.substr(std::min(offset, text.size()), expected)) << "offset " << offset;
+		for (size_t i = expected; i < sizeof(chunk); i++)
+			ASSERT_EQ(chunk[i], '~') << "written past the window at offset " << offset;
+	}
+}
+
+// Bytes fields are encoded in place, numbers printed with snprintf (UENUM fields unsigned), the text has to be what
+// Base64::Encode and std::to_string gave before
+TEST_F(ConfigUtilsTest, ValuesAreEncodedAsBefore)
+{
+	std::mt19937 rng(4);
+	for (int run = 0; run < 50; run++) {
+		config = Config_init_zero;
+		randomMessage(rng, Config_fields, &config);
+		config.boardVersion[0] = '\0';
+		config.gamepadOptions.profileNumber = UINT32_MAX;
+		config.gamepadOptions.dpadMode = static_cast<DpadMode>(-1 - int(rng() % 1000));
+		const std::string text = ConfigUtils::toJSON(config);
+
+		const DisplayOptions_splashImage_t& splash = config.displayOptions.splashImage;
+		EXPECT_EQ(quotedValue(text, "splashImage"), Base64::Encode(reinterpret_cast<const char *>(splash.bytes), splash.size));
+		EXPECT_EQ(quotedValue(text, "boardVersion"), "");
+		EXPECT_NE(text.find("\"profileNumber\": " + std::to_string(UINT32_MAX) + "\n"), std::string::npos);
+		EXPECT_NE(text.find("\"dpadMode\": " + std::to_string(uint32_t(config.gamepadOptions.dpadMode)) + ",\n"), std::string::npos);
+	}
+}
+
+// The point of the chunked path: a response costs the chunk buffer lwIP already has and nothing more
+TEST_F(ConfigUtilsTest, StreamingDoesNotAllocate)
+{
+	std::mt19937 rng(5);
+	randomMessage(rng, Config_fields, &config);
+
+	HostHeap::reset();
+	const std::string text = ConfigUtils::toJSON(config);
+	const size_t stringPeak = HostHeap::peak();
+	const size_t stringAllocations = HostHeap::allocations();
+	EXPECT_GE(stringPeak, text.size());
+
+	static char chunk[1460];
+	HostHeap::reset();
+	const size_t length = ConfigUtils::jsonLength(config);
+	for (size_t offset = 0; offset < length; offset += sizeof(chunk))
+		ConfigUtils::toJSON(config, chunk, offset, sizeof(chunk));
+	EXPECT_EQ(HostHeap::allocations(), 0u);
+	EXPECT_EQ(HostHeap::peak(), 0u);
+
+	RecordProperty("json_bytes", std::to_string(length));
+	RecordProperty("string_peak_heap", std::to_string(stringPeak));
+	RecordProperty("string_allocations", std::to_string(stringAllocations));
+}
@@ -0,0 +1,136 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * CRC32 with the slice-by-8 tables and with the DMA sniffer backend against the nibble table
+ * implementation in support/reference_crc32.cpp, over config-sized buffers at every alignment and
+ * fed in random pieces.
+ */
+
+#include "CRC32.h"
+#include "hardware/dma.h"
+
+#include "crc32_sniffer.h"
+#include "host_sdk.h"
+#include "reference_crc32.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Random piece sizes adding up to size, mostly short with a long one now and then
+	std::vector<uint32_t> randomPieces(std::mt19937& rng, uint32_t size)
+	{
+		std::vector<uint32_t> pieces;
+		while (size) {
+			const uint32_t piece = std::min<uint32_t>(size, (rng() % 4) ? rng() % 16 : rng() % 4096);
+			pieces.push_back(piece);
+			size -= piece;
+		}
+		return pieces;
+	}
+
+	class CRC32Test : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			std::mt19937 rng(1);
+			buffer.resize(8192 + 8);
+			for (uint8_t& byte : buffer)
+				byte = rng() & 0xff;
+		}
+
+		std::vector<uint8_t> buffer;
+	};
+}
+
+TEST_F(CRC32Test, CheckValue)
+{
+	const char *check = "123456789";
+	EXPECT_EQ(CRC32::calculate(check, 9), 0xcbf43926u);
+	EXPECT_EQ(CRC32Sniffer::calculate(reinterpret_cast<const uint8_t *>(check), { 9 }), 0xcbf43926u);
+	EXPECT_EQ(CRC32().finalize(), 0u);
+}
+
+// The stub sniffer set up the way the datasheet gets a standard CRC-32 out of it, independent of lib/CRC32
+TEST_F(CRC32Test, SnifferModelGivesTheCheckValue)
+{
+	const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+	uint8_t sink;
+	const int channel = dma_claim_unused_channel(true);
+	dma_channel_config config = dma_channel_get_default_config(channel);
+	channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+	channel_config_set_write_increment(&config, false);
+	dma_hw->sniff_data = 0xffffffff;
+	dma_sniffer_enable(channel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+	hw_set_bits(&dma_hw->sniff_ctrl, DMA_SNIFF_CTRL_OUT_REV_BITS | DMA_SNIFF_CTRL_OUT_INV_BITS);
+	channel_config_set_sniff_enable(&config, true);
+	dma_channel_configure(channel, &config, &sink, check, sizeof(check), true);
+	dma_channel_wait_for_finish_blocking(channel);
+	EXPECT_EQ(dma_hw->sniff_data, 0xcbf43926u);
+	dma_sniffer_disable();
+	dma_channel_unclaim(channel);
+}
+
+TEST_F(CRC32Test, TablesMatchReference)
+{
+	std::mt19937 rng(2);
+	for (int run = 0; run < 20000; run++) {
+		const uint32_t offset = rng() % 8;
+		const uint32_t size = (run % 4) ? rng() % 300 : rng() % 8193;
+		const uint8_t *data = buffer.data() + offset;
+		const uint32_t expected = Reference::crc32(data, size);
+
+		// In pieces, some of them a byte at a time
+		CRC32 crc;
+		const uint8_t *next = data;
+		for (uint32_t piece : randomPieces(rng, size)) {
+			if (piece == 1)
+				crc.update(*next);
+			else
+				crc.update(next, piece);
+			next += piece;
+		}
+		ASSERT_EQ(crc.finalize(), expected) << "offset " << offset << " size " << size;
+	}
+}
+
+TEST_F(CRC32Test, SnifferMatchesReference)
+{
+	std::mt19937 rng(3);
+	uint32_t sniffed = 0;
+	for (int run = 0; run < 2000; run++) {
+		const uint32_t offset = rng() % 8;
+		const uint32_t size = rng() % 8193;
+		const uint8_t *data = buffer.data() + offset;
+		const std::vector<uint32_t> pieces = randomPieces(rng, size);
+		uint32_t longPieces = 0;
+		for (uint32_t piece : pieces)
+			longPieces += piece >= CRC32_DMA_MIN_LENGTH;
+
+		// Short pieces stay on the tables, every other one is a DMA run
+		const uint32_t runs = HostSDK::counters().dmaRuns;
+		ASSERT_EQ(CRC32Sniffer::calculate(data, pieces), Reference::crc32(data, size)) << "offset " << offset << " size " << size;
+		ASSERT_EQ(HostSDK::counters().dmaRuns - runs, longPieces);
+		sniffed += longPieces;
+	}
+	EXPECT_GT(sniffed, 500u);
+}
+
+// The sniffer is a single block, core1 never touches it
+TEST_F(CRC32Test, SnifferOnlyRunsOnCore0)
+{
+	const std::vector<uint32_t> pieces = { 4096 };
+	HostSDK::setCore(1);
+	EXPECT_EQ(CRC32Sniffer::calculate(buffer.data(), pieces), Reference::crc32(buffer.data(), 4096));
+	EXPECT_EQ(HostSDK::counters().dmaRuns, 0u);
+
+	HostSDK::setCore(0);
+	EXPECT_EQ(CRC32Sniffer::calculate(buffer.data(), pieces), Reference::crc32(buffer.data(), 4096));
+	EXPECT_EQ(HostSDK::counters().dmaRuns, 1u);
+}
@@ -0,0 +1,192 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * GamepadDebouncer against a per-bit model of the three debounce modes. The firmware debounces
+ * all 20 bits at once with masks, the model steps every bit on its own the way the modes are
+ * described in GamepadDebouncer.h.
+ */
+
+#include "gamepad/GamepadDebouncer.h"
+
+#include "host_sdk.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+	struct BitModel
+	{
+		bool reported = false;
+		bool locked = false;
+		bool pending = false;
+		uint32_t since = 0;
+	};
+
+	class DebounceModel
+	{
+	public:
+		DebounceModel(uint32_t windowUs, DebounceMode mode) : windowUs(windowUs), mode(mode) {}
+
+		uint32_t step(uint32_t raw, uint32_t now)
+		{
+			uint32_t result = 0;
+			for (uint32_t bit = 0; bit < DEBOUNCE_BIT_COUNT; bit++) {
+				BitModel& b = bits[bit];
+				const bool input = (raw >> bit) & 1;
+
+				if (b.locked && (now - b.since) >= windowUs)
+					b.locked = false;
+
+				if (!b.locked && input != b.reported) {
+					const bool eager = mode == DEBOUNCE_MODE_EAGER || (mode == DEBOUNCE_MODE_ASYMMETRIC && input);
+					if (eager) {
+						b.reported = input;
+						b.locked = true;
+						b.pending = false;
+						b.since = now;
+					} else if (!b.pending) {
+						b.pending = true;
+						b.since = now;
+					}
+				} else {
+					b.pending = false;
+				}
+
+				if (b.pending && (now - b.since) >= windowUs) {
+					b.reported = !b.reported;
+					b.pending = false;
+				}
+
+				result |= static_cast<uint32_t>(b.reported) << bit;
+			}
+			return result;
+		}
+
+	private:
+		const uint32_t windowUs;
+		const DebounceMode mode;
+		BitModel bits[DEBOUNCE_BIT_COUNT];
+	};
+
+	// Bits flip now and then, and each flip bounces for a while before it settles
+	uint32_t bouncyInput(std::mt19937& rng, uint32_t settled[DEBOUNCE_BIT_COUNT], uint32_t bounceLeft[DEBOUNCE_BIT_COUNT])
+	{
+		uint32_t raw = 0;
+		for (uint32_t bit = 0; bit < DEBOUNCE_BIT_COUNT; bit++) {
+			if (bounceLeft[bit] == 0 && rng() % 200 == 0) {
+				settled[bit] ^= 1;
+				bounceLeft[bit] = rng() % 40;
+			}
+			uint32_t level = settled[bit];
+			if (bounceLeft[bit] > 0) {
+				bounceLeft[bit]--;
+				if (rng() % 3 == 0)
+					level ^= 1;
+			}
+			raw |= level << bit;
+		}
+		return raw;
+	}
+
+	void expectMatchesModel(DebounceMode mode, uint8_t debounceMS, uint32_t start, uint32_t seed)
+	{
+		GamepadDebouncer debouncer(debounceMS, mode);
+		DebounceModel model(debounceMS * 1000, mode);
+		std::mt19937 rng(seed);
+		uint32_t settled[DEBOUNCE_BIT_COUNT] = {};
+		uint32_t bounceLeft[DEBOUNCE_BIT_COUNT] = {};
+
+		uint32_t now = start;
+		for (int frame = 0; frame < 200000; frame++) {
+			now += 50 + rng() % 200; // uneven poll spacing, like a loop that sometimes runs long
+			const uint32_t raw = bouncyInput(rng, settled, bounceLeft);
+			const uint32_t expected = model.step(raw, now);
+			ASSERT_EQ(debouncer.debounceBits(raw, now), expected) << "frame " << frame << " raw 0x" << std::hex << raw;
+		}
+	}
+}
+
+TEST(Debouncer, EagerMatchesPerBitModel)
+{
+	expectMatchesModel(DEBOUNCE_MODE_EAGER, 5, 0, 1);
+}
+
+TEST(Debouncer, DeferMatchesPerBitModel)
+{
+	expectMatchesModel(DEBOUNCE_MODE_DEFER, 5, 0, 2);
+}
+
+TEST(Debouncer, AsymmetricMatchesPerBitModel)
+{
+	expectMatchesModel(DEBOUNCE_MODE_ASYMMETRIC, 5, 0, 3);
+}
+
+TEST(Debouncer, ZeroWindowPassesInputThrough)
+{
+	expectMatchesModel(DEBOUNCE_MODE_EAGER, 0, 0, 4);
+	expectMatchesModel(DEBOUNCE_MODE_DEFER, 0, 0, 5);
+}
+
+// The 32 bit microsecond clock wraps every 71 minutes
+TEST(Debouncer, SurvivesClockWrap)
+{
+	expectMatchesModel(DEBOUNCE_MODE_EAGER, 5, UINT32_MAX - 1000000, 6);
+	expectMatchesModel(DEBOUNCE_MODE_DEFER, 5, UINT32_MAX - 1000000, 7);
+}
+
+TEST(Debouncer, EagerReportsAtOnceAndIgnoresBounce)
+{
+	GamepadDebouncer debouncer(5, DEBOUNCE_MODE_EAGER);
+	EXPECT_EQ(debouncer.debounceBits(0x1, 1000), 0x1u);
+	EXPECT_EQ(debouncer.debounceBits(0x0, 2000), 0x1u); // bounce inside the window
+	EXPECT_EQ(debouncer.debounceBits(0x1, 3000), 0x1u);
+	EXPECT_EQ(debouncer.debounceBits(0x0, 5999), 0x1u);
+	EXPECT_EQ(debouncer.debounceBits(0x0, 6000), 0x0u); // window is over
+}
+
+TEST(Debouncer, DeferWaitsForStableInput)
+{
+	GamepadDebouncer debouncer(5, DEBOUNCE_MODE_DEFER);
+	EXPECT_EQ(debouncer.debounceBits(0x2, 1000), 0x0u);
+	EXPECT_EQ(debouncer.debounceBits(0x0, 3000), 0x0u); // bounced back, timer restarts
+	EXPECT_EQ(debouncer.debounceBits(0x2, 4000), 0x0u);
+	EXPECT_EQ(debouncer.debounceBits(0x2, 8999), 0x0u);
+	EXPECT_EQ(debouncer.debounceBits(0x2, 9000), 0x2u);
+}
+
+TEST(Debouncer, AsymmetricIsEagerOnPressOnly)
+{
+	GamepadDebouncer debouncer(5, DEBOUNCE_MODE_ASYMMETRIC);
+	EXPECT_EQ(debouncer.debounceBits(0x4, 1000), 0x4u);
+	EXPECT_EQ(debouncer.debounceBits(0x0, 7000), 0x4u); // release has to settle
+	EXPECT_EQ(debouncer.debounceBits(0x0, 11999), 0x4u);
+	EXPECT_EQ(debouncer.debounceBits(0x0, 12000), 0x0u);
+}
+
+TEST(Debouncer, PacksDpadAboveButtons)
+{
+	HostSDK::reset();
+	GamepadDebouncer debouncer(5, DEBOUNCE_MODE_EAGER);
+	GamepadState state;
+	state.buttons = GAMEPAD_MASK_B1 | GAMEPAD_MASK_R3;
+	state.dpad = GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT;
+	debouncer.debounce(&state);
+	EXPECT_EQ(state.buttons, GAMEPAD_MASK_B1 | GAMEPAD_MASK_R3);
+	EXPECT_EQ(state.dpad, GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT);
+
+	HostSDK::advanceTime(1000);
+	state.buttons = 0;
+	state.dpad = 0;
+	debouncer.debounce(&state);
+	EXPECT_EQ(state.buttons, GAMEPAD_MASK_B1 | GAMEPAD_MASK_R3);
+	EXPECT_EQ(state.dpad, GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT);
+
+	HostSDK::advanceTime(4000);
+	state.buttons = 0; // debounce() hands back the reported state
+	state.dpad = 0;
+	debouncer.debounce(&state);
+	EXPECT_EQ(state.buttons, 0);
+	EXPECT_EQ(state.dpad, 0);
+}
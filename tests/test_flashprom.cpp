@@ -0,0 +1,254 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The FlashPROM journal on the simulated flash: whatever was committed has to come back after a
+ * reboot, a power loss at any point of a commit must leave either the old or the new image, and a
+ * small change must cost a few page programs rather than erasing the whole image.
+ */
+
+#include "FlashPROM.h"
+
+#include "host_sdk.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	typedef std::vector<uint8_t> Image;
+
+	// Roughly what a serialized Config looks like: a few KB of data, zeros after it
+	void randomImage(std::mt19937& rng, uint8_t *image, size_t used)
+	{
+		memset(image, 0, EEPROM_SIZE_BYTES);
+		for (size_t i = 0; i < used; i++)
+			image[i] = rng() & 0xff;
+	}
+
+	// What a hotkey or a web config save does between two commits
+	void randomChange(std::mt19937& rng, uint8_t *image)
+	{
+		switch (rng() % 6) {
+			case 0:
+				randomImage(rng, image, rng() % EEPROM_SIZE_BYTES);
+				break;
+			case 1:
+				memset(image, 0, EEPROM_SIZE_BYTES);
+				break;
+			default: {
+				const int bytes = 1 + rng() % 8;
+				for (int i = 0; i < bytes; i++)
+					image[rng() % 2048] = rng() & 0xff;
+				break;
+			}
+		}
+	}
+
+	class FlashPROMTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			EEPROM.start();
+		}
+
+		Image cache() const { return Image(FlashPROM::writeCache, FlashPROM::writeCache + EEPROM_SIZE_BYTES); }
+
+		void commitNow()
+		{
+			EEPROM.commit();
+			EEPROM.flush();
+		}
+
+		// Comes back up with nothing but the flash, the way a reset does
+		Image reboot()
+		{
+			HostSDK::powerCycle();
+			memset(FlashPROM::writeCache, 0xA5, EEPROM_SIZE_BYTES);
+			EEPROM.start();
+			return cache();
+		}
+
+		// The image older firmware wrote, where it wrote it
+		uint8_t *legacyImage() { return HostSDK::flash() + (EEPROM_ADDRESS_START - XIP_BASE); }
+	};
+}
+
+TEST_F(FlashPROMTest, BlankFlashReadsAsErased)
+{
+	EXPECT_EQ(cache(), Image(EEPROM_SIZE_BYTES, 0xFF));
+	commitNow();
+	EXPECT_EQ(reboot(), Image(EEPROM_SIZE_BYTES, 0xFF));
+}
+
+TEST_F(FlashPROMTest, EveryCommitComesBackAfterReboot)
+{
+	std::mt19937 rng(1);
+	for (int save = 0; save < 500; save++) {
+		randomChange(rng, FlashPROM::writeCache);
+		const Image saved = cache();
+		commitNow();
+		ASSERT_EQ(reboot(), saved) << "save " << save;
+	}
+}
+
+TEST_F(FlashPROMTest, ChangeDuringACommitIsNotMixedIn)
+{
+	std::mt19937 rng(2);
+	randomImage(rng, FlashPROM::writeCache, 4000);
+	commitNow();
+	const Image first = cache();
+
+	randomImage(rng, FlashPROM::writeCache, 4000);
+	const Image second = cache();
+	EEPROM.commit();
+	HostSDK::advanceTime(EEPROM_WRITE_WAIT * 1000);
+	for (int step = 0; step < 5; step++)
+		ASSERT_TRUE(EEPROM.process());
+
+	// A hotkey toggles something in a block already written and in one still to come
+	FlashPROM::writeCache[10] ^= 0xff;
+	FlashPROM::writeCache[3000] ^= 0xff;
+	EEPROM.commit();
+	const Image latest = cache();
+
+	// Power is lost before the new change is due, whatever got committed has to be one of the images
+	while (EEPROM.process())
+		;
+	const Image recovered = reboot();
+	EXPECT_TRUE(recovered == first || recovered == second) << "mixed image committed";
+
+	memcpy(FlashPROM::writeCache, latest.data(), latest.size());
+	commitNow();
+	EXPECT_EQ(reboot(), latest);
+}
+
+TEST_F(FlashPROMTest, CommitWaitsForChangesToSettle)
+{
+	FlashPROM::writeCache[0] = 1;
+	EEPROM.commit();
+	for (int ms = 0; ms < EEPROM_WRITE_WAIT; ms += 10) {
+		HostSDK::advanceTime(10000 - 1);
+		EXPECT_FALSE(EEPROM.process());
+		FlashPROM::writeCache[0]++;
+		EEPROM.commit(); // every change pushes the commit back
+	}
+	EXPECT_EQ(HostSDK::counters().flashPrograms, 0u);
+	HostSDK::advanceTime(EEPROM_WRITE_WAIT * 1000);
+	EXPECT_TRUE(EEPROM.process());
+}
+
+// The gamepad loop calls process() between frames, core1 must never be held for more than one operation
+TEST_F(FlashPROMTest, EveryStepIsASingleFlashOperation)
+{
+	std::mt19937 rng(3);
+	for (int save = 0; save < 200; save++) {
+		randomChange(rng, FlashPROM::writeCache);
+		EEPROM.commit();
+		HostSDK::advanceTime(EEPROM_WRITE_WAIT * 1000);
+		for (;;) {
+			const HostSDK::Counters before = HostSDK::counters();
+			const bool stepped = EEPROM.process();
+			const HostSDK::Counters& after = HostSDK::counters();
+			const uint32_t operations = (after.flashErases - before.flashErases) + (after.flashPrograms - before.flashPrograms);
+			ASSERT_LE(operations, 1u) << "save " << save;
+			ASSERT_EQ(after.lockouts - before.lockouts, operations) << "save " << save;
+			if (!stepped)
+				break;
+		}
+	}
+}
+
+TEST_F(FlashPROMTest, SmallChangeIsAFewPagePrograms)
+{
+	std::mt19937 rng(4);
+	randomImage(rng, FlashPROM::writeCache, 1500);
+	commitNow();
+
+	const HostSDK::Counters start = HostSDK::counters();
+	const int saves = 1000;
+	for (int save = 0; save < saves; save++) {
+		FlashPROM::writeCache[rng() % 1500] ^= 1 << (rng() % 8); // a hotkey flipping one option
+		commitNow();
+	}
+	const uint32_t erases = HostSDK::counters().flashErases - start.flashErases;
+	const uint32_t programs = HostSDK::counters().flashPrograms - start.flashPrograms;
+
+	// Rewriting the image erased two sectors and programmed 32 pages for every save
+	EXPECT_LT(erases, saves / 4u);
+	EXPECT_LT(programs, saves * 4u);
+	RecordProperty("erases_per_save", std::to_string(double(erases) / saves));
+	RecordProperty("programs_per_save", std::to_string(double(programs) / saves));
+}
+
+TEST_F(FlashPROMTest, OlderFirmwareImageIsTakenOver)
+{
+	std::mt19937 rng(5);
+	Image legacy(EEPROM_SIZE_BYTES);
+	randomImage(rng, legacy.data(), 3000);
+	memcpy(legacyImage(), legacy.data(), legacy.size());
+	EXPECT_EQ(reboot(), legacy);
+
+	// The first commit goes around the old image, so losing power during it still finds that
+	FlashPROM::writeCache[10] ^= 0xff;
+	HostSDK::cutFlashPower(5, 100);
+	EEPROM.commit();
+	EXPECT_THROW(EEPROM.flush(), HostSDK::PowerLoss);
+	EXPECT_EQ(reboot(), legacy);
+
+	FlashPROM::writeCache[10] ^= 0xff;
+	FlashPROM::writeCache[20] ^= 0xff;
+	const Image changed = cache();
+	commitNow();
+	EXPECT_EQ(reboot(), changed);
+}
+
+// Power lost at a random operation of a commit, part of the way through it. After the reboot the image
+// is the one from before the commit or, if the commit record made it, the new one, and saving still works.
+TEST_F(FlashPROMTest, PowerLossKeepsTheOldOrTheNewImage)
+{
+	std::mt19937 rng(6);
+	Image committed = cache();
+	uint32_t cuts = 0;
+	uint32_t newImages = 0;
+	for (int save = 0; save < 3000; save++) {
+		randomChange(rng, FlashPROM::writeCache);
+		const Image attempted = cache();
+		if (rng() % 3 != 0) {
+			commitNow();
+			committed = attempted;
+			continue;
+		}
+
+		const size_t bytes = (rng() & 1) ? rng() % FLASH_PAGE_SIZE : rng() % FLASH_SECTOR_SIZE;
+		HostSDK::cutFlashPower((rng() & 1) ? rng() % 3 : rng() % 40, bytes); // most commits are a few pages
+		EEPROM.commit();
+		bool lost = false;
+		try {
+			EEPROM.flush();
+		} catch (const HostSDK::PowerLoss&) {
+			lost = true;
+		}
+		if (!lost) {
+			committed = attempted; // the commit was done before the cut came due
+			ASSERT_EQ(reboot(), committed) << "save " << save;
+			continue;
+		}
+
+		cuts++;
+		const Image recovered = reboot();
+		if (recovered == attempted) {
+			newImages++;
+		} else {
+			ASSERT_EQ(recovered, committed) << "save " << save;
+		}
+		committed = recovered;
+	}
+	EXPECT_GT(cuts, 400u);
+	EXPECT_GT(newImages, 0u);
+	EXPECT_LT(newImages, cuts);
+}
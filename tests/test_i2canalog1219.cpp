@@ -0,0 +1,351 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The ADS1219 driven from its DRDY interrupt, against the chip model in support/mock_ads1219.cpp on
+ * the stub I2C FIFOs: every result has to land in the slot of the channel it was converted on, also
+ * when transfers are NACKed or a DRDY edge is lost, at the rate the bus allows, and the addon's
+ * process() must not wait on the bus for it.
+ */
+
+#include "addons/i2canalog1219.h"
+#include "storagemanager.h"
+
+#include "host_sdk.h"
+#include "host_storage.h"
+#include "mock_ads1219.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+
+#define ADS_ADDRESS 0x40
+#define ADS_SPEED 400000
+#define ADS_SDA_PIN 0
+#define ADS_SCL_PIN 1
+#define DRDY_PIN 2
+#define LOOP_US 250         // main loop pace, well under a conversion
+#define CONVERSION_US 1000  // 1000 SPS
+#define HOP_BYTES 9         // RDATA, the three byte read and the WREG, each frame with its address byte
+
+namespace
+{
+	// A channel's codes stay in a range of their own, and move with time so a stale one shows
+	int32_t signal(uint channel, uint64_t us) { return (channel + 1) * 1000000 + us % 1000000; }
+
+	class I2CAnalog1219Test : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			HostStorage::resetConfig();
+			Storage::getInstance().SetGamepad(&gamepad);
+			HostSDK::attachI2CDevice(0, ADS_ADDRESS, &chip);
+		}
+
+		// A fresh board and chip, for tests that run twice
+		void restart()
+		{
+			SetUp();
+			chip = MockADS1219(DRDY_PIN, signal);
+		}
+
+		// The setup I2CAnalog1219Input does, then the interrupt mode
+		void begin(int32_t speed = ADS_SPEED)
+		{
+			ads.reset(new ADS1219(1, ADS_SDA_PIN, ADS_SCL_PIN, i2c0, speed, ADS_ADDRESS));
+			ads->begin();
+			ads->setChannel(0);
+			ads->setConversionMode(CONTINUOUS);
+			ads->setGain(ONE);
+			ads->setDataRate(1000);
+			ads->setVoltageReference(REF_INTERNAL);
+			ads->start();
+			ASSERT_TRUE(ads->beginInterrupt(DRDY_PIN, 0x0F));
+		}
+
+		// The main loop every LOOP_US for us, the chip converting alongside
+		void run(uint64_t us, std::function<void()> loop)
+		{
+			const uint64_t end = HostSDK::now() + us;
+			uint64_t nextLoop = HostSDK::now();
+			while (HostSDK::now() < end) {
+				HostSDK::advanceTo(std::min({ chip.nextConversion(), nextLoop, end }));
+				chip.update();
+				if (HostSDK::now() >= nextLoop) {
+					loop();
+					nextLoop += LOOP_US;
+				}
+			}
+		}
+
+		void runServiced(uint64_t us)
+		{
+			run(us, [this]() {
+				ads->serviceInterrupt();
+				expectFiledRight();
+			});
+		}
+
+		// The next conversion finishes with the GPIO interrupt off, returns when the last edge handled fell
+		uint64_t loseEdge()
+		{
+			const uint64_t handled = chip.conversions.back().us;
+			irq_set_enabled(IO_IRQ_BANK0, false);
+			HostSDK::advanceTo(chip.nextConversion());
+			chip.update();
+			irq_set_enabled(IO_IRQ_BANK0, true);
+			return handled;
+		}
+
+		// Each stored result has to be a conversion on its own channel, no older than the last one when it was
+		// stored. RDATA loads the latest result, so on a slow bus it can be newer than the edge it is stamped with
+		void expectFiledRight()
+		{
+			for (uint i = 0; i < 4; i++) {
+				const uint32_t stored = ads->channelTimes[i];
+				if (stored == 0)
+					continue;
+				const int32_t value = ads->channelResults[i];
+				auto found = std::find_if(chip.conversions.rbegin(), chip.conversions.rend(),
+					[value](const MockADS1219::Conversion &c) { return c.value == value; });
+				ASSERT_NE(found, chip.conversions.rend()) << "channel " << i << " holds " << value << ", never converted";
+				ASSERT_EQ(found->channel, i) << "result filed under the wrong channel";
+				EXPECT_GT(static_cast<int64_t>(found->us) + CONVERSION_US, static_cast<int64_t>(stored)) << "channel " << i << " stored a stale result";
+			}
+		}
+
+		// Results stored per channel from here on
+		struct UpdateCounter
+		{
+			uint32_t last[4] = {};
+			uint32_t updates[4] = {};
+
+			void sample(const ADS1219 &ads)
+			{
+				for (uint i = 0; i < 4; i++) {
+					if (ads.channelTimes[i] != last[i]) {
+						last[i] = ads.channelTimes[i];
+						updates[i]++;
+					}
+				}
+			}
+		};
+
+		void runCounted(uint64_t us, UpdateCounter &counter)
+		{
+			counter.sample(*ads);
+			std::fill(counter.updates, counter.updates + 4, 0);
+			run(us, [&]() {
+				ads->serviceInterrupt();
+				expectFiledRight();
+				counter.sample(*ads);
+			});
+		}
+
+		Gamepad gamepad;
+		MockADS1219 chip { DRDY_PIN, signal };
+		std::unique_ptr<ADS1219> ads;
+	};
+}
+
+TEST_F(I2CAnalog1219Test, EveryChannelAtTheRateTheBusAllows)
+{
+	begin();
+	UpdateCounter counter;
+	runCounted(1000000, counter);
+
+	// Each hop waits out a conversion that the WREG at the end of the previous hop restarted
+	const double hopUs = CONVERSION_US + HOP_BYTES * 9 * 1e6 / ADS_SPEED;
+	for (uint i = 0; i < 4; i++)
+		EXPECT_NEAR(counter.updates[i], 1e6 / (4 * hopUs), 2) << "channel " << i;
+	EXPECT_EQ(ads->interruptErrors, 0u);
+	EXPECT_GE(chip.dataReads + 1, chip.conversions.size()) << "every conversion read, but the one in flight";
+
+	// Stamped with the time DRDY fell, not when the bytes came in
+	for (uint i = 0; i < 4; i++) {
+		const uint32_t stored = ads->channelTimes[i];
+		EXPECT_TRUE(std::any_of(chip.conversions.begin(), chip.conversions.end(),
+			[stored](const MockADS1219::Conversion &c) { return static_cast<uint32_t>(c.us) == stored; })) << "channel " << i;
+	}
+	RecordProperty("updates_per_channel", std::to_string(counter.updates[0]));
+}
+
+TEST_F(I2CAnalog1219Test, SkipsChannelsOutsideTheMask)
+{
+	ads.reset(new ADS1219(1, ADS_SDA_PIN, ADS_SCL_PIN, i2c0, ADS_SPEED, ADS_ADDRESS));
+	ads->begin();
+	ads->setConversionMode(CONTINUOUS);
+	ads->setDataRate(1000);
+	ads->start();
+	ASSERT_TRUE(ads->beginInterrupt(DRDY_PIN, 0x0A));
+
+	UpdateCounter counter;
+	runCounted(100000, counter);
+	EXPECT_EQ(counter.updates[0], 0u);
+	EXPECT_EQ(counter.updates[2], 0u);
+	EXPECT_GT(counter.updates[1], 35u);
+	EXPECT_GT(counter.updates[3], 35u);
+	for (const MockADS1219::Conversion &c : chip.conversions)
+		EXPECT_TRUE(c.channel == 1 || c.channel == 3) << "converted channel " << int(c.channel);
+}
+
+// A NACK aborts the rest of the hop, the next DRDY writes the mux again before reading anything
+TEST_F(I2CAnalog1219Test, NackedTransfersAreNeverMisfiled)
+{
+	for (uint32_t every : { 37u, 7u }) {
+		SCOPED_TRACE(every);
+		ads.reset();
+		restart();
+		begin();
+		chip.nackEvery = every;
+
+		UpdateCounter counter;
+		runCounted(500000, counter);
+		EXPECT_GT(ads->interruptErrors, 0u);
+		for (uint i = 0; i < 4; i++) {
+			EXPECT_GT(counter.updates[i], 25u) << "channel " << i;
+			EXPECT_LT(HostSDK::now() - ads->channelTimes[i], 50000u) << "channel " << i << " stopped updating";
+		}
+	}
+}
+
+// On a slow bus the chip finishes conversions on the old channel while a hop is still going out, their edges are dropped
+TEST_F(I2CAnalog1219Test, EdgesDuringAHopAreDropped)
+{
+	begin(20000);
+	UpdateCounter counter;
+	runCounted(200000, counter);
+	EXPECT_GT(ads->interruptErrors, 0u);
+	EXPECT_LT(chip.dataReads, chip.conversions.size() / 2);
+	for (uint i = 0; i < 4; i++)
+		EXPECT_GT(counter.updates[i], 3u) << "channel " << i;
+}
+
+// Without the pulse on an unread result a lost edge leaves DRDY low for good, until serviceInterrupt() notices
+TEST_F(I2CAnalog1219Test, LostEdgeIsRecoveredByTheService)
+{
+	chip.pulseUnread = false;
+	begin();
+	runServiced(20000);
+	loseEdge();
+
+	const uint32_t reads = chip.dataReads;
+	run(20000, []() {});
+	EXPECT_EQ(chip.dataReads, reads) << "nothing reads without an edge";
+	EXPECT_GT(chip.conversions.size(), reads + 10) << "the chip kept converting";
+
+	ads->serviceInterrupt();
+	HostSDK::advanceTime(LOOP_US);
+	EXPECT_EQ(chip.dataReads, reads + 1);
+	expectFiledRight();
+
+	UpdateCounter counter;
+	runCounted(100000, counter);
+	for (uint i = 0; i < 4; i++)
+		EXPECT_GT(counter.updates[i], 15u) << "channel " << i;
+}
+
+// A late edge is not a lost one, reading before the stall would race the handler
+TEST_F(I2CAnalog1219Test, ServiceWaitsOutTheStall)
+{
+	chip.pulseUnread = false;
+	begin();
+	runServiced(20000);
+	const uint64_t handled = loseEdge();
+	const uint32_t reads = chip.dataReads;
+
+	run(handled + ADS1219_INTERRUPT_STALL_US - HostSDK::now(), [this]() { ads->serviceInterrupt(); });
+	EXPECT_EQ(chip.dataReads, reads);
+	run(2 * LOOP_US, [this]() { ads->serviceInterrupt(); });
+	EXPECT_EQ(chip.dataReads, reads + 1);
+}
+
+TEST_F(I2CAnalog1219Test, OneDeviceOwnsTheInterrupts)
+{
+	begin();
+	ADS1219 other(1, ADS_SDA_PIN, ADS_SCL_PIN, i2c0, ADS_SPEED, ADS_ADDRESS);
+	EXPECT_FALSE(other.beginInterrupt(DRDY_PIN, 0x0F));
+	EXPECT_FALSE(ads->beginInterrupt(DRDY_PIN, 0x0F));
+
+	ads->endInterrupt();
+	EXPECT_EQ(i2c0->hw->intr_mask, 0u);
+	run(10000, [this]() { ads->serviceInterrupt(); });
+	EXPECT_GT(chip.conversions.size(), 5u);
+	EXPECT_EQ(chip.dataReads, 0u) << "handlers still attached";
+}
+
+namespace
+{
+	class I2CAnalog1219AddonTest : public I2CAnalog1219Test
+	{
+	protected:
+		std::unique_ptr<I2CAnalog1219Input> startAddon(int drdyPin)
+		{
+			AnalogADS1219Options& options = Storage::getInstance().getAddonOptions().analogADS1219Options;
+			options.enabled = true;
+			options.i2cBlock = 0;
+			options.i2cSDAPin = ADS_SDA_PIN;
+			options.i2cSCLPin = ADS_SCL_PIN;
+			options.i2cAddress = ADS_ADDRESS;
+			options.i2cSpeed = ADS_SPEED;
+			options.drdyPin = drdyPin;
+
+			std::unique_ptr<I2CAnalog1219Input> addon(new I2CAnalog1219Input());
+			EXPECT_TRUE(addon->available());
+			addon->setup();
+			return addon;
+		}
+
+		// Virtual time and chip frames each process() call took
+		struct Cost
+		{
+			uint64_t us = 0;
+			uint32_t frames = 0;
+			uint32_t calls = 0;
+		};
+
+		void runAddon(I2CAnalog1219Input &addon, uint64_t us, Cost &cost)
+		{
+			run(us, [&]() {
+				const uint64_t start = HostSDK::now();
+				const uint32_t frames = chip.frames;
+				addon.process();
+				cost.us += HostSDK::now() - start;
+				cost.frames += chip.frames - frames;
+				cost.calls++;
+			});
+		}
+	};
+}
+
+TEST_F(I2CAnalog1219AddonTest, ProcessDoesNotWaitOnTheBus)
+{
+	std::unique_ptr<I2CAnalog1219Input> addon = startAddon(DRDY_PIN);
+	Cost cost;
+	runAddon(*addon, 200000, cost);
+	EXPECT_EQ(cost.us, 0u);
+	EXPECT_EQ(cost.frames, 0u);
+	EXPECT_GT(chip.dataReads, 150u);
+
+	// The axes show the latest result of each channel, a round of hops behind the signal at most
+	const uint16_t axes[] = { gamepad.state.lx, gamepad.state.ly, gamepad.state.rx, gamepad.state.ry };
+	for (uint i = 0; i < 4; i++) {
+		const float full = (1 << 23) - 1;
+		EXPECT_NEAR(axes[i], 65535.f * signal(i, HostSDK::now()) / full, 65535.f * 6000 / full) << "axis " << i;
+	}
+
+	// What the polling path costs the same loop
+	addon.reset();
+	restart();
+	addon = startAddon(-1);
+	Cost polled;
+	runAddon(*addon, 200000, polled);
+	EXPECT_GT(polled.frames, 0u);
+	EXPECT_GT(polled.us, 0u);
+	RecordProperty("polled_blocking_us_per_call", std::to_string(polled.us / polled.calls));
+	RecordProperty("polled_reads", std::to_string(chip.dataReads));
+}
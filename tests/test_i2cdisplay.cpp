@@ -0,0 +1,201 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * I2CDisplayAddon skipping unchanged frames and flushing only the difference, against a full
+ * redraw. After every frame the panel has to show what a freshly set up addon draws for the
+ * same gamepad state on a panel of its own.
+ */
+
+#include "addons/i2cdisplay.h"
+#include "storagemanager.h"
+
+#include "host_sdk.h"
+#include "host_storage.h"
+#include "mock_oled.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+
+#define DISPLAY_ADDRESS 0x3C
+#define REFERENCE_ADDRESS 0x3D
+#define FLUSH_TIME_US 20000 // enough for a whole frame at 800 kHz
+
+namespace
+{
+	typedef std::tuple<ButtonLayout, ButtonLayoutRight> Layout;
+
+	class I2CDisplayTest : public ::testing::TestWithParam<Layout>
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			HostStorage::resetConfig();
+			DisplayOptions& options = Storage::getInstance().getDisplayOptions();
+			options.enabled = true;
+			options.i2cBlock = 0;
+			options.i2cSDAPin = 0;
+			options.i2cSCLPin = 1;
+			options.i2cAddress = DISPLAY_ADDRESS;
+			options.i2cSpeed = 800000;
+			options.size = OLED_128x64;
+			options.buttonLayout = std::get<0>(GetParam());
+			options.buttonLayoutRight = std::get<1>(GetParam());
+			options.splashMode = SPLASH_MODE_NONE;
+			options.displaySaverTimeout = 0;
+
+			HostSDK::attachI2CDevice(0, DISPLAY_ADDRESS, &panel);
+			HostSDK::attachI2CDevice(0, REFERENCE_ADDRESS, &referencePanel);
+			gamepad.setup();
+			processed.setup();
+			Storage::getInstance().SetGamepad(&gamepad);
+			Storage::getInstance().SetProcessedGamepad(&processed);
+		}
+
+		// A new addon has nothing to skip, its first frame is a full redraw
+		std::vector<uint8_t> fullRedraw()
+		{
+			DisplayOptions& options = Storage::getInstance().getDisplayOptions();
+			options.i2cAddress = REFERENCE_ADDRESS;
+			std::unique_ptr<I2CDisplayAddon> reference(new I2CDisplayAddon());
+			reference->setup();
+			reference->process();
+			HostSDK::advanceTime(FLUSH_TIME_US);
+			reference->process(); // retires the flush, nothing changed so nothing is drawn
+			options.i2cAddress = DISPLAY_ADDRESS;
+			return referencePanel.shown(128, 64);
+		}
+
+		Gamepad gamepad;
+		Gamepad processed;
+		MockOled panel;
+		MockOled referencePanel;
+	};
+}
+
+TEST_P(I2CDisplayTest, EveryFrameMatchesAFullRedraw)
+{
+	I2CDisplayAddon display;
+	ASSERT_TRUE(display.available());
+	display.setup();
+
+	std::mt19937 rng(std::get<0>(GetParam()) * 16 + std::get<1>(GetParam()));
+	uint32_t changes = 0;
+	uint32_t flushes = 0;
+	for (int frame = 0; frame < 1500; frame++) {
+		// Held inputs most frames, presses and releases in between, and an option that shows in the status bar
+		switch (rng() % 6) {
+			case 0:
+				processed.state.buttons = rng() & 0x3fff;
+				changes++;
+				break;
+			case 1:
+				processed.state.dpad = rng() & GAMEPAD_MASK_DPAD;
+				changes++;
+				break;
+			case 2:
+				if (rng() % 8 == 0) {
+					GamepadOptions& options = Storage::getInstance().getGamepadOptions();
+					options.socdMode = static_cast<SOCDMode>((options.socdMode + 1) % 3);
+					changes++;
+				}
+				break;
+			default:
+				break;
+		}
+
+		const uint32_t writes = HostSDK::counters().i2cWrites;
+		display.process();
+		HostSDK::advanceTime(FLUSH_TIME_US);
+		if (HostSDK::counters().i2cWrites != writes)
+			flushes++;
+
+		ASSERT_EQ(panel.shown(128, 64), fullRedraw()) << "frame " << frame;
+	}
+	EXPECT_EQ(panel.error, "");
+	EXPECT_LE(flushes, changes + 1); // frames without a change never reach the bus
+}
+
+TEST_P(I2CDisplayTest, HeldInputsCostNothing)
+{
+	I2CDisplayAddon display;
+	display.setup();
+	processed.state.buttons = GAMEPAD_MASK_B1 | GAMEPAD_MASK_R2;
+	processed.state.dpad = GAMEPAD_MASK_LEFT;
+	display.process();
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	display.process();
+
+	const uint32_t writes = HostSDK::counters().i2cWrites;
+	for (int frame = 0; frame < 100; frame++) {
+		display.process();
+		HostSDK::advanceTime(1000);
+	}
+	EXPECT_EQ(HostSDK::counters().i2cWrites, writes);
+}
+
+TEST_P(I2CDisplayTest, OnePressSendsAFewBytes)
+{
+	I2CDisplayAddon display;
+	display.setup();
+	display.process();
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	display.process();
+
+	const uint32_t bytes = HostSDK::counters().i2cBytes;
+	processed.state.buttons = GAMEPAD_MASK_B1;
+	display.process();
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	const uint32_t sent = HostSDK::counters().i2cBytes - bytes;
+	EXPECT_GT(sent, 0u);
+	EXPECT_LT(sent, 200u) << "a whole frame is 1 KB";
+	EXPECT_EQ(panel.shown(128, 64), fullRedraw());
+}
+
+// A frame the panel NACKed leaves it out of step with the front buffer, the next one is sent whole
+TEST_P(I2CDisplayTest, NackedFlushIsResentWhole)
+{
+	I2CDisplayAddon display;
+	display.setup();
+	display.process();
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	display.process();
+
+	processed.state.buttons = GAMEPAD_MASK_B1;
+	panel.nack = true;
+	display.process();
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	panel.nack = false;
+
+	const uint32_t bytes = HostSDK::counters().i2cBytes;
+	display.process(); // retires the failed flush and starts over
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	EXPECT_GE(HostSDK::counters().i2cBytes - bytes, 1024u);
+	EXPECT_EQ(panel.shown(128, 64), fullRedraw());
+
+	// and it is back to the difference after that
+	display.process();
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	const uint32_t resent = HostSDK::counters().i2cBytes;
+	processed.state.buttons = 0;
+	display.process();
+	HostSDK::advanceTime(FLUSH_TIME_US);
+	display.process();
+	EXPECT_LT(HostSDK::counters().i2cBytes - resent, 200u);
+	EXPECT_EQ(panel.shown(128, 64), fullRedraw());
+}
+
+INSTANTIATE_TEST_SUITE_P(Layouts, I2CDisplayTest,
+	::testing::Values(
+		Layout(BUTTON_LAYOUT_STICK, BUTTON_LAYOUT_ARCADE),
+		Layout(BUTTON_LAYOUT_STICKLESS, BUTTON_LAYOUT_STICKLESSB),
+		Layout(BUTTON_LAYOUT_BUTTONS_ANGLED, BUTTON_LAYOUT_BUTTONS_ANGLEDB),
+		Layout(BUTTON_LAYOUT_KEYBOARD_ANGLED, BUTTON_LAYOUT_VEWLIX),
+		Layout(BUTTON_LAYOUT_DANCEPADA, BUTTON_LAYOUT_CAPCOM)),
+	[](const ::testing::TestParamInfo<Layout>& info) {
+		return "Left" + std::to_string(std::get<0>(info.param)) + "Right" + std::to_string(std::get<1>(info.param));
+	});
@@ -0,0 +1,324 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * NeoPico frames as they leave the pin, with the ws2812 program running on the stub PIO: every
+ * LEDFormat has to come out bit for bit with the WS2812 timing, Show() must hand the frame to DMA
+ * and return, and frames shown while one is going out are sent after it has latched.
+ */
+
+#include "NeoPico.hpp"
+
+#include "host_sdk.h"
+
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#define LED_PIN 15
+#define LED_COUNT 37
+#define BIT_NS 1250        // 800kHz
+#define ONE_HIGH_NS 875    // 7 of the 10 cycles a bit takes
+#define ZERO_HIGH_NS 250   // 2 of them
+#define LATCH_GAP_NS 50000 // low for longer than this and the LEDs latch, WS2812B need 280us
+
+namespace
+{
+	struct WireBit
+	{
+		bool one;
+		uint64_t riseNs;
+		uint64_t fallNs;
+	};
+
+	// Every pulse the state machines put on pin, the line idles low
+	std::vector<WireBit> decodeBits(const std::vector<HostSDK::PinEdge> &edges, uint pin)
+	{
+		std::vector<WireBit> bits;
+		uint64_t riseNs = 0;
+		bool high = false;
+		for (const HostSDK::PinEdge &edge : edges) {
+			if (edge.pin != pin)
+				continue;
+			EXPECT_NE(edge.high, high) << "at " << edge.ns;
+			if (edge.high)
+				riseNs = edge.ns;
+			else
+				bits.push_back({ edge.ns - riseNs > (ONE_HIGH_NS + ZERO_HIGH_NS) / 2, riseNs, edge.ns });
+			high = edge.high;
+		}
+		EXPECT_FALSE(high) << "the line is left high";
+		return bits;
+	}
+
+	// Bits split where the line stayed low long enough to latch, grouped into pixels MSB first
+	std::vector<std::vector<uint32_t>> decodeFrames(const std::vector<WireBit> &bits, uint bitsPerPixel)
+	{
+		std::vector<std::vector<uint32_t>> frames;
+		size_t inFrame = 0;
+		for (size_t i = 0; i < bits.size(); i++) {
+			if (i == 0 || bits[i].riseNs - bits[i - 1].fallNs >= LATCH_GAP_NS) {
+				EXPECT_EQ(inFrame % bitsPerPixel, 0u) << "frame cut off inside a pixel";
+				frames.emplace_back();
+				inFrame = 0;
+			}
+			if (inFrame % bitsPerPixel == 0)
+				frames.back().push_back(0);
+			frames.back().back() = (frames.back().back() << 1) | bits[i].one;
+			inFrame++;
+		}
+		EXPECT_EQ(inFrame % bitsPerPixel, 0u) << "frame cut off inside a pixel";
+		return frames;
+	}
+
+	bool isRgbw(LEDFormat format) { return format == LED_FORMAT_GRBW || format == LED_FORMAT_RGBW; }
+
+	// What the LEDs should receive for frame, NeoPico sends the low 24 bits of each pixel unless it has white
+	std::vector<uint32_t> expectedPixels(const uint32_t *frame, LEDFormat format)
+	{
+		std::vector<uint32_t> pixels;
+		for (int i = 0; i < LED_COUNT; i++)
+			pixels.push_back(isRgbw(format) ? frame[i] : frame[i] & 0xffffff);
+		return pixels;
+	}
+
+	class NeoPicoTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			srand(21);
+		}
+
+		void randomFrame(uint32_t *frame)
+		{
+			for (int i = 0; i < 100; i++)
+				frame[i] = (static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand());
+		}
+
+		// Lets every frame go out and latch, so NeoPico can be destroyed
+		void settle(NeoPico &leds)
+		{
+			for (int waited = 0; leds.IsBusy(); waited++) {
+				ASSERT_LT(waited, 100000) << "never latched";
+				HostSDK::advanceTime(1);
+			}
+		}
+
+		std::vector<HostSDK::PinEdge> edges;
+
+		void takeEdges()
+		{
+			const std::vector<HostSDK::PinEdge> taken = HostSDK::takePioEdges();
+			edges.insert(edges.end(), taken.begin(), taken.end());
+		}
+	};
+}
+
+TEST_F(NeoPicoTest, EveryFormatComesOutBitExact)
+{
+	for (LEDFormat format : { LED_FORMAT_GRB, LED_FORMAT_RGB, LED_FORMAT_GRBW, LED_FORMAT_RGBW }) {
+		SCOPED_TRACE(format);
+		SetUp();
+		uint32_t frame[100];
+		randomFrame(frame);
+		{
+			NeoPico leds(LED_PIN, LED_COUNT, format);
+			leds.SetFrame(frame);
+			leds.Show();
+			settle(leds);
+		}
+
+		const std::vector<WireBit> bits = decodeBits(HostSDK::takePioEdges(), LED_PIN);
+		const std::vector<std::vector<uint32_t>> frames = decodeFrames(bits, isRgbw(format) ? 32 : 24);
+		ASSERT_EQ(frames.size(), 1u);
+		EXPECT_EQ(frames[0], expectedPixels(frame, format));
+
+		for (size_t i = 0; i < bits.size(); i++) {
+			EXPECT_EQ(bits[i].fallNs - bits[i].riseNs, bits[i].one ? ONE_HIGH_NS : ZERO_HIGH_NS) << "bit " << i;
+			if (i > 0)
+				EXPECT_EQ(bits[i].riseNs - bits[i - 1].riseNs, BIT_NS) << "bit " << i;
+		}
+	}
+}
+
+TEST_F(NeoPicoTest, ShowReturnsAtOnceAndLatchesAfterTheReset)
+{
+	uint32_t frame[100];
+	randomFrame(frame);
+	NeoPico leds(LED_PIN, LED_COUNT);
+	leds.SetFrame(frame);
+
+	const uint64_t shown = HostSDK::now();
+	leds.Show();
+	EXPECT_EQ(HostSDK::now(), shown);
+	EXPECT_TRUE(leds.IsBusy());
+	EXPECT_EQ(leds.GetFramesShown(), 0u);
+
+	while (leds.IsBusy()) {
+		EXPECT_EQ(leds.GetFramesShown(), 0u);
+		HostSDK::advanceTime(1);
+	}
+	EXPECT_EQ(leds.GetFramesShown(), 1u);
+
+	// Latched once the line has been low for the reset time after the last bit
+	const std::vector<WireBit> bits = decodeBits(HostSDK::takePioEdges(), LED_PIN);
+	ASSERT_EQ(bits.size(), LED_COUNT * 24u);
+	EXPECT_GE(HostSDK::now() * 1000 - bits.back().fallNs, NEO_PICO_RESET_US * 1000 - BIT_NS);
+	EXPECT_LE(HostSDK::now() - shown, LED_COUNT * 30u + NEO_PICO_RESET_US + 1);
+}
+
+TEST_F(NeoPicoTest, FramesShownWhileSendingGoOutAfterTheLatch)
+{
+	uint32_t first[100], second[100], third[100];
+	randomFrame(first);
+	randomFrame(second);
+	randomFrame(third);
+	NeoPico leds(LED_PIN, LED_COUNT);
+
+	leds.SetFrame(first);
+	leds.Show();
+	HostSDK::advanceTime(100);
+	leds.SetFrame(second);
+	leds.Show();
+	HostSDK::advanceTime(100);
+	// Replaces the queued one, which never goes out
+	leds.SetFrame(third);
+	leds.Show();
+	EXPECT_TRUE(leds.IsBusy());
+	settle(leds);
+	EXPECT_EQ(leds.GetFramesShown(), 2u);
+
+	const std::vector<WireBit> bits = decodeBits(HostSDK::takePioEdges(), LED_PIN);
+	const std::vector<std::vector<uint32_t>> frames = decodeFrames(bits, 24);
+	ASSERT_EQ(frames.size(), 2u);
+	EXPECT_EQ(frames[0], expectedPixels(first, LED_FORMAT_GRB));
+	EXPECT_EQ(frames[1], expectedPixels(third, LED_FORMAT_GRB));
+	const size_t split = LED_COUNT * 24;
+	EXPECT_GE(bits[split].riseNs - bits[split - 1].fallNs, 280000u);
+}
+
+// The latch waits for the FIFO to drain when the state machine falls behind the alarm, then for the
+// last word to shift out and the reset time. Pauses across a whole alarm period, so the FIFO drains
+// at every point between two of its checks
+TEST_F(NeoPicoTest, SlowStateMachineDelaysTheLatch)
+{
+	for (uint pause = 2000; pause < 2000 + NEO_PICO_RESET_US; pause += 7) {
+		SCOPED_TRACE(pause);
+		SetUp();
+		edges.clear();
+		uint32_t first[100], second[100];
+		randomFrame(first);
+		randomFrame(second);
+		NeoPico leds(LED_PIN, LED_COUNT);
+
+		leds.SetFrame(first);
+		leds.Show();
+		leds.SetFrame(second);
+		leds.Show();
+
+		// Stop it between bits, with the line low
+		HostSDK::advanceTime(500);
+		for (;;) {
+			takeEdges();
+			if (!edges.back().high)
+				break;
+			HostSDK::advanceTime(1);
+		}
+		pio_sm_set_enabled(pio0, 0, false);
+		HostSDK::advanceTime(pause);
+		EXPECT_EQ(leds.GetFramesShown(), 0u);
+		pio_sm_set_enabled(pio0, 0, true);
+		settle(leds);
+		EXPECT_EQ(leds.GetFramesShown(), 2u);
+		takeEdges();
+
+		const std::vector<WireBit> bits = decodeBits(edges, LED_PIN);
+		ASSERT_EQ(bits.size(), 2 * LED_COUNT * 24u);
+		const std::vector<WireBit> firstBits(bits.begin(), bits.begin() + LED_COUNT * 24);
+		const std::vector<WireBit> secondBits(bits.begin() + LED_COUNT * 24, bits.end());
+		EXPECT_EQ(decodeFrames(secondBits, 24), std::vector<std::vector<uint32_t>>{ expectedPixels(second, LED_FORMAT_GRB) });
+		std::vector<uint32_t> sent;
+		for (const std::vector<uint32_t> &part : decodeFrames(firstBits, 1))
+			sent.insert(sent.end(), part.begin(), part.end());
+		std::vector<uint32_t> expected;
+		for (uint32_t pixel : expectedPixels(first, LED_FORMAT_GRB)) {
+			for (int bit = 23; bit >= 0; bit--)
+				expected.push_back((pixel >> bit) & 1);
+		}
+		EXPECT_EQ(sent, expected);
+		EXPECT_GE(secondBits.front().riseNs - firstBits.back().fallNs, 280000u);
+	}
+}
+
+TEST_F(NeoPicoTest, PushesTheFifoItselfWithoutADmaChannel)
+{
+	while (dma_claim_unused_channel(false) >= 0) {}
+	uint32_t frame[100];
+	randomFrame(frame);
+	NeoPico leds(LED_PIN, LED_COUNT, LED_FORMAT_RGBW);
+	leds.SetFrame(frame);
+
+	const uint64_t shown = HostSDK::now();
+	leds.Show();
+	EXPECT_GE(HostSDK::now() - shown, LED_COUNT * 40u + NEO_PICO_RESET_US);
+	EXPECT_FALSE(leds.IsBusy());
+	EXPECT_EQ(leds.GetFramesShown(), 1u);
+
+	const std::vector<std::vector<uint32_t>> frames = decodeFrames(decodeBits(HostSDK::takePioEdges(), LED_PIN), 32);
+	ASSERT_EQ(frames.size(), 1u);
+	EXPECT_EQ(frames[0], expectedPixels(frame, LED_FORMAT_RGBW));
+}
+
+TEST_F(NeoPicoTest, DestructorHandsEverythingBack)
+{
+	static const uint16_t fill[PIO_INSTRUCTION_COUNT] = {};
+	const pio_program_t whole = { fill, PIO_INSTRUCTION_COUNT, -1 };
+	{
+		NeoPico leds(LED_PIN, LED_COUNT);
+		EXPECT_FALSE(pio_can_add_program(pio0, &whole));
+		leds.Show();
+		settle(leds);
+	}
+	EXPECT_TRUE(pio_can_add_program(pio0, &whole));
+	EXPECT_EQ(pio_claim_unused_sm(pio0, false), 0);
+	EXPECT_EQ(dma_claim_unused_channel(false), 0);
+}
+
+TEST_F(NeoPicoTest, PlaceholderDrivesNothing)
+{
+	{
+		NeoPico leds(-1, LED_COUNT);
+		leds.Show();
+		EXPECT_FALSE(leds.IsBusy());
+		EXPECT_EQ(pio_claim_unused_sm(pio0, false), 0);
+		EXPECT_EQ(dma_claim_unused_channel(false), 0);
+	}
+	HostSDK::advanceTime(2000);
+	EXPECT_TRUE(HostSDK::takePioEdges().empty());
+}
+
+// As when the keyboard host's PIO-USB has filled pio0
+TEST_F(NeoPicoTest, MovesToPio1WhenPio0IsFull)
+{
+	static const uint16_t fill[PIO_INSTRUCTION_COUNT - 2] = {};
+	const pio_program_t program = { fill, PIO_INSTRUCTION_COUNT - 2, -1 };
+	pio_add_program(pio0, &program);
+
+	uint32_t frame[100];
+	randomFrame(frame);
+	NeoPico leds(LED_PIN, LED_COUNT);
+	leds.SetFrame(frame);
+	leds.Show();
+	settle(leds);
+
+	EXPECT_EQ(pio_claim_unused_sm(pio0, false), 0);
+	EXPECT_EQ(pio_claim_unused_sm(pio1, false), 1);
+	const std::vector<std::vector<uint32_t>> frames = decodeFrames(decodeBits(HostSDK::takePioEdges(), LED_PIN), 24);
+	ASSERT_EQ(frames.size(), 1u);
+	EXPECT_EQ(frames[0], expectedPixels(frame, LED_FORMAT_GRB));
+}
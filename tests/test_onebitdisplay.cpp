@@ -0,0 +1,157 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * obdDumpBufferDiff() against the mock panel in support/mock_oled.cpp: after every flush the panel
+ * has to show the back buffer, whatever was drawn, and the bytes on the wire have to stay with
+ * the change.
+ */
+
+#include "OneBitDisplay.h"
+
+#include "host_sdk.h"
+#include "mock_oled.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define DISPLAY_ADDRESS 0x3C
+
+namespace
+{
+	class OneBitDisplayTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			HostSDK::attachI2CDevice(0, DISPLAY_ADDRESS, &panel);
+		}
+
+		// Brought up like I2CDisplayAddon::setup(): cleared on the panel, the shadow says so
+		void begin()
+		{
+			obdI2CInit(&obd, OLED_128x64, DISPLAY_ADDRESS, 0, 0, 1, 0, 1, i2c0, -1, 800000);
+			obdSetBackBuffer(&obd, backBuffer);
+			obdFill(&obd, 0, 1);
+			memset(shadow, 0, sizeof(shadow));
+		}
+
+		std::vector<uint8_t> expected() const { return std::vector<uint8_t>(backBuffer, backBuffer + sizeof(backBuffer)); }
+
+		// What a frame of the display addon does to the back buffer, now and then starting over
+		void drawRandomFrame(std::mt19937& rng)
+		{
+			switch (rng() % 8) {
+				case 0:
+					obdFill(&obd, 0, 0);
+					break;
+				case 1: {
+					char text[8];
+					snprintf(text, sizeof(text), "%u", static_cast<unsigned>(rng() % 100000));
+					obdWriteString(&obd, 0, rng() % 128, rng() % 8, text, FONT_6x8, rng() & 1, 0);
+					break;
+				}
+				case 2:
+					obdRectangle(&obd, rng() % 128, rng() % 64, rng() % 128, rng() % 64, rng() & 1, rng() & 1);
+					break;
+				case 3:
+					obdPreciseEllipse(&obd, rng() % 128, rng() % 64, 1 + rng() % 8, 1 + rng() % 8, rng() & 1, rng() & 1);
+					break;
+				case 4:
+					backBuffer[rng() % sizeof(backBuffer)] ^= 1 << (rng() % 8);
+					break;
+				default: {
+					const int pixels = rng() % 4;
+					for (int i = 0; i < pixels; i++)
+						obdSetPixel(&obd, rng() % 128, rng() % 64, rng() & 1, 0);
+					break;
+				}
+			}
+		}
+
+		MockOled panel;
+		OBDISP obd;
+		uint8_t backBuffer[1024];
+		uint8_t shadow[1024];
+	};
+}
+
+TEST_F(OneBitDisplayTest, PanelShowsTheBackBufferAfterEveryFlush)
+{
+	begin();
+	std::mt19937 rng(1);
+	for (int frame = 0; frame < 20000; frame++) {
+		drawRandomFrame(rng);
+		obdDumpBufferDiff(&obd, shadow);
+		ASSERT_EQ(panel.shown(128, 64), expected()) << "frame " << frame;
+		ASSERT_EQ(memcmp(shadow, backBuffer, sizeof(shadow)), 0) << "frame " << frame;
+	}
+	EXPECT_EQ(panel.error, "");
+}
+
+TEST_F(OneBitDisplayTest, UnchangedFrameSendsNothing)
+{
+	begin();
+	obdWriteString(&obd, 0, 0, 0, (char *)"GP2040-CE", FONT_6x8, 0, 0);
+	obdRectangle(&obd, 10, 20, 40, 50, 1, 1);
+	obdDumpBufferDiff(&obd, shadow);
+
+	const uint32_t writes = HostSDK::counters().i2cWrites;
+	obdDumpBufferDiff(&obd, shadow);
+	EXPECT_EQ(HostSDK::counters().i2cWrites, writes);
+
+	// Cleared and drawn again the same, as a redrawn frame is
+	obdFill(&obd, 0, 0);
+	obdWriteString(&obd, 0, 0, 0, (char *)"GP2040-CE", FONT_6x8, 0, 0);
+	obdRectangle(&obd, 10, 20, 40, 50, 1, 1);
+	obdDumpBufferDiff(&obd, shadow);
+	EXPECT_EQ(HostSDK::counters().i2cWrites, writes);
+}
+
+TEST_F(OneBitDisplayTest, SinglePixelIsOnePositionAndOneDataWrite)
+{
+	begin();
+	const HostSDK::Counters before = HostSDK::counters();
+	obdSetPixel(&obd, 70, 30, 1, 0);
+	obdDumpBufferDiff(&obd, shadow);
+
+	EXPECT_EQ(HostSDK::counters().i2cWrites - before.i2cWrites, 2u);
+	EXPECT_EQ(HostSDK::counters().i2cBytes - before.i2cBytes, 6u); // page and column commands, then one data byte
+	EXPECT_EQ(panel.shown(128, 64), expected());
+}
+
+TEST_F(OneBitDisplayTest, ChangesWithinTheMergeGapShareOneWrite)
+{
+	begin();
+	uint32_t writes = HostSDK::counters().i2cWrites;
+	obdSetPixel(&obd, 10, 0, 1, 0);
+	obdSetPixel(&obd, 10 + OBD_DIFF_MERGE_GAP, 0, 1, 0);
+	obdDumpBufferDiff(&obd, shadow);
+	EXPECT_EQ(HostSDK::counters().i2cWrites - writes, 2u);
+
+	writes = HostSDK::counters().i2cWrites;
+	obdSetPixel(&obd, 10, 8, 1, 0);
+	obdSetPixel(&obd, 10 + OBD_DIFF_MERGE_GAP + 1, 8, 1, 0);
+	obdDumpBufferDiff(&obd, shadow);
+	EXPECT_EQ(HostSDK::counters().i2cWrites - writes, 4u);
+	EXPECT_EQ(panel.shown(128, 64), expected());
+}
+
+// An SH1106 has 132 columns of RAM with the visible 128 in the middle
+TEST_F(OneBitDisplayTest, SH1106ColumnsAreOffsetByTwo)
+{
+	MockOled sh1106(MOCK_OLED_STATUS_SH1106);
+	HostSDK::attachI2CDevice(0, DISPLAY_ADDRESS, &sh1106);
+	begin();
+	EXPECT_EQ(obd.type, OLED_132x64);
+
+	std::mt19937 rng(2);
+	for (int frame = 0; frame < 2000; frame++) {
+		drawRandomFrame(rng);
+		obdDumpBufferDiff(&obd, shadow);
+		ASSERT_EQ(sh1106.shown(128, 64, 2), expected()) << "frame " << frame;
+	}
+}
@@ -0,0 +1,172 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Report encoders for every input mode against the baseline encoders in support/reference_gamepad.cpp,
+ * over random states including dpad combinations that can't come out of SOCD cleaning.
+ */
+
+#include "gamepad.h"
+#include "storagemanager.h"
+
+#include "host_sdk.h"
+#include "host_storage.h"
+#include "reference_gamepad.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+	GamepadState randomState(std::mt19937& rng, uint32_t frame)
+	{
+		GamepadState state;
+		state.dpad = frame & GAMEPAD_MASK_DPAD; // every combination in turn
+		state.buttons = rng() & 0x3fff;
+		state.aux = rng() & 0xffff;
+		// Mostly full range, sometimes resting or at the ends
+		switch (rng() % 4) {
+			case 0:
+				break;
+			case 1:
+				state.lx = state.ly = state.rx = state.ry = (rng() & 1) ? GAMEPAD_JOYSTICK_MAX : GAMEPAD_JOYSTICK_MIN;
+				break;
+			default:
+				state.lx = rng() & 0xffff;
+				state.ly = rng() & 0xffff;
+				state.rx = rng() & 0xffff;
+				state.ry = rng() & 0xffff;
+				break;
+		}
+		state.lt = rng() & 0xff;
+		state.rt = rng() & 0xff;
+		return state;
+	}
+
+	std::string hexDump(const void *data, size_t size)
+	{
+		std::string out;
+		char byte[4];
+		for (size_t i = 0; i < size; i++) {
+			snprintf(byte, sizeof(byte), "%02x ", static_cast<const uint8_t *>(data)[i]);
+			out += byte;
+		}
+		return out;
+	}
+
+	class ReportTest : public ::testing::TestWithParam<InputMode>
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			HostStorage::resetConfig();
+		}
+
+		// Builds reports for many states from both get*Report() and encodeReport() and compares them
+		void checkAgainstReference(bool tpShareForDs4, bool hasAnalogTriggers, uint32_t seed)
+		{
+			Storage::getInstance().getGamepadOptions().switchTpShareForDs4 = tpShareForDs4;
+			Gamepad gamepad;
+			gamepad.setup();
+			gamepad.setInputMode(GetParam());
+			gamepad.hasAnalogTriggers = hasAnalogTriggers;
+			const KeyboardMapping& keyboardMapping = Storage::getInstance().getKeyboardMapping();
+
+			std::mt19937 rng(seed);
+			uint8_t encoded[64];
+			uint8_t ps4Counter = 0;
+			for (uint32_t frame = 0; frame < 20000; frame++) {
+				gamepad.state = randomState(rng, frame);
+				memset(encoded, 0xAA, sizeof(encoded));
+				memcpy(encoded, gamepad.getReportTemplate(), gamepad.getReportSize());
+				gamepad.encodeReport(encoded);
+
+				switch (GetParam()) {
+					case INPUT_MODE_XINPUT: {
+						XInputReport expected = Reference::xinputReportTemplate;
+						Reference::fillXInputReport(gamepad.state, hasAnalogTriggers, expected);
+						ASSERT_EQ(gamepad.getReportSize(), sizeof(expected));
+						ASSERT_EQ(hexDump(encoded, sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						ASSERT_EQ(hexDump(gamepad.getXInputReport(), sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						break;
+					}
+					case INPUT_MODE_SWITCH: {
+						SwitchReport expected = Reference::switchReportTemplate;
+						Reference::fillSwitchReport(gamepad.state, expected);
+						ASSERT_EQ(gamepad.getReportSize(), sizeof(expected));
+						ASSERT_EQ(hexDump(encoded, sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						ASSERT_EQ(hexDump(gamepad.getSwitchReport(), sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						break;
+					}
+					case INPUT_MODE_HID: {
+						HIDReport expected = Reference::hidReportTemplate;
+						Reference::fillHIDReport(gamepad.state, expected);
+						ASSERT_EQ(gamepad.getReportSize(), sizeof(expected));
+						ASSERT_EQ(hexDump(encoded, sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						ASSERT_EQ(hexDump(gamepad.getHIDReport(), sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						break;
+					}
+					case INPUT_MODE_PS4: {
+						// Every PS4 report built bumps the shared counter, follow it from the first one
+						if (frame == 0)
+							ps4Counter = reinterpret_cast<const PS4Report *>(encoded)->report_counter;
+						PS4Report expected = Reference::ps4ReportTemplate;
+						Reference::fillPS4Report(gamepad.state, gamepad.getOptions(), hasAnalogTriggers, ps4Counter++, expected);
+						ASSERT_EQ(gamepad.getReportSize(), sizeof(expected));
+						ASSERT_EQ(hexDump(encoded, sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						expected = Reference::ps4ReportTemplate;
+						Reference::fillPS4Report(gamepad.state, gamepad.getOptions(), hasAnalogTriggers, ps4Counter++, expected);
+						ASSERT_EQ(hexDump(gamepad.getPS4Report(), sizeof(expected)), hexDump(&expected, sizeof(expected))) << "frame " << frame;
+						break;
+					}
+					case INPUT_MODE_KEYBOARD: {
+						KeyboardReport expected = Reference::keyboardReportTemplate;
+						Reference::fillKeyboardReport(gamepad.state, keyboardMapping, expected);
+						const KeyboardReport *actual = gamepad.getKeyboardReport();
+						ASSERT_EQ(hexDump(actual->keycode, sizeof(actual->keycode)), hexDump(expected.keycode, sizeof(expected.keycode))) << "frame " << frame;
+						ASSERT_EQ(actual->multimedia, expected.multimedia) << "frame " << frame;
+						ASSERT_EQ(hexDump(encoded, sizeof(KeyboardReport)), hexDump(actual, sizeof(KeyboardReport))) << "frame " << frame;
+						break;
+					}
+					default:
+						FAIL() << "no reference for input mode " << GetParam();
+				}
+
+				// Nothing past the report may be touched
+				for (size_t i = gamepad.getReportSize(); i < sizeof(encoded); i++)
+					ASSERT_EQ(encoded[i], 0xAA) << "byte " << i << " written past the report";
+			}
+		}
+	};
+}
+
+TEST_P(ReportTest, MatchesReference)
+{
+	checkAgainstReference(false, false, 1);
+}
+
+TEST_P(ReportTest, MatchesReferenceWithAnalogTriggers)
+{
+	checkAgainstReference(false, true, 2);
+}
+
+TEST_P(ReportTest, MatchesReferenceWithTouchpadShareSwapped)
+{
+	checkAgainstReference(true, false, 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(InputModes, ReportTest,
+	::testing::Values(INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4, INPUT_MODE_KEYBOARD),
+	[](const ::testing::TestParamInfo<InputMode>& info) {
+		switch (info.param) {
+			case INPUT_MODE_XINPUT:   return std::string("XInput");
+			case INPUT_MODE_SWITCH:   return std::string("Switch");
+			case INPUT_MODE_HID:      return std::string("HID");
+			case INPUT_MODE_PS4:      return std::string("PS4");
+			case INPUT_MODE_KEYBOARD: return std::string("Keyboard");
+			default:                  return std::to_string(info.param);
+		}
+	});
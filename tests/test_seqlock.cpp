@@ -0,0 +1,150 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * SeqLock handing PublishedGamepadData from a writer thread to readers, the way core0 publishes
+ * the processed gamepad for core1. Every field of a written value carries the same counter, so
+ * a torn copy shows up as fields that disagree.
+ */
+
+#include "seqlock.h"
+#include "storagemanager.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	PublishedGamepadData makeValue(uint32_t counter)
+	{
+		PublishedGamepadData value;
+		value.state.dpad = counter & 0xff;
+		value.state.buttons = counter & 0xffff;
+		value.state.aux = counter & 0xffff;
+		value.state.lx = counter & 0xffff;
+		value.state.ly = counter & 0xffff;
+		value.state.rx = counter & 0xffff;
+		value.state.ry = counter & 0xffff;
+		value.state.lt = counter & 0xff;
+		value.state.rt = counter & 0xff;
+		memset(value.featureData, counter & 0xff, sizeof(value.featureData));
+		return value;
+	}
+
+	bool isCoherent(const PublishedGamepadData& value)
+	{
+		const uint16_t counter = value.state.buttons;
+		const uint8_t low = counter & 0xff;
+		if (value.state.dpad != low || value.state.lt != low || value.state.rt != low)
+			return false;
+		if (value.state.aux != counter || value.state.lx != counter || value.state.ly != counter ||
+			value.state.rx != counter || value.state.ry != counter)
+			return false;
+		for (uint8_t byte : value.featureData) {
+			if (byte != low)
+				return false;
+		}
+		return true;
+	}
+
+	// Copies in two halves and can run a write in between, like core0 publishing halfway through core1's copy
+	struct SplitCopy
+	{
+		uint32_t first = 0;
+		uint32_t second = 0;
+
+		static std::function<void()> midCopy;
+
+		SplitCopy& operator=(const SplitCopy& other)
+		{
+			first = other.first;
+			if (midCopy) {
+				std::function<void()> hook;
+				hook.swap(midCopy); // once only, the write itself copies too
+				hook();
+			}
+			second = other.second;
+			return *this;
+		}
+	};
+
+	std::function<void()> SplitCopy::midCopy;
+}
+
+TEST(SeqLock, VersionCountsWrites)
+{
+	SeqLock<PublishedGamepadData> lock;
+	PublishedGamepadData value;
+	EXPECT_EQ(lock.version(), 0u);
+	EXPECT_EQ(lock.read(value), 0u);
+
+	lock.write(makeValue(7));
+	lock.write(makeValue(8));
+	EXPECT_EQ(lock.version(), 2u);
+	EXPECT_EQ(lock.read(value), 2u);
+	EXPECT_EQ(value.state.buttons, 8);
+	EXPECT_TRUE(isCoherent(value));
+}
+
+TEST(SeqLock, ReadRetriesWhenAWriteLandsMidCopy)
+{
+	SeqLock<SplitCopy> lock;
+	lock.write({ 1, 1 });
+
+	SplitCopy::midCopy = [&lock] { lock.write({ 2, 2 }); };
+	SplitCopy value;
+	const uint32_t version = lock.read(value);
+
+	EXPECT_FALSE(SplitCopy::midCopy);
+	EXPECT_EQ(version, 2u);
+	EXPECT_EQ(value.first, 2u);
+	EXPECT_EQ(value.second, 2u);
+}
+
+// Real threads, only finds anything on a host with more than one core
+TEST(SeqLock, ReadersNeverSeeTornValues)
+{
+	SeqLock<PublishedGamepadData> lock;
+	lock.write(makeValue(0));
+
+	const uint32_t writes = 200000;
+	std::atomic<bool> done { false };
+	std::atomic<uint32_t> torn { 0 };
+	std::atomic<uint32_t> backwards { 0 };
+	std::atomic<uint32_t> reads { 0 };
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 3; i++) {
+		readers.emplace_back([&] {
+			uint32_t lastVersion = 0;
+			PublishedGamepadData value;
+			while (!done.load(std::memory_order_acquire)) {
+				const uint32_t version = lock.read(value);
+				if (!isCoherent(value))
+					torn++;
+				// Write n stores counter n - 1, so the version says which value must come back
+				if (version < lastVersion || value.state.buttons != ((version - 1) & 0xffff))
+					backwards++;
+				lastVersion = version;
+				reads++;
+			}
+		});
+	}
+
+	while (reads.load() < readers.size())
+		std::this_thread::yield(); // let the readers get going first
+	for (uint32_t i = 1; i < writes; i++)
+		lock.write(makeValue(i));
+	done.store(true, std::memory_order_release);
+	for (std::thread& reader : readers)
+		reader.join();
+
+	EXPECT_EQ(torn.load(), 0u);
+	EXPECT_EQ(backwards.load(), 0u);
+	EXPECT_GT(reads.load(), 0u);
+	EXPECT_EQ(lock.version(), writes);
+}
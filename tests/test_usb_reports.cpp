@@ -0,0 +1,217 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The report path from gp2040.cpp (dirty check, encode into the driver's free endpoint buffer,
+ * send_report(), markReportSent()) against the stub USB device, for every input mode. The host polls
+ * at random, reading in-flight transfers straight from their buffers, so a report rewritten while
+ * it is in flight, or a field left stale by encoding over an older report, shows up in what it reads.
+ */
+
+#include "gamepad.h"
+#include "storagemanager.h"
+#include "usb_driver.h"
+#include "xinput_driver.h"
+#include "device/usbd_pvt.h"
+
+#include "host_sdk.h"
+#include "host_storage.h"
+#include "reference_gamepad.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+const usbd_class_driver_t *usbd_app_driver_get_cb(uint8_t *driver_count);
+
+namespace
+{
+	const uint8_t hidInterface[] = {
+		TUD_HID_DESCRIPTOR(0, 0, HID_ITF_PROTOCOL_NONE, 100, 0x81, CFG_TUD_HID_EP_BUFSIZE, 1)
+	};
+
+	const uint8_t xinputInterface[] = {
+		9, TUSB_DESC_INTERFACE, 0, 0, 2, TUSB_CLASS_VENDOR_SPECIFIC, 0x5D, 0x01, 0,
+		16, 0x21, 0x10, 0x01, 0x01, 0x24, 0x81, 0x14, 0x03, 0x00, 0x03, 0x13, 0x02, 0x00, 0x03, 0x00,
+		7, TUSB_DESC_ENDPOINT, 0x81, TUSB_XFER_INTERRUPT, 32, 0, 1,
+		7, TUSB_DESC_ENDPOINT, 0x02, TUSB_XFER_INTERRUPT, 32, 0, 8,
+	};
+
+	std::vector<uint8_t> bytesOf(const void *data, size_t size)
+	{
+		const uint8_t *bytes = static_cast<const uint8_t *>(data);
+		return std::vector<uint8_t>(bytes, bytes + size);
+	}
+
+	// What the host should read for a state, the way the baseline encoders built it
+	std::vector<uint8_t> expectedReport(Gamepad& gamepad, InputMode mode, const void *sentBuffer)
+	{
+		const GamepadState& state = gamepad.state;
+		switch (mode) {
+			case INPUT_MODE_XINPUT: {
+				XInputReport report = Reference::xinputReportTemplate;
+				Reference::fillXInputReport(state, gamepad.hasAnalogTriggers, report);
+				return bytesOf(&report, sizeof(report));
+			}
+			case INPUT_MODE_SWITCH: {
+				SwitchReport report = Reference::switchReportTemplate;
+				Reference::fillSwitchReport(state, report);
+				return bytesOf(&report, sizeof(report));
+			}
+			case INPUT_MODE_PS4: {
+				// The running counter is followed from the buffer, the rest has to match
+				const PS4Report *sent = static_cast<const PS4Report *>(sentBuffer);
+				PS4Report report = Reference::ps4ReportTemplate;
+				Reference::fillPS4Report(state, gamepad.getOptions(), gamepad.hasAnalogTriggers, sent->report_counter, report);
+				return bytesOf(&report, sizeof(report));
+			}
+			case INPUT_MODE_KEYBOARD: {
+				// tud_hid_report() puts the report ID in front of the keys or the multimedia bits
+				const KeyboardReport *sent = static_cast<const KeyboardReport *>(sentBuffer);
+				KeyboardReport report = Reference::keyboardReportTemplate;
+				Reference::fillKeyboardReport(state, Storage::getInstance().getKeyboardMapping(), report);
+				std::vector<uint8_t> bytes = { sent->reportId };
+				if (sent->reportId == KEYBOARD_KEY_REPORT_ID) {
+					bytes.insert(bytes.end(), report.keycode, report.keycode + sizeof(report.keycode));
+				} else {
+					const std::vector<uint8_t> multimedia = bytesOf(&report.multimedia, sizeof(report.multimedia));
+					bytes.insert(bytes.end(), multimedia.begin(), multimedia.end());
+				}
+				return bytes;
+			}
+			default: {
+				HIDReport report = Reference::hidReportTemplate;
+				Reference::fillHIDReport(state, report);
+				return bytesOf(&report, sizeof(report));
+			}
+		}
+	}
+
+	class UsbReportTest : public ::testing::TestWithParam<InputMode>
+	{
+	protected:
+		void SetUp() override
+		{
+			HostSDK::reset();
+			HostStorage::resetConfig();
+
+			initialize_driver(GetParam());
+			uint8_t driverCount;
+			const usbd_class_driver_t *driver = usbd_app_driver_get_cb(&driverCount);
+			if (GetParam() == INPUT_MODE_XINPUT) {
+				driver->open(0, reinterpret_cast<const tusb_desc_interface_t *>(xinputInterface), sizeof(xinputInterface));
+				endpoint = endpoint_in;
+			} else {
+				driver->open(0, reinterpret_cast<const tusb_desc_interface_t *>(hidInterface), sizeof(hidInterface));
+				endpoint = HostSDK::usbHidEndpoint();
+			}
+			HostSDK::setUsbMounted(true);
+		}
+
+		// One pass of the report section of the core0 loop
+		bool sendIfDirty(Gamepad& gamepad, std::vector<uint8_t>& sent)
+		{
+			if (!gamepad.isReportDirty())
+				return false;
+			void *buffer = get_report_buffer();
+			gamepad.encodeReport(buffer);
+			if (!send_report(gamepad.getReportSize()))
+				return false;
+			gamepad.markReportSent();
+			sent = expectedReport(gamepad, GetParam(), buffer);
+			return true;
+		}
+
+		uint8_t endpoint = 0;
+	};
+}
+
+TEST_P(UsbReportTest, HostReadsEveryReportAsItWasSent)
+{
+	const InputMode mode = GetParam();
+	Gamepad gamepad;
+	gamepad.setup();
+	gamepad.setInputMode(mode);
+	init_report_buffers(gamepad.getReportTemplate(), gamepad.getReportSize());
+
+	std::mt19937 rng(static_cast<uint32_t>(mode) + 1);
+	std::vector<uint8_t> inFlight;
+	uint32_t sends = 0;
+	uint32_t polls = 0;
+	for (uint32_t frame = 0; frame < 50000; frame++) {
+		// Inputs change in bursts, and stay put in between
+		if (rng() % 4 == 0) {
+			gamepad.state.buttons = rng() & 0x3fff;
+			gamepad.state.dpad = rng() & GAMEPAD_MASK_DPAD;
+			gamepad.state.lx = (rng() & 1) ? GAMEPAD_JOYSTICK_MID : rng() & 0xffff;
+			gamepad.state.lt = rng() & 0xff;
+		}
+
+		// Full speed interrupt endpoints are polled at most once a millisecond, the loop runs every 100us
+		if (rng() % 10 == 0 && HostSDK::usbInFlight(endpoint)) {
+			ASSERT_EQ(HostSDK::pollUsbIn(endpoint), inFlight) << "frame " << frame;
+			polls++;
+		}
+
+		const uint32_t transfersBefore = HostSDK::counters().usbTransfers;
+		const bool dirty = gamepad.isReportDirty();
+		std::vector<uint8_t> sent;
+		if (sendIfDirty(gamepad, sent)) {
+			inFlight = sent;
+			sends++;
+			// Anything but PS4 has nothing more to send until the state changes
+			if (mode != INPUT_MODE_PS4)
+				ASSERT_FALSE(gamepad.isReportDirty()) << "frame " << frame;
+		}
+		if (!dirty)
+			ASSERT_EQ(HostSDK::counters().usbTransfers, transfersBefore) << "transfer for an unchanged state, frame " << frame;
+	}
+	EXPECT_GT(sends, 1000u);
+	EXPECT_GT(polls, 1000u);
+
+	// Once the inputs settle the host ends up with the last state, nothing is left behind
+	std::vector<uint8_t> last;
+	for (int frame = 0; frame < 10; frame++) {
+		if (HostSDK::usbInFlight(endpoint)) {
+			last = HostSDK::pollUsbIn(endpoint);
+			ASSERT_EQ(last, inFlight);
+		}
+		std::vector<uint8_t> sent;
+		if (sendIfDirty(gamepad, sent))
+			inFlight = sent;
+	}
+	EXPECT_EQ(last, expectedReport(gamepad, mode, get_report_buffer()));
+}
+
+TEST_P(UsbReportTest, NothingIsSentUntilMounted)
+{
+	HostSDK::setUsbMounted(false);
+	Gamepad gamepad;
+	gamepad.setup();
+	gamepad.setInputMode(GetParam());
+	init_report_buffers(gamepad.getReportTemplate(), gamepad.getReportSize());
+
+	std::vector<uint8_t> sent;
+	EXPECT_FALSE(sendIfDirty(gamepad, sent));
+	EXPECT_EQ(HostSDK::counters().usbTransfers, 0u);
+	EXPECT_TRUE(gamepad.isReportDirty()); // still owed once the host shows up
+
+	HostSDK::setUsbMounted(true);
+	EXPECT_TRUE(sendIfDirty(gamepad, sent));
+	EXPECT_EQ(HostSDK::pollUsbIn(endpoint), sent);
+}
+
+INSTANTIATE_TEST_SUITE_P(InputModes, UsbReportTest,
+	::testing::Values(INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4, INPUT_MODE_KEYBOARD),
+	[](const ::testing::TestParamInfo<InputMode>& info) {
+		switch (info.param) {
+			case INPUT_MODE_XINPUT:   return std::string("XInput");
+			case INPUT_MODE_SWITCH:   return std::string("Switch");
+			case INPUT_MODE_HID:      return std::string("HID");
+			case INPUT_MODE_PS4:      return std::string("PS4");
+			case INPUT_MODE_KEYBOARD: return std::string("Keyboard");
+			default:                  return std::to_string(info.param);
+		}
+	});
@@ -0,0 +1,176 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * The binary search over the web config route tables against the strcmp scan it replaced, and the
+ * arena JSON documents share: one block for every request, handed out to one document at a time.
+ */
+
+#include "configs/jsonarena.h"
+#include "configs/webconfig_routes.h"
+
+#include "webconfig_paths.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Byte order, not the locale: capitals sort before lower case, "/api/setPS4Options" before "/api/setPinMappings"
+	constexpr const char* unsorted[] = { "/api/setPinMappings", "/api/setPS4Options" };
+	constexpr const char* duplicated[] = { "/css", "/js", "/js" };
+	constexpr const char* prefixFirst[] = { "/api/get", "/api/getConfig" };
+	constexpr const char* prefixLast[] = { "/api/getConfig", "/api/get" };
+	constexpr const char* highBit[] = { "/api/z", "/api/\xe9" };
+
+	static_assert(!isSortedByPath(unsorted), "");
+	static_assert(!isSortedByPath(duplicated), "");
+	static_assert(isSortedByPath(prefixFirst), "");
+	static_assert(!isSortedByPath(prefixLast), "");
+	static_assert(isSortedByPath(highBit), "chars compare unsigned, like strcmp");
+
+	// Paths near the real ones: cut short, run on, one character changed, and the odd one
+	std::string nearPath(std::mt19937& rng, const std::string& path)
+	{
+		std::string near = path;
+		switch (rng() % 4) {
+			case 0:
+				near.resize(rng() % near.size());
+				break;
+			case 1:
+				near += static_cast<char>(' ' + rng() % 95);
+				break;
+			case 2:
+				near[rng() % near.size()] = static_cast<char>(' ' + rng() % 95);
+				break;
+			default:
+				near = (rng() & 1) ? "/" : "/api/getConfig?x=1";
+				break;
+		}
+		return near;
+	}
+}
+
+TEST(WebConfigRoutesTest, EveryRouteIsFound)
+{
+	for (const auto& route : WebConfigPaths::api) {
+		const auto* found = findRoute(WebConfigPaths::api, route.first);
+		ASSERT_NE(found, nullptr) << route.first;
+		EXPECT_EQ(found, &route);
+	}
+	for (const char* const& path : WebConfigPaths::spa)
+		EXPECT_EQ(findRoute(WebConfigPaths::spa, path), &path);
+}
+
+TEST(WebConfigRoutesTest, PathsAroundTheTableAreMissed)
+{
+	for (const char* path : { "", "/", "/api", "/api/", "/api/echo/", "/api/getConfig", "/api/getconfig", "/API/getGamepadOptions",
+		"/api/setSplashImagf", "/api/zzz", "/api/setPS4Options ", "/a", "/settingss" }) {
+		EXPECT_EQ(findRoute(WebConfigPaths::api, path), nullptr) << path;
+		EXPECT_EQ(findRoute(WebConfigPaths::spa, path), nullptr) << path;
+	}
+}
+
+TEST(WebConfigRoutesTest, SameAnswerAsTheLinearScan)
+{
+	std::vector<std::string> paths;
+	for (const auto& route : WebConfigPaths::api)
+		paths.push_back(route.first);
+	for (const char* path : WebConfigPaths::spa)
+		paths.push_back(path);
+
+	std::mt19937 rng(1);
+	for (int run = 0; run < 100000; run++) {
+		const std::string& path = paths[rng() % paths.size()];
+		const std::string probe = (rng() % 3) ? nearPath(rng, path) : path;
+		ASSERT_EQ(findRoute(WebConfigPaths::api, probe.c_str()), WebConfigPaths::linearScan(WebConfigPaths::api, probe.c_str())) << probe;
+		ASSERT_EQ(findRoute(WebConfigPaths::spa, probe.c_str()), WebConfigPaths::linearScan(WebConfigPaths::spa, probe.c_str())) << probe;
+	}
+}
+
+TEST(WebConfigRoutesTest, SingleEntryTable)
+{
+	constexpr std::pair<const char*, int> single[] = { { "/api/setConfig", 7 } };
+	static_assert(isSortedByPath(single), "");
+	ASSERT_NE(findRoute(single, "/api/setConfig"), nullptr);
+	EXPECT_EQ(findRoute(single, "/api/setConfig")->second, 7);
+	EXPECT_EQ(findRoute(single, "/api/getConfig"), nullptr);
+	EXPECT_EQ(findRoute(single, "/api/setConfigs"), nullptr);
+}
+
+// Each test has an arena of its own, the size is the template parameter
+TEST(JsonArenaTest, EveryRequestGetsTheSameBlock)
+{
+	typedef JsonArenaAllocator<1024> Allocator;
+	Allocator allocator;
+	void* first = allocator.allocate(512);
+	ASSERT_NE(first, nullptr);
+	EXPECT_EQ(first, Allocator::arena);
+	allocator.deallocate(first);
+	EXPECT_FALSE(Allocator::arenaInUse);
+
+	for (int request = 0; request < 100; request++) {
+		void* block = allocator.allocate(1 + request * 10);
+		EXPECT_EQ(block, first) << "request " << request;
+		memset(block, request, 1 + request * 10);
+		allocator.deallocate(block);
+	}
+	EXPECT_EQ(Allocator::arena, first);
+}
+
+TEST(JsonArenaTest, SecondDocumentFallsBackToTheHeap)
+{
+	typedef JsonArenaAllocator<1000> Allocator;
+	Allocator allocator;
+	void* document = allocator.allocate(1000);
+	void* copy = allocator.allocate(1000);
+	ASSERT_NE(copy, nullptr);
+	EXPECT_EQ(document, Allocator::arena);
+	EXPECT_NE(copy, document);
+	memset(copy, 0x55, 1000);
+
+	allocator.deallocate(copy); // must not release the arena
+	EXPECT_TRUE(Allocator::arenaInUse);
+	allocator.deallocate(document);
+	EXPECT_FALSE(Allocator::arenaInUse);
+	EXPECT_EQ(allocator.allocate(16), document);
+	allocator.deallocate(document);
+}
+
+TEST(JsonArenaTest, LargerThanTheArenaGoesToTheHeap)
+{
+	typedef JsonArenaAllocator<256> Allocator;
+	Allocator allocator;
+	void* large = allocator.allocate(257);
+	ASSERT_NE(large, nullptr);
+	EXPECT_FALSE(Allocator::arenaInUse);
+	EXPECT_NE(large, Allocator::arena);
+	void* small = allocator.allocate(256);
+	EXPECT_EQ(small, Allocator::arena);
+	allocator.deallocate(large);
+	EXPECT_TRUE(Allocator::arenaInUse);
+	allocator.deallocate(small);
+}
+
+// ArduinoJson shrinks a document to fit after parsing and grows it when it runs out, the arena can't move
+TEST(JsonArenaTest, ReallocateStaysInTheArena)
+{
+	typedef JsonArenaAllocator<512> Allocator;
+	Allocator allocator;
+	void* document = allocator.allocate(512);
+	EXPECT_EQ(allocator.reallocate(document, 100), document);
+	EXPECT_EQ(allocator.reallocate(document, 512), document);
+	EXPECT_EQ(allocator.reallocate(document, 513), nullptr);
+	EXPECT_TRUE(Allocator::arenaInUse);
+	allocator.deallocate(document);
+
+	void* heap = allocator.allocate(600);
+	heap = allocator.reallocate(heap, 6000);
+	ASSERT_NE(heap, nullptr);
+	memset(heap, 0, 6000);
+	allocator.deallocate(heap);
+	EXPECT_FALSE(Allocator::arenaInUse);
+}
@@ -191,6 +191,7 @@ app.get("/api/getLedOptions", (req, res) => {
 		pledPin3: 14,
 		pledPin4: 15,
 		pledColor: 65280,
+		ledEffect: "",
 	});
 });
 
@@ -292,6 +293,7 @@ app.get("/api/getAddonsOptions", (req, res) => {
 		i2cAnalog1219Block: 0,
 		i2cAnalog1219Speed: 400000,
 		i2cAnalog1219Address: 0x40,
+		i2cAnalog1219DRDYPin: -1,
 		onBoardLedMode: 0,
 		dualDirUpPin: -1,
 		dualDirDownPin: -1,
@@ -7,6 +7,7 @@ export default {
 		"leds-per-button-label": "LEDs Per Button",
 		"led-brightness-maximum-label": "Max Brightness",
 		"led-brightness-steps-label": "Brightness Steps",
+		"led-effect-label": "Effect Program (base64, empty for none)",
 	},
 	"player": {
 		"header-text": "Player LEDs (XInput)",
@@ -237,6 +237,7 @@ const schema = yup.object().shape({
 	i2cAnalog1219Block:          yup.number().label('I2C Analog1219 Block').validateSelectionWhenValue('I2CAnalog1219InputEnabled', I2C_BLOCKS),
 	i2cAnalog1219Speed:          yup.number().label('I2C Analog1219 Speed').validateNumberWhenValue('I2CAnalog1219InputEnabled'),
 	i2cAnalog1219Address:        yup.number().label('I2C Analog1219 Address').validateNumberWhenValue('I2CAnalog1219InputEnabled'),
+	i2cAnalog1219DRDYPin:        yup.number().label('I2C Analog1219 DRDY Pin').validatePinWhenValue('I2CAnalog1219InputEnabled'),
 
 	AnalogInputEnabled:          yup.number().required().label('Analog Input Enabled'),
 	analogAdc1PinX:              yup.number().label('Analog Stick 1 Pin X').validatePinWhenValue('AnalogInputEnabled'),
@@ -361,6 +362,7 @@ const defaultValues = {
 	i2cAnalog1219Block: 0,
 	i2cAnalog1219Speed: 400000,
 	i2cAnalog1219Address: 0x40,
+	i2cAnalog1219DRDYPin: -1,
 	onBoardLedMode: 0,
 	dualDirUpPin: -1,
 	dualDirDownPin: -1,
@@ -1213,6 +1215,18 @@ export default function AddonsConfigPage() {
 									onChange={handleChange}
 									maxLength={4}
 								/>
+								<FormControl type="number"
+									label={t('AddonsConfig:i2c-analog-ads1219-drdy-pin-label')}
+									name="i2cAnalog1219DRDYPin"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.i2cAnalog1219DRDYPin}
+									error={errors.i2cAnalog1219DRDYPin}
+									isInvalid={errors.i2cAnalog1219DRDYPin}
+									onChange={handleChange}
+									min={-1}
+									max={29}
+								/>
 							</Row>
 						</div>
 						<FormCheck
@@ -56,6 +56,7 @@ const defaultValue = {
 	pledIndex3: -1,
 	pledIndex4: -1,
 	pledColor: '#00ff00',
+	ledEffect: '',
 };
 
 const schema = yup.object().shape({
@@ -75,6 +76,7 @@ const schema = yup.object().shape({
 	pledIndex2        : yup.number().label('PLED Index 2').validateMinWhenEqualTo('pledType', 1, 0),
 	pledIndex3        : yup.number().label('PLED Index 3').validateMinWhenEqualTo('pledType', 1, 0),
 	pledIndex4        : yup.number().label('PLED Index 4').validateMinWhenEqualTo('pledType', 1, 0),
+	ledEffect         : yup.string().label('Effect Program').matches(/^([A-Za-z0-9+/]{4})*([A-Za-z0-9+/]{2}==|[A-Za-z0-9+/]{3}=)?$/, 'Effect Program must be base64'),
 });
 
 const getLedButtons = (buttonLabels, map, excludeNulls, swapTpShareLabels) => {
@@ -382,6 +384,18 @@ export default function LEDConfigPage() {
 								max={10}
 							/>
 						</Row>
+						<Row>
+							<FormControl type="text"
+								label={t('LedConfig:rgb.led-effect-label')}
+								name="ledEffect"
+								className="form-control-sm"
+								groupClassName="col-sm-12 mb-3"
+								value={values.ledEffect}
+								error={errors.ledEffect}
+								isInvalid={errors.ledEffect}
+								onChange={handleChange}
+							/>
+						</Row>
 					</Section>
 					<Section title={t('LedConfig:player.header-text')}>
 						<Form.Group as={Col}>